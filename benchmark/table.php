@@ -7,11 +7,16 @@ $table->create();
 
 define('N', 1000000);
 define('C', 4);
+// readers of the contention test, php table.php [readers]
+define('READERS', intval($argv[1] ?? 64));
+define('HOT_KEYS', 64);
 
 test1();
 test2();
 test3();
 test4();
+test5(false);
+test5(true);
 
 
 function test1()
@@ -77,4 +82,49 @@ function test4()
     for ($i = C; $i--;) {
         swoole_process::wait();
     }
-}
\ No newline at end of file
+}
+
+/**
+ * many processes reading a few hot rows while one process keeps writing them,
+ * like session or rate-limit lookups from all the workers of a server
+ */
+function test5(bool $use_seqlock)
+{
+    $table = new swoole_table(1024, 0.2, $use_seqlock);
+    $table->column('hits', swoole_table::TYPE_INT, 8);
+    $table->column('ts', swoole_table::TYPE_INT, 8);
+    $table->create();
+    for ($i = 0; $i < HOT_KEYS; $i++) {
+        $table->set("user_$i", ['hits' => 0, 'ts' => 0]);
+    }
+    $result = new swoole_atomic_long(0);
+    $mode = $use_seqlock ? 'seqlock' : 'lock';
+
+    $writer = new swoole_process(function () use ($table) {
+        $n = 0;
+        while (true) {
+            $table->incr('user_' . ($n++ % HOT_KEYS), 'hits');
+        }
+    });
+    $writer->start();
+
+    $s = microtime(true);
+    for ($i = READERS; $i--;) {
+        (new swoole_process(function () use ($table, $result) {
+            $n = N / 10;
+            while ($n--) {
+                $table->get('user_' . ($n % HOT_KEYS), 'hits');
+            }
+            $result->add(N / 10);
+        }))->start();
+    }
+    for ($i = READERS; $i--;) {
+        swoole_process::wait();
+    }
+    $time = microtime(true) - $s;
+
+    swoole_process::kill($writer->pid, SIGKILL);
+    swoole_process::wait();
+    echo "[$mode] " . READERS . " readers, 1 writer, get " . $result->get() . " keys, use: " .
+        round($time * 1000, 2) . "ms, " . round($result->get() / $time) . " reads/s\n";
+}
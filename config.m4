@@ -262,8 +262,13 @@ if test "$PHP_SWOOLE" != "no"; then
     AC_CHECK_LIB(c, signalfd, AC_DEFINE(HAVE_SIGNALFD, 1, [have signalfd]))
     AC_CHECK_LIB(c, eventfd, AC_DEFINE(HAVE_EVENTFD, 1, [have eventfd]))
     AC_CHECK_LIB(c, epoll_create, AC_DEFINE(HAVE_EPOLL, 1, [have epoll]))
+    AC_CHECK_HEADER(linux/io_uring.h, AC_DEFINE(HAVE_IO_URING, 1, [have io_uring]))
+    AC_CHECK_HEADER(linux/openat2.h, AC_DEFINE(HAVE_OPENAT2, 1, [have openat2]))
     AC_CHECK_LIB(c, poll, AC_DEFINE(HAVE_POLL, 1, [have poll]))
     AC_CHECK_LIB(c, sendfile, AC_DEFINE(HAVE_SENDFILE, 1, [have sendfile]))
+    AC_CHECK_LIB(c, recvmmsg, AC_DEFINE(HAVE_RECVMMSG, 1, [have recvmmsg]))
+    AC_CHECK_LIB(c, sendmmsg, AC_DEFINE(HAVE_SENDMMSG, 1, [have sendmmsg]))
+    AC_CHECK_LIB(c, preadv2, AC_DEFINE(HAVE_PREADV2, 1, [have preadv2]))
     AC_CHECK_LIB(c, kqueue, AC_DEFINE(HAVE_KQUEUE, 1, [have kqueue]))
     AC_CHECK_LIB(c, backtrace, AC_DEFINE(HAVE_EXECINFO, 1, [have execinfo]))
     AC_CHECK_LIB(c, daemon, AC_DEFINE(HAVE_DAEMON, 1, [have daemon]))
@@ -416,12 +421,14 @@ if test "$PHP_SWOOLE" != "no"; then
         src/core/ring_queue.cc \
         src/core/socket.cc \
         src/core/string.cc \
+        src/core/timing_wheel.cc \
         src/coroutine/base.cc \
         src/coroutine/channel.cc \
         src/coroutine/context.cc \
         src/coroutine/file_lock.cc \
         src/coroutine/hook.cc \
         src/coroutine/socket.cc \
+        src/coroutine/stack_pool.cc \
         src/coroutine/system.cc \
         src/coroutine/thread_context.cc \
         src/coroutine/ucontext.cc \
@@ -438,6 +445,7 @@ if test "$PHP_SWOOLE" != "no"; then
         src/memory/malloc.cc \
         src/memory/ring_buffer.cc \
         src/memory/shared_memory.cc \
+        src/memory/shm_ring.cc \
         src/memory/table.cc \
         src/network/client.cc \
         src/network/dns.cc \
@@ -445,8 +453,10 @@ if test "$PHP_SWOOLE" != "no"; then
         src/network/stream.cc \
         src/network/thread_pool.cc \
         src/network/timer.cc \
+        src/os/async_io_uring.cc \
         src/os/async_thread.cc \
         src/os/base.cc \
+        src/os/io_uring.cc \
         src/os/msg_queue.cc \
         src/os/sendfile.cc \
         src/os/signal.cc \
@@ -469,10 +479,12 @@ if test "$PHP_SWOOLE" != "no"; then
         src/protocol/websocket.cc \
         src/reactor/base.cc \
         src/reactor/epoll.cc \
+        src/reactor/io_uring.cc \
         src/reactor/kqueue.cc \
         src/reactor/poll.cc \
         src/reactor/select.cc \
         src/server/base.cc \
+        src/server/http_cache.cc \
         src/server/manager.cc \
         src/server/master.cc \
         src/server/port.cc \
@@ -188,3 +188,35 @@ TEST(coroutine_base, get_peak_num)
         });
     });
 }
+
+TEST(coroutine_base, stack_pool)
+{
+    StackPool::clear();
+    size_t max_num = Coroutine::get_stack_pool_size();
+
+    Coroutine::set_stack_pool_size(2);
+    for (int i = 0; i < 4; i++)
+    {
+        Coroutine::create([](void *arg)
+        {
+            Coroutine::create([](void *arg)
+            {
+                Coroutine::create([](void *arg)
+                {
+                    // the stack must still be usable after being released with madvise()
+                    char buf[SW_CORO_STACK_POOL_HOT_SIZE * 2];
+                    memset(buf, 'A', sizeof(buf));
+                    ASSERT_EQ(buf[0], 'A');
+                });
+            });
+        });
+        ASSERT_EQ(StackPool::count(), 2);
+    }
+
+    Coroutine::set_stack_pool_size(0);
+    ASSERT_EQ(StackPool::count(), 0);
+    Coroutine::create([](void *arg) {});
+    ASSERT_EQ(StackPool::count(), 0);
+
+    Coroutine::set_stack_pool_size(max_num);
+}
@@ -0,0 +1,95 @@
+#include "tests.h"
+#include "swoole/coroutine_c_api.h"
+#include "swoole/coroutine_system.h"
+
+#include <fcntl.h>
+#include <sys/uio.h>
+
+using swoole::test::coroutine;
+using swoole::coroutine::System;
+
+#if defined(HAVE_PREADV2) && defined(RWF_NOWAIT)
+
+static const char *test_file = "/tmp/swoole_file_nowait_test";
+
+static size_t file_dispatch_num()
+{
+    swAio_lane_stats stats;
+    swAio_get_lane_stats(SW_AIO_LANE_FILE, &stats);
+    return stats.dispatch_num;
+}
+
+TEST(coroutine_file_nowait, read)
+{
+    ASSERT_EQ(swoole_file_put_contents(test_file, SW_STRL("hello world")), SW_OK);
+
+    coroutine::test([](void *arg)
+    {
+        char buf[64];
+        // the file has just been written, it is in the page cache
+        size_t dispatch_num = file_dispatch_num();
+
+        int fd = open(test_file, O_RDONLY);
+        ASSERT_GT(fd, 0);
+        ASSERT_EQ(swoole_coroutine_read(fd, buf, 5), 5);
+        ASSERT_EQ(memcmp(buf, "hello", 5), 0);
+        // continues at the current position
+        ASSERT_EQ(swoole_coroutine_read(fd, buf, sizeof(buf)), 6);
+        ASSERT_EQ(memcmp(buf, " world", 6), 0);
+        ASSERT_EQ(swoole_coroutine_read(fd, buf, sizeof(buf)), 0);
+        close(fd);
+
+        swString *str = System::read_file(test_file, true);
+        ASSERT_NE(str, nullptr);
+        ASSERT_EQ(str->length, 11u);
+        ASSERT_EQ(memcmp(str->str, "hello world", 11), 0);
+        swString_free(str);
+
+        ASSERT_EQ(file_dispatch_num(), dispatch_num);
+    });
+
+    unlink(test_file);
+}
+
+static std::string fallback_log;
+
+TEST(coroutine_file_nowait, fallback)
+{
+    auto write_log = SwooleG.write_log;
+    fallback_log.clear();
+    SwooleG.write_log = [](int level, char *content, size_t length)
+    {
+        if (level == SW_LOG_WARNING)
+        {
+            fallback_log.append(content, length);
+        }
+    };
+
+    coroutine::test([](void *arg)
+    {
+        // the errors are reported by the thread pool
+        ASSERT_EQ(System::read_file("/tmp/swoole_file_nowait_not_exists", false), nullptr);
+        ASSERT_EQ(SwooleG.error, ENOENT);
+    });
+
+    SwooleG.write_log = write_log;
+    // the same warning as before the nowait path
+    ASSERT_NE(fallback_log.find("open(/tmp/swoole_file_nowait_not_exists, O_RDONLY) failed"), std::string::npos);
+}
+
+TEST(coroutine_file_nowait, fallback_fd)
+{
+    coroutine::test([](void *arg)
+    {
+        // the size is 0, the opened file is read by the thread pool
+        size_t dispatch_num = file_dispatch_num();
+        swString *str = System::read_file("/proc/self/status", false);
+        ASSERT_NE(str, nullptr);
+        ASSERT_GT(str->length, 0u);
+        ASSERT_EQ(memcmp(str->str, "Name:", 5), 0);
+        swString_free(str);
+        ASSERT_EQ(file_dispatch_num(), dispatch_num + 1);
+    });
+}
+
+#endif
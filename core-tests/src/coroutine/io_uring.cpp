@@ -0,0 +1,141 @@
+#include "tests.h"
+#include "swoole/coroutine_c_api.h"
+#include "swoole/async.h"
+
+#ifdef HAVE_IO_URING
+
+#include <sys/stat.h>
+#include <fcntl.h>
+
+using swoole::test::coroutine;
+
+static const char *test_file = "/tmp/swoole_aio_io_uring_test";
+static const char *test_dir = "/tmp/swoole_aio_io_uring_dir";
+
+TEST(coroutine_io_uring, file)
+{
+    SwooleG.enable_aio_io_uring = 1;
+    coroutine::test([](void *arg)
+    {
+        char buf[64];
+        struct stat st;
+
+        int fd = swoole_coroutine_open(test_file, O_CREAT | O_RDWR | O_TRUNC, 0644);
+        ASSERT_GT(fd, 0);
+        ASSERT_EQ(swoole_coroutine_write(fd, "hello world", 11), 11);
+        // continues at the current position
+        ASSERT_EQ(swoole_coroutine_write(fd, "!", 1), 1);
+
+        ASSERT_EQ(swoole_coroutine_fstat(fd, &st), 0);
+        ASSERT_EQ(st.st_size, 12);
+        ASSERT_TRUE(S_ISREG(st.st_mode));
+        ASSERT_EQ(st.st_mode & 0777, 0644);
+
+        // not supported by io_uring, goes to the thread pool
+        ASSERT_EQ(swoole_coroutine_lseek(fd, 6, SEEK_SET), 6);
+        ASSERT_EQ(swoole_coroutine_read(fd, buf, sizeof(buf)), 6);
+        ASSERT_EQ(memcmp(buf, "world!", 6), 0);
+        ASSERT_EQ(swoole_coroutine_read(fd, buf, sizeof(buf)), 0);
+        close(fd);
+
+        std::string new_file = std::string(test_file) + ".new";
+        ASSERT_EQ(swoole_coroutine_rename(test_file, new_file.c_str()), 0);
+        ASSERT_EQ(access(test_file, F_OK), -1);
+        ASSERT_EQ(swoole_coroutine_unlink(new_file.c_str()), 0);
+        ASSERT_EQ(access(new_file.c_str(), F_OK), -1);
+
+        ASSERT_EQ(swoole_coroutine_mkdir(test_dir, 0755), 0);
+        ASSERT_EQ(swoole_coroutine_mkdir(test_dir, 0755), -1);
+        ASSERT_EQ(errno, EEXIST);
+        ASSERT_EQ(swoole_coroutine_rmdir(test_dir), 0);
+
+        ASSERT_EQ(swoole_coroutine_open(test_file, O_RDONLY, 0), -1);
+        ASSERT_EQ(errno, ENOENT);
+        ASSERT_EQ(swoole_coroutine_unlink(test_file), -1);
+        ASSERT_EQ(errno, ENOENT);
+    });
+    SwooleG.enable_aio_io_uring = 0;
+}
+
+TEST(coroutine_io_uring, concurrent)
+{
+    int fd = open(test_file, O_CREAT | O_RDWR | O_TRUNC, 0644);
+    ASSERT_GT(fd, 0);
+    char data[4096];
+    memset(data, 'A', sizeof(data));
+    ASSERT_EQ(write(fd, data, sizeof(data)), sizeof(data));
+    close(fd);
+
+    SwooleG.enable_aio_io_uring = 1;
+    swoole_event_init();
+    SwooleTG.reactor->wait_exit = 1;
+    // more requests than the size of the ring
+    const int n = SW_AIO_IOURING_ENTRIES * 3;
+    int done = 0;
+    for (int i = 0; i < n; i++)
+    {
+        swoole::Coroutine::create([](void *arg)
+        {
+            char buf[4096];
+            int fd = swoole_coroutine_open(test_file, O_RDONLY, 0);
+            ASSERT_GT(fd, 0);
+            ASSERT_EQ(swoole_coroutine_read(fd, buf, sizeof(buf)), sizeof(buf));
+            ASSERT_EQ(buf[sizeof(buf) - 1], 'A');
+            close(fd);
+            (*(int *) arg)++;
+        }, &done);
+    }
+    swoole_event_wait();
+    SwooleG.enable_aio_io_uring = 0;
+
+    ASSERT_EQ(done, n);
+    ASSERT_EQ(SwooleTG.aio_task_num, 0);
+    unlink(test_file);
+}
+
+TEST(coroutine_io_uring, free_inflight)
+{
+    int pipes[2];
+    ASSERT_EQ(pipe(pipes), 0);
+    char buf[16];
+
+    swAio_event event;
+    bzero(&event, sizeof(event));
+    event.opcode = SW_AIO_OP_READ;
+    event.fd = pipes[0];
+    event.buf = buf;
+    event.nbytes = sizeof(buf);
+    event.handler = swAio_handler_read;
+    event.callback = [](swAio_event *event)
+    {
+        (*(int *) event->object)++;
+    };
+    int callback_count = 0;
+    event.object = &callback_count;
+
+    SwooleG.enable_aio_io_uring = 1;
+    swoole_event_init();
+    SwooleTG.reactor->wait_exit = 1;
+    ASSERT_NE(swAio_dispatch2(&event), nullptr);
+    ASSERT_EQ(SwooleTG.aio_task_num, 1);
+    if (SwooleTG.aio_iouring_init)
+    {
+        // the read never completes, it is canceled with the event loop
+        swoole_event_free();
+        ASSERT_EQ(callback_count, 0);
+    }
+    else
+    {
+        // taken by the thread pool
+        ASSERT_EQ(write(pipes[1], "hello", 5), 5);
+        swoole_event_wait();
+        ASSERT_EQ(callback_count, 1);
+    }
+    SwooleG.enable_aio_io_uring = 0;
+    ASSERT_EQ(SwooleTG.aio_task_num, 0);
+
+    close(pipes[0]);
+    close(pipes[1]);
+}
+
+#endif
@@ -0,0 +1,229 @@
+#include "tests.h"
+#include "swoole/http.h"
+#include "swoole_http_parser.h"
+
+#include <chrono>
+
+using namespace std;
+
+static const int simd_levels[] = {PHP_HTTP_SIMD_NONE, PHP_HTTP_SIMD_SSE2, PHP_HTTP_SIMD_AVX2};
+
+static int on_data(swoole_http_parser *parser, const char *name, const char *at, size_t length)
+{
+    string *log = (string *) parser->data;
+    log->append(name);
+    log->append(at, length);
+    log->append("\n");
+    return 0;
+}
+
+static int on_event(swoole_http_parser *parser, const char *name)
+{
+    string *log = (string *) parser->data;
+    log->append(name);
+    log->append("\n");
+    return 0;
+}
+
+static const swoole_http_parser_settings settings =
+{
+    [](swoole_http_parser *p) { return on_event(p, "begin"); },
+    [](swoole_http_parser *p, const char *at, size_t n) { return on_data(p, "path:", at, n); },
+    [](swoole_http_parser *p, const char *at, size_t n) { return on_data(p, "query:", at, n); },
+    [](swoole_http_parser *p, const char *at, size_t n) { return on_data(p, "url:", at, n); },
+    [](swoole_http_parser *p, const char *at, size_t n) { return on_data(p, "fragment:", at, n); },
+    [](swoole_http_parser *p, const char *at, size_t n) { return on_data(p, "field:", at, n); },
+    [](swoole_http_parser *p, const char *at, size_t n) { return on_data(p, "value:", at, n); },
+    [](swoole_http_parser *p) { return on_event(p, "headers"); },
+    [](swoole_http_parser *p, const char *at, size_t n) { return on_data(p, "body:", at, n); },
+    [](swoole_http_parser *p) { return on_event(p, "complete"); },
+};
+
+/**
+ * the callbacks, the consumed length of every piece and the final parser state
+ */
+static string parse(int level, const string &data, size_t split)
+{
+    swoole_http_parser parser;
+    string log;
+
+    swoole_http_parser_set_simd_level(level);
+    swoole_http_parser_init(&parser, PHP_HTTP_REQUEST);
+    parser.data = &log;
+
+    split = std::min(split, data.length());
+    size_t n = swoole_http_parser_execute(&parser, &settings, data.c_str(), split);
+    log += "n=" + to_string(n) + "\n";
+    if (n == split)
+    {
+        n = swoole_http_parser_execute(&parser, &settings, data.c_str() + split, data.length() - split);
+        log += "n=" + to_string(n) + "\n";
+    }
+    log += "state=" + to_string(parser.state) + ", header_state=" + to_string(parser.header_state)
+            + ", nread=" + to_string(parser.nread) + ", flags=" + to_string(parser.flags) + ", method="
+            + to_string(parser.method) + ", content_length=" + to_string(parser.content_length) + ", version="
+            + to_string(parser.http_major) + "." + to_string(parser.http_minor) + "\n";
+    return log;
+}
+
+static void assert_same(const string &data, size_t split)
+{
+    string expect = parse(PHP_HTTP_SIMD_NONE, data, split);
+    for (int level : simd_levels)
+    {
+        ASSERT_EQ(parse(level, data, split), expect) << "level=" << level << ", split=" << split;
+    }
+}
+
+static string random_chars(size_t length, const char *chars)
+{
+    string s;
+    size_t n = strlen(chars);
+    for (size_t i = 0; i < length; i++)
+    {
+        s += chars[swoole_system_random(0, n - 1)];
+    }
+    return s;
+}
+
+static string random_request()
+{
+    const char *url_chars = "abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ0123456789-._~/%=&;:@!$'()*+,";
+    string req = "GET /" + random_chars(swoole_system_random(0, 70), url_chars);
+    req += "?" + random_chars(swoole_system_random(0, 70), url_chars) + "?x=1#frag HTTP/1.1\r\n";
+    req += "Host: www.example.com\r\n";
+    req += "Connection: keep-alive\r\n";
+    for (int i = 0; i < 6; i++)
+    {
+        req += "X-" + random_chars(swoole_system_random(1, 40), "abcdefghijklmnopqrstuvwxyz-_0123456789") + ": ";
+        req += random_chars(swoole_system_random(0, 90), "abcdefghijklmnopqrstuvwxyz ;=,/\t\"()0123456789") + "\r\n";
+    }
+    req += "Content-Length: 5\r\n\r\nhello";
+    return req;
+}
+
+TEST(http_parser, simd_differential)
+{
+    const char stop_chars[] = {'\r', '\n', ' ', '\t', ':', '?', '#', '\0', '\x1f', '\x7f', '\x80', '\xff', 'a', '('};
+
+    for (int i = 0; i < 20; i++)
+    {
+        string req = random_request();
+        assert_same(req, req.length());
+        // pipelined requests and pieces which end in every state
+        assert_same(req + req, req.length());
+        for (size_t split = 1; split < req.length(); split += 7)
+        {
+            assert_same(req, split);
+        }
+    }
+
+    // every single byte change of a request
+    string req = random_request();
+    for (size_t i = 0; i < req.length(); i++)
+    {
+        for (char c : stop_chars)
+        {
+            string s = req;
+            s[i] = c;
+            assert_same(s, s.length());
+        }
+    }
+
+    string chunked = "POST /upload HTTP/1.1\r\nTransfer-Encoding: chunked\r\nUser-Agent: " + string(100, 'u')
+            + "\r\n\r\n5\r\nhello\r\n0\r\nX-Trailer: " + string(60, 't') + "\r\n\r\n";
+    assert_same(chunked, chunked.length());
+    assert_same("GET /chat HTTP/1.1\r\nUpgrade: websocket\r\nConnection: Upgrade\r\n\r\n", 100);
+    assert_same("GET /" + string(200, 'p') + " HTTP/1.0\r\n" + string(100, 'h') + ": v\r\n\r\n", 100);
+}
+
+TEST(http_parser, max_header_size)
+{
+    string prefix = "GET / HTTP/1.1\r\nX-Large: ";
+    for (size_t padding = 0; padding < 40; padding++)
+    {
+        size_t length = PHP_HTTP_MAX_HEADER_SIZE - prefix.length() - 4 + padding;
+        // the request fails at the same byte when the limit is in a long run
+        assert_same(prefix + string(length, 'v') + "\r\n\r\n", 8192);
+        assert_same("GET /" + string(length + 20, 'p') + " HTTP/1.1\r\n\r\n", 1);
+    }
+}
+
+TEST(http_parser, layout)
+{
+    swString *buffer = swString_new(64);
+    string req = "POST /api/users?id=1&x=2 HTTP/1.1\r\nHost: localhost\r\nX-Empty:\r\nContent-Length: 5\r\n\r\nhello";
+
+    ASSERT_EQ(swHttpRequest_get_layout(req.c_str(), req.length(), buffer), SW_OK);
+    swHttpRequestLayout *layout = (swHttpRequestLayout *) buffer->str;
+    ASSERT_EQ(layout->size, buffer->length);
+    ASSERT_EQ(layout->method, PHP_HTTP_POST);
+    ASSERT_EQ(layout->http_major, 1);
+    ASSERT_EQ(layout->http_minor, 1);
+    ASSERT_EQ(layout->keep_alive, 1);
+    ASSERT_EQ(req.substr(layout->path_offset, layout->path_length), "/api/users");
+    ASSERT_EQ(req.substr(layout->query_string_offset, layout->query_string_length), "id=1&x=2");
+    ASSERT_EQ(layout->header_num, 3);
+    const char *headers[][2] = {{"Host", "localhost"}, {"X-Empty", ""}, {"Content-Length", "5"}};
+    for (int i = 0; i < 3; i++)
+    {
+        ASSERT_EQ(req.substr(layout->headers[i].name_offset, layout->headers[i].name_length), headers[i][0]);
+        ASSERT_EQ(req.substr(layout->headers[i].value_offset, layout->headers[i].value_length), headers[i][1]);
+    }
+    ASSERT_EQ(req.substr(layout->body_offset, layout->body_length), "hello");
+
+    req = "GET / HTTP/1.0\r\n\r\n";
+    ASSERT_EQ(swHttpRequest_get_layout(req.c_str(), req.length(), buffer), SW_OK);
+    layout = (swHttpRequestLayout *) buffer->str;
+    ASSERT_EQ(layout->keep_alive, 0);
+    ASSERT_EQ(layout->header_num, 0);
+    ASSERT_EQ(layout->body_length, 0);
+
+    // the worker parses these requests
+    req = "POST / HTTP/1.1\r\nTransfer-Encoding: chunked\r\n\r\n2\r\nab\r\n1\r\nc\r\n0\r\n\r\n";
+    ASSERT_EQ(swHttpRequest_get_layout(req.c_str(), req.length(), buffer), SW_ERR);
+    req = "GET / HTTP/1.1\r\nContent-Length: 10\r\n\r\nabc";
+    ASSERT_EQ(swHttpRequest_get_layout(req.c_str(), req.length(), buffer), SW_ERR);
+    req = "GET /\x01 HTTP/1.1\r\n\r\n";
+    ASSERT_EQ(swHttpRequest_get_layout(req.c_str(), req.length(), buffer), SW_ERR);
+    req = "GET / HTTP/1.1\r\n";
+    for (int i = 0; i <= SW_HTTP_LAYOUT_MAX_HEADERS; i++)
+    {
+        req += "X-" + to_string(i) + ": v\r\n";
+    }
+    req += "\r\n";
+    ASSERT_EQ(swHttpRequest_get_layout(req.c_str(), req.length(), buffer), SW_ERR);
+
+    swString_free(buffer);
+}
+
+TEST(http_parser, benchmark)
+{
+    const char *names[] = {"scalar", "sse2", "avx2"};
+    string req = "GET /api/v1/users/" + string(60, 'u') + "?query=" + string(60, 'q') + " HTTP/1.1\r\n";
+    req += "Host: www.example.com\r\n";
+    req += "User-Agent: Mozilla/5.0 (X11; Linux x86_64) AppleWebKit/537.36 (KHTML, like Gecko) Chrome/86.0 Safari/537.36\r\n";
+    req += "Accept: text/html,application/xhtml+xml,application/xml;q=0.9,image/webp,*/*;q=0.8\r\n";
+    req += "Accept-Language: en-US,en;q=0.9\r\n";
+    req += "Cookie: " + string(300, 'c') + "\r\n\r\n";
+    const int rounds = 100000;
+
+    for (int level : simd_levels)
+    {
+        if (swoole_http_parser_set_simd_level(level) != level)
+        {
+            continue;
+        }
+        swoole_http_parser_settings empty = {};
+        swoole_http_parser parser;
+        auto begin = chrono::steady_clock::now();
+        for (int i = 0; i < rounds; i++)
+        {
+            swoole_http_parser_init(&parser, PHP_HTTP_REQUEST);
+            ASSERT_EQ(swoole_http_parser_execute(&parser, &empty, req.c_str(), req.length()), req.length());
+        }
+        double ms = chrono::duration<double, milli>(chrono::steady_clock::now() - begin).count();
+        RecordProperty(names[level], (int) ((double) req.length() * rounds / 1024 / 1024 / ms * 1000));
+    }
+    swoole_http_parser_set_simd_level(PHP_HTTP_SIMD_SSE2);
+}
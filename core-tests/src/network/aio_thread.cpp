@@ -42,3 +42,160 @@ TEST(aio_thread, dispatch)
     ASSERT_EQ(handle_count, 1000);
     ASSERT_EQ(callback_count, 1000);
 }
+
+TEST(aio_thread, dispatch_order)
+{
+    atomic<int> handle_count(0);
+    swAio_event event;
+    bzero(&event, sizeof(event));
+    event.object = &handle_count;
+    event.callback = aio_callback;
+
+    callback_count = 0;
+
+    event.handler = [](swAio_event *event)
+    {
+        (*(atomic<int> *) event->object)++;
+    };
+
+    swoole_event_init();
+    SwooleTG.reactor->wait_exit = 1;
+
+    size_t task_id = 0;
+    for (int i = 0; i < 100; ++i)
+    {
+        auto ret = swAio_dispatch2(&event);
+        ASSERT_NE(ret, &event);
+        // the copies are numbered in the order of dispatch
+        if (i > 0)
+        {
+            ASSERT_EQ(ret->task_id, task_id + 1);
+        }
+        task_id = ret->task_id;
+    }
+
+    swoole_event_wait();
+
+    ASSERT_EQ(handle_count, 100);
+    ASSERT_EQ(callback_count, 100);
+}
+
+TEST(aio_thread, work_stealing)
+{
+    const int n = 200;
+    static atomic<int> handle_count;
+    static atomic<bool> stolen;
+    swAio_event event;
+    bzero(&event, sizeof(event));
+    event.callback = aio_callback;
+
+    handle_count = 0;
+    stolen = false;
+    callback_count = 0;
+
+    uint32_t core_worker_num = SwooleG.aio_core_worker_num;
+    uint32_t worker_num = SwooleG.aio_worker_num;
+    SwooleG.aio_core_worker_num = 4;
+    SwooleG.aio_worker_num = 4;
+
+    swoole_event_init();
+    SwooleTG.reactor->wait_exit = 1;
+
+    // the first event blocks its thread, the events behind it are taken by the other threads
+    event.handler = [](swAio_event *event)
+    {
+        for (int i = 0; i < 5000 && handle_count < n - 1; i++)
+        {
+            usleep(1000);
+        }
+        stolen = handle_count == n - 1;
+        handle_count++;
+    };
+    swAio_dispatch2(&event);
+
+    event.handler = [](swAio_event *event)
+    {
+        handle_count++;
+    };
+    for (int i = 1; i < n; i++)
+    {
+        swAio_dispatch2(&event);
+    }
+
+    swoole_event_wait();
+
+    SwooleG.aio_core_worker_num = core_worker_num;
+    SwooleG.aio_worker_num = worker_num;
+
+    ASSERT_TRUE(stolen);
+    ASSERT_EQ(handle_count, n);
+    ASSERT_EQ(callback_count, n);
+}
+
+TEST(aio_thread, lane)
+{
+    const int n = 8;
+    static atomic<int> file_running;
+    static atomic<int> file_max_running;
+    static atomic<int> file_done;
+    static atomic<int> file_done_before_dns;
+    swAio_event event;
+    bzero(&event, sizeof(event));
+    event.callback = aio_callback;
+
+    file_running = 0;
+    file_max_running = 0;
+    file_done = 0;
+    file_done_before_dns = -1;
+    callback_count = 0;
+
+    uint32_t core_worker_num = SwooleG.aio_core_worker_num;
+    uint32_t worker_num = SwooleG.aio_worker_num;
+    SwooleG.aio_core_worker_num = 4;
+    SwooleG.aio_worker_num = 4;
+    swAio_set_lane_max_threads(SW_AIO_LANE_FILE, 1);
+
+    swoole_event_init();
+    SwooleTG.reactor->wait_exit = 1;
+
+    event.lane = SW_AIO_LANE_FILE;
+    event.handler = [](swAio_event *event)
+    {
+        int running = ++file_running;
+        if (running > file_max_running)
+        {
+            file_max_running = running;
+        }
+        usleep(20000);
+        file_running--;
+        file_done++;
+    };
+    for (int i = 0; i < n; i++)
+    {
+        swAio_dispatch2(&event);
+    }
+
+    // the other threads are not taken by the file lane
+    event.lane = SW_AIO_LANE_DNS;
+    event.handler = [](swAio_event *event)
+    {
+        file_done_before_dns = file_done.load();
+    };
+    swAio_dispatch2(&event);
+
+    swAio_lane_stats stats;
+    ASSERT_EQ(swAio_get_lane_stats(SW_AIO_LANE_FILE, &stats), SW_OK);
+    ASSERT_EQ(stats.max_thread_num, 1u);
+    ASSERT_EQ(stats.dispatch_num, (size_t) n);
+
+    swoole_event_wait();
+
+    swAio_set_lane_max_threads(SW_AIO_LANE_FILE, 0);
+    SwooleG.aio_core_worker_num = core_worker_num;
+    SwooleG.aio_worker_num = worker_num;
+
+    ASSERT_EQ(file_max_running, 1);
+    ASSERT_EQ(file_done, n);
+    ASSERT_LT(file_done_before_dns, n);
+    ASSERT_EQ(callback_count, n + 1);
+}
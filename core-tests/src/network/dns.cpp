@@ -0,0 +1,437 @@
+#include "tests.h"
+#include "swoole/coroutine_socket.h"
+#include "swoole/coroutine_system.h"
+
+#include <map>
+
+using swoole::Coroutine;
+using swoole::coroutine::Socket;
+using swoole::coroutine::dns_lookup;
+using swoole::coroutine::dns_clear_cache;
+using std::string;
+using std::vector;
+
+static const char *resolvconf_file = "/tmp/swoole_dns_test_resolv.conf";
+static const char *hosts_file = "/tmp/swoole_dns_test_hosts";
+
+struct stub_record
+{
+    string owner;
+    int type;
+    uint32_t ttl;
+    string data;
+};
+
+struct stub_answer
+{
+    int rcode;
+    vector<stub_record> records;
+    int delay_ms;
+    /**
+     * the UDP response only has the TC flag, the records are sent over TCP
+     */
+    bool truncated;
+};
+
+/**
+ * a nameserver on 127.0.0.1 answering from a table, it counts the queries of every name
+ */
+struct stub_server
+{
+    Socket *sock;
+    Socket *tcp_sock;
+    int port;
+    bool running;
+    std::map<string, stub_answer> answers;
+    std::map<string, int> queries;
+};
+
+static string stub_key(const string &name, int type)
+{
+    return name + "/" + std::to_string(type);
+}
+
+static void stub_put16(string &buf, uint16_t value)
+{
+    buf.push_back(value >> 8);
+    buf.push_back(value & 0xff);
+}
+
+static void stub_put32(string &buf, uint32_t value)
+{
+    stub_put16(buf, value >> 16);
+    stub_put16(buf, value & 0xffff);
+}
+
+static void stub_put_name(string &buf, const string &name)
+{
+    size_t start = 0;
+    while (start < name.length())
+    {
+        size_t end = name.find('.', start);
+        if (end == string::npos)
+        {
+            end = name.length();
+        }
+        buf.push_back(end - start);
+        buf.append(name, start, end - start);
+        start = end + 1;
+    }
+    buf.push_back(0);
+}
+
+static string stub_response(stub_server *server, const char *packet, size_t n, bool tcp)
+{
+    string name;
+    size_t pos = 12;
+    while (pos < n && packet[pos] != 0)
+    {
+        if (!name.empty())
+        {
+            name.append(".");
+        }
+        name.append(packet + pos + 1, (uchar) packet[pos]);
+        pos += (uchar) packet[pos] + 1;
+    }
+    pos++;
+    int type = ((uchar) packet[pos] << 8) | (uchar) packet[pos + 1];
+    pos += 4;
+
+    string key = stub_key(name, type);
+    server->queries[key]++;
+
+    stub_answer answer = {3, {}, 0, false};
+    auto iter = server->answers.find(key);
+    if (iter != server->answers.end())
+    {
+        answer = iter->second;
+    }
+    if (answer.delay_ms > 0)
+    {
+        swoole::coroutine::System::sleep((double) answer.delay_ms / 1000);
+    }
+    bool truncated = answer.truncated && !tcp;
+    if (truncated)
+    {
+        answer.records.clear();
+    }
+
+    string response(packet, 2);
+    stub_put16(response, 0x8180 | (truncated ? 0x0200 : 0) | answer.rcode);
+    stub_put16(response, 1);
+    int ancount = 0, nscount = 0;
+    for (auto &record : answer.records)
+    {
+        record.type == 6 ? nscount++ : ancount++;
+    }
+    stub_put16(response, ancount);
+    stub_put16(response, nscount);
+    stub_put16(response, 0);
+    response.append(packet + 12, pos - 12);
+
+    for (auto &record : answer.records)
+    {
+        stub_put_name(response, record.owner);
+        stub_put16(response, record.type);
+        stub_put16(response, 1);
+        stub_put32(response, record.ttl);
+        string rdata;
+        if (record.type == 1)
+        {
+            rdata.resize(4);
+            inet_pton(AF_INET, record.data.c_str(), &rdata[0]);
+        }
+        else if (record.type == 28)
+        {
+            rdata.resize(16);
+            inet_pton(AF_INET6, record.data.c_str(), &rdata[0]);
+        }
+        else if (record.type == 5)
+        {
+            stub_put_name(rdata, record.data);
+        }
+        else if (record.type == 6)
+        {
+            // mname, rname, serial, refresh, retry, expire, minimum
+            stub_put_name(rdata, "ns.test");
+            stub_put_name(rdata, "admin.test");
+            for (int i = 0; i < 4; i++)
+            {
+                stub_put32(rdata, 100);
+            }
+            stub_put32(rdata, atoi(record.data.c_str()));
+        }
+        stub_put16(response, rdata.length());
+        response.append(rdata);
+    }
+    return response;
+}
+
+static void stub_serve(void *arg)
+{
+    stub_server *server = (stub_server *) arg;
+    char packet[1024];
+
+    while (server->running)
+    {
+        struct sockaddr_in addr;
+        socklen_t addr_len = sizeof(addr);
+        ssize_t n = server->sock->recvfrom(packet, sizeof(packet), (struct sockaddr *) &addr, &addr_len);
+        if (n <= 12)
+        {
+            continue;
+        }
+        string response = stub_response(server, packet, n, false);
+        server->sock->sendto(inet_ntoa(addr.sin_addr), ntohs(addr.sin_port), response.c_str(), response.length());
+    }
+}
+
+/**
+ * one query per connection, prefixed with its length
+ */
+static void stub_serve_tcp(void *arg)
+{
+    stub_server *server = (stub_server *) arg;
+    char packet[1024];
+
+    while (server->running)
+    {
+        Socket *conn = server->tcp_sock->accept();
+        if (!conn)
+        {
+            continue;
+        }
+        uint16_t length;
+        if (conn->recv_all(&length, sizeof(length)) == sizeof(length) && ntohs(length) > 12
+                && ntohs(length) <= sizeof(packet) && conn->recv_all(packet, ntohs(length)) == ntohs(length))
+        {
+            string response = stub_response(server, packet, ntohs(length), true);
+            length = htons(response.length());
+            conn->send_all(&length, sizeof(length));
+            conn->send_all(response.c_str(), response.length());
+        }
+        conn->close();
+        delete conn;
+    }
+}
+
+static void stub_run(stub_server *server, const char *nameservers, coroutine_func_t fn)
+{
+    FILE *fp = fopen(resolvconf_file, "w");
+    fputs("search example\noptions ndots:1 attempts:1\n", fp);
+    fclose(fp);
+    fp = fopen(hosts_file, "w");
+    fputs("127.0.0.1 localhost\n10.9.9.9 myhost myhost.alias # comment\nfd00::9 myhost\n", fp);
+    fclose(fp);
+
+    swoole_event_init();
+    SwooleTG.reactor->wait_exit = 1;
+
+    server->sock = new Socket(SW_SOCK_UDP);
+    ASSERT_TRUE(server->sock->bind("127.0.0.1", 0));
+    struct sockaddr_in addr;
+    socklen_t len = sizeof(addr);
+    ASSERT_EQ(getsockname(server->sock->get_fd(), (struct sockaddr *) &addr, &len), 0);
+    server->port = ntohs(addr.sin_port);
+    server->sock->set_timeout(0.05, swoole::SW_TIMEOUT_READ);
+    server->tcp_sock = new Socket(SW_SOCK_TCP);
+    ASSERT_TRUE(server->tcp_sock->bind("127.0.0.1", server->port));
+    ASSERT_TRUE(server->tcp_sock->listen());
+    server->tcp_sock->set_timeout(0.05, swoole::SW_TIMEOUT_READ);
+    server->running = true;
+
+    string servers = string(nameservers) + "127.0.0.1:" + std::to_string(server->port);
+    SwooleG.dns_server_v4 = sw_strdup(servers.c_str());
+    SwooleG.dns_resolvconf_path = sw_strdup(resolvconf_file);
+    SwooleG.dns_hosts_path = sw_strdup(hosts_file);
+    dns_clear_cache();
+
+    Coroutine::create(stub_serve, server);
+    Coroutine::create(stub_serve_tcp, server);
+    Coroutine::create(fn, server);
+    swoole_event_wait();
+
+    delete server->sock;
+    delete server->tcp_sock;
+    sw_free(SwooleG.dns_server_v4);
+    sw_free(SwooleG.dns_resolvconf_path);
+    sw_free(SwooleG.dns_hosts_path);
+    SwooleG.dns_server_v4 = nullptr;
+    SwooleG.dns_resolvconf_path = nullptr;
+    SwooleG.dns_hosts_path = nullptr;
+    dns_clear_cache();
+    unlink(resolvconf_file);
+    unlink(hosts_file);
+}
+
+TEST(dns, resolve)
+{
+    stub_server server;
+    server.answers[stub_key("a.test", 1)] = {0, {{"a.test", 1, 60, "10.0.0.1"}, {"a.test", 1, 60, "10.0.0.2"}}, 0};
+    server.answers[stub_key("a.test", 28)] = {0, {{"a.test", 28, 60, "fd00::1"}}, 0};
+    server.answers[stub_key("www.test", 1)] = {0, {{"www.test", 5, 60, "a1.test"}, {"a1.test", 1, 60, "10.0.0.3"}}, 0};
+    server.answers[stub_key("alias.test", 1)] = {0, {{"alias.test", 5, 60, "b.test"}}, 0};
+    server.answers[stub_key("b.test", 1)] = {0, {{"b.test", 1, 60, "10.0.0.4"}}, 0};
+    server.answers[stub_key("host.example", 1)] = {0, {{"host.example", 1, 60, "10.0.0.6"}}, 0};
+
+    stub_run(&server, "", [](void *arg)
+    {
+        stub_server *server = (stub_server *) arg;
+
+        auto result = dns_lookup("a.test", AF_INET, 1);
+        ASSERT_EQ(result.size(), 2);
+        ASSERT_EQ(result[0], "10.0.0.1");
+        ASSERT_EQ(result[1], "10.0.0.2");
+        result = dns_lookup("A.Test.", AF_INET, 1);
+        ASSERT_EQ(result.size(), 2);
+        ASSERT_EQ(server->queries[stub_key("a.test", 1)], 1);
+
+        result = dns_lookup("a.test", AF_INET6, 1);
+        ASSERT_EQ(result.size(), 1);
+        ASSERT_EQ(result[0], "fd00::1");
+
+        // CNAME resolved by the same response
+        result = dns_lookup("www.test", AF_INET, 1);
+        ASSERT_EQ(result.size(), 1);
+        ASSERT_EQ(result[0], "10.0.0.3");
+        ASSERT_EQ(server->queries[stub_key("a1.test", 1)], 0);
+
+        // CNAME followed with another query
+        result = dns_lookup("alias.test", AF_INET, 1);
+        ASSERT_EQ(result.size(), 1);
+        ASSERT_EQ(result[0], "10.0.0.4");
+        ASSERT_EQ(server->queries[stub_key("b.test", 1)], 1);
+
+        // fewer dots than ndots, the search domain goes first
+        result = dns_lookup("host", AF_INET, 1);
+        ASSERT_EQ(result.size(), 1);
+        ASSERT_EQ(result[0], "10.0.0.6");
+        ASSERT_EQ(server->queries[stub_key("host", 1)], 0);
+
+        // /etc/hosts
+        result = dns_lookup("MyHost.alias", AF_INET, 1);
+        ASSERT_EQ(result.size(), 1);
+        ASSERT_EQ(result[0], "10.9.9.9");
+        result = dns_lookup("myhost", AF_INET6, 1);
+        ASSERT_EQ(result.size(), 1);
+        ASSERT_EQ(result[0], "fd00::9");
+        ASSERT_EQ(server->queries[stub_key("myhost", 1)], 0);
+
+        result = dns_lookup("127.0.0.1", AF_INET, 1);
+        ASSERT_EQ(result.size(), 1);
+        ASSERT_EQ(result[0], "127.0.0.1");
+
+        server->running = false;
+    });
+}
+
+TEST(dns, cache)
+{
+    stub_server server;
+    server.answers[stub_key("zero.test", 1)] = {0, {{"zero.test", 1, 0, "10.0.0.5"}}, 0};
+    server.answers[stub_key("none.test", 1)] = {3, {{"test", 6, 300, "30"}}, 0};
+    server.answers[stub_key("slow.test", 1)] = {0, {{"slow.test", 1, 60, "10.0.0.7"}}, 100};
+    server.answers[stub_key("slower.test", 1)] = {0, {{"slower.test", 1, 60, "10.0.0.8"}}, 300};
+
+    stub_run(&server, "", [](void *arg)
+    {
+        stub_server *server = (stub_server *) arg;
+
+        // TTL 0 is never cached
+        ASSERT_EQ(dns_lookup("zero.test", AF_INET, 1).size(), 1);
+        ASSERT_EQ(dns_lookup("zero.test", AF_INET, 1).size(), 1);
+        ASSERT_EQ(server->queries[stub_key("zero.test", 1)], 2);
+
+        // negative caching with the SOA minimum
+        ASSERT_EQ(dns_lookup("none.test", AF_INET, 1).size(), 0);
+        ASSERT_EQ(dns_lookup("none.test", AF_INET, 1).size(), 0);
+        ASSERT_EQ(server->queries[stub_key("none.test", 1)], 1);
+
+        // identical lookups in flight share one query
+        int done = 0;
+        for (int i = 0; i < 3; i++)
+        {
+            Coroutine::create([](void *arg)
+            {
+                auto result = dns_lookup("slow.test", AF_INET, 1);
+                ASSERT_EQ(result.size(), 1);
+                ASSERT_EQ(result[0], "10.0.0.7");
+                (*(int *) arg)++;
+            }, &done);
+        }
+        while (done < 3)
+        {
+            swoole::coroutine::System::sleep(0.01);
+        }
+        ASSERT_EQ(server->queries[stub_key("slow.test", 1)], 1);
+
+        // a waiter gives up at its own timeout, the query in flight goes on
+        done = 0;
+        Coroutine::create([](void *arg)
+        {
+            auto result = dns_lookup("slower.test", AF_INET, 1);
+            ASSERT_EQ(result.size(), 1);
+            (*(int *) arg)++;
+        }, &done);
+        double begin = swoole_microtime();
+        ASSERT_EQ(dns_lookup("slower.test", AF_INET, 0.05).size(), 0);
+        ASSERT_LT(swoole_microtime() - begin, 0.2);
+        while (done < 1)
+        {
+            swoole::coroutine::System::sleep(0.01);
+        }
+        ASSERT_EQ(server->queries[stub_key("slower.test", 1)], 1);
+
+        dns_clear_cache();
+        ASSERT_EQ(dns_lookup("none.test", AF_INET, 1).size(), 0);
+        ASSERT_EQ(server->queries[stub_key("none.test", 1)], 2);
+
+        server->running = false;
+    });
+}
+
+TEST(dns, failover)
+{
+    stub_server server;
+    server.answers[stub_key("a.test", 1)] = {0, {{"a.test", 1, 60, "10.0.0.1"}}, 0};
+    server.answers[stub_key("fail.test", 1)] = {2, {}, 0};
+
+    // the first nameserver never answers
+    stub_run(&server, "127.0.0.1:9,", [](void *arg)
+    {
+        stub_server *server = (stub_server *) arg;
+
+        auto result = dns_lookup("a.test", AF_INET, 1);
+        ASSERT_EQ(result.size(), 1);
+        ASSERT_EQ(result[0], "10.0.0.1");
+
+        // SERVFAIL is not cached
+        ASSERT_EQ(dns_lookup("fail.test", AF_INET, 0.5).size(), 0);
+        ASSERT_EQ(dns_lookup("fail.test", AF_INET, 0.5).size(), 0);
+        ASSERT_EQ(server->queries[stub_key("fail.test", 1)], 2);
+
+        server->running = false;
+    });
+}
+
+TEST(dns, truncated)
+{
+    stub_server server;
+    server.answers[stub_key("big.test", 1)] = {0, {{"big.test", 1, 60, "10.0.0.1"}, {"big.test", 1, 60, "10.0.0.2"}}, 0, true};
+
+    stub_run(&server, "", [](void *arg)
+    {
+        stub_server *server = (stub_server *) arg;
+
+        // retried over TCP, the truncated answer is not cached as NXDOMAIN
+        auto result = dns_lookup("big.test", AF_INET, 1);
+        ASSERT_EQ(result.size(), 2);
+        ASSERT_EQ(result[1], "10.0.0.2");
+        ASSERT_EQ(server->queries[stub_key("big.test", 1)], 2);
+
+        ASSERT_EQ(dns_lookup("big.test", AF_INET, 1).size(), 2);
+        ASSERT_EQ(server->queries[stub_key("big.test", 1)], 2);
+
+        server->running = false;
+    });
+}
@@ -0,0 +1,132 @@
+#include "tests.h"
+
+#ifdef SW_USE_OPENSSL
+#include "swoole/ssl.h"
+
+#include <thread>
+
+using namespace std;
+
+static const char *test_file = "/tmp/swoole_ssl_sendfile_test";
+static const size_t test_file_size = 1024 * 1024 + 123;
+
+static string get_cert_file(const char *name)
+{
+    string path = __FILE__;
+    return path.substr(0, path.rfind("/core-tests/")) + "/tests/include/api/swoole_http_server/localhost-ssl/" + name;
+}
+
+static string create_test_file()
+{
+    string data;
+    data.reserve(test_file_size);
+    for (size_t i = 0; i < test_file_size; i++)
+    {
+        data.push_back((char) swoole_rand(0, 255));
+    }
+    int fd = open(test_file, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    EXPECT_EQ(write(fd, data.c_str(), data.length()), (ssize_t) data.length());
+    close(fd);
+    return data;
+}
+
+/**
+ * a loopback TCP connection, kTLS is not offered on the unix sockets
+ */
+static void create_tcp_pair(int *server_fd, int *client_fd)
+{
+    struct sockaddr_in addr;
+    socklen_t len = sizeof(addr);
+    bzero(&addr, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+
+    int listen_fd = socket(AF_INET, SOCK_STREAM, 0);
+    ASSERT_EQ(bind(listen_fd, (struct sockaddr *) &addr, sizeof(addr)), 0);
+    ASSERT_EQ(listen(listen_fd, 1), 0);
+    ASSERT_EQ(getsockname(listen_fd, (struct sockaddr *) &addr, &len), 0);
+
+    *client_fd = socket(AF_INET, SOCK_STREAM, 0);
+    ASSERT_EQ(connect(*client_fd, (struct sockaddr *) &addr, sizeof(addr)), 0);
+    *server_fd = accept(listen_fd, nullptr, nullptr);
+    ASSERT_GE(*server_fd, 0);
+    close(listen_fd);
+}
+
+static void test_sendfile(bool disable_ktls)
+{
+    string data = create_test_file();
+    string cert_file = get_cert_file("server.crt");
+    string key_file = get_cert_file("server.key");
+
+    swSSL_option server_option = {};
+    server_option.cert_file = (char *) cert_file.c_str();
+    server_option.key_file = (char *) key_file.c_str();
+    server_option.disable_ktls = disable_ktls;
+    SSL_CTX *server_context = swSSL_get_context(&server_option);
+    ASSERT_NE(server_context, nullptr);
+
+    swSSL_option client_option = {};
+    client_option.disable_ktls = disable_ktls;
+    SSL_CTX *client_context = swSSL_get_context(&client_option);
+    ASSERT_NE(client_context, nullptr);
+
+    int server_fd = -1, client_fd = -1;
+    create_tcp_pair(&server_fd, &client_fd);
+    swSocket *server_socket = swSocket_new(server_fd, SW_FD_STREAM);
+    swSocket *client_socket = swSocket_new(client_fd, SW_FD_STREAM);
+    ASSERT_EQ(swSSL_create(server_socket, server_context, SW_SSL_SERVER), SW_OK);
+    ASSERT_EQ(swSSL_create(client_socket, client_context, SW_SSL_CLIENT), SW_OK);
+
+    string received;
+    thread client([&]()
+    {
+        ASSERT_EQ(swSSL_connect(client_socket), SW_OK);
+        ASSERT_EQ(client_socket->ssl_state, SW_SSL_STATE_READY);
+        char buf[65536];
+        while (received.length() < data.length())
+        {
+            ssize_t n = swSSL_recv(client_socket, buf, sizeof(buf));
+            ASSERT_GT(n, 0);
+            received.append(buf, n);
+        }
+    });
+
+    ASSERT_EQ(swSSL_accept(server_socket), SW_READY);
+    if (disable_ktls)
+    {
+        ASSERT_EQ(server_socket->ssl_ktls_send, 0);
+    }
+    ::testing::Test::RecordProperty("ktls_send", server_socket->ssl_ktls_send);
+
+    int file_fd = open(test_file, O_RDONLY);
+    ASSERT_GE(file_fd, 0);
+    off_t offset = 0;
+    while ((size_t) offset < data.length())
+    {
+        ASSERT_GT(swSSL_sendfile(server_socket, file_fd, &offset, data.length() - offset), 0);
+    }
+    close(file_fd);
+
+    client.join();
+    ASSERT_EQ(received, data);
+
+    swSSL_close(client_socket);
+    swSSL_close(server_socket);
+    swSocket_free(client_socket);
+    swSocket_free(server_socket);
+    swSSL_free_context(client_context);
+    swSSL_free_context(server_context);
+    unlink(test_file);
+}
+
+TEST(ssl, sendfile)
+{
+    test_sendfile(false);
+}
+
+TEST(ssl, sendfile_without_ktls)
+{
+    test_sendfile(true);
+}
+#endif
@@ -0,0 +1,219 @@
+#include "tests.h"
+#include "swoole/swoole_api.h"
+
+#ifdef HAVE_IO_URING
+
+TEST(reactor_io_uring, create)
+{
+    swReactor reactor;
+
+    SwooleG.enable_io_uring = 1;
+    int ret = swReactor_create(&reactor, SW_REACTOR_MAXEVENTS);
+    SwooleG.enable_io_uring = 0;
+    ASSERT_EQ(ret, SW_OK);
+
+    // fallback to the default reactor when the kernel does not support io_uring
+    ASSERT_NE(reactor.object, nullptr);
+    ASSERT_EQ(reactor.max_event_num, SW_REACTOR_MAXEVENTS);
+    ASSERT_NE(reactor.add, nullptr);
+    ASSERT_NE(reactor.set, nullptr);
+    ASSERT_NE(reactor.del, nullptr);
+    ASSERT_NE(reactor.wait, nullptr);
+    ASSERT_NE(reactor.free, nullptr);
+
+    swReactor_destroy(&reactor);
+}
+
+TEST(reactor_io_uring, wait)
+{
+    int ret;
+    swPipe p;
+
+    SwooleG.enable_io_uring = 1;
+    ret = swoole_event_init();
+    SwooleG.enable_io_uring = 0;
+    ASSERT_EQ(ret, SW_OK);
+    ASSERT_NE(SwooleTG.reactor, nullptr);
+
+    ret = swPipeUnsock_create(&p, 1, SOCK_DGRAM);
+    ASSERT_EQ(ret, SW_OK);
+
+    swoole_event_set_handler(SW_FD_PIPE | SW_EVENT_READ, [](swReactor *reactor, swEvent *ev) -> int
+    {
+        char buffer[16];
+
+        ssize_t n = read(ev->fd, buffer, sizeof(buffer));
+        EXPECT_EQ(sizeof("hello world"), n);
+        EXPECT_STREQ("hello world", buffer);
+        reactor->del(reactor, ev->socket);
+        reactor->wait_exit = 1;
+
+        return SW_OK;
+    });
+
+    ret = swoole_event_add(p.worker_socket, SW_EVENT_READ);
+    ASSERT_EQ(ret, SW_OK);
+
+    ret = p.write(&p, (void *) SW_STRS("hello world"));
+    ASSERT_EQ(ret, sizeof("hello world"));
+
+    ret = swoole_event_wait();
+    ASSERT_EQ(ret, SW_OK);
+    ASSERT_EQ(SwooleTG.reactor, nullptr);
+
+    p.close(&p);
+}
+
+/**
+ * the read handler consumes one message per event, the remaining ones must be reported again (level-triggered)
+ */
+TEST(reactor_io_uring, level_triggered)
+{
+    int ret;
+    swPipe p;
+    static int count;
+
+    SwooleG.enable_io_uring = 1;
+    ret = swoole_event_init();
+    SwooleG.enable_io_uring = 0;
+    ASSERT_EQ(ret, SW_OK);
+
+    ret = swPipeUnsock_create(&p, 1, SOCK_DGRAM);
+    ASSERT_EQ(ret, SW_OK);
+
+    count = 0;
+    swoole_event_set_handler(SW_FD_PIPE | SW_EVENT_READ, [](swReactor *reactor, swEvent *ev) -> int
+    {
+        char buffer[16];
+
+        ssize_t n = read(ev->fd, buffer, sizeof(buffer));
+        EXPECT_EQ(sizeof("hello world"), n);
+        if (++count == 3)
+        {
+            reactor->del(reactor, ev->socket);
+            reactor->wait_exit = 1;
+        }
+
+        return SW_OK;
+    });
+
+    ret = swoole_event_add(p.worker_socket, SW_EVENT_READ);
+    ASSERT_EQ(ret, SW_OK);
+
+    for (int i = 0; i < 3; i++)
+    {
+        ret = p.write(&p, (void *) SW_STRS("hello world"));
+        ASSERT_EQ(ret, sizeof("hello world"));
+    }
+
+    ret = swoole_event_wait();
+    ASSERT_EQ(ret, SW_OK);
+    ASSERT_EQ(count, 3);
+
+    p.close(&p);
+}
+
+TEST(reactor_io_uring, set)
+{
+    int ret;
+    swPipe p;
+
+    SwooleG.enable_io_uring = 1;
+    ret = swoole_event_init();
+    SwooleG.enable_io_uring = 0;
+    ASSERT_EQ(ret, SW_OK);
+
+    ret = swPipeUnsock_create(&p, 1, SOCK_DGRAM);
+    ASSERT_EQ(ret, SW_OK);
+
+    swoole_event_set_handler(SW_FD_PIPE | SW_EVENT_READ, [](swReactor *reactor, swEvent *ev) -> int
+    {
+        char buffer[16];
+
+        ssize_t n = read(ev->fd, buffer, sizeof(buffer));
+        EXPECT_EQ(sizeof("hello world"), n);
+        // switch to the write event, the socket is always writable
+        return reactor->set(reactor, ev->socket, SW_EVENT_WRITE);
+    });
+
+    swoole_event_set_handler(SW_FD_PIPE | SW_EVENT_WRITE, [](swReactor *reactor, swEvent *ev) -> int
+    {
+        reactor->del(reactor, ev->socket);
+        reactor->wait_exit = 1;
+        return SW_OK;
+    });
+
+    ret = swoole_event_add(p.worker_socket, SW_EVENT_READ);
+    ASSERT_EQ(ret, SW_OK);
+
+    ret = p.write(&p, (void *) SW_STRS("hello world"));
+    ASSERT_EQ(ret, sizeof("hello world"));
+
+    ret = swoole_event_wait();
+    ASSERT_EQ(ret, SW_OK);
+    ASSERT_EQ(SwooleTG.reactor, nullptr);
+
+    p.close(&p);
+}
+
+/**
+ * a handler adds a higher fd, the slots of the reactor move while the event is handled
+ */
+TEST(reactor_io_uring, add_in_handler)
+{
+    int ret;
+    swPipe p, p2;
+    static int count;
+    static int high_fd;
+    static swSocket *high_socket;
+
+    SwooleG.enable_io_uring = 1;
+    ret = swoole_event_init();
+    SwooleG.enable_io_uring = 0;
+    ASSERT_EQ(ret, SW_OK);
+
+    ASSERT_EQ(swPipeUnsock_create(&p, 1, SOCK_DGRAM), SW_OK);
+    ASSERT_EQ(swPipeUnsock_create(&p2, 1, SOCK_DGRAM), SW_OK);
+    high_fd = fcntl(p2.getSocket(&p2, 0)->fd, F_DUPFD, 4096);
+    ASSERT_GT(high_fd, 0);
+
+    count = 0;
+    high_socket = nullptr;
+    swoole_event_set_handler(SW_FD_PIPE | SW_EVENT_READ, [](swReactor *reactor, swEvent *ev) -> int
+    {
+        char buffer[16];
+
+        ssize_t n = read(ev->fd, buffer, sizeof(buffer));
+        EXPECT_EQ(sizeof("hello world"), n);
+        if (++count == 1)
+        {
+            high_socket = swSocket_new(high_fd, SW_FD_PIPE);
+            EXPECT_EQ(reactor->add(reactor, high_socket, SW_EVENT_READ), SW_OK);
+        }
+        else if (count == 2)
+        {
+            reactor->del(reactor, high_socket);
+            reactor->del(reactor, ev->socket);
+            reactor->wait_exit = 1;
+        }
+        return SW_OK;
+    });
+
+    ASSERT_EQ(swoole_event_add(p.worker_socket, SW_EVENT_READ), SW_OK);
+
+    for (int i = 0; i < 2; i++)
+    {
+        ret = p.write(&p, (void *) SW_STRS("hello world"));
+        ASSERT_EQ(ret, sizeof("hello world"));
+    }
+
+    ASSERT_EQ(swoole_event_wait(), SW_OK);
+    // the first socket is armed again after the slots moved
+    ASSERT_EQ(count, 2);
+
+    swSocket_free(high_socket);
+    p.close(&p);
+    p2.close(&p2);
+}
+
+#endif
@@ -1,5 +1,6 @@
 #include "tests.h"
 #include "swoole/swoole_cxx.h"
+#include "swoole/hash.h"
 
 using namespace std;
 
@@ -17,4 +18,220 @@ TEST(server, create_pipe_buffers)
     {
         ASSERT_NE(nullptr, serv.pipe_buffers[i]);
     }
-}
\ No newline at end of file
+}
+TEST(server, task_shm)
+{
+    swServer serv;
+    swServer_init(&serv);
+    serv.task_shm_slice_size = 128 * 1024;
+    serv.task_shm_size = 300 * 1024;
+    ASSERT_EQ(swTaskWorker_create_shm(&serv), SW_OK);
+
+    string data(100 * 1024, 0);
+    swoole_random_string(&data[0], data.length());
+
+    // two slices, the third packet goes to the tmpfile
+    swEventData tasks[3];
+    for (auto &task : tasks)
+    {
+        bzero(&task.info, sizeof(task.info));
+        ASSERT_EQ(swTaskWorker_large_pack(&task, data.c_str(), data.length()), SW_OK);
+        ASSERT_TRUE(swTask_type(&task) & SW_TASK_TMPFILE);
+    }
+    ASSERT_NE(((swPacket_task *) tasks[0].data)->shm_data, nullptr);
+    ASSERT_NE(((swPacket_task *) tasks[1].data)->shm_data, nullptr);
+    ASSERT_EQ(((swPacket_task *) tasks[2].data)->shm_data, nullptr);
+
+    for (auto &task : tasks)
+    {
+        swString *result = swTaskWorker_large_unpack(&task);
+        ASSERT_NE(result, nullptr);
+        ASSERT_EQ(string(result->str, result->length), data);
+    }
+
+    // the slices are reused
+    ASSERT_EQ(swTaskWorker_large_pack(&tasks[0], data.c_str(), data.length()), SW_OK);
+    ASSERT_NE(((swPacket_task *) tasks[0].data)->shm_data, nullptr);
+    ASSERT_NE(swTaskWorker_large_unpack(&tasks[0]), nullptr);
+
+    // larger than a slice
+    string large(200 * 1024, 'a');
+    ASSERT_EQ(swTaskWorker_large_pack(&tasks[0], large.c_str(), large.length()), SW_OK);
+    ASSERT_EQ(((swPacket_task *) tasks[0].data)->shm_data, nullptr);
+    swString *result = swTaskWorker_large_unpack(&tasks[0]);
+    ASSERT_EQ(string(result->str, result->length), large);
+
+    swTaskWorker_free_shm(&serv);
+}
+
+TEST(server, task_shm_free)
+{
+    swServer serv;
+    swServer_init(&serv);
+    serv.task_shm_slice_size = 128 * 1024;
+    serv.task_shm_size = 300 * 1024;
+    ASSERT_EQ(swTaskWorker_create_shm(&serv), SW_OK);
+
+    string data(100 * 1024, 'a');
+    swEventData tasks[2];
+    for (auto &task : tasks)
+    {
+        bzero(&task.info, sizeof(task.info));
+        ASSERT_EQ(swTaskWorker_large_pack(&task, data.c_str(), data.length()), SW_OK);
+        ASSERT_NE(((swPacket_task *) task.data)->shm_data, nullptr);
+    }
+
+    // the results are dropped without being read, their slices are reused
+    for (auto &task : tasks)
+    {
+        swTaskWorker_large_free(&task);
+    }
+    for (auto &task : tasks)
+    {
+        ASSERT_EQ(swTaskWorker_large_pack(&task, data.c_str(), data.length()), SW_OK);
+        ASSERT_NE(((swPacket_task *) task.data)->shm_data, nullptr);
+        swTaskWorker_large_free(&task);
+    }
+
+    swTaskWorker_free_shm(&serv);
+}
+
+TEST(server, dispatch_least_latency)
+{
+    swServer serv;
+    swServer_init(&serv);
+    serv.dispatch_mode = SW_DISPATCH_LEAST_LATENCY;
+    serv.worker_num = 4;
+
+    swWorker workers[4];
+    bzero(workers, sizeof(workers));
+    serv.workers = workers;
+
+    // a slow worker with queued requests
+    workers[2].inflight_num = 8;
+    workers[2].service_time = 100000;
+    for (int i = 0; i < 4; i++)
+    {
+        if (i != 2)
+        {
+            workers[i].service_time = 1000;
+        }
+    }
+
+    int count[4] = {};
+    for (int i = 0; i < 400; i++)
+    {
+        int worker_id = swServer_worker_schedule(&serv, 0, nullptr);
+        ASSERT_GE(worker_id, 0);
+        ASSERT_LT(worker_id, 4);
+        count[worker_id]++;
+    }
+    // the two choices are always different workers, the slow one loses every time
+    ASSERT_EQ(count[2], 0);
+    ASSERT_GT(count[0], 0);
+    ASSERT_GT(count[1], 0);
+    ASSERT_GT(count[3], 0);
+}
+
+TEST(server, dispatch_inflight_num)
+{
+    swServer serv;
+    create_test_server(&serv);
+    serv.factory_mode = SW_MODE_PROCESS;
+    serv.dispatch_mode = SW_DISPATCH_LEAST_LATENCY;
+    serv.onPacket = [](swServer *serv, swEventData *req) -> int
+    {
+        usleep(1000);
+        return SW_OK;
+    };
+
+    serv.gs->event_workers.workers = serv.workers;
+
+    swPipe *pipes = (swPipe *) sw_calloc(serv.worker_num, sizeof(swPipe));
+    for (uint32_t i = 0; i < serv.worker_num; i++)
+    {
+        swWorker *worker = swServer_get_worker(&serv, i);
+        bzero(worker, sizeof(*worker));
+        worker->id = i;
+        ASSERT_EQ(swPipeUnsock_create(&pipes[i], 1, SOCK_DGRAM), SW_OK);
+        worker->pipe_master = pipes[i].getSocket(&pipes[i], SW_PIPE_MASTER);
+        worker->pipe_worker = pipes[i].getSocket(&pipes[i], SW_PIPE_WORKER);
+    }
+    swServer_set_ipc_max_size(&serv);
+    ASSERT_EQ(swServer_create_pipe_buffers(&serv), SW_OK);
+
+    const int n = 16;
+    swSendData task = {};
+    task.info.type = SW_SERVER_EVENT_SNED_DGRAM;
+    task.info.reactor_id = -1;
+    task.info.len = 5;
+    task.data = (char *) "hello";
+    for (int i = 0; i < n; i++)
+    {
+        task.info.fd = i;
+        ASSERT_EQ(serv.factory.dispatch(&serv.factory, &task), SW_OK);
+    }
+
+    uint32_t inflight_num = 0;
+    for (uint32_t i = 0; i < serv.worker_num; i++)
+    {
+        inflight_num += swServer_get_worker(&serv, i)->inflight_num;
+    }
+    ASSERT_EQ(inflight_num, n);
+
+    // each worker processes its queued packets
+    char buffer[sizeof(swDataHead) + 64];
+    SwooleWG.run_always = 1;
+    for (uint32_t i = 0; i < serv.worker_num; i++)
+    {
+        swWorker *worker = swServer_get_worker(&serv, i);
+        SwooleWG.worker = worker;
+        while (worker->inflight_num > 0)
+        {
+            ASSERT_GT(read(worker->pipe_worker->fd, buffer, sizeof(buffer)), 0);
+            ASSERT_EQ(swWorker_onTask(&serv.factory, (swEventData *) buffer), SW_OK);
+        }
+        if (worker->request_count > 0)
+        {
+            ASSERT_GT(worker->service_time, 0);
+        }
+        // the packets queued for a previous worker do not wrap the counter
+        ASSERT_EQ(write(worker->pipe_master->fd, buffer, sizeof(swDataHead) + 5), sizeof(swDataHead) + 5);
+        ASSERT_GT(read(worker->pipe_worker->fd, buffer, sizeof(buffer)), 0);
+        ASSERT_EQ(swWorker_onTask(&serv.factory, (swEventData *) buffer), SW_OK);
+        ASSERT_EQ(worker->inflight_num, 0);
+        pipes[i].close(&pipes[i]);
+    }
+    SwooleWG.worker = nullptr;
+    SwooleWG.run_always = 0;
+    sw_free(pipes);
+}
+
+TEST(server, dispatch_consistent_hash)
+{
+    const int n = 10000;
+    int moved = 0;
+    for (int key = 0; key < n; key++)
+    {
+        uint32_t a = swoole_hash_jump_consistent(key, 8);
+        uint32_t b = swoole_hash_jump_consistent(key, 9);
+        ASSERT_LT(a, 8u);
+        if (a != b)
+        {
+            // only to the new worker
+            ASSERT_EQ(b, 8u);
+            moved++;
+        }
+    }
+    // about 1/9 of the keys
+    ASSERT_GT(moved, n / 9 / 2);
+    ASSERT_LT(moved, n / 9 * 2);
+
+    swServer serv;
+    swServer_init(&serv);
+    serv.dispatch_mode = SW_DISPATCH_CONSISTENT_HASH;
+    serv.worker_num = 8;
+    serv.max_connection = 0;
+    // without a connection the fd is the key
+    ASSERT_EQ(swServer_worker_schedule(&serv, 100, nullptr), (int) swoole_hash_jump_consistent(100, 8));
+}
@@ -0,0 +1,153 @@
+#include "tests.h"
+#include "swoole/static_handler.h"
+
+using swoole::http::StaticHandler;
+
+static const char *document_root = "/tmp/swoole_static_handler_test";
+
+static void write_file(const char *name, const char *data)
+{
+    std::string path = std::string(document_root) + name;
+    FILE *fp = fopen(path.c_str(), "w");
+    fputs(data, fp);
+    fclose(fp);
+}
+
+TEST(static_handler, cache)
+{
+    swServer serv;
+    swServer_init(&serv);
+    mkdir(document_root, 0755);
+    serv.document_root = (char *) document_root;
+    serv.document_root_len = strlen(document_root);
+    serv.locations = new std::unordered_set<std::string>;
+    serv.static_handler_cache_capacity = 2;
+    serv.static_handler_cache_interval = 0;
+
+    write_file("/a.txt", "version 1");
+    write_file("/b.txt", "b");
+    write_file("/c.txt", "c");
+
+    int fd;
+    {
+        StaticHandler handler(&serv, SW_STRL("/a.txt?v=1"));
+        ASSERT_TRUE(handler.hit());
+        fd = handler.get_task()->fd;
+        ASSERT_GE(fd, 0);
+        ASSERT_EQ(handler.get_task()->length, 9);
+        ASSERT_STREQ(handler.get_mimetype(), "text/plain");
+    }
+    {
+        StaticHandler handler(&serv, SW_STRL("/a.txt"));
+        ASSERT_TRUE(handler.hit());
+        ASSERT_EQ(handler.get_task()->fd, fd);
+        ASSERT_STREQ(handler.get_filename(), (std::string(document_root) + "/a.txt").c_str());
+    }
+
+    // a changed file is opened again
+    write_file("/a.txt", "version 22");
+    {
+        StaticHandler handler(&serv, SW_STRL("/a.txt"));
+        ASSERT_TRUE(handler.hit());
+        ASSERT_EQ(handler.get_task()->length, 10);
+        ASSERT_GE(handler.get_task()->fd, 0);
+        fd = handler.get_task()->fd;
+    }
+
+    // the least recently used file is closed
+    {
+        StaticHandler handler1(&serv, SW_STRL("/b.txt"));
+        ASSERT_TRUE(handler1.hit());
+        StaticHandler handler2(&serv, SW_STRL("/c.txt"));
+        ASSERT_TRUE(handler2.hit());
+    }
+    ASSERT_EQ(fcntl(fd, F_GETFD), -1);
+
+    unlink((std::string(document_root) + "/a.txt").c_str());
+    {
+        StaticHandler handler(&serv, SW_STRL("/a.txt"));
+        ASSERT_FALSE(handler.hit());
+    }
+    unlink((std::string(document_root) + "/b.txt").c_str());
+    unlink((std::string(document_root) + "/c.txt").c_str());
+    {
+        StaticHandler handler(&serv, SW_STRL("/c.txt"));
+        ASSERT_FALSE(handler.hit());
+    }
+    rmdir(document_root);
+    delete serv.locations;
+}
+
+TEST(static_handler, range)
+{
+    swServer serv;
+    swServer_init(&serv);
+    mkdir(document_root, 0755);
+    serv.document_root = (char *) document_root;
+    serv.document_root_len = strlen(document_root);
+    serv.locations = new std::unordered_set<std::string>;
+
+    write_file("/range.txt", "0123456789");
+    StaticHandler handler(&serv, SW_STRL("/range.txt"));
+    ASSERT_TRUE(handler.hit());
+
+    std::string etag = handler.get_etag();
+    ASSERT_EQ(etag.front(), '"');
+    ASSERT_TRUE(handler.is_etag_matched(etag));
+    ASSERT_TRUE(handler.is_etag_matched("\"x\", W/" + etag));
+    ASSERT_TRUE(handler.is_etag_matched("*"));
+    ASSERT_FALSE(handler.is_etag_matched("\"x\""));
+
+    ASSERT_TRUE(handler.parse_range("bytes=2-4", ""));
+    ASSERT_EQ(handler.status_code, SW_HTTP_PARTIAL_CONTENT);
+    ASSERT_EQ(handler.get_ranges().size(), 1);
+    ASSERT_EQ(handler.get_ranges()[0].offset, 2);
+    ASSERT_EQ(handler.get_ranges()[0].length, 3);
+    ASSERT_EQ(handler.get_content_length(), 3);
+
+    // suffix, open end and a too large end
+    ASSERT_TRUE(handler.parse_range("bytes=-3, 7-, 8-100", ""));
+    auto &ranges = handler.get_ranges();
+    ASSERT_EQ(ranges.size(), 3);
+    ASSERT_EQ(ranges[0].offset, 7);
+    ASSERT_EQ(ranges[0].length, 3);
+    ASSERT_EQ(ranges[1].offset, 7);
+    ASSERT_EQ(ranges[1].length, 3);
+    ASSERT_EQ(ranges[2].offset, 8);
+    ASSERT_EQ(ranges[2].length, 2);
+    ASSERT_EQ(strlen(handler.get_boundary()), SW_HTTP_RANGE_BOUNDARY_LEN);
+    std::string part = handler.get_part_header(ranges[2]);
+    ASSERT_NE(part.find("Content-Range: bytes 8-9/10\r\n"), std::string::npos);
+    size_t length = 0;
+    for (auto &range : ranges)
+    {
+        length += handler.get_part_header(range).length() + range.length;
+    }
+    length += strlen("\r\n--") + SW_HTTP_RANGE_BOUNDARY_LEN + strlen("--\r\n");
+    ASSERT_EQ(handler.get_content_length(), length);
+
+    // unsatisfiable ranges are skipped
+    ASSERT_TRUE(handler.parse_range("bytes=20-30,0-0", ""));
+    ASSERT_EQ(handler.get_ranges().size(), 1);
+    ASSERT_TRUE(handler.parse_range("bytes=20-30", ""));
+    ASSERT_EQ(handler.status_code, SW_HTTP_RANGE_NOT_SATISFIABLE);
+
+    // invalid headers are ignored
+    handler.status_code = SW_HTTP_OK;
+    ASSERT_FALSE(handler.parse_range("bytes=5-2", ""));
+    ASSERT_FALSE(handler.parse_range("bytes=a-", ""));
+    ASSERT_FALSE(handler.parse_range("bytes=-", ""));
+    ASSERT_FALSE(handler.parse_range("items=0-1", ""));
+    ASSERT_FALSE(handler.parse_range("bytes=0-1,2-3,4-5,6-7,8-9,0-1,2-3,4-5,6-7,8-9,0-1,2-3,4-5,6-7,8-9,0-1,2-3", ""));
+    ASSERT_EQ(handler.status_code, SW_HTTP_OK);
+
+    // If-Range
+    ASSERT_FALSE(handler.parse_range("bytes=0-1", "\"other\""));
+    ASSERT_FALSE(handler.parse_range("bytes=0-1", "W/" + etag));
+    ASSERT_TRUE(handler.parse_range("bytes=0-1", etag));
+    ASSERT_TRUE(handler.parse_range("bytes=0-1", handler.get_date_last_modified()));
+
+    unlink((std::string(document_root) + "/range.txt").c_str());
+    rmdir(document_root);
+    delete serv.locations;
+}
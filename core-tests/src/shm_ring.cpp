@@ -0,0 +1,184 @@
+#include "tests.h"
+#include "swoole/shm_ring.h"
+
+#include <thread>
+
+#define PACKET_NUM       10000
+#define PACKET_MAX_LEN   3000
+
+TEST(shm_ring, push_pop)
+{
+    swShmRing *ring = swShmRing_new(1000);
+    ASSERT_NE(ring, nullptr);
+    ASSERT_EQ(ring->size, 1024);
+    ASSERT_TRUE(swShmRing_empty(ring));
+
+    uint32_t length;
+    ASSERT_EQ(swShmRing_front(ring, &length), nullptr);
+
+    // too large
+    ASSERT_EQ(swShmRing_alloc(ring, 2000), nullptr);
+
+    char *buf = (char *) swShmRing_alloc(ring, 5);
+    ASSERT_NE(buf, nullptr);
+    memcpy(buf, "hello", 5);
+    // not published yet
+    ASSERT_EQ(swShmRing_front(ring, &length), nullptr);
+    ASSERT_FALSE(swShmRing_push(ring));
+
+    buf = (char *) swShmRing_front(ring, &length);
+    ASSERT_NE(buf, nullptr);
+    ASSERT_EQ(length, 5);
+    ASSERT_EQ(memcmp(buf, "hello", 5), 0);
+    swShmRing_pop(ring);
+    ASSERT_TRUE(swShmRing_empty(ring));
+
+    swShmRing_free(ring);
+}
+
+TEST(shm_ring, wrap_around)
+{
+    swShmRing *ring = swShmRing_new(1024);
+    uint32_t length;
+
+    // 8 bytes header + 400 bytes
+    ASSERT_NE(swShmRing_alloc(ring, 400), nullptr);
+    swShmRing_push(ring);
+    ASSERT_NE(swShmRing_alloc(ring, 400), nullptr);
+    swShmRing_push(ring);
+    // only 208 bytes left
+    ASSERT_EQ(swShmRing_alloc(ring, 400), nullptr);
+
+    ASSERT_NE(swShmRing_front(ring, &length), nullptr);
+    swShmRing_pop(ring);
+
+    // does not fit at the end, starts over at the beginning
+    char *buf = (char *) swShmRing_alloc(ring, 400);
+    ASSERT_EQ(buf, ring->data + 8);
+    memset(buf, 'A', 400);
+    swShmRing_push(ring);
+
+    ASSERT_NE(swShmRing_front(ring, &length), nullptr);
+    swShmRing_pop(ring);
+    buf = (char *) swShmRing_front(ring, &length);
+    ASSERT_EQ(buf, ring->data + 8);
+    ASSERT_EQ(length, 400);
+    ASSERT_EQ(buf[399], 'A');
+    swShmRing_pop(ring);
+    ASSERT_TRUE(swShmRing_empty(ring));
+
+    swShmRing_free(ring);
+}
+
+static std::string consume_log;
+
+TEST(shm_ring, consume)
+{
+    swShmRing *ring = swShmRing_new(1024);
+    uint32_t length;
+    auto write_log = SwooleG.write_log;
+    consume_log.clear();
+    SwooleG.write_log = [](int level, char *content, size_t length)
+    {
+        consume_log.append(content, length);
+    };
+
+    memcpy(swShmRing_alloc(ring, 5), "crash", 5);
+    swShmRing_push(ring);
+    memcpy(swShmRing_alloc(ring, 5), "hello", 5);
+    swShmRing_push(ring);
+
+    ASSERT_NE(swShmRing_front(ring, &length), nullptr);
+    // the consumer exits while handling the packet, without popping it
+    swShmRing_consume(ring);
+
+    // the next consumer skips it
+    char *buf = (char *) swShmRing_front(ring, &length);
+    SwooleG.write_log = write_log;
+    ASSERT_NE(consume_log.find("the packet[length=5] that was being handled by the previous consumer is dropped"), std::string::npos);
+    ASSERT_NE(buf, nullptr);
+    ASSERT_EQ(memcmp(buf, "hello", 5), 0);
+    swShmRing_consume(ring);
+    swShmRing_pop(ring);
+    ASSERT_TRUE(swShmRing_empty(ring));
+
+    swShmRing_free(ring);
+}
+
+TEST(shm_ring, wait)
+{
+    swShmRing *ring = swShmRing_new(1024);
+    uint32_t length;
+
+    ASSERT_TRUE(swShmRing_wait(ring));
+    swShmRing_alloc(ring, 10);
+    // the consumer is sleeping
+    ASSERT_TRUE(swShmRing_push(ring));
+    swShmRing_alloc(ring, 10);
+    // already woken up
+    ASSERT_FALSE(swShmRing_push(ring));
+
+    // not empty, the consumer keeps running
+    ASSERT_FALSE(swShmRing_wait(ring));
+    while (swShmRing_front(ring, &length))
+    {
+        swShmRing_pop(ring);
+    }
+    ASSERT_TRUE(swShmRing_wait(ring));
+
+    swShmRing_free(ring);
+}
+
+TEST(shm_ring, thread)
+{
+    swShmRing *ring = swShmRing_new(64 * 1024);
+    swPipe notify;
+    ASSERT_EQ(swPipeNotify_auto(&notify, 1, 0), 0);
+
+    std::thread consumer([ring, &notify]()
+    {
+        uint32_t length;
+        uint64_t flag;
+        char *packet;
+        int n = 0;
+
+        while (n < PACKET_NUM)
+        {
+            while ((packet = (char *) swShmRing_front(ring, &length)))
+            {
+                ASSERT_EQ(length, (uint32_t) n % PACKET_MAX_LEN + sizeof(n) + 1);
+                ASSERT_EQ(*(int *) packet, n);
+                ASSERT_EQ(packet[length - 1], (char) n);
+                swShmRing_pop(ring);
+                n++;
+            }
+            if (swShmRing_wait(ring))
+            {
+                notify.read(&notify, &flag, sizeof(flag));
+            }
+        }
+    });
+
+    uint64_t flag = 1;
+    for (int n = 0; n < PACKET_NUM; n++)
+    {
+        uint32_t length = n % PACKET_MAX_LEN + sizeof(n) + 1;
+        char *packet;
+        while (!(packet = (char *) swShmRing_alloc(ring, length)))
+        {
+            sched_yield();
+        }
+        *(int *) packet = n;
+        packet[length - 1] = (char) n;
+        if (swShmRing_push(ring))
+        {
+            notify.write(&notify, &flag, sizeof(flag));
+        }
+    }
+
+    consumer.join();
+    ASSERT_TRUE(swShmRing_empty(ring));
+
+    notify.close(&notify);
+    swShmRing_free(ring);
+}
@@ -1,4 +1,6 @@
 #include "tests.h"
+#include "swoole/swoole_api.h"
+
 #ifndef _WIN32
 TEST(socket, swSocket_unix_sendto)
 {
@@ -31,4 +33,55 @@ TEST(socket, swSocket_unix_sendto)
     unlink(sock1_path);
     unlink(sock2_path);
 }
+
+TEST(socket, sendto_batch)
+{
+    struct sockaddr_in addr;
+    socklen_t len = sizeof(addr);
+    bzero(&addr, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+
+    int server_fd = socket(AF_INET, SOCK_DGRAM, 0);
+    ASSERT_EQ(bind(server_fd, (struct sockaddr *) &addr, sizeof(addr)), 0);
+    ASSERT_EQ(getsockname(server_fd, (struct sockaddr *) &addr, &len), 0);
+    int client_fd = socket(AF_INET, SOCK_DGRAM, 0);
+
+    auto recv_all = [server_fd]()
+    {
+        std::vector<std::string> packets;
+        char buf[64];
+        ssize_t n;
+        while ((n = recv(server_fd, buf, sizeof(buf), MSG_DONTWAIT)) > 0)
+        {
+            packets.emplace_back(buf, n);
+        }
+        return packets;
+    };
+
+    sw_atomic_long_t dropped = 0;
+    swoole_event_init();
+    SwooleTG.reactor->wait_exit = 1;
+    for (int i = 0; i < 10; i++)
+    {
+        std::string data = "packet-" + std::to_string(i);
+        ASSERT_EQ(swSocket_sendto_batch(client_fd, data.c_str(), data.length(), (struct sockaddr *) &addr, len, 4, &dropped), data.length());
+    }
+#ifdef HAVE_SENDMMSG
+    // two full batches are sent, the rest waits for the end of the event loop round
+    ASSERT_EQ(recv_all().size(), 8);
+    swoole_event_wait();
+    auto packets = recv_all();
+    ASSERT_EQ(packets.size(), 2);
+#else
+    swoole_event_wait();
+    auto packets = recv_all();
+    ASSERT_EQ(packets.size(), 10);
+#endif
+    ASSERT_EQ(packets.back(), "packet-9");
+    ASSERT_EQ(dropped, 0);
+
+    close(client_fd);
+    close(server_fd);
+}
 #endif
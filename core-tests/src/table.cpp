@@ -0,0 +1,115 @@
+#include "tests.h"
+#include "swoole/table.h"
+
+#include <sys/wait.h>
+
+static swTable* create_table(uint8_t use_seqlock)
+{
+    swTable *table = swTable_new(1024, 0.2);
+    table->use_seqlock = use_seqlock;
+    swTableColumn_add(table, SW_STRL("a"), SW_TABLE_INT, 8);
+    swTableColumn_add(table, SW_STRL("b"), SW_TABLE_INT, 8);
+    swTable_create(table);
+    return table;
+}
+
+static void set_row(swTable *table, const char *key, int64_t value)
+{
+    swTableRow *rowlock;
+    swTableRow *row = swTableRow_set(table, key, strlen(key), &rowlock);
+    ASSERT_NE(row, nullptr);
+    swTableRow_set_value(row, swTableColumn_get(table, (char *) SW_STRL("a")), &value, 0);
+    swTableRow_set_value(row, swTableColumn_get(table, (char *) SW_STRL("b")), &value, 0);
+    swTableRow_unlock(rowlock);
+}
+
+static void get_row(swTable *table, swTableRow *row, int64_t *a, int64_t *b)
+{
+    memcpy(a, row->data + swTableColumn_get(table, (char *) SW_STRL("a"))->index, sizeof(*a));
+    memcpy(b, row->data + swTableColumn_get(table, (char *) SW_STRL("b"))->index, sizeof(*b));
+}
+
+TEST(table, snapshot)
+{
+    swTable *table = create_table(1);
+    int64_t a, b;
+
+    ASSERT_EQ(swTableRow_get_snapshot(table, SW_STRL("key1")), nullptr);
+    set_row(table, "key1", 100);
+    // some of them go to the collision lists
+    for (int i = 0; i < 128; i++)
+    {
+        set_row(table, std::to_string(i).c_str(), i);
+    }
+
+    swTableRow *row = swTableRow_get_snapshot(table, SW_STRL("key1"));
+    ASSERT_NE(row, nullptr);
+    ASSERT_EQ(row, table->row_buffer);
+    ASSERT_STREQ(row->key, "key1");
+    get_row(table, row, &a, &b);
+    ASSERT_EQ(a, 100);
+
+    row = swTableRow_get_snapshot(table, SW_STRL("100"));
+    ASSERT_NE(row, nullptr);
+    get_row(table, row, &a, &b);
+    ASSERT_EQ(b, 100);
+
+    ASSERT_EQ(swTableRow_del(table, (char *) SW_STRL("key1")), SW_OK);
+    ASSERT_EQ(swTableRow_get_snapshot(table, SW_STRL("key1")), nullptr);
+    for (int i = 0; i < 128; i++)
+    {
+        std::string key = std::to_string(i);
+        ASSERT_EQ(swTableRow_del(table, (char *) key.c_str(), key.length()), SW_OK);
+    }
+    ASSERT_EQ(table->row_num, 0);
+
+    // no slot is left locked for the readers
+    for (size_t i = 0; i < table->size; i++)
+    {
+        ASSERT_EQ(table->rows[i]->lock, 0);
+        ASSERT_EQ(table->rows[i]->version % 2, 0);
+    }
+    swTable_free(table);
+}
+
+TEST(table, snapshot_concurrent_write)
+{
+    swTable *table = create_table(1);
+    const int keys = 8;
+    for (int i = 0; i < keys; i++)
+    {
+        set_row(table, std::to_string(i).c_str(), 0);
+    }
+
+    pid_t pid = fork();
+    ASSERT_GE(pid, 0);
+    if (pid == 0)
+    {
+        for (int64_t n = 1; n < 200000; n++)
+        {
+            set_row(table, std::to_string(n % keys).c_str(), n);
+        }
+        _exit(0);
+    }
+
+    int status;
+    int torn = 0;
+    while (waitpid(pid, &status, WNOHANG) == 0)
+    {
+        for (int i = 0; i < keys; i++)
+        {
+            int64_t a, b;
+            std::string key = std::to_string(i);
+            swTableRow *row = swTableRow_get_snapshot(table, key.c_str(), key.length());
+            ASSERT_NE(row, nullptr);
+            get_row(table, row, &a, &b);
+            if (a != b)
+            {
+                torn++;
+            }
+        }
+    }
+    ASSERT_EQ(torn, 0);
+    ASSERT_EQ(WEXITSTATUS(status), 0);
+    swTable_free(table);
+}
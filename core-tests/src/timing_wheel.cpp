@@ -0,0 +1,185 @@
+#include "tests.h"
+#include "swoole/swoole_api.h"
+#include "swoole/timing_wheel.h"
+
+#include <chrono>
+#include <vector>
+
+using namespace std;
+
+#define SIZE    10000
+
+TEST(timing_wheel, pop)
+{
+    swTimingWheel *wheel = swTimingWheel_new(0);
+    ASSERT_NE(wheel, nullptr);
+
+    vector<swTimingWheel_node> nodes(SIZE);
+    for (int i = 0; i < SIZE; i++)
+    {
+        nodes[i].data = &nodes[i];
+        swTimingWheel_add(wheel, &nodes[i], swoole_system_random(1, 10000000));
+    }
+    ASSERT_EQ(swTimingWheel_size(wheel), SIZE);
+
+    uint64_t now = 0;
+    int count = 0;
+    while (swTimingWheel_size(wheel) > 0)
+    {
+        int64_t next = swTimingWheel_next(wheel);
+        ASSERT_GT(next, (int64_t) now);
+        now = next;
+
+        swTimingWheel_node *node;
+        while ((node = swTimingWheel_pop(wheel, now)))
+        {
+            // every node must be popped exactly at its tick
+            ASSERT_EQ(node->expire, now);
+            count++;
+        }
+    }
+    ASSERT_EQ(count, SIZE);
+    ASSERT_EQ(swTimingWheel_next(wheel), -1);
+
+    swTimingWheel_free(wheel);
+}
+
+TEST(timing_wheel, remove)
+{
+    swTimingWheel *wheel = swTimingWheel_new(0);
+    ASSERT_NE(wheel, nullptr);
+
+    vector<swTimingWheel_node> nodes(SIZE);
+    for (int i = 0; i < SIZE; i++)
+    {
+        swTimingWheel_add(wheel, &nodes[i], i * 100);
+    }
+    for (int i = 0; i < SIZE; i += 2)
+    {
+        swTimingWheel_remove(wheel, &nodes[i]);
+    }
+    ASSERT_EQ(swTimingWheel_size(wheel), SIZE / 2);
+
+    int count = 0;
+    swTimingWheel_node *node;
+    while ((node = swTimingWheel_pop(wheel, SIZE * 100)))
+    {
+        ASSERT_EQ((node - &nodes[0]) % 2, 1);
+        count++;
+    }
+    ASSERT_EQ(count, SIZE / 2);
+
+    swTimingWheel_free(wheel);
+}
+
+TEST(timing_wheel, expired)
+{
+    swTimingWheel *wheel = swTimingWheel_new(1000);
+    swTimingWheel_node node1, node2;
+
+    // more than 2^32 ticks, clamped to the last slot and cascaded down again
+    swTimingWheel_add(wheel, &node1, 1000 + (1ULL << 33));
+    // already expired
+    swTimingWheel_add(wheel, &node2, 10);
+
+    ASSERT_EQ(swTimingWheel_next(wheel), 1000);
+    ASSERT_EQ(swTimingWheel_pop(wheel, 1000), &node2);
+    ASSERT_EQ(swTimingWheel_pop(wheel, 1000 + (1ULL << 33) - 1), nullptr);
+    ASSERT_EQ(swTimingWheel_pop(wheel, 1000 + (1ULL << 33)), &node1);
+
+    swTimingWheel_free(wheel);
+}
+
+TEST(timing_wheel, timer)
+{
+    static int after_count, tick_count;
+
+    swoole_event_init();
+    SwooleTG.reactor->timer_wheel = 1;
+    SwooleTG.reactor->wait_exit = 1;
+
+    after_count = tick_count = 0;
+    swoole_timer_after(20, [](swTimer *timer, swTimer_node *tnode)
+    {
+        after_count++;
+    }, nullptr);
+    swoole_timer_tick(5, [](swTimer *timer, swTimer_node *tnode)
+    {
+        if (++tick_count == 5)
+        {
+            swoole_timer_del(tnode);
+        }
+    }, nullptr);
+    swTimer_node *tnode = swoole_timer_add(10, SW_FALSE, [](swTimer *timer, swTimer_node *tnode)
+    {
+        after_count += 100;
+    }, nullptr);
+    ASSERT_NE(SwooleTG.timer->wheel, nullptr);
+    swoole_timer_del(tnode);
+
+    swoole_event_wait();
+    ASSERT_EQ(after_count, 1);
+    ASSERT_EQ(tick_count, 5);
+}
+
+TEST(timing_wheel, round)
+{
+    static vector<uint64_t> rounds;
+
+    swoole_event_init();
+    SwooleTG.reactor->timer_wheel = 1;
+    SwooleTG.reactor->wait_exit = 1;
+
+    rounds.clear();
+    static swTimerCallback callback = [](swTimer *timer, swTimer_node *tnode)
+    {
+        rounds.push_back(timer->round);
+        if (rounds.size() < 5)
+        {
+            swoole_timer_add(1, SW_FALSE, callback, nullptr);
+            // the new timer is expired before this round ends
+            usleep(5000);
+        }
+    };
+    swoole_timer_add(1, SW_FALSE, callback, nullptr);
+
+    swoole_event_wait();
+    ASSERT_EQ(rounds.size(), 5);
+    for (size_t i = 1; i < rounds.size(); i++)
+    {
+        ASSERT_GT(rounds[i], rounds[i - 1]);
+    }
+}
+
+static double timer_benchmark(bool timer_wheel, int n)
+{
+    vector<swTimer_node *> nodes(n);
+
+    swoole_event_init();
+    SwooleTG.reactor->timer_wheel = timer_wheel;
+
+    auto begin = chrono::steady_clock::now();
+    for (int i = 0; i < n; i++)
+    {
+        nodes[i] = swoole_timer_add(swoole_system_random(1000, 60000), SW_FALSE, [](swTimer *, swTimer_node *) {}, nullptr);
+    }
+    for (int i = 0; i < n; i++)
+    {
+        swoole_timer_del(nodes[i]);
+    }
+    auto end = chrono::steady_clock::now();
+
+    swoole_event_free();
+    return chrono::duration<double, milli>(end - begin).count();
+}
+
+TEST(timing_wheel, benchmark)
+{
+    int n = 200000;
+    double heap_ms = timer_benchmark(false, n);
+    double wheel_ms = timer_benchmark(true, n);
+
+    // microseconds of adding and deleting all the timers
+    RecordProperty("heap", (int) (heap_ms * 1000));
+    RecordProperty("timing_wheel", (int) (wheel_ms * 1000));
+}
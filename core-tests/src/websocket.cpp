@@ -0,0 +1,185 @@
+#include "tests.h"
+#include "swoole/websocket.h"
+
+#include <chrono>
+
+using namespace std;
+
+static const int simd_levels[] = {SW_WEBSOCKET_SIMD_NONE, SW_WEBSOCKET_SIMD_SSE2, SW_WEBSOCKET_SIMD_AVX2};
+
+static void mask_bytewise(char *data, size_t len, const char *mask_key)
+{
+    for (size_t i = 0; i < len; i++)
+    {
+        data[i] ^= mask_key[i % SW_WEBSOCKET_MASK_LEN];
+    }
+}
+
+/**
+ * a plain decoder as the reference
+ */
+static bool utf8_reference(const string &s)
+{
+    size_t i = 0;
+    while (i < s.length())
+    {
+        uchar c = s[i];
+        size_t n;
+        uint32_t cp;
+        if (c < 0x80)
+        {
+            i++;
+            continue;
+        }
+        else if ((c & 0xe0) == 0xc0)
+        {
+            n = 1;
+            cp = c & 0x1f;
+        }
+        else if ((c & 0xf0) == 0xe0)
+        {
+            n = 2;
+            cp = c & 0x0f;
+        }
+        else if ((c & 0xf8) == 0xf0)
+        {
+            n = 3;
+            cp = c & 0x07;
+        }
+        else
+        {
+            return false;
+        }
+        if (i + n >= s.length())
+        {
+            return false;
+        }
+        for (size_t k = 1; k <= n; k++)
+        {
+            if (((uchar) s[i + k] & 0xc0) != 0x80)
+            {
+                return false;
+            }
+            cp = (cp << 6) | ((uchar) s[i + k] & 0x3f);
+        }
+        static const uint32_t min_cp[] = {0, 0x80, 0x800, 0x10000};
+        if (cp < min_cp[n] || cp > 0x10ffff || (cp >= 0xd800 && cp <= 0xdfff))
+        {
+            return false;
+        }
+        i += n + 1;
+    }
+    return true;
+}
+
+static string random_utf8(size_t chars)
+{
+    static const char *samples[] = {"a", "Z", "\xc2\xa9", "\xdf\xbf", "\xe2\x82\xac", "\xed\x9f\xbf", "\xef\xbf\xbf",
+            "\xf0\x9f\x98\x80", "\xf4\x8f\xbf\xbf"};
+    string s;
+    for (size_t i = 0; i < chars; i++)
+    {
+        s.append(samples[swoole_system_random(0, sizeof(samples) / sizeof(samples[0]) - 1)]);
+    }
+    return s;
+}
+
+TEST(websocket, mask)
+{
+    const char *key = "\x12\x34\x56\x78";
+    char buf[300], expect[300];
+
+    for (int level : simd_levels)
+    {
+        swWebSocket_set_simd_level(level);
+        for (size_t offset = 0; offset < 4; offset++)
+        {
+            for (size_t len = 0; len < sizeof(buf) - offset; len += 7)
+            {
+                swoole_random_string(buf, sizeof(buf) - 1);
+                memcpy(expect, buf, sizeof(buf));
+                mask_bytewise(expect + offset, len, key);
+                swWebSocket_mask(buf + offset, len, key);
+                ASSERT_EQ(memcmp(buf, expect, sizeof(buf)), 0);
+            }
+        }
+    }
+    swWebSocket_set_simd_level(SW_WEBSOCKET_SIMD_AVX2);
+}
+
+TEST(websocket, validate_utf8)
+{
+    const char *invalid[] = {
+        "\x80", "\xbf", "\xc0\x80", "\xc1\xbf", "\xc2", "\xc2\x41", "\xe0\x80\x80", "\xe0\x9f\xbf", "\xe2\x82",
+        "\xed\xa0\x80", "\xed\xbf\xbf", "\xf0\x80\x80\x80", "\xf0\x8f\xbf\xbf", "\xf4\x90\x80\x80", "\xf5\x80\x80\x80",
+        "\xf8\x88\x80\x80\x80", "\xfe", "\xff", "\xf0\x9f\x98", "\xe2\x82\xac\xac",
+    };
+
+    for (int level : simd_levels)
+    {
+        swWebSocket_set_simd_level(level);
+        ASSERT_TRUE(swWebSocket_validate_utf8("", 0));
+
+        // the bad sequence goes over the block boundaries
+        for (size_t prefix = 0; prefix < 70; prefix++)
+        {
+            for (auto bad : invalid)
+            {
+                string s = string(prefix, 'a') + bad + string(prefix % 5, 'b');
+                ASSERT_EQ(swWebSocket_validate_utf8(s.c_str(), s.length()), false) << "level=" << level << ", prefix=" << prefix;
+                ASSERT_FALSE(utf8_reference(s));
+            }
+            string s = string(prefix, 'a') + "\xf0\x9f\x98\x80" + random_utf8(prefix);
+            ASSERT_TRUE(swWebSocket_validate_utf8(s.c_str(), s.length()));
+        }
+
+        // every single byte change of a valid text
+        string text = random_utf8(40);
+        for (size_t i = 0; i < text.length(); i++)
+        {
+            for (int c = 0; c < 256; c += 3)
+            {
+                string s = text;
+                s[i] = c;
+                ASSERT_EQ(swWebSocket_validate_utf8(s.c_str(), s.length()), utf8_reference(s))
+                    << "level=" << level << ", i=" << i << ", c=" << c;
+            }
+        }
+    }
+    swWebSocket_set_simd_level(SW_WEBSOCKET_SIMD_AVX2);
+}
+
+TEST(websocket, benchmark)
+{
+    const size_t size = 4 * 1024 * 1024;
+    const int rounds = 20;
+    string data = random_utf8(size / 3);
+    const char *key = "\x12\x34\x56\x78";
+    const char *names[] = {"scalar", "sse2", "avx2"};
+
+    for (int level : simd_levels)
+    {
+        if (swWebSocket_set_simd_level(level) != level)
+        {
+            continue;
+        }
+        auto begin = chrono::steady_clock::now();
+        for (int i = 0; i < rounds; i++)
+        {
+            swWebSocket_mask(&data[0], data.length(), key);
+        }
+        double mask_ms = chrono::duration<double, milli>(chrono::steady_clock::now() - begin).count();
+
+        begin = chrono::steady_clock::now();
+        for (int i = 0; i < rounds; i++)
+        {
+            ASSERT_TRUE(swWebSocket_validate_utf8(data.c_str(), data.length()));
+        }
+        double utf8_ms = chrono::duration<double, milli>(chrono::steady_clock::now() - begin).count();
+
+        double mb = (double) data.length() * rounds / 1024 / 1024;
+        RecordProperty(string(names[level]) + "_mask", (int) (mb / mask_ms * 1000));
+        RecordProperty(string(names[level]) + "_validate_utf8", (int) (mb / utf8_ms * 1000));
+    }
+    swWebSocket_set_simd_level(SW_WEBSOCKET_SIMD_AVX2);
+}
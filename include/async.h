@@ -29,6 +29,39 @@ enum swAioFlag
 {
     SW_AIO_WRITE_FSYNC = 1u << 1,
     SW_AIO_EOF         = 1u << 2,
+    /**
+     * swAio_handler_read_file() reads and closes event->fd instead of opening event->req
+     */
+    SW_AIO_READ_FILE_FD = 1u << 3,
+};
+
+/**
+ * what the handler does, the requests with an opcode may be executed by io_uring instead of the thread pool
+ */
+enum swAioOpcode
+{
+    SW_AIO_OP_NONE = 0,
+    SW_AIO_OP_READ,
+    SW_AIO_OP_WRITE,
+    SW_AIO_OP_OPEN,
+    SW_AIO_OP_FSTAT,
+    SW_AIO_OP_UNLINK,
+    SW_AIO_OP_MKDIR,
+    SW_AIO_OP_RMDIR,
+    SW_AIO_OP_RENAME,
+    SW_AIO_OP_MAX,
+};
+
+/**
+ * each lane has its own queues and limit of threads, a burst of slow requests only holds up its own lane
+ */
+enum swAioLane
+{
+    SW_AIO_LANE_USER = 0,
+    SW_AIO_LANE_DNS,
+    SW_AIO_LANE_FILE,
+    SW_AIO_LANE_BLOCKING,
+    SW_AIO_LANE_MAX,
 };
 
 typedef struct _swAio_event
@@ -37,6 +70,8 @@ typedef struct _swAio_event
     size_t task_id;
     uint8_t lock;
     uint8_t canceled;
+    uint8_t opcode;
+    uint8_t lane;
     /**
      * input & output
      */
@@ -53,7 +88,8 @@ typedef struct _swAio_event
     /**
      * reserved by system
      */
-    int pipe_fd;
+    void *completion;
+    struct _swAio_event *next;
     double timestamp;
     void *object;
     void (*handler)(struct _swAio_event *event);
@@ -62,11 +98,34 @@ typedef struct _swAio_event
 
 typedef void (*swAio_handler)(swAio_event *event);
 
+typedef struct
+{
+    size_t queue_num;
+    size_t running_num;
+    size_t max_thread_num;
+    size_t dispatch_num;
+    /**
+     * seconds between dispatching and running, of the events taken so far
+     */
+    double wait_time;
+    double max_wait_time;
+} swAio_lane_stats;
+
 ssize_t swAio_dispatch(const swAio_event *request);
 swAio_event* swAio_dispatch2(const swAio_event *request);
 int swAio_cancel(int task_id);
 int swAio_callback(swReactor *reactor, swEvent *_event);
 size_t swAio_thread_count();
+int swAio_lane_get_id(const char *name);
+const char* swAio_lane_get_name(int lane);
+void swAio_set_lane_max_threads(int lane, uint32_t num);
+void swAio_set_lane_priority(const uint8_t *lanes, size_t n);
+int swAio_get_lane_stats(int lane, swAio_lane_stats *stats);
+
+#ifdef HAVE_IO_URING
+swAio_event* swAio_iouring_dispatch(const swAio_event *request);
+int swAio_iouring_callback(swReactor *reactor, swEvent *_event);
+#endif
 
 #ifdef SW_DEBUG
 void swAio_notify_one();
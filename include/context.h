@@ -50,58 +50,30 @@ typedef void (*coroutine_func_t)(void*);
 
 namespace swoole
 {
-#ifdef SW_CONTEXT_PROTECT_STACK_PAGE
-//namespace start
-static uint32_t& get_protect_stack_page()
+/**
+ * per-thread cache of mmap'd coroutine stacks, the lowest page of each stack is a permanent guard page
+ */
+class StackPool
 {
-    static uint32_t protect_stack_page = 0;
-    return protect_stack_page;
-}
+public:
+    static char* alloc(size_t stack_size);
+    static void release(char *stack, size_t stack_size);
+    static void clear();
+    static size_t count();
 
-static bool protect_stack(void *top, size_t stack_size, uint32_t page)
-{
-    if (stack_size <= SwooleG.pagesize * (page + 1))
-    {
-        swoole_error_log(SW_LOG_ERROR, SW_ERROR_CO_PROTECT_STACK_FAILED, "getpagesize() failed");
-        return false;
-    }
-#ifdef PROT_NONE
-    void *protect_page_addr = ((size_t) top & 0xfff) ? (void*) (((size_t) top & ~(size_t) 0xfff) + 0x1000) : top;
-    if (-1 == mprotect(protect_page_addr, SwooleG.pagesize * page, PROT_NONE))
+    static inline size_t get_max_num()
     {
-        swSysWarn(
-            "mprotect() failed: origin_addr:%p, align_addr:%p, page_size:%d, protect_page:%u",
-            top, protect_page_addr, SwooleG.pagesize, page
-        );
-        return false;
+        return max_num;
     }
-    else
-    {
-        swDebug("origin_addr:%p, align_addr:%p, page_size:%d, protect_page:%u", top, protect_page_addr, page, SwooleG.pagesize);
-        return true;
-    }
-#endif
-}
-static bool unprotect_stack(void *top, uint32_t page)
-{
-    void *protect_page_addr = ((size_t) top & 0xfff) ? (void*) (((size_t) top & ~(size_t) 0xfff) + 0x1000) : top;
-#ifdef PROT_READ
-    if (-1 == mprotect(protect_page_addr, SwooleG.pagesize * page, PROT_READ | PROT_WRITE))
-    {
-        swSysWarn(
-            "mprotect() failed: origin_addr:%p, align_addr:%p, page_size:%d, protect_page:%u",
-            top, protect_page_addr, SwooleG.pagesize, page
-        );
-        return false;
-    }
-    else
+
+    static inline void set_max_num(size_t num)
     {
-        swDebug("origin_addr:%p, align_addr:%p, page_size:%d, protect_page:%u", top, protect_page_addr, page, SwooleG.pagesize);
-        return true;
+        max_num = num;
     }
-#endif
-}
-#endif
+
+private:
+    static size_t max_num;
+};
 
 class Context
 {
@@ -131,9 +103,6 @@ protected:
     char* stack_;
     uint32_t stack_size_;
 #endif
-#ifdef SW_CONTEXT_PROTECT_STACK_PAGE
-    uint32_t protect_page_;
-#endif
 #ifdef USE_VALGRIND
     uint32_t valgrind_stack_id;
 #endif
@@ -176,6 +176,20 @@ public:
         stack_size = SW_MEM_ALIGNED_SIZE_EX(SW_MAX(SW_CORO_MIN_STACK_SIZE, SW_MIN(size, SW_CORO_MAX_STACK_SIZE)), SW_CORO_STACK_ALIGNED_SIZE);
     }
 
+    static inline size_t get_stack_pool_size()
+    {
+        return StackPool::get_max_num();
+    }
+
+    static inline void set_stack_pool_size(size_t num)
+    {
+        StackPool::set_max_num(num);
+        if (StackPool::count() > num)
+        {
+            StackPool::clear();
+        }
+    }
+
     static inline long get_last_cid()
     {
         return last_cid;
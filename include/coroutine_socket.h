@@ -559,5 +559,7 @@ public:
     };
 };
 std::vector<std::string> dns_lookup(const char *domain, double timeout = 2.0);
+std::vector<std::string> dns_lookup(const char *domain, int family, double timeout);
+void dns_clear_cache();
 //-------------------------------------------------------------------------------
 }}
@@ -146,8 +146,8 @@ enum swErrorCode
     SW_ERROR_CO_MAKECONTEXT_FAILED,
 
     SW_ERROR_CO_IOCPINIT_FAILED,
-    SW_ERROR_CO_PROTECT_STACK_FAILED,
-    SW_ERROR_CO_STD_THREAD_LINK_ERROR,
+    // the code of the removed stack protection error is not reused
+    SW_ERROR_CO_STD_THREAD_LINK_ERROR = SW_ERROR_CO_IOCPINIT_FAILED + 2,
     SW_ERROR_CO_DISABLED_MULTI_THREAD,
 
     SW_ERROR_END
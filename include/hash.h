@@ -213,6 +213,22 @@ static inline uint64_t swoole_hash_php(const char *key, uint32_t len)
     return hash;
 }
 
+/**
+ * Jump Consistent Hash (John Lamping, Eric Veach), when the number of buckets grows from n to n+1,
+ * only 1/(n+1) of the keys move and all of them move to the new bucket
+ */
+static inline uint32_t swoole_hash_jump_consistent(uint64_t key, uint32_t num_buckets)
+{
+    int64_t b = -1, j = 0;
+    while (j < (int64_t) num_buckets)
+    {
+        b = j;
+        key = key * 2862933555777941757ULL + 1;
+        j = (b + 1) * ((double) (1LL << 31) / (double) ((key >> 33) + 1));
+    }
+    return (uint32_t) b;
+}
+
 #define CRC_STRING_MAXLEN      256
 
 uint32_t swoole_crc32(const char *data, uint32_t size);
@@ -109,10 +109,52 @@ typedef struct _swHttpRequest
     uint32_t request_line_length; /* without \r\n  */
     uint32_t header_length; /* include request_line_length + \r\n */
     uint32_t content_length;
+    /* the bytes of a streamed request which have been dispatched */
+    size_t stream_offset;
 
     swString *buffer;
 } swHttpRequest;
 
+/**
+ * the offsets of a request which is parsed in the reactor, they are relative to the request data
+ */
+typedef struct _swHttpHeaderLayout
+{
+    uint16_t name_offset;
+    uint16_t name_length;
+    uint16_t value_offset;
+    uint16_t value_length;
+} swHttpHeaderLayout;
+
+typedef struct _swHttpRequestLayout
+{
+    uint8_t method; /* swoole_http_method */
+    uint8_t http_major;
+    uint8_t http_minor;
+    uint8_t keep_alive;
+    uint16_t size;
+    uint16_t header_num;
+    uint16_t path_offset;
+    uint16_t path_length;
+    uint16_t query_string_offset;
+    uint16_t query_string_length;
+    uint32_t body_offset;
+    uint32_t body_length;
+    swHttpHeaderLayout headers[0];
+} swHttpRequestLayout;
+
+/**
+ * a response of the worker which is stored in the response cache of the reactor,
+ * the key, the vary lines ("name: value\r\n" of the request headers) and the response follow it
+ */
+typedef struct _swHttpCachePacket
+{
+    uint32_t ttl;
+    uint16_t key_length;
+    uint16_t vary_length;
+    char data[0];
+} swHttpCachePacket;
+
 int swHttp_get_method(const char *method_str, size_t method_len);
 const char* swHttp_get_method_string(int method);
 const char *swHttp_get_status_message(int code);
@@ -125,15 +167,14 @@ int swHttpRequest_get_header_length(swHttpRequest *request);
 int swHttpRequest_get_chunked_body_length(swHttpRequest *request);
 void swHttpRequest_parse_header_info(swHttpRequest *request);
 void swHttpRequest_free(swConnection *conn);
+int swHttpRequest_get_layout(const char *data, size_t length, swString *layout);
 
 static inline void swHttpRequest_clean(swHttpRequest *request)
 {
     memset(request, 0, offsetof(swHttpRequest, buffer));
 }
 
-#ifdef SW_HTTP_100_CONTINUE
 int swHttpRequest_has_expect_header(swHttpRequest *request);
-#endif
 
 #ifdef SW_USE_HTTP2
 ssize_t swHttpMix_get_package_length(swProtocol *protocol, swSocket *conn, char *data, uint32_t length);
@@ -0,0 +1,86 @@
+/*
+ +----------------------------------------------------------------------+
+ | Swoole                                                               |
+ +----------------------------------------------------------------------+
+ | This source file is subject to version 2.0 of the Apache license,    |
+ | that is bundled with this package in the file LICENSE, and is        |
+ | available through the world-wide-web at the following url:           |
+ | http://www.apache.org/licenses/LICENSE-2.0.html                      |
+ | If you did not receive a copy of the Apache2.0 license and are unable|
+ | to obtain it through the world-wide-web, please send a note to       |
+ | license@swoole.com so we can mail you a copy immediately.            |
+ +----------------------------------------------------------------------+
+ | Author: Tianfeng Han  <mikan.tenny@gmail.com>                        |
+ +----------------------------------------------------------------------+
+ */
+
+#ifndef SW_IO_URING_H_
+#define SW_IO_URING_H_
+
+#ifdef HAVE_IO_URING
+#include <linux/io_uring.h>
+
+/**
+ * Raw io_uring submission and completion rings, shared by the reactor and the AIO backend.
+ * Not thread safe, every ring belongs to one thread.
+ */
+typedef struct _swIouring
+{
+    int ring_fd;
+    uint32_t features;
+
+    uint32_t *sq_head;
+    uint32_t *sq_tail;
+    uint32_t *sq_mask;
+    uint32_t *sq_array;
+    uint32_t sq_entries;
+    uint32_t sq_pending;
+    struct io_uring_sqe *sqes;
+
+    uint32_t *cq_head;
+    uint32_t *cq_tail;
+    uint32_t *cq_mask;
+    struct io_uring_cqe *cqes;
+
+    void *sq_ring;
+    size_t sq_ring_size;
+    void *cq_ring;
+    size_t cq_ring_size;
+    size_t sqes_size;
+} swIouring;
+
+int swIouring_create(swIouring *ring, uint32_t entries);
+void swIouring_free(swIouring *ring);
+int swIouring_submit(swIouring *ring, uint32_t min_complete, int timeout_msec);
+int swIouring_register(swIouring *ring, uint32_t opcode, void *arg, uint32_t nr_args);
+struct io_uring_sqe* swIouring_get_sqe(swIouring *ring);
+
+/**
+ * take back the last sqe returned by swIouring_get_sqe, it must not have been submitted yet
+ */
+static inline void swIouring_put_sqe(swIouring *ring)
+{
+    __atomic_store_n(ring->sq_tail, *ring->sq_tail - 1, __ATOMIC_RELEASE);
+    ring->sq_pending--;
+}
+
+/**
+ * the next completion, NULL if the completion queue is empty
+ */
+static inline struct io_uring_cqe* swIouring_peek_cqe(swIouring *ring)
+{
+    uint32_t head = *ring->cq_head;
+    if (head == __atomic_load_n(ring->cq_tail, __ATOMIC_ACQUIRE))
+    {
+        return NULL;
+    }
+    return &ring->cqes[head & *ring->cq_mask];
+}
+
+static inline void swIouring_cqe_seen(swIouring *ring)
+{
+    __atomic_store_n(ring->cq_head, *ring->cq_head + 1, __ATOMIC_RELEASE);
+}
+#endif
+
+#endif /* SW_IO_URING_H_ */
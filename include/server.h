@@ -19,6 +19,7 @@
 #include "swoole_api.h"
 #include "ssl.h"
 #include "http.h"
+#include "shm_ring.h"
 
 #ifdef SW_USE_OPENSSL
 #include "dtls.h"
@@ -58,6 +59,10 @@ enum swServer_event_type
     //process message
     SW_SERVER_EVENT_INCOMING,
     SW_SERVER_EVENT_SHUTDOWN,
+    //the same data to many sessions
+    SW_SERVER_EVENT_BROADCAST,
+    //a http response which is also stored in the response cache of the reactor
+    SW_SERVER_EVENT_HTTP_CACHE,
 };
 
 enum swTask_ipc_mode
@@ -77,6 +82,18 @@ enum swFactory_dispatch_mode
     SW_DISPATCH_UIDMOD   = 5,
     SW_DISPATCH_USERFUNC = 6,
     SW_DISPATCH_STREAM   = 7,
+    SW_DISPATCH_LEAST_LATENCY = 8,
+    SW_DISPATCH_CONSISTENT_HASH = 9,
+};
+
+/**
+ * the key of SW_DISPATCH_CONSISTENT_HASH, the connections without a uid use the fd
+ */
+enum swFactory_dispatch_hash_key
+{
+    SW_DISPATCH_HASH_KEY_IP  = 0,
+    SW_DISPATCH_HASH_KEY_UID = 1,
+    SW_DISPATCH_HASH_KEY_FD  = 2,
 };
 
 enum swFactory_dispatch_result
@@ -86,6 +103,20 @@ enum swFactory_dispatch_result
     SW_DISPATCH_RESULT_USERFUNC_FALLBACK = -3,
 };
 
+/**
+ * shared memory ring between a reactor thread and a worker
+ */
+struct swIpcRing
+{
+    swShmRing *ring;
+    /**
+     * packets of this reactor sent through the pipe and received by the worker,
+     * the ring can only be used again once the worker has caught up with the pipe
+     */
+    sw_atomic_t pipe_send_count;
+    sw_atomic_t pipe_recv_count;
+};
+
 struct swReactorThread
 {
     pthread_t thread_id;
@@ -150,6 +181,10 @@ struct swListenPort
      * open websocket close frame
      */
     uchar open_websocket_close_frame :1;
+    /**
+     * text messages must be valid UTF-8, or the connection is closed with 1007
+     */
+    uchar open_websocket_utf8_check :1;
     /**
      *  one package: length check
      */
@@ -221,6 +256,10 @@ struct swWorkerStopMessage
 struct swPacket_task
 {
     size_t length;
+    /**
+     * a slice of swServer::task_shm_pool, NULL if the data is in the tmpfile
+     */
+    char *shm_data;
     char tmpfile[SW_TASK_TMPDIR_SIZE + sizeof(SW_TASK_TMP_FILE)];
 };
 
@@ -236,6 +275,15 @@ struct swPacket_ptr
     swString data;
 };
 
+/**
+ * the sessions are followed by the data
+ */
+struct swPacket_broadcast
+{
+    uint32_t session_num;
+    int sessions[0];
+};
+
 //-----------------------------------Factory--------------------------------------------
 struct swFactory
 {
@@ -288,6 +336,7 @@ struct swServerStats
     sw_atomic_long_t accept_count;
     sw_atomic_long_t close_count;
     sw_atomic_long_t request_count;
+    sw_atomic_long_t dgram_send_dropped;
 };
 
 struct swServerGS
@@ -328,6 +377,7 @@ struct swServer
      * package dispatch mode
      */
     uint8_t dispatch_mode;
+    uint8_t dispatch_hash_key;
 
     /**
      * No idle work process is available.
@@ -350,6 +400,14 @@ struct swServer
 
     int udp_socket_ipv4;
     int udp_socket_ipv6;
+    /**
+     * the max number of datagrams read by one recvmmsg call
+     */
+    uint32_t dgram_recv_burst;
+    /**
+     * the datagrams sent by the worker are flushed by sendmmsg, 0 means send them one by one
+     */
+    uint32_t dgram_send_batch;
 
     uint32_t max_wait_time;
 
@@ -396,6 +454,15 @@ struct swServer
      * parse multipart/form-data files to match $_FILES
      */
     uchar http_parse_files :1;
+    /**
+     * parse the http requests in the reactor, the offsets are sent to the worker with the request,
+     * only in SW_MODE_PROCESS without dispatch_func
+     */
+    uchar http_parse_in_reactor :1;
+    /**
+     * the handler is called when the headers arrive, then the body is sent to the worker piece by piece
+     */
+    uchar http_body_stream :1;
     /**
      * http content compression
      */
@@ -412,6 +479,10 @@ struct swServer
      * show file list in the current directory
      */
     uchar http_autoindex :1;
+    /**
+     * gzip the static files into sibling .gz files in the background, they are sent to the clients which accept them
+     */
+    uchar static_handler_precompress :1;
     /**
      * enable onConnect/onClose event when use dispatch_mode=1/3
      */
@@ -485,6 +556,25 @@ struct swServer
      */
     uint32_t ipc_max_size;
 
+    /**
+     * size of the shared memory ring between each reactor thread and each worker, 0 to disable.
+     * packets are written once into the ring and processed in place by the worker,
+     * oversized packets and packets which do not fit into a full ring go through the pipe.
+     */
+    uint32_t ipc_ring_size;
+    /**
+     * [worker_id * reactor_num + reactor_id]
+     */
+    swIpcRing *ipc_rings;
+    /**
+     * written only when the worker is sleeping
+     */
+    swPipe *ipc_ring_notify;
+    /**
+     * pid of the worker which consumes the rings
+     */
+    sw_atomic_t *ipc_ring_owners;
+
     void *ptr2;
     void *private_data_3;
 
@@ -501,6 +591,13 @@ struct swServer
     uint32_t task_max_request_grace;
     swPipe *task_notify;
     swEventData *task_result;
+    /**
+     * shared memory slices for the large task data, the tmpfile is used when they are used up
+     */
+    uint32_t task_shm_size;
+    uint32_t task_shm_slice_size;
+    swLock *task_shm_lock;
+    swMemoryPool *task_shm_pool;
 
     /**
      * user process
@@ -545,6 +642,18 @@ struct swServer
      */
     char *document_root;
     uint16_t document_root_len;
+    /**
+     * max number of the opened static files kept by each reactor thread, 0 means disabled
+     */
+    uint32_t static_handler_cache_capacity;
+    /**
+     * the cached files are checked with lstat() when they are older than it (seconds)
+     */
+    double static_handler_cache_interval;
+    /**
+     * max number of the http responses cached by each reactor thread, 0 means disabled
+     */
+    uint32_t http_response_cache_capacity;
     /**
      * master process pid
      */
@@ -626,6 +735,7 @@ typedef int (*swServer_dispatch_function)(swServer *, swConnection *, swSendData
 int swServer_master_onAccept(swReactor *reactor, swEvent *event);
 void swServer_master_onTimer(swTimer *timer, swTimer_node *tnode);
 int swServer_master_send(swServer *serv, swSendData *_send);
+int swServer_broadcast(swServer *serv, const int *session_ids, uint32_t session_num, const char *data, uint32_t length);
 
 int swServer_onFinish(swFactory *factory, swSendData *resp);
 int swServer_onFinish2(swFactory *factory, swSendData *resp);
@@ -722,6 +832,21 @@ static sw_inline int swEventData_is_stream(uint8_t type)
     }
 }
 
+/**
+ * the events which run the onReceive/onPacket callbacks
+ */
+static sw_inline int swEventData_is_request(uint8_t type)
+{
+    switch (type)
+    {
+    case SW_SERVER_EVENT_SEND_DATA:
+    case SW_SERVER_EVENT_SNED_DGRAM:
+        return SW_TRUE;
+    default:
+        return SW_FALSE;
+    }
+}
+
 swPipe * swServer_get_pipe_object(swServer *serv, int pipe_fd);
 void swServer_store_pipe_fd(swServer *serv, swPipe *p);
 void swServer_store_listen_socket(swServer *serv);
@@ -741,6 +866,8 @@ int swTaskWorker_onFinish(swReactor *reactor, swEvent *event);
 void swTaskWorker_onStart(swProcessPool *pool, int worker_id);
 void swTaskWorker_onStop(swProcessPool *pool, int worker_id);
 int swTaskWorker_large_pack(swEventData *task, const void *data, size_t data_len);
+int swTaskWorker_create_shm(swServer *serv);
+void swTaskWorker_free_shm(swServer *serv);
 int swTaskWorker_finish(swServer *serv, const char *data, size_t data_len, int flags, swEventData *current_task);
 
 static sw_inline swString* swTaskWorker_large_unpack(swEventData *task_result)
@@ -748,6 +875,24 @@ static sw_inline swString* swTaskWorker_large_unpack(swEventData *task_result)
     swPacket_task _pkg;
     memcpy(&_pkg, task_result->data, sizeof(_pkg));
 
+    if (_pkg.shm_data)
+    {
+        if (SwooleTG.buffer_stack->size < _pkg.length && swString_extend_align(SwooleTG.buffer_stack, _pkg.length) < 0)
+        {
+            return NULL;
+        }
+        memcpy(SwooleTG.buffer_stack->str, _pkg.shm_data, _pkg.length);
+        if (!(swTask_type(task_result) & SW_TASK_PEEK))
+        {
+            swServer *serv = (swServer *) SwooleG.serv;
+            serv->task_shm_lock->lock(serv->task_shm_lock);
+            serv->task_shm_pool->free(serv->task_shm_pool, _pkg.shm_data);
+            serv->task_shm_lock->unlock(serv->task_shm_lock);
+        }
+        SwooleTG.buffer_stack->length = _pkg.length;
+        return SwooleTG.buffer_stack;
+    }
+
     int tmp_file_fd = open(_pkg.tmpfile, O_RDONLY);
     if (tmp_file_fd < 0)
     {
@@ -773,6 +918,32 @@ static sw_inline swString* swTaskWorker_large_unpack(swEventData *task_result)
     return SwooleTG.buffer_stack;
 }
 
+/**
+ * release a large result without reading it, e.g. the result of a task that has timed out
+ */
+static sw_inline void swTaskWorker_large_free(swEventData *task_result)
+{
+    if (!(swTask_type(task_result) & SW_TASK_TMPFILE) || (swTask_type(task_result) & SW_TASK_PEEK))
+    {
+        return;
+    }
+
+    swPacket_task _pkg;
+    memcpy(&_pkg, task_result->data, sizeof(_pkg));
+
+    if (_pkg.shm_data)
+    {
+        swServer *serv = (swServer *) SwooleG.serv;
+        serv->task_shm_lock->lock(serv->task_shm_lock);
+        serv->task_shm_pool->free(serv->task_shm_pool, _pkg.shm_data);
+        serv->task_shm_lock->unlock(serv->task_shm_lock);
+    }
+    else
+    {
+        unlink(_pkg.tmpfile);
+    }
+}
+
 #define SW_SERVER_MAX_FD_INDEX          0 //max connection socket
 #define SW_SERVER_MIN_FD_INDEX          1 //min listen socket
 
@@ -835,6 +1006,32 @@ static sw_inline swWorker* swServer_get_worker(swServer *serv, uint16_t worker_i
     return NULL;
 }
 
+static sw_inline uint64_t swServer_worker_expected_wait(swWorker *worker)
+{
+    return (uint64_t) (worker->inflight_num + 1) * SW_MAX(worker->service_time, 1);
+}
+
+/**
+ * power of two choices: the one of two workers with the lower expected wait
+ */
+static sw_inline int swServer_worker_schedule_least_latency(swServer *serv)
+{
+    uint32_t round = sw_atomic_fetch_add(&serv->worker_round_id, 1);
+    uint32_t a = round % serv->worker_num;
+    if (serv->worker_num == 1)
+    {
+        return a;
+    }
+    uint32_t b = (a + 1 + ((round * 2654435761u) >> 16) % (serv->worker_num - 1)) % serv->worker_num;
+    if (swServer_worker_expected_wait(&serv->workers[b]) < swServer_worker_expected_wait(&serv->workers[a]))
+    {
+        return b;
+    }
+    return a;
+}
+
+int swServer_worker_schedule_hash(swServer *serv, int fd);
+
 static sw_inline int swServer_worker_schedule(swServer *serv, int fd, swSendData *data)
 {
     uint32_t key = 0;
@@ -896,6 +1093,14 @@ static sw_inline int swServer_worker_schedule(swServer *serv, int fd, swSendData
             key = conn->uid;
         }
     }
+    else if (serv->dispatch_mode == SW_DISPATCH_LEAST_LATENCY)
+    {
+        return swServer_worker_schedule_least_latency(serv);
+    }
+    else if (serv->dispatch_mode == SW_DISPATCH_CONSISTENT_HASH)
+    {
+        return swServer_worker_schedule_hash(serv, fd);
+    }
     //Preemptive distribution
     else
     {
@@ -926,6 +1131,8 @@ void swServer_worker_onStop(swServer *serv);
 int swServer_http_static_handler_hit(swServer *serv, swHttpRequest *request, swConnection *conn);
 int swServer_http_static_handler_add_location(swServer *serv, const char *location, size_t length);
 int swServer_http_static_handler_add_http_index_files(swServer *serv, const char *filename, size_t length);
+int swServer_http_cache_hit(swServer *serv, swHttpRequest *request, swConnection *conn);
+int swServer_http_cache_store(swServer *serv, swSendData *_send);
 
 int swWorker_onTask(swFactory *factory, swEventData *task);
 void swWorker_stop(swWorker *worker);
@@ -1010,10 +1217,15 @@ static sw_inline swSocket* swServer_get_send_pipe(swServer *serv, int session_id
     return worker->pipe_worker;
 }
 
+static sw_inline swIpcRing* swServer_get_ipc_ring(swServer *serv, uint32_t worker_id, int reactor_id)
+{
+    return &serv->ipc_rings[worker_id * serv->reactor_num + reactor_id];
+}
+
 static sw_inline uint8_t swServer_support_unsafe_events(swServer *serv)
 {
     if (serv->dispatch_mode != SW_DISPATCH_ROUND && serv->dispatch_mode != SW_DISPATCH_QUEUE
-            && serv->dispatch_mode != SW_DISPATCH_STREAM)
+            && serv->dispatch_mode != SW_DISPATCH_STREAM && serv->dispatch_mode != SW_DISPATCH_LEAST_LATENCY)
     {
         return 1;
     }
@@ -1025,7 +1237,8 @@ static sw_inline uint8_t swServer_support_unsafe_events(swServer *serv)
 
 static sw_inline uint8_t swServer_dispatch_mode_is_mod(swServer *serv)
 {
-    return serv->dispatch_mode == SW_DISPATCH_FDMOD || serv->dispatch_mode == SW_DISPATCH_IPMOD;
+    return serv->dispatch_mode == SW_DISPATCH_FDMOD || serv->dispatch_mode == SW_DISPATCH_IPMOD
+            || (serv->dispatch_mode == SW_DISPATCH_CONSISTENT_HASH && serv->dispatch_hash_key != SW_DISPATCH_HASH_KEY_UID);
 }
 
 static sw_inline swServer* sw_server()
@@ -1063,6 +1276,7 @@ void swReactorThread_free(swServer *serv);
 int swReactorThread_close(swReactor *reactor, swSocket *_socket);
 int swReactorThread_dispatch(swProtocol *proto, swSocket *_socket, char *data, uint32_t length);
 int swReactorThread_send2worker(swServer *serv, swWorker *worker, void *data, size_t len);
+int swReactorThread_send2worker_ring(swServer *serv, swWorker *worker, swDataHead *info, const char *data);
 
 int swReactorProcess_create(swServer *serv);
 int swReactorProcess_start(swServer *serv);
@@ -0,0 +1,63 @@
+/*
+ +----------------------------------------------------------------------+
+ | Swoole                                                               |
+ +----------------------------------------------------------------------+
+ | This source file is subject to version 2.0 of the Apache license,    |
+ | that is bundled with this package in the file LICENSE, and is        |
+ | available through the world-wide-web at the following url:           |
+ | http://www.apache.org/licenses/LICENSE-2.0.html                      |
+ | If you did not receive a copy of the Apache2.0 license and are unable|
+ | to obtain it through the world-wide-web, please send a note to       |
+ | license@swoole.com so we can mail you a copy immediately.            |
+ +----------------------------------------------------------------------+
+ | Author: Tianfeng Han  <mikan.tenny@gmail.com>                        |
+ +----------------------------------------------------------------------+
+ */
+
+#ifndef SW_SHM_RING_H_
+#define SW_SHM_RING_H_
+
+/**
+ * Lock-free single producer single consumer ring in shared memory.
+ * The producer writes a packet in place with alloc() and publishes it with push(),
+ * the consumer reads it in place with front(), marks it with consume() before handling it and releases it with pop().
+ * Packets never wrap around, the unused tail of the ring is skipped instead.
+ */
+typedef struct _swShmRing
+{
+    uint32_t size;
+    char _pad0[SW_CACHELINE_SIZE - sizeof(uint32_t)];
+    /**
+     * written by the producer
+     */
+    volatile uint32_t tail;
+    uint32_t reserved;
+    char _pad1[SW_CACHELINE_SIZE - 2 * sizeof(uint32_t)];
+    /**
+     * written by the consumer
+     */
+    volatile uint32_t head;
+    char _pad2[SW_CACHELINE_SIZE - sizeof(uint32_t)];
+    /**
+     * set by the consumer before it goes to sleep, cleared by the producer which has to wake it up
+     */
+    sw_atomic_t waiting;
+    char _pad3[SW_CACHELINE_SIZE - sizeof(sw_atomic_t)];
+    char data[0];
+} swShmRing;
+
+swShmRing* swShmRing_new(uint32_t size);
+void swShmRing_free(swShmRing *ring);
+void* swShmRing_alloc(swShmRing *ring, uint32_t length);
+bool swShmRing_push(swShmRing *ring);
+void* swShmRing_front(swShmRing *ring, uint32_t *length);
+void swShmRing_consume(swShmRing *ring);
+void swShmRing_pop(swShmRing *ring);
+bool swShmRing_wait(swShmRing *ring);
+
+static inline bool swShmRing_empty(swShmRing *ring)
+{
+    return ring->head == ring->tail;
+}
+
+#endif /* SW_SHM_RING_H_ */
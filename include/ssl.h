@@ -29,6 +29,10 @@ SW_EXTERN_C_BEGIN
 #include <openssl/conf.h>
 #include <openssl/ossl_typ.h>
 
+#if defined(__linux__) && defined(SSL_OP_ENABLE_KTLS) && !defined(OPENSSL_NO_KTLS)
+#define SW_SSL_KTLS 1
+#endif
+
 enum swSSL_create_flag
 {
     SW_SSL_SERVER = 1,
@@ -53,6 +57,10 @@ typedef struct _swSSL_option
     uint8_t dtls;
 #endif
     uchar disable_compress :1;
+    /**
+     * kernel TLS is used when OpenSSL, the kernel and the negotiated cipher support it
+     */
+    uchar disable_ktls :1;
     uchar verify_peer :1;
     uchar allow_self_signed :1;
     uint32_t disable_protocols;
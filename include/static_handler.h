@@ -22,11 +22,43 @@
 
 #include <string>
 #include <set>
+#include <vector>
+#include <memory>
 
 namespace swoole { namespace http {
 
+/**
+ * an opened static file kept by the open-file cache of a reactor thread
+ */
+struct StaticFile
+{
+    int fd;
+    struct stat file_stat;
+    std::string filename;
+    std::string mime_type;
+    std::string date_last_modified;
+    std::string etag;
+    double checked_at;
+
+    StaticFile() : fd(-1), checked_at(0) { }
+    ~StaticFile()
+    {
+        if (fd >= 0)
+        {
+            close(fd);
+        }
+    }
+};
+
 class StaticHandler
 {
+public:
+    struct range_t
+    {
+        off_t offset;
+        size_t length;
+    };
+
 private:
     swServer *serv;
     std::string request_url;
@@ -35,12 +67,22 @@ private:
     {
         off_t offset;
         size_t length;
+        int fd;
         char filename[PATH_MAX];
     } task;
 
     size_t l_filename;
     struct stat file_stat;
     bool last;
+    std::shared_ptr<StaticFile> file;
+    std::vector<range_t> ranges;
+    char boundary[SW_HTTP_RANGE_BOUNDARY_LEN + 1];
+    std::string content_type;
+    const char *content_encoding;
+
+    bool get_cached_file(const char *url, size_t length);
+    void set_cached_file(const char *url, size_t length);
+    void set_file(const std::shared_ptr<StaticFile> &_file);
 
 public:
     int status_code;
@@ -50,6 +92,9 @@ public:
         serv = _server;
         task.length = 0;
         task.offset = 0;
+        task.fd = -1;
+        boundary[0] = '\0';
+        content_encoding = nullptr;
         last = false;
         status_code = 200;
         l_filename = 0;
@@ -60,6 +105,7 @@ public:
     size_t get_index_page(std::set<std::string> &index_files, char *buffer, size_t size);
     bool get_dir_files(std::set<std::string> &index_files);
     bool set_filename(std::string &filename);
+    bool set_encoding(const std::string &accept_encoding);
 
     std::string get_date();
 
@@ -73,6 +119,26 @@ public:
     }
 
     std::string get_date_last_modified();
+    std::string get_etag();
+    bool is_etag_matched(const std::string &if_none_match);
+    bool parse_range(const std::string &range, const std::string &if_range);
+    std::string get_part_header(const range_t &range);
+    size_t get_content_length();
+
+    inline const std::vector<range_t>& get_ranges()
+    {
+        return ranges;
+    }
+
+    inline const char* get_boundary()
+    {
+        return boundary;
+    }
+
+    inline const char* get_content_encoding()
+    {
+        return content_encoding;
+    }
 
     inline const char* get_filename()
     {
@@ -81,9 +147,22 @@ public:
 
     inline const char* get_mimetype()
     {
+        if (!content_type.empty())
+        {
+            return content_type.c_str();
+        }
+        if (file)
+        {
+            return file->mime_type.c_str();
+        }
         return swoole::mime_type::get(get_filename()).c_str();
     }
 
+    inline size_t get_filename_length()
+    {
+        return l_filename;
+    }
+
     inline std::string get_filename_std_string()
     {
         return std::string(task.filename, l_filename);
@@ -99,6 +178,13 @@ public:
         return (const swSendFile_request*) &task;
     }
 
+    inline const swSendFile_request* get_task(const range_t &range)
+    {
+        task.offset = range.offset;
+        task.length = range.length;
+        return get_task();
+    }
+
     inline const bool is_dir()
     {
         return S_ISDIR(file_stat.st_mode);
@@ -184,6 +184,7 @@ typedef unsigned long ulong_t;
 #include "hashmap.h"
 #include "list.h"
 #include "heap.h"
+#include "timing_wheel.h"
 #include "ring_queue.h"
 #include "error.h"
 
@@ -356,6 +357,14 @@ enum swFd_type
      * signalfd
      */
     SW_FD_SIGNAL,
+    /**
+     * wakes up the worker when the shared memory ring of the reactor is not empty
+     */
+    SW_FD_IPC_RING,
+    /**
+     * eventfd of the io_uring AIO backend, readable when there are completions
+     */
+    SW_FD_AIO_IOURING,
     /**
      * SW_FD_USER or SW_FD_USER+n: for custom event
      */
@@ -651,6 +660,11 @@ typedef struct _swSocket
     uchar ssl_renegotiation :1;
     uchar ssl_handshake_buffer_set :1;
     uchar ssl_quiet_shutdown :1;
+    /**
+     * records are encrypted/decrypted by the kernel (kTLS)
+     */
+    uchar ssl_ktls_send :1;
+    uchar ssl_ktls_recv :1;
 #ifdef SW_SUPPORT_DTLS
     uchar dtls :1;
 #endif
@@ -949,6 +963,10 @@ enum _swEventData_flag
     SW_EVENT_DATA_CHUNK = 1u << 2,
     SW_EVENT_DATA_END = 1u << 3,
     SW_EVENT_DATA_OBJ_PTR = 1u << 4,
+    /**
+     * sent through the pipe while the shared memory ring of its reactor is in use
+     */
+    SW_EVENT_DATA_RING = 1u << 5,
 };
 
 typedef struct _swDataHead
@@ -1022,6 +1040,10 @@ typedef struct
 {
     off_t offset;
     size_t length;
+    /**
+     * an opened descriptor of the file, -1 if it must be opened by the filename
+     */
+    int fd;
     char filename[0];
 } swSendFile_request;
 
@@ -1509,6 +1531,8 @@ char* swoole_dirname(char *file);
 size_t swoole_sync_writefile(int fd, const void *data, size_t len);
 size_t swoole_sync_readfile(int fd, void *buf, size_t len);
 swString* swoole_sync_readfile_eof(int fd);
+ssize_t swoole_read_nowait(int fd, void *buf, size_t len, off_t offset);
+ssize_t swoole_write_nowait(int fd, const void *buf, size_t len, off_t offset);
 int swoole_rand(int min, int max);
 int swoole_system_random(int min, int max);
 long swoole_file_get_size(FILE *fp);
@@ -1601,6 +1625,10 @@ int swSocket_wait(int fd, int timeout_ms, int events);
 int swSocket_wait_multi(int *list_of_fd, int n_fd, int timeout_ms, int events);
 void swSocket_clean(int fd);
 ssize_t swSocket_sendto_blocking(int fd, const void *buf, size_t n, int flag, struct sockaddr *addr, socklen_t addr_len);
+ssize_t swSocket_sendto_batch(int fd, const void *buf, size_t n, struct sockaddr *addr, socklen_t addr_len, uint32_t batch_size, sw_atomic_long_t *dropped);
+#ifdef HAVE_SENDMMSG
+void swSocket_sendto_flush();
+#endif
 int swSocket_set_buffer_size(swSocket *sock, uint32_t buffer_size);
 ssize_t swSocket_udp_sendto(int server_sock, const char *dst_ip, int dst_port, const char *data, uint32_t len);
 ssize_t swSocket_udp_sendto6(int server_sock, const char *dst_ip, int dst_port, const char *data, uint32_t len);
@@ -1712,6 +1740,7 @@ static sw_inline int swSocket_set_block(swSocket *sock)
 int swSocket_buffer_send(swSocket *conn);
 
 int swSocket_sendfile(swSocket *conn, const char *filename, off_t offset, size_t length);
+int swSocket_sendfile_fd(swSocket *conn, int file_fd, const char *filename, off_t offset, size_t length);
 int swSocket_onSendfile(swSocket *conn, swBuffer_chunk *chunk);
 void swSocket_sendfile_destructor(swBuffer_chunk *chunk);
 const char* swSocket_get_ip(enum swSocket_type socket_type, swSocketAddress *info);
@@ -1816,6 +1845,10 @@ struct _swReactor
      * callback signal
      */
     uchar check_signalfd :1;
+    /**
+     * use the timing wheel instead of the heap for the timer of this reactor
+     */
+    uchar timer_wheel :1;
     /**
      * reactor->wait timeout (millisecond) or -1
      */
@@ -1918,6 +1951,13 @@ struct _swWorker
     long dispatch_count;
     long request_count;
 
+    /**
+     * dispatch_mode=8, the requests which are dispatched and not done yet,
+     * and the moving average of the time of a request in microseconds
+     */
+    sw_atomic_t inflight_num;
+    sw_atomic_t service_time;
+
     /**
      * worker id
      */
@@ -2214,6 +2254,7 @@ static sw_inline int swReactor_trigger_close_event(swReactor *reactor, swEvent *
 }
 
 int swReactorEpoll_create(swReactor *reactor, int max_event_num);
+int swReactorIouring_create(swReactor *reactor, int max_event_num);
 int swReactorPoll_create(swReactor *reactor, int max_event_num);
 int swReactorKqueue_create(swReactor *reactor, int max_event_num);
 int swReactorSelect_create(swReactor *reactor);
@@ -2386,6 +2427,7 @@ struct _swTimer_node
     uint64_t round;
     uint8_t removed;
     swHeap_node *heap_node;
+    swTimingWheel_node wheel_node;
     /*-----------------callback---------------*/
     swTimerCallback callback;
     void *data;
@@ -2398,6 +2440,7 @@ struct _swTimer
     /*--------------signal timer--------------*/
     swReactor *reactor;
     swHeap *heap;
+    swTimingWheel *wheel;
     swHashMap *map;
     uint32_t num;
     uint64_t round;
@@ -2480,8 +2523,8 @@ typedef struct
     swTimer *timer;
     uint8_t aio_init;
     uint8_t aio_schedule;
+    uint8_t aio_iouring_init;
     uint32_t aio_task_num;
-    swPipe aio_pipe;
     swSocket *aio_read_socket;
     swSocket *aio_write_socket;
 #ifdef SW_AIO_WRITE_LOCK
@@ -2508,6 +2551,9 @@ typedef struct
     uchar socket_dontwait :1;
     uchar dns_lookup_random :1;
     uchar use_async_resolver :1;
+    uchar enable_io_uring :1;
+    uchar enable_timer_wheel :1;
+    uchar enable_aio_io_uring :1;
 
     int error;
     int process_type;
@@ -2554,6 +2600,8 @@ typedef struct
 
     char *dns_server_v4;
     char *dns_server_v6;
+    char *dns_resolvconf_path;
+    char *dns_hosts_path;
     double dns_cache_refresh_time;
 
     /**
@@ -2563,7 +2611,6 @@ typedef struct
     uint32_t aio_worker_num;
     double aio_max_wait_time;
     double aio_max_idle_time;
-    swSocket *aio_default_socket;
 
     swHashMap *functions;
     void *hooks[SW_MAX_HOOK_TYPE];
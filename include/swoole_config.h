@@ -80,6 +80,10 @@
 #define SW_BUFFER_SIZE_STD         8192
 #define SW_BUFFER_SIZE_BIG         65536
 #define SW_BUFFER_SIZE_UDP         65536
+#define SW_DGRAM_RECV_BURST        8
+#define SW_DGRAM_RECV_BURST_MAX    64
+#define SW_DGRAM_SEND_BATCH_MAX    1024
+#define SW_CACHELINE_SIZE          64
 // #define SW_BUFFER_RECV_TIME
 
 #define SW_SENDFILE_CHUNK_SIZE     65536
@@ -102,6 +106,7 @@
 #define SW_AIO_MAX_CHUNK_SIZE            (1*1024*1024)
 #define SW_AIO_MAX_EVENTS                128
 #define SW_AIO_HANDLER_MAX_SIZE          8
+#define SW_AIO_IOURING_ENTRIES           256
 #define SW_THREADPOOL_QUEUE_LEN          10000
 #define SW_IP_MAX_LENGTH                 46
 
@@ -111,12 +116,16 @@
 #define SW_WORKER_MAX_WAIT_TIME          3
 #define SW_WORKER_MIN_REQUEST            10
 #define SW_WORKER_MAX_RECV_CHUNK_COUNT   32
+#define SW_WORKER_MAX_RECV_RING_COUNT    256
+#define SW_WORKER_SERVICE_TIME_EWMA_SHIFT 3     // the weight of a new sample is 1/8
 
 #define SW_REACTOR_MAXEVENTS             4096
 #define SW_SESSION_LIST_SIZE             (1*1024*1024)
 
 #define SW_MSGMAX                        65536
 #define SW_UNIXSOCK_MAX_BUF_SIZE         (2*1024*1024)
+#define SW_IPC_RING_MIN_SIZE             (64*1024)
+#define SW_IPC_RING_MAX_SIZE             (1U << 30)
 
 #define SW_DGRAM_HEADER_SIZE                32
 
@@ -165,11 +174,14 @@
 
 #define SW_TASK_TMP_FILE                 "/tmp/swoole.task.XXXXXX"
 #define SW_TASK_TMPDIR_SIZE              128
+#define SW_TASK_SHM_SLICE_SIZE           (512 * 1024)
 
 #define SW_FILE_CHUNK_SIZE               65536
 
 #define SW_TABLE_CONFLICT_PROPORTION     0.2 // 20%
 #define SW_TABLE_KEY_SIZE                64
+//optimistic reads of a seqlock table before falling back to the row lock
+#define SW_TABLE_SEQLOCK_RETRY           64
 
 #define SW_SSL_BUFFER_SIZE               16384
 #define SW_SSL_CIPHER_LIST               "EECDH+AESGCM:EDH+AESGCM:AES256+EECDH:AES256+EDH"
@@ -189,6 +201,14 @@
 #define SW_DNS_HOST_BUFFER_SIZE          16
 #define SW_DNS_SERVER_PORT               53
 #define SW_DNS_DEFAULT_SERVER            "8.8.8.8"
+#define SW_DNS_RESOLV_CONF               "/etc/resolv.conf"
+#define SW_DNS_HOSTS_CONF                "/etc/hosts"
+#define SW_DNS_ATTEMPTS                  2
+#define SW_DNS_MAX_CNAME                 8
+#define SW_DNS_CACHE_CAPACITY            1000
+#define SW_DNS_CACHE_MAX_TTL             3600
+//used when a negative response has no SOA record
+#define SW_DNS_NEGATIVE_TTL              30
 
 /**
  * HTTP Protocol
@@ -208,6 +228,15 @@
 #define SW_HTTP_RFC850_DATE              "%A, %d-%b-%y %T GMT"
 #define SW_HTTP_ASCTIME_DATE             "%a %b %e %T %Y"
 #define SW_HTTP_SEND_TWICE               1
+#define SW_HTTP_STATIC_CACHE_INTERVAL    1
+#define SW_HTTP_MAX_RANGES               16
+#define SW_HTTP_RANGE_BOUNDARY_LEN       16
+#define SW_HTTP_LAYOUT_MAX_HEADERS       128
+#define SW_HTTP_RESPONSE_CACHE_MAX_SIZE  65536
+#define SW_HTTP_BODY_STREAM_BUFFER_SIZE  (2 * 1024 * 1024)
+#define SW_HTTP_COMPRESS_STREAM_POOL_SIZE  16
+#define SW_HTTP_PRECOMPRESS_MIN_SIZE     1024
+#define SW_HTTP_PRECOMPRESS_FAILED_NUM   1024
 
 // #define SW_HTTP_100_CONTINUE
 #define SW_HTTP_100_CONTINUE_PACKET                "HTTP/1.1 100 Continue\r\n\r\n"
@@ -258,6 +287,8 @@
  * Coroutine
  */
 #define SW_DEFAULT_C_STACK_SIZE          (2 *1024 * 1024)
+#define SW_CORO_STACK_POOL_SIZE          64
+#define SW_CORO_STACK_POOL_HOT_SIZE      (64 * 1024)
 #define SW_CORO_SUPPORT_BAILOUT          1
 #define SW_CORO_SWAP_BAILOUT             1
 
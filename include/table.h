@@ -29,6 +29,10 @@ typedef struct _swTableRow
 {
     sw_atomic_t lock;
     pid_t lock_pid;
+    /**
+     * odd while a writer holds the lock, only meaningful on the first row of a slot
+     */
+    sw_atomic_t version;
     /**
      * 1:used, 0:empty
      */
@@ -61,6 +65,10 @@ typedef struct
     size_t item_size;
     size_t memory_size;
     float conflict_proportion;
+    /**
+     * readers copy the row without locking it and retry when the version of the slot changes
+     */
+    uint8_t use_seqlock;
 
     /**
      * total rows that in active state(shm)
@@ -71,6 +79,10 @@ typedef struct
     swMemoryPool *pool;
 
     swTable_iterator *iterator;
+    /**
+     * process local, holds the copy made by swTableRow_get_snapshot
+     */
+    swTableRow *row_buffer;
 
     void *memory;
 } swTable;
@@ -114,6 +126,7 @@ void swTable_free(swTable *table);
 int swTableColumn_add(swTable *table, const char *name, int len, int type, int size);
 swTableRow* swTableRow_set(swTable *table, const char *key, int keylen, swTableRow **rowlock);
 swTableRow* swTableRow_get(swTable *table, const char *key, int keylen, swTableRow **rowlock);
+swTableRow* swTableRow_get_snapshot(swTable *table, const char *key, int keylen);
 
 void swTable_iterator_rewind(swTable *table);
 swTableRow* swTable_iterator_current(swTable *table);
@@ -134,6 +147,11 @@ static sw_inline void swTableRow_lock(swTableRow *row)
         if (*lock == 0 && sw_atomic_cmp_set(lock, 0, 1))
         {
             _success: row->lock_pid = SwooleG.pid;
+            /**
+             * stays odd if the previous owner died in the middle of writing
+             */
+            row->version = (row->version + 1) | 1;
+            __atomic_thread_fence(__ATOMIC_RELEASE);
             return;
         }
         if (SW_CPU_NUM > 1)
@@ -161,6 +179,7 @@ static sw_inline void swTableRow_lock(swTableRow *row)
 
 static sw_inline void swTableRow_unlock(swTableRow *row)
 {
+    __atomic_store_n(&row->version, row->version + 1, __ATOMIC_RELEASE);
     sw_spinlock_release(&row->lock);
 }
 
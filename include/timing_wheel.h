@@ -0,0 +1,64 @@
+/*
+ +----------------------------------------------------------------------+
+ | Swoole                                                               |
+ +----------------------------------------------------------------------+
+ | This source file is subject to version 2.0 of the Apache license,    |
+ | that is bundled with this package in the file LICENSE, and is        |
+ | available through the world-wide-web at the following url:           |
+ | http://www.apache.org/licenses/LICENSE-2.0.html                      |
+ | If you did not receive a copy of the Apache2.0 license and are unable|
+ | to obtain it through the world-wide-web, please send a note to       |
+ | license@swoole.com so we can mail you a copy immediately.            |
+ +----------------------------------------------------------------------+
+ | Author: Tianfeng Han  <mikan.tenny@gmail.com>                        |
+ +----------------------------------------------------------------------+
+ */
+
+#ifndef SW_TIMING_WHEEL_H_
+#define SW_TIMING_WHEEL_H_
+
+/**
+ * Hierarchical timing wheel, one tick per millisecond.
+ * level 0 has 256 slots, the other levels have 64 slots each, covering 2^32 ticks (~49 days),
+ * later expirations are clamped to the last slot and cascaded down again.
+ */
+#define SW_TIMING_WHEEL_LEVEL_NUM      5
+#define SW_TIMING_WHEEL_ROOT_BITS      8
+#define SW_TIMING_WHEEL_BITS           6
+#define SW_TIMING_WHEEL_ROOT_SIZE      (1 << SW_TIMING_WHEEL_ROOT_BITS)
+#define SW_TIMING_WHEEL_SIZE           (1 << SW_TIMING_WHEEL_BITS)
+#define SW_TIMING_WHEEL_SLOT_NUM       (SW_TIMING_WHEEL_ROOT_SIZE + (SW_TIMING_WHEEL_LEVEL_NUM - 1) * SW_TIMING_WHEEL_SIZE)
+
+typedef struct _swTimingWheel_node
+{
+    uint64_t expire;
+    struct _swTimingWheel_node *next;
+    struct _swTimingWheel_node **pprev;
+    uint8_t level;
+    void *data;
+} swTimingWheel_node;
+
+typedef struct _swTimingWheel
+{
+    /**
+     * the next tick to be processed
+     */
+    uint64_t current;
+    uint32_t num;
+    uint32_t level_num[SW_TIMING_WHEEL_LEVEL_NUM];
+    swTimingWheel_node *slots[SW_TIMING_WHEEL_SLOT_NUM];
+} swTimingWheel;
+
+swTimingWheel *swTimingWheel_new(uint64_t current);
+void swTimingWheel_free(swTimingWheel *wheel);
+void swTimingWheel_add(swTimingWheel *wheel, swTimingWheel_node *node, uint64_t expire);
+void swTimingWheel_remove(swTimingWheel *wheel, swTimingWheel_node *node);
+swTimingWheel_node* swTimingWheel_pop(swTimingWheel *wheel, uint64_t now);
+int64_t swTimingWheel_next(swTimingWheel *wheel);
+
+static inline uint32_t swTimingWheel_size(swTimingWheel *wheel)
+{
+    return wheel->num;
+}
+
+#endif /* SW_TIMING_WHEEL_H_ */
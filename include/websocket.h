@@ -42,6 +42,13 @@ enum swWebsocket_status
     WEBSOCKET_STATUS_CLOSING    = 4,
 };
 
+enum swWebSocket_simd_level
+{
+    SW_WEBSOCKET_SIMD_NONE = 0,
+    SW_WEBSOCKET_SIMD_SSE2 = 1,
+    SW_WEBSOCKET_SIMD_AVX2 = 2,
+};
+
 enum swWebSocket_frame_flag
 {
     SW_WEBSOCKET_FLAG_FIN =  1 << 0, /* BC: must be 1 */
@@ -168,6 +175,9 @@ static inline uchar swWebSocket_set_flags(uchar fin, uchar mask, uchar rsv1, uch
     return flags;
 }
 
+void swWebSocket_mask(char *data, size_t len, const char *mask_key);
+bool swWebSocket_validate_utf8(const char *data, size_t len);
+int swWebSocket_set_simd_level(int level);
 void swWebSocket_encode(swString *buffer, const char *data, size_t length, char opcode, uint8_t flags);
 void swWebSocket_decode(swWebSocket_frame *frame, swString *data);
 int swWebSocket_pack_close_frame(swString *buffer, int code, char* reason, size_t length, uint8_t flags);
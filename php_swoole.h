@@ -284,7 +284,6 @@ void php_swoole_redis_server_minit(int module_number);
  * RSHUTDOWN
  * ==============================================================
  */
-void php_swoole_async_coro_rshutdown();
 void php_swoole_redis_server_rshutdown();
 void php_swoole_coroutine_rshutdown();
 void php_swoole_runtime_rshutdown();
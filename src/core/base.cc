@@ -25,6 +25,7 @@
 #include <sys/stat.h>
 #include <sys/resource.h>
 #include <sys/ioctl.h>
+#include <sys/uio.h>
 
 #include <algorithm>
 
@@ -185,7 +186,7 @@ pid_t swoole_fork(int flags)
         {
             swFatalError(SW_ERROR_OPERATION_NOT_SUPPORT, "must be forked outside the coroutine");
         }
-        if (SwooleTG.aio_init)
+        if (SwooleTG.aio_init || SwooleTG.aio_iouring_init)
         {
             swFatalError(SW_ERROR_OPERATION_NOT_SUPPORT, "can not create server after using async file operation");
         }
@@ -814,6 +815,69 @@ size_t swoole_sync_readfile(int fd, void *buf, size_t len)
     return readn;
 }
 
+#if defined(HAVE_PREADV2) && defined(RWF_NOWAIT)
+static bool nowait_read_unsupported = false;
+static bool nowait_write_unsupported = false;
+#endif
+
+/**
+ * reads only the data in the page cache, fails with EAGAIN if the read would wait for the disk,
+ * the offset -1 is the current file offset
+ */
+ssize_t swoole_read_nowait(int fd, void *buf, size_t len, off_t offset)
+{
+#if defined(HAVE_PREADV2) && defined(RWF_NOWAIT)
+    if (!nowait_read_unsupported)
+    {
+        struct iovec iov = { buf, len };
+        ssize_t n;
+        do
+        {
+            n = preadv2(fd, &iov, 1, offset, RWF_NOWAIT);
+        } while (n < 0 && errno == EINTR);
+        if (n >= 0 || errno == EAGAIN)
+        {
+            return n;
+        }
+        if (errno == ENOSYS)
+        {
+            nowait_read_unsupported = true;
+        }
+    }
+#endif
+    // the other errors are reported by the blocking call
+    errno = EAGAIN;
+    return -1;
+}
+
+/**
+ * most kernels only support RWF_NOWAIT for direct writes, it is turned off after the first EOPNOTSUPP
+ */
+ssize_t swoole_write_nowait(int fd, const void *buf, size_t len, off_t offset)
+{
+#if defined(HAVE_PREADV2) && defined(RWF_NOWAIT)
+    if (!nowait_write_unsupported)
+    {
+        struct iovec iov = { (void *) buf, len };
+        ssize_t n;
+        do
+        {
+            n = pwritev2(fd, &iov, 1, offset, RWF_NOWAIT);
+        } while (n < 0 && errno == EINTR);
+        if (n >= 0 || errno == EAGAIN)
+        {
+            return n;
+        }
+        if (errno == ENOSYS || errno == EOPNOTSUPP)
+        {
+            nowait_write_unsupported = true;
+        }
+    }
+#endif
+    errno = EAGAIN;
+    return -1;
+}
+
 swString* swoole_sync_readfile_eof(int fd)
 {
     ssize_t n = 0;
@@ -202,8 +202,6 @@ const char* swoole_strerror(int code)
         return "Coroutine makecontext failed";
     case SW_ERROR_CO_IOCPINIT_FAILED:
         return "Coroutine iocpinit failed";
-    case SW_ERROR_CO_PROTECT_STACK_FAILED:
-        return "Coroutine protect stack failed";
     case SW_ERROR_CO_STD_THREAD_LINK_ERROR:
         return "Coroutine std thread link error";
     case SW_ERROR_CO_DISABLED_MULTI_THREAD:
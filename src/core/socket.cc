@@ -17,6 +17,8 @@
 #include "swoole_api.h"
 #include "ssl.h"
 
+#include <vector>
+
 #ifndef MSG_NOSIGNAL
 #define MSG_NOSIGNAL        0
 #endif
@@ -340,6 +342,143 @@ ssize_t swSocket_sendto_blocking(int fd, const void *__buf, size_t __n, int flag
     return n;
 }
 
+#ifdef HAVE_SENDMMSG
+struct swDgram_message
+{
+    int fd;
+    socklen_t addr_len;
+    struct sockaddr_storage addr;
+    size_t offset;
+    size_t length;
+    sw_atomic_long_t *dropped;
+};
+
+static thread_local std::vector<swDgram_message> *dgram_queue = nullptr;
+static thread_local swString *dgram_buffer = nullptr;
+
+static void swSocket_sendto_flush_callback(void *data)
+{
+    swSocket_sendto_flush();
+}
+
+/**
+ * the datagrams of the same socket go out with one sendmmsg call,
+ * a datagram that cannot be sent is dropped and counted in its dropped counter
+ */
+void swSocket_sendto_flush()
+{
+    if (!dgram_queue || dgram_queue->empty())
+    {
+        return;
+    }
+
+    std::vector<swDgram_message> &queue = *dgram_queue;
+    std::vector<struct mmsghdr> msgs(queue.size());
+    std::vector<struct iovec> iovs(queue.size());
+
+    for (size_t i = 0; i < queue.size(); i++)
+    {
+        iovs[i].iov_base = dgram_buffer->str + queue[i].offset;
+        iovs[i].iov_len = queue[i].length;
+        bzero(&msgs[i], sizeof(msgs[i]));
+        msgs[i].msg_hdr.msg_name = &queue[i].addr;
+        msgs[i].msg_hdr.msg_namelen = queue[i].addr_len;
+        msgs[i].msg_hdr.msg_iov = &iovs[i];
+        msgs[i].msg_hdr.msg_iovlen = 1;
+    }
+
+    size_t i = 0;
+    int retry = 0;
+    while (i < queue.size())
+    {
+        int fd = queue[i].fd;
+        size_t n = 1;
+        while (i + n < queue.size() && queue[i + n].fd == fd)
+        {
+            n++;
+        }
+
+        int ret = sendmmsg(fd, &msgs[i], n, 0);
+        if (ret > 0)
+        {
+            i += ret;
+            retry = 0;
+            continue;
+        }
+        if (errno == EINTR)
+        {
+            continue;
+        }
+        if (swSocket_error(errno) == SW_WAIT && ++retry < SW_SOCKET_SYNC_SEND_RETRY_COUNT
+                && swSocket_wait(fd, (int) (SwooleG.socket_send_timeout * 1000), SW_EVENT_WRITE) == SW_OK)
+        {
+            continue;
+        }
+        // the datagram is dropped like a failed sendto
+        swSysWarn("sendmmsg(%d) failed", fd);
+        if (queue[i].dropped)
+        {
+            sw_atomic_fetch_add(queue[i].dropped, 1);
+        }
+        i++;
+        retry = 0;
+    }
+
+    queue.clear();
+    swString_clear(dgram_buffer);
+}
+#endif
+
+/**
+ * the datagram is queued and sent at the end of the event loop round or when there are batch_size datagrams,
+ * it is sent at once if there is no event loop.
+ * a queued datagram is fire-and-forget: n is returned before it is sent,
+ * and the send failure is only counted in dropped (if not null)
+ */
+ssize_t swSocket_sendto_batch(int fd, const void *buf, size_t n, struct sockaddr *addr, socklen_t addr_len, uint32_t batch_size, sw_atomic_long_t *dropped)
+{
+#ifdef HAVE_SENDMMSG
+    if (batch_size > 1 && SwooleTG.reactor && addr_len <= sizeof(struct sockaddr_storage))
+    {
+        if (!dgram_queue)
+        {
+            dgram_queue = new std::vector<swDgram_message>;
+            dgram_buffer = swString_new(SW_BUFFER_SIZE_BIG);
+            if (!dgram_buffer)
+            {
+                delete dgram_queue;
+                dgram_queue = nullptr;
+                return SW_ERR;
+            }
+        }
+
+        swDgram_message message;
+        message.fd = fd;
+        message.addr_len = addr_len;
+        memcpy(&message.addr, addr, addr_len);
+        message.offset = dgram_buffer->length;
+        message.length = n;
+        message.dropped = dropped;
+        if (swString_append_ptr(dgram_buffer, (const char *) buf, n) < 0)
+        {
+            return SW_ERR;
+        }
+        dgram_queue->push_back(message);
+
+        if (dgram_queue->size() >= batch_size)
+        {
+            swSocket_sendto_flush();
+        }
+        else if (dgram_queue->size() == 1)
+        {
+            SwooleTG.reactor->defer(SwooleTG.reactor, swSocket_sendto_flush_callback, nullptr);
+        }
+        return n;
+    }
+#endif
+    return swSocket_sendto_blocking(fd, buf, n, 0, addr, addr_len);
+}
+
 int swSocket_create(enum swSocket_type type, uchar nonblock, uchar cloexec)
 {
     int sock_domain;
@@ -754,7 +893,14 @@ int swSocket_sendfile(swSocket *conn, const char *filename, off_t offset, size_t
         swSysWarn("open(%s) failed", filename);
         return SW_OK;
     }
+    return swSocket_sendfile_fd(conn, file_fd, filename, offset, length);
+}
 
+/**
+ * the file_fd is closed by the buffer chunk after the file has been sent, or here on failure
+ */
+int swSocket_sendfile_fd(swSocket *conn, int file_fd, const char *filename, off_t offset, size_t length)
+{
     struct stat file_stat;
     if (fstat(file_fd, &file_stat) < 0)
     {
@@ -775,6 +921,7 @@ int swSocket_sendfile(swSocket *conn, const char *filename, off_t offset, size_t
         conn->out_buffer = swBuffer_new(SW_SEND_BUFFER_SIZE);
         if (conn->out_buffer == NULL)
         {
+            close(file_fd);
             return SW_ERR;
         }
     }
@@ -784,6 +931,7 @@ int swSocket_sendfile(swSocket *conn, const char *filename, off_t offset, size_t
     if (task == NULL)
     {
         swWarn("malloc for swTask_sendfile failed");
+        close(file_fd);
         return SW_ERR;
     }
     bzero(task, sizeof(swTask_sendfile));
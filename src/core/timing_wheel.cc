@@ -0,0 +1,216 @@
+/*
+ +----------------------------------------------------------------------+
+ | Swoole                                                               |
+ +----------------------------------------------------------------------+
+ | This source file is subject to version 2.0 of the Apache license,    |
+ | that is bundled with this package in the file LICENSE, and is        |
+ | available through the world-wide-web at the following url:           |
+ | http://www.apache.org/licenses/LICENSE-2.0.html                      |
+ | If you did not receive a copy of the Apache2.0 license and are unable|
+ | to obtain it through the world-wide-web, please send a note to       |
+ | license@swoole.com so we can mail you a copy immediately.            |
+ +----------------------------------------------------------------------+
+ | Author: Tianfeng Han  <mikan.tenny@gmail.com>                        |
+ +----------------------------------------------------------------------+
+ */
+
+#include "swoole.h"
+#include "timing_wheel.h"
+
+#define SW_TIMING_WHEEL_ROOT_MASK      (SW_TIMING_WHEEL_ROOT_SIZE - 1)
+#define SW_TIMING_WHEEL_MASK           (SW_TIMING_WHEEL_SIZE - 1)
+#define SW_TIMING_WHEEL_MAX_TICKS      ((1ULL << (SW_TIMING_WHEEL_ROOT_BITS + (SW_TIMING_WHEEL_LEVEL_NUM - 1) * SW_TIMING_WHEEL_BITS)) - 1)
+
+static sw_inline uint32_t swTimingWheel_shift(int level)
+{
+    return SW_TIMING_WHEEL_ROOT_BITS + (level - 1) * SW_TIMING_WHEEL_BITS;
+}
+
+static sw_inline uint32_t swTimingWheel_offset(int level)
+{
+    return SW_TIMING_WHEEL_ROOT_SIZE + (level - 1) * SW_TIMING_WHEEL_SIZE;
+}
+
+static sw_inline void swTimingWheel_link(swTimingWheel *wheel, swTimingWheel_node *node, uint32_t slot, uint8_t level)
+{
+    swTimingWheel_node **head = &wheel->slots[slot];
+    node->level = level;
+    node->next = *head;
+    if (node->next)
+    {
+        node->next->pprev = &node->next;
+    }
+    node->pprev = head;
+    *head = node;
+    wheel->level_num[level]++;
+    wheel->num++;
+}
+
+static sw_inline void swTimingWheel_unlink(swTimingWheel *wheel, swTimingWheel_node *node)
+{
+    *node->pprev = node->next;
+    if (node->next)
+    {
+        node->next->pprev = node->pprev;
+    }
+    node->next = NULL;
+    node->pprev = NULL;
+    wheel->level_num[node->level]--;
+    wheel->num--;
+}
+
+swTimingWheel *swTimingWheel_new(uint64_t current)
+{
+    swTimingWheel *wheel = (swTimingWheel *) sw_malloc(sizeof(swTimingWheel));
+    if (!wheel)
+    {
+        return NULL;
+    }
+    bzero(wheel, sizeof(swTimingWheel));
+    wheel->current = current;
+    return wheel;
+}
+
+void swTimingWheel_free(swTimingWheel *wheel)
+{
+    sw_free(wheel);
+}
+
+void swTimingWheel_add(swTimingWheel *wheel, swTimingWheel_node *node, uint64_t expire)
+{
+    node->expire = expire;
+    /**
+     * already expired, run it at the next tick
+     */
+    if (expire < wheel->current)
+    {
+        expire = wheel->current;
+    }
+
+    uint64_t ticks = expire - wheel->current;
+    if (ticks < SW_TIMING_WHEEL_ROOT_SIZE)
+    {
+        swTimingWheel_link(wheel, node, expire & SW_TIMING_WHEEL_ROOT_MASK, 0);
+        return;
+    }
+    if (ticks > SW_TIMING_WHEEL_MAX_TICKS)
+    {
+        expire = wheel->current + SW_TIMING_WHEEL_MAX_TICKS;
+        ticks = SW_TIMING_WHEEL_MAX_TICKS;
+    }
+
+    int level;
+    for (level = 1; level < SW_TIMING_WHEEL_LEVEL_NUM - 1; level++)
+    {
+        if (ticks < (1ULL << swTimingWheel_shift(level + 1)))
+        {
+            break;
+        }
+    }
+    uint32_t index = (expire >> swTimingWheel_shift(level)) & SW_TIMING_WHEEL_MASK;
+    swTimingWheel_link(wheel, node, swTimingWheel_offset(level) + index, level);
+}
+
+void swTimingWheel_remove(swTimingWheel *wheel, swTimingWheel_node *node)
+{
+    if (node->pprev)
+    {
+        swTimingWheel_unlink(wheel, node);
+    }
+}
+
+/**
+ * move the nodes of the current slot of the upper levels down, called when the root wheel wraps around
+ */
+static void swTimingWheel_cascade(swTimingWheel *wheel)
+{
+    for (int level = 1; level < SW_TIMING_WHEEL_LEVEL_NUM; level++)
+    {
+        uint32_t index = (wheel->current >> swTimingWheel_shift(level)) & SW_TIMING_WHEEL_MASK;
+        swTimingWheel_node **head = &wheel->slots[swTimingWheel_offset(level) + index];
+        swTimingWheel_node *node;
+
+        while ((node = *head))
+        {
+            swTimingWheel_unlink(wheel, node);
+            swTimingWheel_add(wheel, node, node->expire);
+        }
+        if (index != 0)
+        {
+            break;
+        }
+    }
+}
+
+/**
+ * remove and return one node which expires at or before now, NULL if there is none
+ */
+swTimingWheel_node* swTimingWheel_pop(swTimingWheel *wheel, uint64_t now)
+{
+    while (wheel->current <= now)
+    {
+        swTimingWheel_node *node = wheel->slots[wheel->current & SW_TIMING_WHEEL_ROOT_MASK];
+        if (node)
+        {
+            swTimingWheel_unlink(wheel, node);
+            return node;
+        }
+        if (wheel->num == 0)
+        {
+            wheel->current = now + 1;
+            break;
+        }
+        if (wheel->level_num[0] == 0)
+        {
+            /**
+             * nothing in the lower levels, skip to the next cascade of the lowest non-empty level
+             */
+            int level = 1;
+            while (level < SW_TIMING_WHEEL_LEVEL_NUM - 1 && wheel->level_num[level] == 0)
+            {
+                level++;
+            }
+            uint64_t next = (wheel->current | ((1ULL << swTimingWheel_shift(level)) - 1)) + 1;
+            if (next > now + 1)
+            {
+                wheel->current = now + 1;
+                break;
+            }
+            wheel->current = next;
+        }
+        else
+        {
+            wheel->current++;
+        }
+        if ((wheel->current & SW_TIMING_WHEEL_ROOT_MASK) == 0)
+        {
+            swTimingWheel_cascade(wheel);
+        }
+    }
+    return NULL;
+}
+
+/**
+ * the tick of the nearest expiration, or the next cascade if it comes first, -1 if the wheel is empty
+ */
+int64_t swTimingWheel_next(swTimingWheel *wheel)
+{
+    if (wheel->num == 0)
+    {
+        return -1;
+    }
+
+    uint64_t cascade = (wheel->current | SW_TIMING_WHEEL_ROOT_MASK) + 1;
+    if (wheel->level_num[0] > 0)
+    {
+        uint64_t limit = wheel->level_num[0] < wheel->num ? cascade : wheel->current + SW_TIMING_WHEEL_ROOT_SIZE;
+        for (uint64_t tick = wheel->current; tick < limit; tick++)
+        {
+            if (wheel->slots[tick & SW_TIMING_WHEEL_ROOT_MASK])
+            {
+                return tick;
+            }
+        }
+    }
+    return cascade;
+}
@@ -27,16 +27,13 @@ using namespace swoole;
 Context::Context(size_t stack_size, coroutine_func_t fn, void* private_data) :
         fn_(fn), stack_size_(stack_size), private_data_(private_data)
 {
-#ifdef SW_CONTEXT_PROTECT_STACK_PAGE
-    protect_page_ = 0;
-#endif
     end_ = false;
     swap_ctx_ = nullptr;
 
-    stack_ = (char*) sw_malloc(stack_size_);
+    stack_ = StackPool::alloc(stack_size_);
     if (!stack_)
     {
-        swFatalError(SW_ERROR_MALLOC_FAIL, "failed to malloc stack memory.");
+        swFatalError(SW_ERROR_MALLOC_FAIL, "failed to alloc stack memory.");
         exit(254);
     }
     swTraceLog(SW_TRACE_COROUTINE, "alloc stack: size=%u, ptr=%p", stack_size_, stack_);
@@ -55,16 +52,6 @@ Context::Context(size_t stack_size, coroutine_func_t fn, void* private_data) :
         offset *= 2;
     }
 #endif
-#ifdef SW_CONTEXT_PROTECT_STACK_PAGE
-    uint32_t protect_page = get_protect_stack_page();
-    if (protect_page)
-    {
-        if (protect_stack(stack_, stack_size_, protect_page))
-        {
-            protect_page_ = protect_page;
-        }
-    }
-#endif
 }
 
 Context::~Context()
@@ -72,16 +59,10 @@ Context::~Context()
     if (stack_)
     {
         swTraceLog(SW_TRACE_COROUTINE, "free stack: ptr=%p", stack_);
-#ifdef SW_CONTEXT_PROTECT_STACK_PAGE
-        if (protect_page_)
-        {
-            unprotect_stack(stack_, protect_page_);
-        }
-#endif
 #ifdef USE_VALGRIND
         VALGRIND_STACK_DEREGISTER(valgrind_stack_id);
 #endif
-        sw_free(stack_);
+        StackPool::release(stack_, stack_size_);
         stack_ = NULL;
     }
 }
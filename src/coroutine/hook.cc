@@ -307,6 +307,8 @@ int swoole_coroutine_open(const char *pathname, int flags, mode_t mode)
     ev.offset = mode;
     ev.flags = flags;
     ev.handler = handler_open;
+    ev.lane = SW_AIO_LANE_FILE;
+    ev.opcode = SW_AIO_OP_OPEN;
     ev.callback = aio_onCompleted;
     ev.object = Coroutine::get_current();
     ev.req = &ev;
@@ -333,12 +335,21 @@ ssize_t swoole_coroutine_read(int sockfd, void *buf, size_t count)
         return socket->read(buf, count);
     }
 
+    // the data in the page cache is read without switching to the thread pool
+    ssize_t n = swoole_read_nowait(sockfd, buf, count, -1);
+    if (n >= 0)
+    {
+        return n;
+    }
+
     swAio_event ev;
     bzero(&ev, sizeof(ev));
     ev.fd = sockfd;
     ev.buf = buf;
     ev.nbytes = count;
     ev.handler = handler_read;
+    ev.lane = SW_AIO_LANE_FILE;
+    ev.opcode = SW_AIO_OP_READ;
     ev.callback = aio_onCompleted;
     ev.object = Coroutine::get_current();
     ev.req = &ev;
@@ -365,12 +376,20 @@ ssize_t swoole_coroutine_write(int sockfd, const void *buf, size_t count)
         return socket->write(buf, count);
     }
 
+    ssize_t n = swoole_write_nowait(sockfd, buf, count, -1);
+    if (n >= 0)
+    {
+        return n;
+    }
+
     swAio_event ev;
     bzero(&ev, sizeof(ev));
     ev.fd = sockfd;
     ev.buf = (void*) buf;
     ev.nbytes = count;
     ev.handler = handler_write;
+    ev.lane = SW_AIO_LANE_FILE;
+    ev.opcode = SW_AIO_OP_WRITE;
     ev.callback = aio_onCompleted;
     ev.object = Coroutine::get_current();
     ev.req = &ev;
@@ -397,6 +416,7 @@ off_t swoole_coroutine_lseek(int fd, off_t offset, int whence)
     ev.offset = offset;
     ev.flags = whence;
     ev.handler = handler_lseek;
+    ev.lane = SW_AIO_LANE_FILE;
     ev.callback = aio_onCompleted;
     ev.object = Coroutine::get_current();
     ev.req = &ev;
@@ -422,6 +442,8 @@ int swoole_coroutine_fstat(int fd, struct stat *statbuf)
     ev.fd = fd;
     ev.buf = (void*) statbuf;
     ev.handler = handler_fstat;
+    ev.lane = SW_AIO_LANE_FILE;
+    ev.opcode = SW_AIO_OP_FSTAT;
     ev.callback = aio_onCompleted;
     ev.object = Coroutine::get_current();
     ev.req = &ev;
@@ -446,6 +468,8 @@ int swoole_coroutine_unlink(const char *pathname)
     bzero(&ev, sizeof(ev));
     ev.buf = (void*) pathname;
     ev.handler = handler_unlink;
+    ev.lane = SW_AIO_LANE_FILE;
+    ev.opcode = SW_AIO_OP_UNLINK;
     ev.callback = aio_onCompleted;
     ev.object = Coroutine::get_current();
     ev.req = &ev;
@@ -471,6 +495,7 @@ int swoole_coroutine_statvfs(const char *path, struct statvfs *buf)
     ev.buf = (void*) path;
     ev.offset = (off_t) buf;
     ev.handler = handler_statvfs;
+    ev.lane = SW_AIO_LANE_FILE;
     ev.callback = aio_onCompleted;
     ev.object = Coroutine::get_current();
     ev.req = &ev;
@@ -496,6 +521,8 @@ int swoole_coroutine_mkdir(const char *pathname, mode_t mode)
     ev.buf = (void*) pathname;
     ev.offset = mode;
     ev.handler = handler_mkdir;
+    ev.lane = SW_AIO_LANE_FILE;
+    ev.opcode = SW_AIO_OP_MKDIR;
     ev.callback = aio_onCompleted;
     ev.object = Coroutine::get_current();
     ev.req = &ev;
@@ -520,6 +547,8 @@ int swoole_coroutine_rmdir(const char *pathname)
     bzero(&ev, sizeof(ev));
     ev.buf = (void*) pathname;
     ev.handler = handler_rmdir;
+    ev.lane = SW_AIO_LANE_FILE;
+    ev.opcode = SW_AIO_OP_RMDIR;
     ev.callback = aio_onCompleted;
     ev.object = Coroutine::get_current();
     ev.req = &ev;
@@ -545,6 +574,8 @@ int swoole_coroutine_rename(const char *oldpath, const char *newpath)
     ev.buf = (void*) oldpath;
     ev.offset = (off_t) newpath;
     ev.handler = handler_rename;
+    ev.lane = SW_AIO_LANE_FILE;
+    ev.opcode = SW_AIO_OP_RENAME;
     ev.callback = aio_onCompleted;
     ev.object = Coroutine::get_current();
     ev.req = &ev;
@@ -570,6 +601,7 @@ int swoole_coroutine_access(const char *pathname, int mode)
     ev.buf = (void*) pathname;
     ev.offset = mode;
     ev.handler = handler_access;
+    ev.lane = SW_AIO_LANE_FILE;
     ev.callback = aio_onCompleted;
     ev.object = Coroutine::get_current();
     ev.req = &ev;
@@ -595,6 +627,7 @@ int swoole_coroutine_flock(int fd, int operation)
     ev.fd = fd;
     ev.flags = operation;
     ev.handler = handler_flock;
+    ev.lane = SW_AIO_LANE_FILE;
     ev.callback = aio_onCompleted;
     ev.object = Coroutine::get_current();
     ev.req = &ev;
@@ -634,6 +667,7 @@ DIR *swoole_coroutine_opendir(const char *name)
     bzero(&ev, sizeof(ev));
     ev.buf = (void*) name;
     ev.handler = handler_opendir;
+    ev.lane = SW_AIO_LANE_FILE;
     ev.callback = aio_onCompleted;
     ev.object = Coroutine::get_current();
     ev.req = &ev;
@@ -658,6 +692,7 @@ struct dirent *swoole_coroutine_readdir(DIR *dirp)
     bzero(&ev, sizeof(ev));
     ev.buf = (void*) dirp;
     ev.handler = handler_readdir;
+    ev.lane = SW_AIO_LANE_FILE;
     ev.callback = aio_onCompleted;
     ev.object = Coroutine::get_current();
     ev.req = &ev;
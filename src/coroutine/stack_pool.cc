@@ -0,0 +1,127 @@
+/*
+  +----------------------------------------------------------------------+
+  | Swoole                                                               |
+  +----------------------------------------------------------------------+
+  | This source file is subject to version 2.0 of the Apache license,    |
+  | that is bundled with this package in the file LICENSE, and is        |
+  | available through the world-wide-web at the following url:           |
+  | http://www.apache.org/licenses/LICENSE-2.0.html                      |
+  | If you did not receive a copy of the Apache2.0 license and are unable|
+  | to obtain it through the world-wide-web, please send a note to       |
+  | license@swoole.com so we can mail you a copy immediately.            |
+  +----------------------------------------------------------------------+
+  | Author: Tianfeng Han  <mikan.tenny@gmail.com>                        |
+  +----------------------------------------------------------------------+
+*/
+
+#include "swoole.h"
+#include "context.h"
+
+#include <vector>
+
+#ifndef MAP_NORESERVE
+#define MAP_NORESERVE 0
+#endif
+
+#ifndef MAP_STACK
+#define MAP_STACK 0
+#endif
+
+using namespace swoole;
+
+size_t StackPool::max_num = SW_CORO_STACK_POOL_SIZE;
+
+struct stack_pool_t
+{
+    size_t stack_size = 0;
+    std::vector<char *> stacks;
+
+    ~stack_pool_t()
+    {
+        StackPool::clear();
+    }
+};
+
+static thread_local stack_pool_t pool;
+
+static void stack_unmap(char *stack, size_t stack_size)
+{
+    char *addr = stack - SwooleG.pagesize;
+    if (munmap(addr, stack_size + SwooleG.pagesize) < 0)
+    {
+        swSysWarn("munmap(%p, %zu) failed", addr, stack_size + SwooleG.pagesize);
+    }
+}
+
+char* StackPool::alloc(size_t stack_size)
+{
+    if (pool.stack_size == stack_size && !pool.stacks.empty())
+    {
+        char *stack = pool.stacks.back();
+        pool.stacks.pop_back();
+        return stack;
+    }
+
+    size_t size = stack_size + SwooleG.pagesize;
+    char *addr = (char *) mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE | MAP_STACK, -1, 0);
+    if (addr == MAP_FAILED)
+    {
+        swSysWarn("mmap(%zu) failed", size);
+        return NULL;
+    }
+    /**
+     * the stack grows down, the lowest page catches overflows
+     */
+    if (mprotect(addr, SwooleG.pagesize, PROT_NONE) < 0)
+    {
+        swSysWarn("mprotect(%p, %u) failed", addr, SwooleG.pagesize);
+        munmap(addr, size);
+        return NULL;
+    }
+    return addr + SwooleG.pagesize;
+}
+
+void StackPool::release(char *stack, size_t stack_size)
+{
+    if (pool.stack_size != stack_size)
+    {
+        /**
+         * the stack size has been changed, the cached stacks can no longer be reused
+         */
+        clear();
+        pool.stack_size = stack_size;
+    }
+    if (pool.stacks.size() >= max_num)
+    {
+        stack_unmap(stack, stack_size);
+        return;
+    }
+    /**
+     * give the pages back to the kernel, except for the top of the stack which every coroutine touches
+     */
+    if (stack_size > SW_CORO_STACK_POOL_HOT_SIZE)
+    {
+        size_t length = stack_size - SW_CORO_STACK_POOL_HOT_SIZE;
+#ifdef MADV_FREE
+        if (madvise(stack, length, MADV_FREE) < 0)
+#endif
+        {
+            madvise(stack, length, MADV_DONTNEED);
+        }
+    }
+    pool.stacks.push_back(stack);
+}
+
+void StackPool::clear()
+{
+    for (char *stack : pool.stacks)
+    {
+        stack_unmap(stack, pool.stack_size);
+    }
+    pool.stacks.clear();
+}
+
+size_t StackPool::count()
+{
+    return pool.stacks.size();
+}
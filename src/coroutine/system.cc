@@ -16,8 +16,15 @@
 
 #include "coroutine.h"
 #include "coroutine_system.h"
+#include "coroutine_socket.h"
 #include "lru_cache.h"
 
+#include <sys/file.h>
+#ifdef HAVE_OPENAT2
+#include <sys/syscall.h>
+#include <linux/openat2.h>
+#endif
+
 using namespace std;
 using namespace swoole;
 using swoole::coroutine::System;
@@ -50,6 +57,7 @@ void System::clear_dns_cache()
     {
         dns_cache->clear();
     }
+    swoole::coroutine::dns_clear_cache();
 }
 
 static void aio_onReadFileCompleted(swAio_event *event)
@@ -107,8 +115,92 @@ int System::sleep(double sec)
     return 0;
 }
 
+/**
+ * the path is resolved from the dentry cache only, it fails with EAGAIN instead of waiting for the disk
+ */
+static int open_cached(const char *file)
+{
+#if defined(HAVE_OPENAT2) && defined(SYS_openat2) && defined(RESOLVE_CACHED)
+    static bool unsupported = false;
+    if (!unsupported)
+    {
+        struct open_how how;
+        bzero(&how, sizeof(how));
+        how.flags = O_RDONLY | O_CLOEXEC;
+        how.resolve = RESOLVE_CACHED;
+        int fd = syscall(SYS_openat2, AT_FDCWD, file, &how, sizeof(how));
+        if (fd < 0 && (errno == ENOSYS || errno == EINVAL))
+        {
+            unsupported = true;
+        }
+        return fd;
+    }
+#endif
+    errno = EAGAIN;
+    return -1;
+}
+
+/**
+ * reads the file in the coroutine if its metadata and all of its data are cached,
+ * otherwise the thread pool reads the opened file or opens it again and reports the errors
+ */
+static swString* read_file_nowait(const char *file, bool lock, int *fd)
+{
+    *fd = open_cached(file);
+    if (*fd < 0)
+    {
+        return nullptr;
+    }
+
+    swString *str = nullptr;
+    struct stat file_stat;
+    if (fstat(*fd, &file_stat) < 0 || !S_ISREG(file_stat.st_mode) || file_stat.st_size == 0)
+    {
+        return nullptr;
+    }
+    if (lock && flock(*fd, LOCK_SH | LOCK_NB) < 0)
+    {
+        return nullptr;
+    }
+    str = swString_new(file_stat.st_size);
+    if (str)
+    {
+        while (str->length < (size_t) file_stat.st_size)
+        {
+            ssize_t n = swoole_read_nowait(*fd, str->str + str->length, file_stat.st_size - str->length, str->length);
+            if (n <= 0)
+            {
+                break;
+            }
+            str->length += n;
+        }
+        if (str->length < (size_t) file_stat.st_size)
+        {
+            swString_free(str);
+            str = nullptr;
+        }
+    }
+    if (lock)
+    {
+        flock(*fd, LOCK_UN);
+    }
+    if (str)
+    {
+        close(*fd);
+        *fd = -1;
+    }
+    return str;
+}
+
 swString* System::read_file(const char *file, bool lock)
 {
+    int fd;
+    swString *str = read_file_nowait(file, lock, &fd);
+    if (str)
+    {
+        return str;
+    }
+
     AsyncTask task;
 
     swAio_event ev;
@@ -120,12 +212,22 @@ swString* System::read_file(const char *file, bool lock)
     ev.lock = lock ? 1 : 0;
     ev.object = (void*) &task;
     ev.handler = swAio_handler_read_file;
+    ev.lane = SW_AIO_LANE_FILE;
     ev.callback = aio_onReadFileCompleted;
     ev.req = (void*) file;
+    if (fd >= 0)
+    {
+        ev.fd = fd;
+        ev.flags = SW_AIO_READ_FILE_FD;
+    }
 
     ssize_t ret = swAio_dispatch(&ev);
     if (ret < 0)
     {
+        if (fd >= 0)
+        {
+            close(fd);
+        }
         return NULL;
     }
     task.co->yield();
@@ -162,6 +264,7 @@ ssize_t System::write_file(const char *file, char *buf, size_t length, bool lock
     ev.nbytes = length;
     ev.object = (void*) &task;
     ev.handler = swAio_handler_write_file;
+    ev.lane = SW_AIO_LANE_FILE;
     ev.callback = aio_onWriteFileCompleted;
     ev.req = (void*) file;
     ev.flags = flags;
@@ -181,6 +284,24 @@ ssize_t System::write_file(const char *file, char *buf, size_t length, bool lock
 
 string System::gethostbyname(const string &hostname, int domain, double timeout)
 {
+    /**
+     * the resolver keeps its own cache with the TTL of the records
+     */
+    if (SwooleG.use_async_resolver)
+    {
+        vector<string> result = swoole::coroutine::dns_lookup(hostname.c_str(), domain, timeout);
+        if (result.empty())
+        {
+            SwooleG.error = SW_ERROR_DNSLOOKUP_RESOLVE_FAILED;
+            return "";
+        }
+        if (SwooleG.dns_lookup_random)
+        {
+            return result[swoole_rand(0, result.size() - 1)];
+        }
+        return result[0];
+    }
+
     if (dns_cache == nullptr && dns_cache_capacity != 0)
     {
         dns_cache = new LRUCache(dns_cache_capacity);
@@ -226,6 +347,7 @@ string System::gethostbyname(const string &hostname, int domain, double timeout)
     ev.flags = domain;
     ev.object = (void*) &task;
     ev.handler = swAio_handler_gethostbyname;
+    ev.lane = SW_AIO_LANE_DNS;
     ev.callback = aio_onDNSCompleted;
     /* TODO: find a better way */
     ev.ret = 1;
@@ -290,6 +412,7 @@ vector<string> System::getaddrinfo(const string &hostname, int family, int sockt
 
     ev.object = &task;
     ev.handler = swAio_handler_getaddrinfo;
+    ev.lane = SW_AIO_LANE_DNS;
     ev.callback = aio_onDNSCompleted;
     ev.req = &req;
 
@@ -695,6 +818,9 @@ void System::init_reactor(swReactor *reactor)
     swReactor_set_handler(reactor, SW_FD_CORO_EVENT | SW_EVENT_ERROR, event_waiter_error_callback);
 
     swReactor_set_handler(reactor, SW_FD_AIO | SW_EVENT_READ, swAio_callback);
+#ifdef HAVE_IO_URING
+    swReactor_set_handler(reactor, SW_FD_AIO_IOURING | SW_EVENT_READ, swAio_iouring_callback);
+#endif
 }
 
 static void async_task_completed(swAio_event *event)
@@ -789,6 +915,7 @@ bool coroutine::async(const std::function<void(void)> &fn, double timeout)
 
     event.object = &task;
     event.handler = async_lambda_handler;
+    event.lane = SW_AIO_LANE_BLOCKING;
     event.callback = async_lambda_callback;
 
     swAio_event *_ev = swAio_dispatch2(&event);
@@ -30,12 +30,14 @@ Context::Context(size_t stack_size, coroutine_func_t fn, void* private_data) :
         return;
     }
 
-#ifdef SW_CONTEXT_PROTECT_STACK_PAGE
-    protect_page_ = 0;
-#endif
     end_ = false;
 
-    stack_ = (char*) sw_malloc(stack_size);
+    stack_ = StackPool::alloc(stack_size);
+    if (!stack_)
+    {
+        swFatalError(SW_ERROR_MALLOC_FAIL, "failed to alloc stack memory.");
+        exit(254);
+    }
     swTraceLog(SW_TRACE_COROUTINE, "alloc stack: size=%lu, ptr=%p", stack_size, stack_);
 
     ctx_.uc_stack.ss_sp = stack_;
@@ -47,17 +49,6 @@ Context::Context(size_t stack_size, coroutine_func_t fn, void* private_data) :
 #endif
 
     makecontext(&ctx_, (void (*)(void))&context_func, 1, this);
-
-#ifdef SW_CONTEXT_PROTECT_STACK_PAGE
-    uint32_t protect_page = get_protect_stack_page();
-    if (protect_page)
-    {
-        if (protect_stack(stack_, stack_size, protect_page))
-        {
-            protect_page_ = protect_page;
-        }
-    }
-#endif
 }
 
 Context::~Context()
@@ -65,17 +56,10 @@ Context::~Context()
     if (stack_)
     {
         swTraceLog(SW_TRACE_COROUTINE, "free stack: ptr=%p", stack_);
-#ifdef SW_CONTEXT_PROTECT_STACK_PAGE
-        if (protect_page_)
-        {
-            unprotect_stack(stack_, protect_page_);
-        }
-#endif
-
 #if defined(USE_VALGRIND)
         VALGRIND_STACK_DEREGISTER(valgrind_stack_id);
 #endif
-        sw_free(stack_);
+        StackPool::release(stack_, stack_size_);
         stack_ = NULL;
     }
 }
@@ -103,7 +103,8 @@ static void swFixedPool_init(swFixedPool *object)
 {
     swFixedPool_slice *slice;
     void *cur = object->memory;
-    void *max = (char *) object->memory + object->size;
+    // the memory after the last whole slice is not used
+    void *max = (char *) object->memory + object->slice_num * (sizeof(swFixedPool_slice) + object->slice_size);
     do
     {
         slice = (swFixedPool_slice *) cur;
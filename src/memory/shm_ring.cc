@@ -0,0 +1,179 @@
+/*
+ +----------------------------------------------------------------------+
+ | Swoole                                                               |
+ +----------------------------------------------------------------------+
+ | This source file is subject to version 2.0 of the Apache license,    |
+ | that is bundled with this package in the file LICENSE, and is        |
+ | available through the world-wide-web at the following url:           |
+ | http://www.apache.org/licenses/LICENSE-2.0.html                      |
+ | If you did not receive a copy of the Apache2.0 license and are unable|
+ | to obtain it through the world-wide-web, please send a note to       |
+ | license@swoole.com so we can mail you a copy immediately.            |
+ +----------------------------------------------------------------------+
+ | Author: Tianfeng Han  <mikan.tenny@gmail.com>                        |
+ +----------------------------------------------------------------------+
+ */
+
+#include "swoole.h"
+#include "shm_ring.h"
+
+#define SW_SHM_RING_SKIP        UINT32_MAX
+#define SW_SHM_RING_ALIGN(n)    (((n) + 7) & ~7U)
+
+typedef struct _swShmRing_item
+{
+    uint32_t length;
+    /**
+     * set by the consumer before the packet is handled
+     */
+    uint32_t consumed;
+    char data[0];
+} swShmRing_item;
+
+static sw_inline swShmRing_item* swShmRing_item_get(swShmRing *ring, uint32_t offset)
+{
+    return (swShmRing_item *) (ring->data + (offset & (ring->size - 1)));
+}
+
+/**
+ * the size is rounded up to a power of 2
+ */
+swShmRing* swShmRing_new(uint32_t size)
+{
+    uint32_t n = SW_MEM_ALIGNED_SIZE_EX(sizeof(swShmRing_item) * 2, 8);
+    while (n < size)
+    {
+        n <<= 1;
+    }
+    swShmRing *ring = (swShmRing *) sw_shm_malloc(sizeof(swShmRing) + n);
+    if (ring == NULL)
+    {
+        swWarn("sw_shm_malloc(%zu) failed", sizeof(swShmRing) + n);
+        return NULL;
+    }
+    bzero(ring, sizeof(swShmRing));
+    ring->size = n;
+    return ring;
+}
+
+void swShmRing_free(swShmRing *ring)
+{
+    sw_shm_free(ring);
+}
+
+/**
+ * [producer] reserve length bytes, NULL if the ring has no room for them
+ */
+void* swShmRing_alloc(swShmRing *ring, uint32_t length)
+{
+    uint32_t need = sizeof(swShmRing_item) + SW_SHM_RING_ALIGN(length);
+    if (length > ring->size || need > ring->size)
+    {
+        return NULL;
+    }
+
+    uint32_t tail = ring->tail;
+    uint32_t used = tail - __atomic_load_n(&ring->head, __ATOMIC_ACQUIRE);
+    uint32_t offset = tail & (ring->size - 1);
+    uint32_t skip = offset + need > ring->size ? ring->size - offset : 0;
+
+    if (need + skip > ring->size - used)
+    {
+        return NULL;
+    }
+    if (skip > 0)
+    {
+        swShmRing_item_get(ring, tail)->length = SW_SHM_RING_SKIP;
+    }
+
+    swShmRing_item *item = swShmRing_item_get(ring, tail + skip);
+    item->length = length;
+    item->consumed = 0;
+    ring->reserved = skip + need;
+    return item->data;
+}
+
+/**
+ * [producer] publish the reserved packet, returns true if the consumer is sleeping and has to be woken up
+ */
+bool swShmRing_push(swShmRing *ring)
+{
+    __atomic_store_n(&ring->tail, ring->tail + ring->reserved, __ATOMIC_RELEASE);
+    ring->reserved = 0;
+    /**
+     * pairs with the barrier in swShmRing_wait, either the consumer sees the new tail or we see it waiting
+     */
+    sw_atomic_memory_barrier();
+    return ring->waiting && sw_atomic_cmp_set(&ring->waiting, 1, 0);
+}
+
+/**
+ * [consumer] the oldest packet, NULL if the ring is empty.
+ * a packet marked consumed was being handled by a consumer which has exited, it is dropped
+ */
+void* swShmRing_front(swShmRing *ring, uint32_t *length)
+{
+    uint32_t head = ring->head;
+    uint32_t tail = __atomic_load_n(&ring->tail, __ATOMIC_ACQUIRE);
+
+    while (head != tail)
+    {
+        swShmRing_item *item = swShmRing_item_get(ring, head);
+        if (item->length == SW_SHM_RING_SKIP)
+        {
+            head += ring->size - (head & (ring->size - 1));
+        }
+        else if (item->consumed)
+        {
+            swWarn("the packet[length=%u] that was being handled by the previous consumer is dropped", item->length);
+            head += sizeof(swShmRing_item) + SW_SHM_RING_ALIGN(item->length);
+        }
+        else
+        {
+            if (head != ring->head)
+            {
+                __atomic_store_n(&ring->head, head, __ATOMIC_RELEASE);
+            }
+            *length = item->length;
+            return item->data;
+        }
+    }
+    __atomic_store_n(&ring->head, head, __ATOMIC_RELEASE);
+    return NULL;
+}
+
+/**
+ * [consumer] mark the packet returned by swShmRing_front as consumed before it is handled,
+ * so that it is not handled again if the consumer exits before swShmRing_pop
+ */
+void swShmRing_consume(swShmRing *ring)
+{
+    swShmRing_item *item = swShmRing_item_get(ring, ring->head);
+    __atomic_store_n(&item->consumed, 1, __ATOMIC_RELEASE);
+}
+
+/**
+ * [consumer] release the packet returned by swShmRing_front
+ */
+void swShmRing_pop(swShmRing *ring)
+{
+    uint32_t head = ring->head;
+    swShmRing_item *item = swShmRing_item_get(ring, head);
+    head += sizeof(swShmRing_item) + SW_SHM_RING_ALIGN(item->length);
+    __atomic_store_n(&ring->head, head, __ATOMIC_RELEASE);
+}
+
+/**
+ * [consumer] mark the consumer as sleeping, returns false if a packet arrived in the meantime
+ */
+bool swShmRing_wait(swShmRing *ring)
+{
+    ring->waiting = 1;
+    sw_atomic_memory_barrier();
+    if (!swShmRing_empty(ring))
+    {
+        ring->waiting = 0;
+        return false;
+    }
+    return true;
+}
@@ -188,6 +188,13 @@ int swTable_create(swTable *table)
         return SW_ERR;
     }
 
+    table->row_buffer = (swTableRow *) sw_malloc(row_memory_size);
+    if (table->row_buffer == NULL)
+    {
+        sw_shm_free(memory);
+        return SW_ERR;
+    }
+
     table->memory_size = memory_size;
     table->memory = memory;
 
@@ -219,6 +226,7 @@ void swTable_free(swTable *table)
     sw_free(table->iterator);
     if (table->memory)
     {
+        sw_free(table->row_buffer);
         sw_shm_free(table->memory);
     }
 }
@@ -324,6 +332,69 @@ swTableRow* swTableRow_get(swTable *table, const char *key, int keylen, swTableR
     return row;
 }
 
+/**
+ * Seqlock read: the writers make the version of the slot odd while they hold the lock,
+ * so a copy taken between two equal and even versions is consistent.
+ * Readers never write to the shared memory, they fall back to the lock only under heavy writing.
+ */
+swTableRow* swTableRow_get_snapshot(swTable *table, const char *key, int keylen)
+{
+    if (keylen > SW_TABLE_KEY_SIZE)
+    {
+        keylen = SW_TABLE_KEY_SIZE;
+    }
+
+    swTableRow *head = swTable_hash(table, key, keylen);
+    size_t row_memory_size = sizeof(swTableRow) + table->item_size;
+
+    for (int i = 0; i < SW_TABLE_SEQLOCK_RETRY; i++)
+    {
+        uint32_t version = __atomic_load_n(&head->version, __ATOMIC_ACQUIRE);
+        if (version & 1)
+        {
+            sw_atomic_cpu_pause();
+            continue;
+        }
+
+        swTableRow *row = head;
+        /**
+         * the chain may be changed by a writer, a stale pointer still points into the table memory,
+         * but it must not make us loop forever
+         */
+        for (size_t n = 0; row && n <= table->size; n++)
+        {
+            if (strncmp(row->key, key, keylen) == 0)
+            {
+                break;
+            }
+            row = row->next;
+        }
+        if (row && row->active)
+        {
+            memcpy(table->row_buffer, row, row_memory_size);
+        }
+        else
+        {
+            row = NULL;
+        }
+
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+        if (__atomic_load_n(&head->version, __ATOMIC_RELAXED) == version)
+        {
+            return row ? table->row_buffer : NULL;
+        }
+    }
+
+    swTableRow *rowlock;
+    swTableRow *row = swTableRow_get(table, key, keylen, &rowlock);
+    if (row)
+    {
+        memcpy(table->row_buffer, row, row_memory_size);
+    }
+    swTableRow_unlock(rowlock);
+    return row ? table->row_buffer : NULL;
+}
+
 swTableRow* swTableRow_set(swTable *table, const char *key, int keylen, swTableRow **rowlock)
 {
     if (keylen >= SW_TABLE_KEY_SIZE)
@@ -418,7 +489,10 @@ int swTableRow_del(swTable *table, char *key, int keylen)
     {
         if (strncmp(row->key, key, keylen) == 0)
         {
-            bzero(row, sizeof(swTableRow) + table->item_size);
+            /**
+             * keep the lock and the version, the slot is still locked
+             */
+            bzero(&row->active, sizeof(swTableRow) + table->item_size - offsetof(swTableRow, active));
             goto _delete_element;
         }
         else
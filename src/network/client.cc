@@ -664,6 +664,7 @@ static int swClient_tcp_connect_async(swClient *cli, const char *host, int port,
         ev.object = cli;
         ev.fd = cli->socket->fd;
         ev.handler = swAio_handler_gethostbyname;
+        ev.lane = SW_AIO_LANE_DNS;
         ev.callback = swClient_onResolveCompleted;
 
         if (swAio_dispatch(&ev) < 0)
@@ -16,349 +16,1070 @@
 
 #include "swoole.h"
 #include "coroutine_socket.h"
+#include "lru_cache.h"
+
+#include <sys/stat.h>
+#include <algorithm>
 #include <string>
 #include <vector>
+#include <memory>
+#include <unordered_map>
 
-#define SW_DNS_SERVER_CONF         "/etc/resolv.conf"
-#define SW_DNS_SERVER_NUM          2
-
+using namespace swoole;
 using namespace swoole::coroutine;
 using namespace std;
 
 enum swDNS_type
 {
-    SW_DNS_A_RECORD    = 0x01, //Lookup IPv4 address
-    SW_DNS_AAAA_RECORD = 0x1c, //Lookup IPv6 address
-    SW_DNS_MX_RECORD   = 0x0f  //Lookup mail server for domain
+    SW_DNS_A_RECORD     = 0x01, //Lookup IPv4 address
+    SW_DNS_CNAME_RECORD = 0x05, //Canonical name
+    SW_DNS_SOA_RECORD   = 0x06, //Start of authority, carries the negative caching TTL
+    SW_DNS_AAAA_RECORD  = 0x1c, //Lookup IPv6 address
 };
 
-enum swDNS_error
+enum swDNS_rcode
 {
-    SW_DNS_NOT_EXIST, //Error: adress does not exist
-    SW_DNS_TIMEOUT,   //Lookup time expired
-    SW_DNS_ERROR      //No memory or other error
+    SW_DNS_RCODE_NOERROR  = 0,
+    SW_DNS_RCODE_SERVFAIL = 2,
+    SW_DNS_RCODE_NXDOMAIN = 3,
 };
 
-/* Struct for the DNS Header */
+enum swDNS_status
+{
+    SW_DNS_FOUND,
+    SW_DNS_NOT_FOUND, //NXDOMAIN or no record of the type, may be cached
+    SW_DNS_FAILED,    //timeout or no usable response, never cached
+};
+
+#define SW_DNS_FLAG_QR         0x8000
+#define SW_DNS_FLAG_TC         0x0200
+#define SW_DNS_FLAG_RD         0x0100
+#define SW_DNS_RCODE(flags)    ((flags) & 0x000f)
+#define SW_DNS_CLASS_IN        1
+#define SW_DNS_HEADER_SIZE     12
+#define SW_DNS_NAME_MAX_LEN    255
+#define SW_DNS_MAX_POINTERS    32
+
+typedef struct
+{
+    string host;
+    int port;
+    bool ipv6;
+    union
+    {
+        struct sockaddr_in in;
+        struct sockaddr_in6 in6;
+    } addr;
+} swDNS_server_addr;
+
+typedef struct
+{
+    vector<swDNS_server_addr> servers;
+    vector<string> search;
+    int ndots;
+    int attempts;
+    bool rotate;
+    /**
+     * the server that answered last time, the next query starts with it
+     */
+    size_t current_server;
+
+    unordered_map<string, vector<string>> hosts_v4;
+    unordered_map<string, vector<string>> hosts_v6;
+
+    /**
+     * used to detect changes of the configuration
+     */
+    string resolvconf_path;
+    struct timespec resolvconf_mtime;
+    string hosts_path;
+    struct timespec hosts_mtime;
+    string server_override;
+    bool loaded;
+} swDNS_config;
+
+typedef struct
+{
+    int rcode;
+    bool truncated;
+    uint32_t ttl;
+    vector<string> addresses;
+    /**
+     * the last name of a CNAME chain the response does not resolve
+     */
+    string cname;
+} swDNS_answer;
+
+/**
+ * identical lookups wait for the one that is in flight instead of sending their own queries
+ */
 typedef struct
 {
-    uint16_t id;
-    uchar rd :1;
-    uchar tc :1;
-    uchar aa :1;
-    uchar opcode :4;
-    uchar qr :1;
-    uchar rcode :4;
-    uchar z :3;
-    uchar ra :1;
-    uint16_t qdcount;
-    uint16_t ancount;
-    uint16_t nscount;
-    uint16_t arcount;
-} swDNSResolver_header;
-
-/* Struct for the flags for the DNS Question */
-typedef struct q_flags
-{
-    uint16_t qtype;
-    uint16_t qclass;
-} Q_FLAGS;
-
-/* Struct for the flags for the DNS RRs */
-typedef struct rr_flags
-{
-    uint16_t type;
-    uint16_t rdclass;
+    vector<Coroutine *> waiters;
+    int status;
     uint32_t ttl;
-    uint16_t rdlength;
-} RR_FLAGS;
+    vector<string> addresses;
+} swDNS_request;
 
-static uint16_t swoole_dns_request_id = 1;
+/**
+ * a waiter gives up at its own timeout, the query goes on for the others
+ */
+typedef struct
+{
+    Coroutine *co;
+    swDNS_request *request;
+    swTimer_node *timer;
+    bool timedout;
+} swDNS_waiter;
 
-static int domain_encode(const char *src, int n, char *dest);
-static void domain_decode(char *str);
-static int get_dns_server();
+static swDNS_config dns_config = {};
+/**
+ * not shared between the processes, each worker caches the answers of its own lookups
+ */
+static LRUCache *dns_process_cache = nullptr;
+static unordered_map<string, shared_ptr<swDNS_request>> dns_requests;
 
-static int get_dns_server()
+static string dns_lowercase(const string &name)
 {
-    FILE *fp;
-    char line[100];
-    char buf[16] = {};
+    string retval(name);
+    for (auto &c : retval)
+    {
+        c = tolower((uchar) c);
+    }
+    return retval;
+}
 
-    if ((fp = fopen(SW_DNS_SERVER_CONF, "rt")) == NULL)
+static bool dns_stat_changed(const string &path, struct timespec *mtime)
+{
+    struct stat st;
+    struct timespec ts = {};
+    if (stat(path.c_str(), &st) == 0)
     {
-        swSysWarn("fopen(" SW_DNS_SERVER_CONF ") failed");
-        return SW_ERR;
+        ts = st.st_mtim;
     }
+    if (ts.tv_sec == mtime->tv_sec && ts.tv_nsec == mtime->tv_nsec)
+    {
+        return false;
+    }
+    *mtime = ts;
+    return true;
+}
+
+/**
+ * 1.1.1.1, 1.1.1.1:53, ::1 or [::1]:53
+ */
+static bool dns_parse_server(const string &str, swDNS_server_addr &server)
+{
+    string host;
+    int port = SW_DNS_SERVER_PORT;
 
-    while (fgets(line, 100, fp))
+    if (str.empty())
     {
-        if (strncmp(line, "nameserver", 10) == 0)
+        return false;
+    }
+    if (str[0] == '[')
+    {
+        size_t pos = str.find(']');
+        if (pos == string::npos)
         {
-            strcpy(buf, strtok(line, " "));
-            strcpy(buf, strtok(NULL, "\n"));
-            break;
+            return false;
+        }
+        host = str.substr(1, pos - 1);
+        if (pos + 1 < str.length() && str[pos + 1] == ':')
+        {
+            port = atoi(str.c_str() + pos + 2);
         }
     }
-    fclose(fp);
+    else if (count(str.begin(), str.end(), ':') == 1)
+    {
+        size_t pos = str.find(':');
+        host = str.substr(0, pos);
+        port = atoi(str.c_str() + pos + 1);
+    }
+    else
+    {
+        host = str;
+    }
+    if (port <= 0 || port > 65535)
+    {
+        return false;
+    }
 
-    if (strlen(buf) == 0)
+    bzero(&server.addr, sizeof(server.addr));
+    if (inet_pton(AF_INET, host.c_str(), &server.addr.in.sin_addr) == 1)
     {
-        SwooleG.dns_server_v4 = sw_strdup(SW_DNS_DEFAULT_SERVER);
+        server.ipv6 = false;
+        server.addr.in.sin_family = AF_INET;
+        server.addr.in.sin_port = htons(port);
+    }
+    else if (inet_pton(AF_INET6, host.c_str(), &server.addr.in6.sin6_addr) == 1)
+    {
+        server.ipv6 = true;
+        server.addr.in6.sin6_family = AF_INET6;
+        server.addr.in6.sin6_port = htons(port);
     }
     else
     {
-        SwooleG.dns_server_v4 = sw_strdup(buf);
+        return false;
     }
+    server.host = host;
+    server.port = port;
+    return true;
+}
 
-    return SW_OK;
+static void dns_add_server(vector<swDNS_server_addr> &servers, const string &str)
+{
+    swDNS_server_addr server;
+    if (dns_parse_server(str, server))
+    {
+        servers.push_back(server);
+    }
+    else
+    {
+        swoole_error_log(SW_LOG_WARNING, SW_ERROR_DNSLOOKUP_RESOLVE_FAILED, "invalid nameserver[%s]", str.c_str());
+    }
 }
 
-vector<string> swoole::coroutine::dns_lookup(const char *domain, double timeout)
+static void dns_load_resolvconf(swDNS_config *config, vector<swDNS_server_addr> &servers)
 {
-    char *_domain_name;
-    Q_FLAGS *qflags = NULL;
-    char packet[SW_BUFFER_SIZE_STD];
-    swDNSResolver_header *header = NULL;
-    int steps = 0;
+    FILE *fp;
+    char line[1024];
+    bool has_search = false;
 
-    vector<string> result;
-    if (SwooleG.dns_server_v4 == NULL)
+    config->search.clear();
+    config->ndots = 1;
+    config->attempts = SW_DNS_ATTEMPTS;
+    config->rotate = false;
+
+    if ((fp = fopen(config->resolvconf_path.c_str(), "r")) == NULL)
+    {
+        return;
+    }
+
+    while (fgets(line, sizeof(line), fp))
     {
-        if (get_dns_server() < 0)
+        char *saveptr = NULL;
+        char *key = strtok_r(line, " \t\r\n", &saveptr);
+        if (key == NULL || key[0] == '#' || key[0] == ';')
         {
-            return result;
+            continue;
+        }
+        if (strcmp(key, "nameserver") == 0)
+        {
+            char *value = strtok_r(NULL, " \t\r\n", &saveptr);
+            if (value)
+            {
+                dns_add_server(servers, value);
+            }
+        }
+        else if (strcmp(key, "search") == 0 || (strcmp(key, "domain") == 0 && !has_search))
+        {
+            /**
+             * the last search or domain line wins, but search takes precedence over domain
+             */
+            has_search = key[0] == 's';
+            config->search.clear();
+            char *value;
+            while ((value = strtok_r(NULL, " \t\r\n", &saveptr)))
+            {
+                config->search.push_back(dns_lowercase(value));
+            }
+        }
+        else if (strcmp(key, "options") == 0)
+        {
+            char *value;
+            while ((value = strtok_r(NULL, " \t\r\n", &saveptr)))
+            {
+                if (strncmp(value, "ndots:", 6) == 0)
+                {
+                    config->ndots = SW_MAX(0, SW_MIN(15, atoi(value + 6)));
+                }
+                else if (strncmp(value, "attempts:", 9) == 0)
+                {
+                    config->attempts = SW_MAX(1, SW_MIN(5, atoi(value + 9)));
+                }
+                else if (strcmp(value, "rotate") == 0)
+                {
+                    config->rotate = true;
+                }
+            }
         }
     }
+    fclose(fp);
+}
 
-    header = (swDNSResolver_header *) packet;
-    int _request_id = swoole_dns_request_id++;
-    header->id = htons(_request_id);
-    header->qr = 0;
-    header->opcode = 0;
-    header->aa = 0;
-    header->tc = 0;
-    header->rd = 1;
-    header->ra = 0;
-    header->z = 0;
-    header->rcode = 0;
-    header->qdcount = htons(1);
-    header->ancount = 0x0000;
-    header->nscount = 0x0000;
-    header->arcount = 0x0000;
-
-    steps = sizeof(swDNSResolver_header);
+static void dns_load_hosts(swDNS_config *config)
+{
+    FILE *fp;
+    char line[1024];
 
-    _domain_name = &packet[steps];
+    config->hosts_v4.clear();
+    config->hosts_v6.clear();
 
-    int len = strlen(domain);
-    if (domain_encode(domain, len, _domain_name) < 0)
+    if ((fp = fopen(config->hosts_path.c_str(), "r")) == NULL)
     {
-        swWarn("invalid domain[%s]", domain);
-        return result;
+        return;
     }
 
-    steps += (strlen((const char *) _domain_name) + 1);
+    while (fgets(line, sizeof(line), fp))
+    {
+        char *comment = strchr(line, '#');
+        if (comment)
+        {
+            *comment = '\0';
+        }
+        char *saveptr = NULL;
+        char *address = strtok_r(line, " \t\r\n", &saveptr);
+        if (address == NULL)
+        {
+            continue;
+        }
+
+        struct in6_addr buf;
+        unordered_map<string, vector<string>> *hosts;
+        if (inet_pton(AF_INET, address, &buf) == 1)
+        {
+            hosts = &config->hosts_v4;
+        }
+        else if (inet_pton(AF_INET6, address, &buf) == 1)
+        {
+            hosts = &config->hosts_v6;
+        }
+        else
+        {
+            continue;
+        }
+
+        char *name;
+        while ((name = strtok_r(NULL, " \t\r\n", &saveptr)))
+        {
+            (*hosts)[dns_lowercase(name)].push_back(address);
+        }
+    }
+    fclose(fp);
+}
 
-    qflags = (Q_FLAGS *) &packet[steps];
-    qflags->qtype = htons(SW_DNS_A_RECORD);
-    qflags->qclass = htons(0x0001);
-    steps += sizeof(Q_FLAGS);
+/**
+ * reload /etc/resolv.conf and /etc/hosts when they have been modified
+ */
+static swDNS_config* dns_get_config()
+{
+    swDNS_config *config = &dns_config;
+    const char *resolvconf_path = SwooleG.dns_resolvconf_path ? SwooleG.dns_resolvconf_path : SW_DNS_RESOLV_CONF;
+    const char *hosts_path = SwooleG.dns_hosts_path ? SwooleG.dns_hosts_path : SW_DNS_HOSTS_CONF;
+    string server_override;
 
-    Socket _sock(SW_SOCK_UDP);
-    if (timeout > 0)
+    if (SwooleG.dns_server_v4)
+    {
+        server_override.append(SwooleG.dns_server_v4);
+    }
+    if (SwooleG.dns_server_v6)
     {
-        _sock.set_timeout(timeout);
+        server_override.append(",").append(SwooleG.dns_server_v6);
     }
 
-    char *_port;
-    int dns_server_port = SW_DNS_SERVER_PORT;
-    char dns_server_host[32];
-    strcpy(dns_server_host, SwooleG.dns_server_v4);
-    if ((_port = strchr(SwooleG.dns_server_v4, ':')))
+    bool resolvconf_changed = !config->loaded || config->resolvconf_path != resolvconf_path
+            || config->server_override != server_override;
+    if (config->resolvconf_path != resolvconf_path)
     {
-        dns_server_port = atoi(_port + 1);
-        dns_server_host[_port - SwooleG.dns_server_v4] = '\0';
+        config->resolvconf_path = resolvconf_path;
+        config->resolvconf_mtime = {};
     }
-    if (!_sock.sendto(dns_server_host, dns_server_port, (char *) packet, steps))
+    if (dns_stat_changed(config->resolvconf_path, &config->resolvconf_mtime))
     {
-        return result;
+        resolvconf_changed = true;
+    }
+    if (resolvconf_changed)
+    {
+        vector<swDNS_server_addr> servers;
+        dns_load_resolvconf(config, servers);
+        /**
+         * dns_server overrides the nameservers of resolv.conf, it may be a comma separated list
+         */
+        if (!server_override.empty())
+        {
+            servers.clear();
+            size_t start = 0;
+            while (start <= server_override.length())
+            {
+                size_t end = server_override.find(',', start);
+                if (end == string::npos)
+                {
+                    end = server_override.length();
+                }
+                if (end > start)
+                {
+                    dns_add_server(servers, server_override.substr(start, end - start));
+                }
+                start = end + 1;
+            }
+        }
+        if (servers.empty())
+        {
+            dns_add_server(servers, SW_DNS_DEFAULT_SERVER);
+        }
+        config->servers = servers;
+        config->current_server = 0;
+        config->server_override = server_override;
     }
 
-    /**
-     * response
-     */
-    header = NULL;
-    qflags = NULL;
-    RR_FLAGS *rrflags = NULL;
+    if (!config->loaded || config->hosts_path != hosts_path)
+    {
+        config->hosts_path = hosts_path;
+        config->hosts_mtime = {};
+    }
+    if (dns_stat_changed(config->hosts_path, &config->hosts_mtime) || !config->loaded)
+    {
+        dns_load_hosts(config);
+    }
 
-    uchar rdata[10][254];
-    uint32_t type[10];
+    config->loaded = true;
+    return config;
+}
 
-    char *temp;
-    steps = 0;
+/**
+ * The function converts the dot-based hostname into the DNS format
+ * (i.e. www.apple.com into 3www5apple3com0)
+ */
+static int domain_encode(const string &name, char *dest, size_t size)
+{
+    size_t pos = 0, start = 0;
+    if (name.length() + 2 > SW_MIN(size, SW_DNS_NAME_MAX_LEN))
+    {
+        return SW_ERR;
+    }
+    while (start < name.length())
+    {
+        size_t end = name.find('.', start);
+        if (end == string::npos)
+        {
+            end = name.length();
+        }
+        size_t len = end - start;
+        if (len == 0 || len > 63)
+        {
+            return SW_ERR;
+        }
+        dest[pos++] = len;
+        memcpy(dest + pos, name.c_str() + start, len);
+        pos += len;
+        start = end + 1;
+    }
+    dest[pos++] = 0;
+    return pos;
+}
 
-    char name[10][254];
-    int i, j;
+/**
+ * This function reads a compressed name of the packet in dot-based format,
+ * returns the offset behind the name or -1 if the name is malformed
+ */
+static int domain_decode(const uchar *packet, size_t length, size_t offset, string &name)
+{
+    size_t pos = offset;
+    int end = -1;
+    int pointers = 0;
 
-    int ret = _sock.recv(packet, sizeof(packet) - 1);
-    if (ret <= 0)
+    name.clear();
+    while (true)
     {
-        return result;
+        if (pos >= length)
+        {
+            return -1;
+        }
+        uchar len = packet[pos];
+        if ((len & 0xc0) == 0xc0)
+        {
+            if (pos + 1 >= length || ++pointers > SW_DNS_MAX_POINTERS)
+            {
+                return -1;
+            }
+            if (end < 0)
+            {
+                end = pos + 2;
+            }
+            pos = ((len & 0x3f) << 8) | packet[pos + 1];
+            continue;
+        }
+        if (len & 0xc0)
+        {
+            return -1;
+        }
+        pos++;
+        if (len == 0)
+        {
+            break;
+        }
+        if (pos + len > length || name.length() + len + 1 > SW_DNS_NAME_MAX_LEN)
+        {
+            return -1;
+        }
+        if (!name.empty())
+        {
+            name.append(".");
+        }
+        name.append((const char *) packet + pos, len);
+        pos += len;
     }
+    return end < 0 ? (int) pos : end;
+}
 
-    packet[ret] = 0;
-    header = (swDNSResolver_header *) packet;
-    steps = sizeof(swDNSResolver_header);
+static sw_inline uint16_t dns_read16(const uchar *p)
+{
+    return (p[0] << 8) | p[1];
+}
 
-    _domain_name = &packet[steps];
-    domain_decode(_domain_name);
-    steps = steps + (strlen(_domain_name) + 2);
+static sw_inline uint32_t dns_read32(const uchar *p)
+{
+    return ((uint32_t) p[0] << 24) | (p[1] << 16) | (p[2] << 8) | p[3];
+}
+
+static sw_inline void dns_write16(char *p, uint16_t value)
+{
+    p[0] = value >> 8;
+    p[1] = value & 0xff;
+}
+
+static int dns_build_query(char *packet, size_t size, uint16_t id, const string &name, int qtype)
+{
+    bzero(packet, SW_DNS_HEADER_SIZE);
+    dns_write16(packet, id);
+    dns_write16(packet + 2, SW_DNS_FLAG_RD);
+    //qdcount
+    dns_write16(packet + 4, 1);
 
-    qflags = (Q_FLAGS *) &packet[steps];
-    (void) qflags;
-    steps = steps + sizeof(Q_FLAGS);
+    int n = domain_encode(name, packet + SW_DNS_HEADER_SIZE, size - SW_DNS_HEADER_SIZE - 4);
+    if (n < 0)
+    {
+        return SW_ERR;
+    }
+    n += SW_DNS_HEADER_SIZE;
+    dns_write16(packet + n, qtype);
+    dns_write16(packet + n + 2, SW_DNS_CLASS_IN);
+    return n + 4;
+}
+
+/**
+ * @return false if the packet is not the response of this query
+ */
+static bool dns_parse_response(const uchar *packet, size_t length, uint16_t id, const string &qname, int qtype,
+        swDNS_answer &answer)
+{
+    if (length < SW_DNS_HEADER_SIZE || dns_read16(packet) != id)
+    {
+        return false;
+    }
+    uint16_t flags = dns_read16(packet + 2);
+    uint16_t qdcount = dns_read16(packet + 4);
+    uint16_t ancount = dns_read16(packet + 6);
+    uint16_t nscount = dns_read16(packet + 8);
+    if (!(flags & SW_DNS_FLAG_QR) || qdcount != 1)
+    {
+        return false;
+    }
 
-    int ancount = ntohs(header->ancount);
-    if (ancount > 10)
+    string name;
+    int offset = domain_decode(packet, length, SW_DNS_HEADER_SIZE, name);
+    if (offset < 0 || (size_t) offset + 4 > length || strcasecmp(name.c_str(), qname.c_str()) != 0
+            || dns_read16(packet + offset) != qtype)
     {
-        ancount = 10;
+        return false;
     }
-    /* Parsing the RRs from the reply packet */
-    for (i = 0; i < ancount; ++i)
+    offset += 4;
+
+    answer.rcode = SW_DNS_RCODE(flags);
+    answer.truncated = flags & SW_DNS_FLAG_TC;
+    answer.ttl = UINT32_MAX;
+    answer.addresses.clear();
+    answer.cname.clear();
+
+    /**
+     * owner => (target, ttl)
+     */
+    unordered_map<string, pair<string, uint32_t>> cnames;
+    vector<pair<string, pair<string, uint32_t>>> records;
+    uint32_t negative_ttl = SW_DNS_NEGATIVE_TTL;
+
+    for (int i = 0; i < ancount + nscount; i++)
     {
-        type[i] = 0;
-        /* Parsing the NAME portion of the RR */
-        temp = &packet[steps];
-        j = 0;
-        while (*temp != 0)
+        offset = domain_decode(packet, length, offset, name);
+        if (offset < 0 || (size_t) offset + 10 > length)
+        {
+            break;
+        }
+        uint16_t type = dns_read16(packet + offset);
+        uint16_t rdclass = dns_read16(packet + offset + 2);
+        uint32_t ttl = dns_read32(packet + offset + 4);
+        uint16_t rdlength = dns_read16(packet + offset + 8);
+        const uchar *rdata = packet + offset + 10;
+        offset += 10;
+        if ((size_t) offset + rdlength > length)
+        {
+            break;
+        }
+        offset += rdlength;
+
+        if (rdclass != SW_DNS_CLASS_IN)
+        {
+            continue;
+        }
+        //authority section
+        if (i >= ancount)
+        {
+            if (type == SW_DNS_SOA_RECORD)
+            {
+                string mname, rname;
+                int pos = domain_decode(packet, length, rdata - packet, mname);
+                if (pos > 0)
+                {
+                    pos = domain_decode(packet, length, pos, rname);
+                }
+                if (pos > 0 && (size_t) pos + 20 <= (size_t) (rdata - packet) + rdlength)
+                {
+                    negative_ttl = SW_MIN(ttl, dns_read32(packet + pos + 16));
+                }
+            }
+            continue;
+        }
+
+        string owner = dns_lowercase(name);
+        if (type == SW_DNS_CNAME_RECORD)
+        {
+            string target;
+            if (domain_decode(packet, length, rdata - packet, target) > 0)
+            {
+                cnames[owner] = make_pair(dns_lowercase(target), ttl);
+            }
+        }
+        else if (type == qtype)
         {
-            if ((uchar) (*temp) == 0xc0)
+            char address[INET6_ADDRSTRLEN];
+            if (type == SW_DNS_A_RECORD && rdlength == 4)
             {
-                ++temp;
-                temp = &packet[(uint8_t) *temp];
+                inet_ntop(AF_INET, rdata, address, sizeof(address));
+            }
+            else if (type == SW_DNS_AAAA_RECORD && rdlength == 16)
+            {
+                inet_ntop(AF_INET6, rdata, address, sizeof(address));
             }
             else
             {
-                name[i][j] = *temp;
-                ++j;
-                ++temp;
+                continue;
             }
+            records.push_back(make_pair(owner, make_pair(string(address), ttl)));
         }
-        name[i][j] = '\0';
-
-        domain_decode(name[i]);
-        steps = steps + 2;
-
-        /* Parsing the RR flags of the RR */
-        rrflags = (RR_FLAGS *) &packet[steps];
-        steps = steps + sizeof(RR_FLAGS) - 2;
+    }
 
-        /* Parsing the IPv4 address in the RR */
-        if (ntohs(rrflags->type) == 1)
+    /**
+     * follow the CNAME chain starting at the name of the question
+     */
+    string current = dns_lowercase(qname);
+    for (int depth = 0; ; depth++)
+    {
+        for (auto &record : records)
         {
-            for (j = 0; j < ntohs(rrflags->rdlength); ++j)
+            if (record.first == current)
             {
-                rdata[i][j] = (uchar) packet[steps + j];
+                answer.addresses.push_back(record.second.first);
+                answer.ttl = SW_MIN(answer.ttl, record.second.second);
             }
-            type[i] = ntohs(rrflags->type);
         }
-
-        /* Parsing the canonical name in the RR */
-        if (ntohs(rrflags->type) == 5)
+        if (!answer.addresses.empty())
+        {
+            break;
+        }
+        auto iter = cnames.find(current);
+        if (iter == cnames.end() || depth >= SW_DNS_MAX_CNAME)
         {
-            temp = &packet[steps];
-            j = 0;
-            while (*temp != 0)
+            if (current != dns_lowercase(qname))
             {
-                if ((uchar) (*temp) == 0xc0)
-                {
-                    ++temp;
-                    temp = &packet[(uint8_t) *temp];
-                }
-                else
-                {
-                    rdata[i][j] = *temp;
-                    ++j;
-                    ++temp;
-                }
+                answer.cname = current;
             }
-            rdata[i][j] = '\0';
-            domain_decode((char *) rdata[i]);
-            type[i] = ntohs(rrflags->type);
+            break;
         }
-        steps = steps + ntohs(rrflags->rdlength);
+        current = iter->second.first;
+        answer.ttl = SW_MIN(answer.ttl, iter->second.second);
     }
 
-    int request_id = ntohs(header->id);
-    //bad response
-    if (request_id != _request_id)
+    if (answer.addresses.empty() && answer.cname.empty())
     {
-        return result;
+        answer.ttl = SW_MIN(answer.ttl, negative_ttl);
     }
-    for (i = 0; i < ancount; i++)
+    return true;
+}
+
+static bool dns_is_server_address(const swDNS_server_addr *server, const struct sockaddr *addr)
+{
+    if (server->ipv6)
     {
-        if (type[i] != SW_DNS_A_RECORD)
+        const struct sockaddr_in6 *in6 = (const struct sockaddr_in6 *) addr;
+        return in6->sin6_family == AF_INET6 && in6->sin6_port == server->addr.in6.sin6_port
+                && memcmp(&in6->sin6_addr, &server->addr.in6.sin6_addr, sizeof(in6->sin6_addr)) == 0;
+    }
+    else
+    {
+        const struct sockaddr_in *in = (const struct sockaddr_in *) addr;
+        return in->sin_family == AF_INET && in->sin_port == server->addr.in.sin_port
+                && in->sin_addr.s_addr == server->addr.in.sin_addr.s_addr;
+    }
+}
+
+/**
+ * @return false if the server did not answer in time, or its answer is still truncated
+ */
+static bool dns_query_server_tcp(const swDNS_server_addr *server, const string &name, int qtype, double timeout,
+        swDNS_answer &answer)
+{
+    char query[SW_BUFFER_SIZE_STD];
+    uint16_t id = swoole_rand(0, 65535);
+
+    if (timeout < SW_TIMER_MIN_SEC)
+    {
+        return false;
+    }
+    int n = dns_build_query(query + 2, sizeof(query) - 2, id, name, qtype);
+    if (n < 0)
+    {
+        return false;
+    }
+    *(uint16_t *) query = htons(n);
+
+    Socket _sock(server->ipv6 ? SW_SOCK_TCP6 : SW_SOCK_TCP);
+    if (_sock.get_fd() < 0)
+    {
+        return false;
+    }
+    _sock.set_timeout(timeout);
+    socklen_t addr_len = server->ipv6 ? sizeof(server->addr.in6) : sizeof(server->addr.in);
+    if (!_sock.connect((struct sockaddr *) &server->addr, addr_len) || _sock.send_all(query, n + 2) != n + 2)
+    {
+        return false;
+    }
+
+    uint16_t length;
+    if (_sock.recv_all(&length, sizeof(length)) != sizeof(length))
+    {
+        return false;
+    }
+    length = ntohs(length);
+    unique_ptr<uchar[]> packet(new uchar[length]);
+    if (_sock.recv_all(packet.get(), length) != length
+            || !dns_parse_response(packet.get(), length, id, name, qtype, answer))
+    {
+        return false;
+    }
+    return !answer.truncated;
+}
+
+/**
+ * @return false if the server did not answer in time
+ */
+static bool dns_query_server(const swDNS_server_addr *server, const string &name, int qtype, double timeout,
+        swDNS_answer &answer)
+{
+    char packet[SW_BUFFER_SIZE_STD];
+    uint16_t id = swoole_rand(0, 65535);
+
+    int n = dns_build_query(packet, sizeof(packet), id, name, qtype);
+    if (n < 0)
+    {
+        swoole_error_log(SW_LOG_NOTICE, SW_ERROR_DNSLOOKUP_RESOLVE_FAILED, "invalid domain[%s]", name.c_str());
+        return false;
+    }
+
+    Socket _sock(server->ipv6 ? SW_SOCK_UDP6 : SW_SOCK_UDP);
+    if (_sock.get_fd() < 0)
+    {
+        return false;
+    }
+    if (_sock.sendto(server->host.c_str(), server->port, packet, n) < 0)
+    {
+        return false;
+    }
+
+    double deadline = swoole_microtime() + timeout;
+    while (true)
+    {
+        double left = deadline - swoole_microtime();
+        if (left < SW_TIMER_MIN_SEC)
         {
-            continue;
+            return false;
+        }
+        _sock.set_timeout(left, SW_TIMEOUT_READ);
+
+        union
+        {
+            struct sockaddr_in in;
+            struct sockaddr_in6 in6;
+        } addr = {};
+        socklen_t addr_len = sizeof(addr);
+        ssize_t retval = _sock.recvfrom(packet, sizeof(packet), (struct sockaddr *) &addr, &addr_len);
+        if (retval <= 0)
+        {
+            return false;
+        }
+        /**
+         * ignore the packets from other addresses and the stale responses of former queries
+         */
+        if (dns_is_server_address(server, (struct sockaddr *) &addr)
+                && dns_parse_response((uchar *) packet, retval, id, name, qtype, answer))
+        {
+            break;
         }
-        char address[16];
-        size_t n = sw_snprintf(address, sizeof(address), "%d.%d.%d.%d", rdata[i][0], rdata[i][1], rdata[i][2],
-                rdata[i][3]);
-        result.push_back(string(address, n));
     }
-    return result;
+
+    if (!answer.truncated)
+    {
+        return true;
+    }
+    /**
+     * the answer does not fit in a datagram, the query is sent again over TCP
+     */
+    return dns_query_server_tcp(server, name, qtype, deadline - swoole_microtime(), answer);
 }
 
 /**
- * The function converts the dot-based hostname into the DNS format
- * (i.e. www.apple.com into 3www5apple3com0)
+ * query the nameservers one by one until one of them gives a definite answer
  */
-static int domain_encode(const char *src, int n, char *dest)
+static bool dns_query(const string &name, int qtype, double timeout, swDNS_answer &answer)
 {
-    if (src[n] == '.')
+    swDNS_config *config = dns_get_config();
+    size_t server_num = config->servers.size();
+    int tries = server_num * config->attempts;
+    double deadline = swoole_microtime() + timeout;
+
+    for (int i = 0; i < tries; i++)
     {
-        return SW_ERR;
+        double left = deadline - swoole_microtime();
+        if (left < SW_TIMER_MIN_SEC)
+        {
+            break;
+        }
+        size_t index = (config->current_server + i) % server_num;
+        const swDNS_server_addr *server = &config->servers[index];
+        if (!dns_query_server(server, name, qtype, left / (tries - i), answer))
+        {
+            swTraceLog(SW_TRACE_AIO, "nameserver %s:%d timed out", server->host.c_str(), server->port);
+            continue;
+        }
+        if (answer.rcode != SW_DNS_RCODE_NOERROR && answer.rcode != SW_DNS_RCODE_NXDOMAIN)
+        {
+            swTraceLog(SW_TRACE_AIO, "nameserver %s:%d failed, rcode=%d", server->host.c_str(), server->port, answer.rcode);
+            continue;
+        }
+        config->current_server = config->rotate ? index + 1 : index;
+        return true;
     }
+    return false;
+}
 
-    int pos = 0;
-    int i;
-    int len = 0;
-    memcpy(dest + 1, src, n + 1);
-    dest[n + 1] = '.';
-    dest[n + 2] = 0;
-    src = dest + 1;
-    n++;
+static string dns_cache_key(const string &name, int qtype)
+{
+    return to_string(qtype) + "_" + dns_lowercase(name);
+}
+
+static void dns_cache_set(const string &key, const vector<string> &addresses, uint32_t ttl)
+{
+    if (ttl == 0)
+    {
+        return;
+    }
+    if (dns_process_cache == nullptr)
+    {
+        dns_process_cache = new LRUCache(SW_DNS_CACHE_CAPACITY);
+    }
+    dns_process_cache->set(key, make_shared<vector<string>>(addresses), SW_MIN(ttl, SW_DNS_CACHE_MAX_TTL));
+}
+
+static void dns_waiter_timeout(swTimer *timer, swTimer_node *tnode)
+{
+    swDNS_waiter *waiter = (swDNS_waiter *) tnode->data;
+    auto &waiters = waiter->request->waiters;
+    waiters.erase(std::remove(waiters.begin(), waiters.end(), waiter->co), waiters.end());
+    waiter->timer = nullptr;
+    waiter->timedout = true;
+    waiter->co->resume();
+}
+
+static int dns_resolve(const string &name, int qtype, double timeout, vector<string> &addresses, uint32_t &ttl, int depth)
+{
+    string key = dns_cache_key(name, qtype);
+    if (dns_process_cache)
+    {
+        auto cache = dns_process_cache->get(key);
+        if (cache)
+        {
+            addresses = *(vector<string> *) cache.get();
+            return addresses.empty() ? SW_DNS_NOT_FOUND : SW_DNS_FOUND;
+        }
+    }
+
+    /**
+     * the names of a CNAME chain are never coalesced, so that two chains pointing at each other can not deadlock
+     */
+    shared_ptr<swDNS_request> request;
+    if (depth == 0)
+    {
+        auto iter = dns_requests.find(key);
+        if (iter != dns_requests.end())
+        {
+            request = iter->second;
+            swDNS_waiter waiter = { Coroutine::get_current_safe(), request.get(), nullptr, false };
+            waiter.timer = swoole_timer_add((long) (timeout * 1000), SW_FALSE, dns_waiter_timeout, &waiter);
+            request->waiters.push_back(waiter.co);
+            waiter.co->yield();
+            if (waiter.timer)
+            {
+                swoole_timer_del(waiter.timer);
+            }
+            if (waiter.timedout)
+            {
+                return SW_DNS_FAILED;
+            }
+            addresses = request->addresses;
+            ttl = request->ttl;
+            return request->status;
+        }
+        request = make_shared<swDNS_request>();
+        dns_requests[key] = request;
+    }
+
+    int status;
+    swDNS_answer answer;
+    double deadline = swoole_microtime() + timeout;
+
+    if (!dns_query(name, qtype, timeout, answer))
+    {
+        status = SW_DNS_FAILED;
+    }
+    else if (!answer.addresses.empty())
+    {
+        status = SW_DNS_FOUND;
+        addresses = answer.addresses;
+        ttl = answer.ttl;
+    }
+    else if (!answer.cname.empty() && answer.rcode == SW_DNS_RCODE_NOERROR && depth < SW_DNS_MAX_CNAME)
+    {
+        uint32_t target_ttl = UINT32_MAX;
+        status = dns_resolve(answer.cname, qtype, deadline - swoole_microtime(), addresses, target_ttl, depth + 1);
+        ttl = SW_MIN(answer.ttl, target_ttl);
+    }
+    else
+    {
+        status = SW_DNS_NOT_FOUND;
+        ttl = answer.ttl;
+    }
+    if (status != SW_DNS_FAILED)
+    {
+        dns_cache_set(key, addresses, ttl);
+    }
 
-    for (i = 0; i < n; i++)
+    if (request)
     {
-        if (src[i] == '.')
+        dns_requests.erase(key);
+        request->status = status;
+        request->ttl = ttl;
+        request->addresses = addresses;
+        for (auto co : request->waiters)
         {
-            len = i - pos;
-            dest[pos] = len;
-            pos += len + 1;
+            co->resume();
         }
     }
-    dest[pos] = 0;
-    return SW_OK;
+    return status;
+}
+
+vector<string> swoole::coroutine::dns_lookup(const char *domain, double timeout)
+{
+    return dns_lookup(domain, AF_INET, timeout);
 }
 
 /**
- * This function converts a DNS-based hostname into dot-based format
- * (i.e. 3www5apple3com0 into www.apple.com)
+ * resolve the domain with /etc/hosts, the search domains and the nameservers of /etc/resolv.conf
  */
-static void domain_decode(char *str)
+vector<string> swoole::coroutine::dns_lookup(const char *domain, int family, double timeout)
 {
-    size_t i, j;
-    for (i = 0; i < strlen((const char*) str); i++)
+    vector<string> result;
+    string name(domain);
+    bool absolute = false;
+    int qtype = family == AF_INET6 ? SW_DNS_AAAA_RECORD : SW_DNS_A_RECORD;
+
+    if (timeout <= 0)
+    {
+        timeout = Socket::default_dns_timeout;
+    }
+    if (!name.empty() && name.back() == '.')
+    {
+        name.pop_back();
+        absolute = true;
+    }
+    if (name.empty() || name.length() >= SW_DNS_NAME_MAX_LEN)
+    {
+        swoole_error_log(SW_LOG_NOTICE, SW_ERROR_DNSLOOKUP_RESOLVE_FAILED, "invalid domain[%s]", domain);
+        return result;
+    }
+
+    struct in6_addr buf;
+    if (inet_pton(family, name.c_str(), &buf) == 1)
     {
-        unsigned int len = str[i];
-        for (j = 0; j < len; j++)
+        result.push_back(name);
+        return result;
+    }
+
+    swDNS_config *config = dns_get_config();
+    auto &hosts = family == AF_INET6 ? config->hosts_v6 : config->hosts_v4;
+    auto iter = hosts.find(dns_lowercase(name));
+    if (iter != hosts.end())
+    {
+        return iter->second;
+    }
+
+    /**
+     * names with fewer dots than ndots are tried with the search domains first
+     */
+    vector<string> names;
+    if (!absolute && !config->search.empty())
+    {
+        int dots = count(name.begin(), name.end(), '.');
+        if (dots >= config->ndots)
+        {
+            names.push_back(name);
+        }
+        for (auto &search : config->search)
+        {
+            names.push_back(name + "." + search);
+        }
+        if (dots < config->ndots)
         {
-            str[i] = str[i + 1];
-            i++;
+            names.push_back(name);
         }
-        str[i] = '.';
     }
-    str[i - 1] = '\0';
+    else
+    {
+        names.push_back(name);
+    }
+
+    double deadline = swoole_microtime() + timeout;
+    for (auto &_name : names)
+    {
+        double left = deadline - swoole_microtime();
+        if (left < SW_TIMER_MIN_SEC)
+        {
+            break;
+        }
+        uint32_t ttl;
+        if (dns_resolve(_name, qtype, left, result, ttl, 0) == SW_DNS_FOUND)
+        {
+            break;
+        }
+        result.clear();
+    }
+    return result;
+}
+
+void swoole::coroutine::dns_clear_cache()
+{
+    if (dns_process_cache)
+    {
+        dns_process_cache->clear();
+    }
+    dns_config.loaded = false;
 }
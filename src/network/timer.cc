@@ -76,17 +76,36 @@ int swTimer_init(swTimer *timer, long msec)
         return SW_ERR;
     }
 
-    timer->heap = swHeap_new(1024, SW_MIN_HEAP);
-    if (!timer->heap)
+    if (SwooleTG.reactor ? SwooleTG.reactor->timer_wheel : SwooleG.enable_timer_wheel)
     {
-        return SW_ERR;
+        timer->wheel = swTimingWheel_new(0);
+        if (!timer->wheel)
+        {
+            return SW_ERR;
+        }
+    }
+    else
+    {
+        timer->heap = swHeap_new(1024, SW_MIN_HEAP);
+        if (!timer->heap)
+        {
+            return SW_ERR;
+        }
     }
 
     timer->map = swHashMap_new(SW_HASHMAP_INIT_BUCKET_N, NULL);
     if (!timer->map)
     {
-        swHeap_free(timer->heap);
-        timer->heap = NULL;
+        if (timer->wheel)
+        {
+            swTimingWheel_free(timer->wheel);
+            timer->wheel = NULL;
+        }
+        else
+        {
+            swHeap_free(timer->heap);
+            timer->heap = NULL;
+        }
         return SW_ERR;
     }
 
@@ -131,6 +150,10 @@ void swTimer_free(swTimer *timer)
     {
         swHeap_free(timer->heap);
     }
+    if (timer->wheel)
+    {
+        swTimingWheel_free(timer->wheel);
+    }
     if (timer->map)
     {
         timer->map->dtor = swTimer_node_dtor;
@@ -183,14 +206,32 @@ swTimer_node* swTimer_add(swTimer *timer, long _msec, int interval, void *data,
         timer->_next_id = 2;
     }
 
-    tnode->heap_node = swHeap_push(timer->heap, tnode->exec_msec, tnode);
-    if (sw_unlikely(tnode->heap_node == NULL))
+    if (timer->wheel)
     {
-        sw_free(tnode);
-        return NULL;
+        tnode->heap_node = NULL;
+        tnode->wheel_node.data = tnode;
+        swTimingWheel_add(timer->wheel, &tnode->wheel_node, tnode->exec_msec);
+    }
+    else
+    {
+        tnode->heap_node = swHeap_push(timer->heap, tnode->exec_msec, tnode);
+        if (sw_unlikely(tnode->heap_node == NULL))
+        {
+            sw_free(tnode);
+            return NULL;
+        }
     }
     if (sw_unlikely(swHashMap_add_int(timer->map, tnode->id, tnode) != SW_OK))
     {
+        if (timer->wheel)
+        {
+            swTimingWheel_remove(timer->wheel, &tnode->wheel_node);
+        }
+        else
+        {
+            swHeap_remove(timer->heap, tnode->heap_node);
+            sw_free(tnode->heap_node);
+        }
         sw_free(tnode);
         return NULL;
     }
@@ -220,6 +261,10 @@ enum swBool_type swTimer_del(swTimer *timer, swTimer_node *tnode)
         swHeap_remove(timer->heap, tnode->heap_node);
         sw_free(tnode->heap_node);
     }
+    else if (timer->wheel)
+    {
+        swTimingWheel_remove(timer->wheel, &tnode->wheel_node);
+    }
     if (tnode->dtor)
     {
         tnode->dtor(tnode);
@@ -230,6 +275,68 @@ enum swBool_type swTimer_del(swTimer *timer, swTimer_node *tnode)
     return SW_TRUE;
 }
 
+static int swTimer_select_wheel(swTimer *timer, int64_t now_msec)
+{
+    swTimer_node *tnode;
+    swTimingWheel_node *wnode;
+
+    swTraceLog(SW_TRACE_TIMER, "timer msec=%" PRId64 ", round=%" PRId64, now_msec, timer->round);
+    while ((wnode = swTimingWheel_pop(timer->wheel, now_msec)))
+    {
+        tnode = (swTimer_node *) wnode->data;
+        /**
+         * added by the callbacks of this round, it is run at the next round like on the heap
+         */
+        if (tnode->round == timer->round)
+        {
+            swTimingWheel_add(timer->wheel, wnode, wnode->expire);
+            break;
+        }
+
+        timer->_current_id = tnode->id;
+        if (!tnode->removed)
+        {
+            swTraceLog(SW_TRACE_TIMER, "id=%ld, exec_msec=%" PRId64 ", round=%" PRIu64 ", exist=%u", tnode->id, tnode->exec_msec, tnode->round, timer->num - 1);
+            tnode->callback(timer, tnode);
+        }
+        timer->_current_id = -1;
+
+        //persistent timer
+        if (tnode->interval > 0 && !tnode->removed)
+        {
+            while (tnode->exec_msec <= now_msec)
+            {
+                tnode->exec_msec += tnode->interval;
+            }
+            swTimingWheel_add(timer->wheel, wnode, tnode->exec_msec);
+            continue;
+        }
+
+        timer->num--;
+        swHashMap_del_int(timer->map, tnode->id);
+        sw_free(tnode);
+    }
+
+    int64_t next_msec = swTimingWheel_next(timer->wheel);
+    if (next_msec < 0)
+    {
+        timer->_next_msec = -1;
+        timer->set(timer, -1);
+    }
+    else
+    {
+        next_msec -= now_msec;
+        if (next_msec <= 0)
+        {
+            next_msec = 1;
+        }
+        timer->set(timer, next_msec);
+    }
+    timer->round++;
+
+    return SW_OK;
+}
+
 int swTimer_select(swTimer *timer)
 {
     int64_t now_msec = swTimer_get_relative_msec();
@@ -238,6 +345,11 @@ int swTimer_select(swTimer *timer)
         return SW_ERR;
     }
 
+    if (timer->wheel)
+    {
+        return swTimer_select_wheel(timer, now_msec);
+    }
+
     swTimer_node *tnode = NULL;
     swHeap_node *tmp;
 
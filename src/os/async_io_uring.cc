@@ -0,0 +1,474 @@
+/*
+ +----------------------------------------------------------------------+
+ | Swoole                                                               |
+ +----------------------------------------------------------------------+
+ | This source file is subject to version 2.0 of the Apache license,    |
+ | that is bundled with this package in the file LICENSE, and is        |
+ | available through the world-wide-web at the following url:           |
+ | http://www.apache.org/licenses/LICENSE-2.0.html                      |
+ | If you did not receive a copy of the Apache2.0 license and are unable|
+ | to obtain it through the world-wide-web, please send a note to       |
+ | license@swoole.com so we can mail you a copy immediately.            |
+ +----------------------------------------------------------------------+
+ | Author: Tianfeng Han  <mikan.tenny@gmail.com>                        |
+ +----------------------------------------------------------------------+
+ */
+
+#include "swoole_api.h"
+#include "async.h"
+
+#ifdef HAVE_IO_URING
+#include "io_uring.h"
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <sys/sysmacros.h>
+#include <sys/eventfd.h>
+
+/**
+ * AIO backend built on io_uring.
+ *
+ * The requests which have an opcode are queued in a per-thread ring instead of the thread pool,
+ * the kernel runs them and posts the completions, the eventfd registered with the ring wakes up
+ * the reactor which resumes the callbacks. No thread switching and no pipe round trip per request.
+ * Operations the kernel does not support (checked with IORING_REGISTER_PROBE) and the requests
+ * that do not fit into the ring are still executed by the thread pool.
+ */
+#define SW_AIO_IOURING_UNSUPPORTED    0xff
+
+#define SW_AIO_IOURING_DRAIN_TIMEOUT  1000
+
+typedef struct _swAio_iouring_request
+{
+    swAio_event event;
+#ifdef STATX_BASIC_STATS
+    struct statx statx;
+#endif
+    struct _swAio_iouring_request *prev;
+    struct _swAio_iouring_request *next;
+} swAio_iouring_request;
+
+typedef struct
+{
+    swIouring ring;
+    swSocket *socket;
+    /**
+     * in flight requests never exceed the size of the completion queue, so it can not overflow
+     */
+    uint32_t inflight;
+    uint32_t max_inflight;
+    /**
+     * the requests in flight, canceled when the event loop is destroyed
+     */
+    swAio_iouring_request *requests;
+    size_t task_id;
+    uint8_t opcodes[SW_AIO_OP_MAX];
+} swAio_iouring;
+
+static thread_local swAio_iouring *aio_ring = nullptr;
+static thread_local bool aio_ring_unavailable = false;
+
+static const uint8_t aio_opcodes[SW_AIO_OP_MAX] =
+{
+    SW_AIO_IOURING_UNSUPPORTED,
+    IORING_OP_READ,
+    IORING_OP_WRITE,
+    IORING_OP_OPENAT,
+#ifdef STATX_BASIC_STATS
+    IORING_OP_STATX,
+#else
+    SW_AIO_IOURING_UNSUPPORTED,
+#endif
+    IORING_OP_UNLINKAT,
+    IORING_OP_MKDIRAT,
+    IORING_OP_UNLINKAT,
+    IORING_OP_RENAMEAT,
+};
+
+static void swAio_iouring_link(swAio_iouring *object, swAio_iouring_request *req)
+{
+    req->prev = nullptr;
+    req->next = object->requests;
+    if (object->requests)
+    {
+        object->requests->prev = req;
+    }
+    object->requests = req;
+    object->inflight++;
+}
+
+static void swAio_iouring_unlink(swAio_iouring *object, swAio_iouring_request *req)
+{
+    if (req->prev)
+    {
+        req->prev->next = req->next;
+    }
+    else
+    {
+        object->requests = req->next;
+    }
+    if (req->next)
+    {
+        req->next->prev = req->prev;
+    }
+    object->inflight--;
+}
+
+/**
+ * cancel the requests in flight and wait for them, the kernel may still write into their buffers.
+ * their callbacks are not called as the event loop is gone
+ */
+static void swAio_iouring_drain(swAio_iouring *object)
+{
+    struct io_uring_sqe *sqe;
+    struct io_uring_cqe *cqe;
+
+    for (swAio_iouring_request *req = object->requests; req; req = req->next)
+    {
+        if ((sqe = swIouring_get_sqe(&object->ring)) == nullptr)
+        {
+            break;
+        }
+        sqe->opcode = IORING_OP_ASYNC_CANCEL;
+        sqe->fd = -1;
+        sqe->addr = (uint64_t) (uintptr_t) req;
+        sqe->user_data = 0;
+    }
+
+    while (object->inflight > 0)
+    {
+        int ret = swIouring_submit(&object->ring, 1, SW_AIO_IOURING_DRAIN_TIMEOUT);
+        int error = errno;
+        uint32_t count = 0;
+        while ((cqe = swIouring_peek_cqe(&object->ring)))
+        {
+            swAio_iouring_request *req = (swAio_iouring_request *) (uintptr_t) cqe->user_data;
+            swIouring_cqe_seen(&object->ring);
+            count++;
+            // the completion of a cancel request
+            if (req == nullptr)
+            {
+                continue;
+            }
+            swAio_iouring_unlink(object, req);
+            SwooleTG.aio_task_num--;
+            sw_free(req);
+        }
+        if (ret < 0 && error != EINTR && count == 0)
+        {
+            /**
+             * the requests which are never completed are leaked, the kernel may still use them
+             */
+            errno = error;
+            swSysWarn("failed to wait for the %u io_uring requests in flight", object->inflight);
+            return;
+        }
+    }
+}
+
+static void swAio_iouring_free(void *private_data)
+{
+    swAio_iouring *object = aio_ring;
+    if (object == nullptr)
+    {
+        return;
+    }
+    aio_ring = nullptr;
+    SwooleTG.aio_iouring_init = 0;
+
+    swoole_event_del(object->socket);
+    swSocket_free(object->socket);
+    swAio_iouring_drain(object);
+    swIouring_free(&object->ring);
+    sw_free(object);
+}
+
+static void swAio_iouring_probe(swAio_iouring *object)
+{
+    size_t size = sizeof(struct io_uring_probe) + 256 * sizeof(struct io_uring_probe_op);
+    struct io_uring_probe *probe = (struct io_uring_probe *) sw_calloc(1, size);
+    bool probed = probe && swIouring_register(&object->ring, IORING_REGISTER_PROBE, probe, 256) == 0;
+
+    for (int i = 0; i < SW_AIO_OP_MAX; i++)
+    {
+        uint8_t op = aio_opcodes[i];
+        if (op == SW_AIO_IOURING_UNSUPPORTED || !probed || op > probe->last_op
+                || !(probe->ops[op].flags & IO_URING_OP_SUPPORTED))
+        {
+            object->opcodes[i] = SW_AIO_IOURING_UNSUPPORTED;
+        }
+        else
+        {
+            object->opcodes[i] = op;
+        }
+    }
+    /**
+     * reading and writing at the current file position requires linux-5.6
+     */
+    if (!(object->ring.features & IORING_FEAT_RW_CUR_POS))
+    {
+        object->opcodes[SW_AIO_OP_READ] = SW_AIO_IOURING_UNSUPPORTED;
+        object->opcodes[SW_AIO_OP_WRITE] = SW_AIO_IOURING_UNSUPPORTED;
+    }
+    if (probe)
+    {
+        sw_free(probe);
+    }
+}
+
+static swAio_iouring* swAio_iouring_init()
+{
+    swAio_iouring *object = (swAio_iouring *) sw_malloc(sizeof(swAio_iouring));
+    if (object == nullptr)
+    {
+        swWarn("malloc[0] failed");
+        return nullptr;
+    }
+    bzero(object, sizeof(swAio_iouring));
+
+    if (swIouring_create(&object->ring, SW_AIO_IOURING_ENTRIES) < 0)
+    {
+        sw_free(object);
+        return nullptr;
+    }
+    object->max_inflight = *object->ring.cq_mask + 1;
+    swAio_iouring_probe(object);
+
+    int efd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (efd < 0)
+    {
+        swSysWarn("eventfd() failed");
+        goto _error;
+    }
+    if (swIouring_register(&object->ring, IORING_REGISTER_EVENTFD, &efd, 1) < 0)
+    {
+        swSysWarn("io_uring_register(IORING_REGISTER_EVENTFD) failed");
+        close(efd);
+        goto _error;
+    }
+    object->socket = swSocket_new(efd, SW_FD_AIO_IOURING);
+    if (object->socket == nullptr)
+    {
+        close(efd);
+        goto _error;
+    }
+    if (swoole_event_add(object->socket, SW_EVENT_READ) < 0)
+    {
+        swSocket_free(object->socket);
+        goto _error;
+    }
+
+    swReactor_add_destroy_callback(SwooleTG.reactor, swAio_iouring_free, nullptr);
+    SwooleTG.aio_iouring_init = 1;
+    return object;
+
+    _error:
+    swIouring_free(&object->ring);
+    sw_free(object);
+    return nullptr;
+}
+
+static bool swAio_iouring_prepare(struct io_uring_sqe *sqe, uint8_t op, swAio_iouring_request *req)
+{
+    swAio_event *event = &req->event;
+
+    sqe->opcode = op;
+    sqe->user_data = (uint64_t) (uintptr_t) req;
+
+    switch (event->opcode)
+    {
+    case SW_AIO_OP_READ:
+    case SW_AIO_OP_WRITE:
+        sqe->fd = event->fd;
+        sqe->addr = (uint64_t) (uintptr_t) event->buf;
+        sqe->len = event->nbytes;
+        sqe->off = (uint64_t) -1;
+        break;
+    case SW_AIO_OP_OPEN:
+        sqe->fd = AT_FDCWD;
+        sqe->addr = (uint64_t) (uintptr_t) event->buf;
+        sqe->len = event->offset;
+        sqe->open_flags = event->flags;
+        break;
+#ifdef STATX_BASIC_STATS
+    case SW_AIO_OP_FSTAT:
+        sqe->fd = event->fd;
+        sqe->addr = (uint64_t) (uintptr_t) "";
+        sqe->len = STATX_BASIC_STATS;
+        sqe->statx_flags = AT_EMPTY_PATH;
+        sqe->addr2 = (uint64_t) (uintptr_t) &req->statx;
+        break;
+#endif
+    case SW_AIO_OP_UNLINK:
+    case SW_AIO_OP_RMDIR:
+        sqe->fd = AT_FDCWD;
+        sqe->addr = (uint64_t) (uintptr_t) event->buf;
+        sqe->unlink_flags = event->opcode == SW_AIO_OP_RMDIR ? AT_REMOVEDIR : 0;
+        break;
+    case SW_AIO_OP_MKDIR:
+        sqe->fd = AT_FDCWD;
+        sqe->addr = (uint64_t) (uintptr_t) event->buf;
+        sqe->len = event->offset;
+        break;
+    case SW_AIO_OP_RENAME:
+        sqe->fd = AT_FDCWD;
+        sqe->addr = (uint64_t) (uintptr_t) event->buf;
+        sqe->len = (uint32_t) AT_FDCWD;
+        sqe->addr2 = (uint64_t) event->offset;
+        break;
+    default:
+        return false;
+    }
+    return true;
+}
+
+/**
+ * queue the request in the io_uring of the current thread, NULL if it has to go to the thread pool
+ */
+swAio_event* swAio_iouring_dispatch(const swAio_event *request)
+{
+    if (sw_unlikely(aio_ring == nullptr))
+    {
+        if (aio_ring_unavailable || !SwooleTG.reactor)
+        {
+            return nullptr;
+        }
+        if ((aio_ring = swAio_iouring_init()) == nullptr)
+        {
+            swoole_error_log(SW_LOG_NOTICE, SW_ERROR_OPERATION_NOT_SUPPORT, "io_uring is not available, fall back to the aio thread pool");
+            aio_ring_unavailable = true;
+            return nullptr;
+        }
+    }
+
+    swAio_iouring *object = aio_ring;
+    if (request->opcode >= SW_AIO_OP_MAX)
+    {
+        return nullptr;
+    }
+    uint8_t op = object->opcodes[request->opcode];
+    if (op == SW_AIO_IOURING_UNSUPPORTED || object->inflight >= object->max_inflight)
+    {
+        return nullptr;
+    }
+
+    struct io_uring_sqe *sqe = swIouring_get_sqe(&object->ring);
+    if (sqe == nullptr)
+    {
+        return nullptr;
+    }
+
+    swAio_iouring_request *req = (swAio_iouring_request *) sw_malloc(sizeof(swAio_iouring_request));
+    if (req == nullptr)
+    {
+        swIouring_put_sqe(&object->ring);
+        return nullptr;
+    }
+    req->event = *request;
+    req->event.task_id = object->task_id++;
+    req->event.timestamp = swoole_microtime();
+
+    if (!swAio_iouring_prepare(sqe, op, req) || swIouring_submit(&object->ring, 0, 0) < 1)
+    {
+        /**
+         * the kernel has not taken it (EAGAIN/EBUSY), let the thread pool run it
+         */
+        swIouring_put_sqe(&object->ring);
+        sw_free(req);
+        return nullptr;
+    }
+
+    swAio_iouring_link(object, req);
+    swTraceLog(SW_TRACE_AIO, "io_uring submit task#%zu, opcode=%d", req->event.task_id, op);
+    return &req->event;
+}
+
+#ifdef STATX_BASIC_STATS
+static void swAio_iouring_statx_to_stat(const struct statx *stx, struct stat *st)
+{
+    bzero(st, sizeof(*st));
+    st->st_dev = makedev(stx->stx_dev_major, stx->stx_dev_minor);
+    st->st_ino = stx->stx_ino;
+    st->st_mode = stx->stx_mode;
+    st->st_nlink = stx->stx_nlink;
+    st->st_uid = stx->stx_uid;
+    st->st_gid = stx->stx_gid;
+    st->st_rdev = makedev(stx->stx_rdev_major, stx->stx_rdev_minor);
+    st->st_size = stx->stx_size;
+    st->st_blksize = stx->stx_blksize;
+    st->st_blocks = stx->stx_blocks;
+    st->st_atim.tv_sec = stx->stx_atime.tv_sec;
+    st->st_atim.tv_nsec = stx->stx_atime.tv_nsec;
+    st->st_mtim.tv_sec = stx->stx_mtime.tv_sec;
+    st->st_mtim.tv_nsec = stx->stx_mtime.tv_nsec;
+    st->st_ctim.tv_sec = stx->stx_ctime.tv_sec;
+    st->st_ctim.tv_nsec = stx->stx_ctime.tv_nsec;
+}
+#endif
+
+int swAio_iouring_callback(swReactor *reactor, swEvent *_event)
+{
+    swAio_iouring *object = aio_ring;
+    uint64_t count;
+    struct io_uring_cqe *cqe;
+
+    if (read(_event->fd, &count, sizeof(count)) < 0 && errno != EAGAIN)
+    {
+        swSysWarn("read() aio eventfd failed");
+        return SW_ERR;
+    }
+    if (object == nullptr)
+    {
+        return SW_OK;
+    }
+
+    while ((cqe = swIouring_peek_cqe(&object->ring)))
+    {
+        swAio_iouring_request *req = (swAio_iouring_request *) (uintptr_t) cqe->user_data;
+        swAio_event *event = &req->event;
+        int res = cqe->res;
+        /**
+         * release the cqe first, the callback may dispatch new requests
+         */
+        swIouring_cqe_seen(&object->ring);
+        swAio_iouring_unlink(object, req);
+
+        if (res < 0)
+        {
+            event->ret = -1;
+            event->error = -res;
+        }
+        else
+        {
+            event->ret = res;
+            event->error = 0;
+#ifdef STATX_BASIC_STATS
+            if (event->opcode == SW_AIO_OP_FSTAT)
+            {
+                swAio_iouring_statx_to_stat(&req->statx, (struct stat *) event->buf);
+            }
+#endif
+        }
+
+        swTraceLog(SW_TRACE_AIO, "io_uring task#%zu %s. ret=%d, error=%d", event->task_id, event->ret < 0 ? "failed" : "ok", event->ret, event->error);
+
+        if (!event->canceled)
+        {
+            event->callback(event);
+        }
+        SwooleTG.aio_task_num--;
+        sw_free(req);
+
+        /**
+         * the callback may have destroyed the event loop
+         */
+        if (aio_ring != object)
+        {
+            break;
+        }
+    }
+
+    return SW_OK;
+}
+
+#endif
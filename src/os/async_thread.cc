@@ -23,7 +23,9 @@
 #include <chrono>
 #include <condition_variable>
 #include <mutex>
-#include <queue>
+#include <deque>
+#include <vector>
+#include <algorithm>
 
 using namespace std;
 
@@ -31,32 +33,69 @@ typedef swAio_event AsyncEvent;
 
 static mutex init_lock;
 static atomic<int> refcount(0);
+/**
+ * not reset with the thread pool, 0 is never the id of a dispatched event
+ */
+static atomic<size_t> aio_task_id(1);
 
 static void aio_thread_release(AsyncEvent *event);
 
+static const char *lane_names[SW_AIO_LANE_MAX] = { "user", "dns", "file", "blocking" };
+static uint32_t lane_max_threads[SW_AIO_LANE_MAX] = { 0 };
+static uint8_t lane_priority[SW_AIO_LANE_MAX] = { SW_AIO_LANE_DNS, SW_AIO_LANE_FILE, SW_AIO_LANE_BLOCKING, SW_AIO_LANE_USER };
+
 namespace swoole { namespace async {
 //-------------------------------------------------------------------------------
+/**
+ * the events of an AIO thread, the reactor threads push them without a lock,
+ * the owner and the other idle threads (stealing) take them in order under the lock of the queue
+ */
 class EventQueue
 {
 public:
+    EventQueue()
+    {
+        inbox = nullptr;
+        n_events = 0;
+    }
+
     inline void push(AsyncEvent *event)
     {
-        _queue.push(event);
+        n_events++;
+        AsyncEvent *head = inbox.load(memory_order_relaxed);
+        do
+        {
+            event->next = head;
+        } while (!inbox.compare_exchange_weak(head, event));
     }
 
     inline AsyncEvent* pop()
     {
-        if (_queue.empty())
+        unique_lock<mutex> lock(_lock);
+        return pop_front();
+    }
+
+    inline AsyncEvent* steal()
+    {
+        unique_lock<mutex> lock(_lock, try_to_lock);
+        if (!lock.owns_lock())
         {
             return nullptr;
         }
-        AsyncEvent* retval = _queue.front();
-        _queue.pop();
-        return retval;
+        return pop_front();
     }
 
+    /**
+     * the queue which is being popped is skipped
+     */
     inline double get_max_wait_time()
     {
+        unique_lock<mutex> lock(_lock, try_to_lock);
+        if (!lock.owns_lock())
+        {
+            return 0;
+        }
+        move_inbox();
         if (_queue.empty())
         {
             return 0;
@@ -70,11 +109,163 @@ public:
 
     inline size_t count()
     {
-        return _queue.size();
+        return n_events;
     }
 
 private:
-    queue<AsyncEvent *> _queue;
+    /**
+     * the inbox is a stack, the events are moved in the order of dispatching
+     */
+    inline void move_inbox()
+    {
+        AsyncEvent *event = inbox.exchange(nullptr);
+        size_t offset = _queue.size();
+        for (; event; event = event->next)
+        {
+            _queue.push_back(event);
+        }
+        reverse(_queue.begin() + offset, _queue.end());
+    }
+
+    inline AsyncEvent* pop_front()
+    {
+        if (_queue.empty())
+        {
+            move_inbox();
+            if (_queue.empty())
+            {
+                return nullptr;
+            }
+        }
+        AsyncEvent* retval = _queue.front();
+        _queue.pop_front();
+        n_events--;
+        return retval;
+    }
+
+    atomic<AsyncEvent *> inbox;
+    atomic<size_t> n_events;
+    deque<AsyncEvent *> _queue;
+    mutex _lock;
+};
+
+/**
+ * the completed events of a reactor thread, the reactor is woken up once for a batch of events.
+ * it lives as long as the thread pool, the events completed after its reactor has exited are freed with it
+ */
+struct CompletionQueue
+{
+    atomic<AsyncEvent *> head;
+    swPipe pipe;
+
+    CompletionQueue()
+    {
+        head = nullptr;
+        bzero(&pipe, sizeof(pipe));
+    }
+
+    ~CompletionQueue()
+    {
+        AsyncEvent *next;
+        for (AsyncEvent *event = pop_all(); event; event = next)
+        {
+            next = event->next;
+            if (event->callback == aio_thread_release)
+            {
+                delete (thread::id *) event->object;
+            }
+            delete event;
+        }
+        if (pipe.close)
+        {
+            pipe.close(&pipe);
+        }
+    }
+
+    void push(AsyncEvent *event)
+    {
+        AsyncEvent *_head = head.load(memory_order_relaxed);
+        do
+        {
+            event->next = _head;
+        } while (!head.compare_exchange_weak(_head, event, memory_order_release, memory_order_relaxed));
+
+        if (_head == nullptr)
+        {
+            uint64_t flag = 1;
+            // a full pipe has the wakeup already
+            if (pipe.write(&pipe, &flag, sizeof(flag)) < 0 && errno != EAGAIN)
+            {
+                swSysWarn("failed to notify the reactor of the aio events");
+            }
+        }
+    }
+
+    /**
+     * in the order of completion
+     */
+    AsyncEvent* pop_all()
+    {
+        AsyncEvent *event = head.exchange(nullptr, memory_order_acquire);
+        AsyncEvent *list = nullptr;
+        while (event)
+        {
+            AsyncEvent *next = event->next;
+            event->next = list;
+            list = event;
+            event = next;
+        }
+        return list;
+    }
+};
+
+/**
+ * the queues of a kind of events, at most max_threads threads run them at the same time (0 is unlimited)
+ */
+struct Lane
+{
+    EventQueue *queues;
+    size_t max_threads;
+    atomic<size_t> n_running;
+    atomic<size_t> n_dispatched;
+    atomic<uint64_t> wait_usec;
+    atomic<uint64_t> max_wait_usec;
+
+    Lane()
+    {
+        queues = nullptr;
+        max_threads = 0;
+        n_running = 0;
+        n_dispatched = 0;
+        wait_usec = 0;
+        max_wait_usec = 0;
+    }
+
+    inline bool runnable()
+    {
+        return max_threads == 0 || n_running < max_threads;
+    }
+
+    inline bool acquire()
+    {
+        size_t n = n_running.load();
+        do
+        {
+            if (max_threads != 0 && n >= max_threads)
+            {
+                return false;
+            }
+        } while (!n_running.compare_exchange_weak(n, n + 1));
+        return true;
+    }
+
+    inline void add_wait_time(double seconds)
+    {
+        uint64_t usec = seconds > 0 ? seconds * 1000 * 1000 : 0;
+        wait_usec += usec;
+        uint64_t max = max_wait_usec.load();
+        while (usec > max && !max_wait_usec.compare_exchange_weak(max, usec));
+    }
 };
 
 class ThreadPool
@@ -89,23 +280,34 @@ public:
         max_wait_time = _max_wait_time == 0 ? SW_AIO_TASK_MAX_WAIT_TIME : _max_wait_time;
         max_idle_time = _max_idle_time == 0 ? SW_AIO_THREAD_MAX_IDLE_TIME : _max_idle_time;
 
+        // each core thread owns a queue of every lane, the other threads only steal
+        for (size_t i = 0; i < SW_AIO_LANE_MAX; i++)
+        {
+            lanes[i].queues = new EventQueue[core_worker_num];
+            lanes[i].max_threads = lane_max_threads[i];
+            priority[i] = lane_priority[i];
+        }
+
         current_pid = getpid();
     }
 
     ~ThreadPool()
     {
         shutdown();
+        for (size_t i = 0; i < SW_AIO_LANE_MAX; i++)
+        {
+            delete[] lanes[i].queues;
+        }
     }
 
     bool start()
     {
         running = true;
-        current_task_id = 0;
         n_waiting = 0;
         n_closing = 0;
         for (size_t i = 0; i < core_worker_num; i++)
         {
-            create_thread(true);
+            create_thread(i);
         }
         return true;
     }
@@ -117,10 +319,10 @@ public:
             return false;
         }
 
-        event_mutex.lock();
+        idle_mutex.lock();
         running = false;
         _cv.notify_all();
-        event_mutex.unlock();
+        idle_mutex.unlock();
 
         for (auto &i : threads)
         {
@@ -139,9 +341,19 @@ public:
     {
         if (n_waiting == 0 && threads.size() < worker_num && max_wait_time > 0)
         {
-            event_mutex.lock();
-            double _max_wait_time = _queue.get_max_wait_time();
-            event_mutex.unlock();
+            // the lanes which are full do not need more threads
+            double _max_wait_time = 0;
+            for (size_t i = 0; i < SW_AIO_LANE_MAX; i++)
+            {
+                if (!lanes[i].runnable())
+                {
+                    continue;
+                }
+                for (size_t j = 0; j < core_worker_num; j++)
+                {
+                    _max_wait_time = SW_MAX(_max_wait_time, lanes[i].queues[j].get_max_wait_time());
+                }
+            }
 
             if (_max_wait_time > max_wait_time)
             {
@@ -162,20 +374,31 @@ public:
         }
     }
 
-    AsyncEvent* dispatch(const AsyncEvent *request)
+    AsyncEvent* dispatch(const AsyncEvent *request, CompletionQueue *completion)
     {
-        if (SwooleTG.aio_schedule) 
+        static thread_local size_t cursor = 0;
+
+        if (SwooleTG.aio_schedule)
         {
             schedule();
         }
         auto _event_copy = new AsyncEvent(*request);
-        _event_copy->task_id = current_task_id++;
+        _event_copy->task_id = aio_task_id++;
         _event_copy->timestamp = swoole_microtime();
-        _event_copy->pipe_fd = SwooleTG.aio_write_socket->fd;
-        event_mutex.lock();
-        _queue.push(_event_copy);
-        _cv.notify_one();
-        event_mutex.unlock();
+        _event_copy->completion = completion;
+        if (sw_unlikely(_event_copy->lane >= SW_AIO_LANE_MAX))
+        {
+            _event_copy->lane = SW_AIO_LANE_USER;
+        }
+        Lane &lane = lanes[_event_copy->lane];
+        lane.n_dispatched++;
+        lane.queues[cursor++ % core_worker_num].push(_event_copy);
+        // the mutex is only taken to wake up an idle thread
+        if (n_waiting > 0)
+        {
+            lock_guard<mutex> lock(idle_mutex);
+            _cv.notify_one();
+        }
         swDebug("push and notify one: %f", swoole_microtime());
         return _event_copy;
     }
@@ -185,13 +408,45 @@ public:
         return threads.size();
     }
 
-    inline size_t queue_count()
+    inline size_t queue_count(int lane)
+    {
+        size_t n = 0;
+        for (size_t i = 0; i < core_worker_num; i++)
+        {
+            n += lanes[lane].queues[i].count();
+        }
+        return n;
+    }
+
+    /**
+     * the events which can be taken now
+     */
+    inline size_t runnable_count()
     {
-        unique_lock<mutex> lock(event_mutex);
-        return _queue.count();
+        size_t n = 0;
+        for (size_t i = 0; i < SW_AIO_LANE_MAX; i++)
+        {
+            if (lanes[i].runnable())
+            {
+                n += queue_count(i);
+            }
+        }
+        return n;
+    }
+
+    void get_lane_stats(int lane, swAio_lane_stats *stats)
+    {
+        Lane &_lane = lanes[lane];
+        stats->queue_num = queue_count(lane);
+        stats->running_num = _lane.n_running;
+        stats->max_thread_num = _lane.max_threads;
+        stats->dispatch_num = _lane.n_dispatched;
+        stats->wait_time = (double) _lane.wait_usec / (1000 * 1000);
+        stats->max_wait_time = (double) _lane.max_wait_usec / (1000 * 1000);
     }
 
     pid_t current_pid;
+    CompletionQueue *default_completion = nullptr;
 
     void release_thread(thread::id tid)
     {
@@ -222,7 +477,63 @@ public:
 #endif
 
 private:
-    void create_thread(const bool is_core_worker = false);
+    void create_thread(ssize_t queue_id = -1);
+
+    /**
+     * the lanes in the order of priority, the full lanes are skipped
+     */
+    AsyncEvent* get_event(size_t start, bool has_queue)
+    {
+        for (size_t i = 0; i < SW_AIO_LANE_MAX; i++)
+        {
+            Lane &lane = lanes[priority[i]];
+            if (queue_count(priority[i]) == 0 || !lane.acquire())
+            {
+                continue;
+            }
+            AsyncEvent *event = get_event(lane.queues, start, has_queue);
+            if (event)
+            {
+                lane.add_wait_time(swoole_microtime() - event->timestamp);
+                return event;
+            }
+            release_lane(priority[i]);
+        }
+        return nullptr;
+    }
+
+    /**
+     * the own queue first, then the queues of the others from the next one
+     */
+    AsyncEvent* get_event(EventQueue *queues, size_t start, bool has_queue)
+    {
+        AsyncEvent *event;
+        if (has_queue && (event = queues[start].pop()))
+        {
+            return event;
+        }
+        for (size_t i = has_queue ? 1 : 0; i < core_worker_num; i++)
+        {
+            if ((event = queues[(start + i) % core_worker_num].steal()))
+            {
+                return event;
+            }
+        }
+        return nullptr;
+    }
+
+    /**
+     * an idle thread may be waiting for the events of this lane
+     */
+    void release_lane(int lane)
+    {
+        lanes[lane].n_running--;
+        if (n_waiting > 0 && queue_count(lane) > 0)
+        {
+            lock_guard<mutex> lock(idle_mutex);
+            _cv.notify_one();
+        }
+    }
 
     size_t core_worker_num;
     size_t worker_num;
@@ -233,25 +544,35 @@ private:
 
     atomic<size_t> n_waiting;
     atomic<size_t> n_closing;
-    size_t current_task_id = 0;
 
     unordered_map<thread::id, thread *> threads;
-    EventQueue _queue;
-    mutex event_mutex;
+    Lane lanes[SW_AIO_LANE_MAX];
+    uint8_t priority[SW_AIO_LANE_MAX];
+    mutex idle_mutex;
     condition_variable _cv;
 };
 //-------------------------------------------------------------------------------
 }};
 
 static swoole::async::ThreadPool *pool = nullptr;
+static thread_local swoole::async::CompletionQueue *completion_queue = nullptr;
+/**
+ * the completion queues of all the reactor threads, freed after the thread pool
+ */
+static vector<swoole::async::CompletionQueue *> completion_queues;
+static size_t pool_generation = 0;
+static thread_local size_t completion_generation = 0;
 
-void swoole::async::ThreadPool::create_thread(const bool is_core_worker)
+void swoole::async::ThreadPool::create_thread(ssize_t queue_id)
 {
     try
     {
-        thread *_thread = new thread([this, is_core_worker]()
+        // the other threads start stealing from different queues
+        size_t start = queue_id >= 0 ? queue_id : threads.size() % core_worker_num;
+        thread *_thread = new thread([this, queue_id, start]()
         {
             bool exit_flag = false;
+            bool is_core_worker = queue_id >= 0;
 
             SwooleTG.buffer_stack = swString_new(SW_STACK_BUFFER_SIZE);
             if (SwooleTG.buffer_stack == nullptr)
@@ -263,9 +584,7 @@ void swoole::async::ThreadPool::create_thread(const bool is_core_worker)
 
             while (running)
             {
-                event_mutex.lock();
-                AsyncEvent *event = _queue.pop();
-                event_mutex.unlock();
+                AsyncEvent *event = get_event(start, is_core_worker);
 
                 swDebug("%s: %f", event ? "pop 1 event" : "no event", swoole_microtime());
 
@@ -285,31 +604,12 @@ void swoole::async::ThreadPool::create_thread(const bool is_core_worker)
                     {
                         event->handler(event);
                     }
+                    release_lane(event->lane);
 
                     swTraceLog(SW_TRACE_AIO, "aio_thread %s. ret=%d, error=%d", event->ret > 0 ? "ok" : "failed", event->ret, event->error);
 
                     _send_event:
-                    while (true)
-                    {
-                        int ret = write(event->pipe_fd, &event, sizeof(event));
-                        if (ret < 0)
-                        {
-                            if (errno == EAGAIN)
-                            {
-                                swSocket_wait(event->pipe_fd, 1000, SW_EVENT_WRITE);
-                                continue;
-                            }
-                            else if (errno == EINTR)
-                            {
-                                continue;
-                            }
-                            else
-                            {
-                                swSysWarn("sendto swoole_aio_pipe_write failed");
-                            }
-                        }
-                        break;
-                    }
+                    ((CompletionQueue *) event->completion)->push(event);
 
                     // exit
                     if (exit_flag)
@@ -320,16 +620,19 @@ void swoole::async::ThreadPool::create_thread(const bool is_core_worker)
                 }
                 else
                 {
-                    unique_lock<mutex> lock(event_mutex);
-                    if (_queue.count() > 0)
+                    unique_lock<mutex> lock(idle_mutex);
+                    ++n_waiting;
+                    // an event pushed or a lane released after it is counted wakes this thread up
+                    if (runnable_count() > 0)
                     {
+                        --n_waiting;
                         continue;
                     }
                     if (!running)
                     {
+                        --n_waiting;
                         break;
                     }
-                    ++n_waiting;
                     if (is_core_worker || max_idle_time <= 0)
                     {
                         _cv.wait(lock);
@@ -349,7 +652,7 @@ void swoole::async::ThreadPool::create_thread(const bool is_core_worker)
                                 event = new AsyncEvent;
                                 event->object = new thread::id(this_thread::get_id());
                                 event->callback = aio_thread_release;
-                                event->pipe_fd = SwooleG.aio_default_socket->fd;
+                                event->completion = default_completion;
                                 event->canceled = false;
 
                                 --n_waiting;
@@ -393,16 +696,28 @@ static void swAio_free(void *private_data)
     
     if (pool->current_pid == getpid())
     {
+        init_lock.lock();
         if ((--refcount) == 0)
         {
             delete pool;
             pool = nullptr;
 
-            SwooleTG.aio_pipe.close(&SwooleTG.aio_pipe);
-            SwooleTG.aio_read_socket = nullptr;
-            SwooleTG.aio_write_socket = nullptr;
+            /**
+             * no more events are completed, the queues and the pipes of every thread are released
+             */
+            for (auto queue : completion_queues)
+            {
+                delete queue;
+            }
+            completion_queues.clear();
         }
+        init_lock.unlock();
     }
+    /**
+     * the queue of this thread is kept for the events in flight, and reused by its next event loop
+     */
+    SwooleTG.aio_read_socket = nullptr;
+    SwooleTG.aio_write_socket = nullptr;
 }
 
 static int swAio_init()
@@ -418,29 +733,40 @@ static int swAio_init()
         return SW_ERR;
     }
 
-    if (swPipeBase_create(&SwooleTG.aio_pipe, 0) < 0)
+    init_lock.lock();
+    if (!pool || pool->current_pid != getpid() || completion_generation != pool_generation)
     {
-        swoole_throw_error(SW_ERROR_SYSTEM_CALL_FAIL);
+        completion_queue = new swoole::async::CompletionQueue();
+        if (swPipeNotify_auto(&completion_queue->pipe, 0, 0) < 0)
+        {
+            delete completion_queue;
+            completion_queue = nullptr;
+            init_lock.unlock();
+            swoole_throw_error(SW_ERROR_SYSTEM_CALL_FAIL);
+        }
+        completion_queues.push_back(completion_queue);
+        completion_generation = pool ? pool_generation : pool_generation + 1;
     }
 
-    SwooleTG.aio_read_socket = SwooleTG.aio_pipe.getSocket(&SwooleTG.aio_pipe, 0);
-    SwooleTG.aio_write_socket = SwooleTG.aio_pipe.getSocket(&SwooleTG.aio_pipe, 1);
+    swPipe *pipe = &completion_queue->pipe;
+    SwooleTG.aio_read_socket = pipe->getSocket(pipe, 0);
+    SwooleTG.aio_write_socket = pipe->getSocket(pipe, 1);
     SwooleTG.aio_read_socket->fdtype = SW_FD_AIO;
     SwooleTG.aio_write_socket->fdtype = SW_FD_AIO;
 
     swoole_event_add(SwooleTG.aio_read_socket, SW_EVENT_READ);
     swReactor_add_destroy_callback(SwooleTG.reactor, swAio_free, nullptr);
 
-    init_lock.lock();
     if ((refcount++) == 0)
     {
         pool = new swoole::async::ThreadPool(
             SwooleG.aio_core_worker_num, SwooleG.aio_worker_num,
             SwooleG.aio_max_wait_time, SwooleG.aio_max_idle_time
         );
+        pool_generation++;
+        pool->default_completion = completion_queue;
         pool->start();
         SwooleTG.aio_schedule = 1;
-        SwooleG.aio_default_socket = SwooleTG.aio_write_socket;
     }
     SwooleTG.aio_init = 1;
     init_lock.unlock();
@@ -453,6 +779,79 @@ size_t swAio_thread_count()
     return pool ? pool->worker_count() : 0;
 }
 
+int swAio_lane_get_id(const char *name)
+{
+    for (int i = 0; i < SW_AIO_LANE_MAX; i++)
+    {
+        if (strcasecmp(name, lane_names[i]) == 0)
+        {
+            return i;
+        }
+    }
+    return SW_ERR;
+}
+
+const char* swAio_lane_get_name(int lane)
+{
+    return lane >= 0 && lane < SW_AIO_LANE_MAX ? lane_names[lane] : nullptr;
+}
+
+/**
+ * takes effect when the thread pool is created
+ */
+void swAio_set_lane_max_threads(int lane, uint32_t num)
+{
+    if (lane >= 0 && lane < SW_AIO_LANE_MAX)
+    {
+        lane_max_threads[lane] = num;
+    }
+}
+
+/**
+ * the given lanes come first, the others follow in their current order
+ */
+void swAio_set_lane_priority(const uint8_t *lanes, size_t n)
+{
+    uint8_t _priority[SW_AIO_LANE_MAX];
+    bool added[SW_AIO_LANE_MAX] = { false };
+    size_t count = 0;
+
+    for (size_t i = 0; i < n; i++)
+    {
+        if (lanes[i] < SW_AIO_LANE_MAX && !added[lanes[i]])
+        {
+            added[lanes[i]] = true;
+            _priority[count++] = lanes[i];
+        }
+    }
+    for (size_t i = 0; i < SW_AIO_LANE_MAX; i++)
+    {
+        if (!added[lane_priority[i]])
+        {
+            _priority[count++] = lane_priority[i];
+        }
+    }
+    memcpy(lane_priority, _priority, sizeof(lane_priority));
+}
+
+int swAio_get_lane_stats(int lane, swAio_lane_stats *stats)
+{
+    bzero(stats, sizeof(*stats));
+    if (lane < 0 || lane >= SW_AIO_LANE_MAX)
+    {
+        return SW_ERR;
+    }
+    if (pool)
+    {
+        pool->get_lane_stats(lane, stats);
+    }
+    else
+    {
+        stats->max_thread_num = lane_max_threads[lane];
+    }
+    return SW_OK;
+}
+
 ssize_t swAio_dispatch(const swAio_event *request)
 {
     AsyncEvent *event = swAio_dispatch2(request);
@@ -465,11 +864,22 @@ ssize_t swAio_dispatch(const swAio_event *request)
 
 swAio_event* swAio_dispatch2(const swAio_event *request)
 {
+#ifdef HAVE_IO_URING
+    if (request->opcode != SW_AIO_OP_NONE && SwooleG.enable_aio_io_uring)
+    {
+        AsyncEvent *event = swAio_iouring_dispatch(request);
+        if (event)
+        {
+            SwooleTG.aio_task_num++;
+            return event;
+        }
+    }
+#endif
     if (sw_unlikely(!SwooleTG.aio_init))
     {
         swAio_init();
     }
-    AsyncEvent *event = pool->dispatch(request);
+    AsyncEvent *event = pool->dispatch(request, completion_queue);
     if (sw_likely(event))
     {
         SwooleTG.aio_task_num++;
@@ -484,16 +894,18 @@ int swAio_callback(swReactor *reactor, swEvent *event)
         pool->schedule();
     }
 
-    AsyncEvent *events[SW_AIO_EVENT_NUM];
-    ssize_t n = read(event->fd, events, sizeof(AsyncEvent *) * SW_AIO_EVENT_NUM);
-    if (n < 0)
+    // the wakeup is cleared first, the events completed after it wake the reactor up again
+    uint64_t flags[SW_AIO_EVENT_NUM];
+    if (read(event->fd, flags, sizeof(flags)) < 0 && errno != EAGAIN)
     {
         swSysWarn("read() aio events failed");
         return SW_ERR;
     }
-    for (size_t i = 0; i < n / sizeof(AsyncEvent *); i++)
+
+    AsyncEvent *next;
+    for (AsyncEvent *event = completion_queue->pop_all(); event; event = next)
     {
-        AsyncEvent *event = events[i];
+        next = event->next;
         if (!event->canceled)
         {
             event->callback(event);
@@ -366,7 +366,7 @@ void swAio_handler_fgets(swAio_event *event)
 void swAio_handler_read_file(swAio_event *event)
 {
     int ret = -1;
-    int fd = open((char*) event->req, O_RDONLY);
+    int fd = (event->flags & SW_AIO_READ_FILE_FD) ? event->fd : open((char*) event->req, O_RDONLY);
     if (fd < 0)
     {
         swSysWarn("open(%s, O_RDONLY) failed", (char * )event->req);
@@ -0,0 +1,200 @@
+/*
+ +----------------------------------------------------------------------+
+ | Swoole                                                               |
+ +----------------------------------------------------------------------+
+ | This source file is subject to version 2.0 of the Apache license,    |
+ | that is bundled with this package in the file LICENSE, and is        |
+ | available through the world-wide-web at the following url:           |
+ | http://www.apache.org/licenses/LICENSE-2.0.html                      |
+ | If you did not receive a copy of the Apache2.0 license and are unable|
+ | to obtain it through the world-wide-web, please send a note to       |
+ | license@swoole.com so we can mail you a copy immediately.            |
+ +----------------------------------------------------------------------+
+ | Author: Tianfeng Han  <mikan.tenny@gmail.com>                        |
+ +----------------------------------------------------------------------+
+ */
+
+#include "swoole.h"
+#include "io_uring.h"
+
+#ifdef HAVE_IO_URING
+#include <sys/syscall.h>
+#include <sys/mman.h>
+
+static sw_inline int sw_io_uring_setup(uint32_t entries, struct io_uring_params *p)
+{
+    return (int) syscall(__NR_io_uring_setup, entries, p);
+}
+
+static sw_inline int sw_io_uring_enter(int fd, uint32_t to_submit, uint32_t min_complete, uint32_t flags, void *arg, size_t argsz)
+{
+    return (int) syscall(__NR_io_uring_enter, fd, to_submit, min_complete, flags, arg, argsz);
+}
+
+static void swIouring_unmap(swIouring *ring)
+{
+    if (ring->sqes && ring->sqes != MAP_FAILED)
+    {
+        munmap(ring->sqes, ring->sqes_size);
+    }
+    if (ring->cq_ring && ring->cq_ring != MAP_FAILED && ring->cq_ring != ring->sq_ring)
+    {
+        munmap(ring->cq_ring, ring->cq_ring_size);
+    }
+    if (ring->sq_ring && ring->sq_ring != MAP_FAILED)
+    {
+        munmap(ring->sq_ring, ring->sq_ring_size);
+    }
+}
+
+int swIouring_create(swIouring *ring, uint32_t entries)
+{
+    struct io_uring_params params;
+    bzero(&params, sizeof(params));
+    bzero(ring, sizeof(swIouring));
+
+    ring->ring_fd = sw_io_uring_setup(entries, &params);
+    if (ring->ring_fd < 0)
+    {
+        swSysWarn("io_uring_setup(%u) failed", entries);
+        return SW_ERR;
+    }
+    ring->features = params.features;
+
+    ring->sq_ring_size = params.sq_off.array + params.sq_entries * sizeof(uint32_t);
+    ring->cq_ring_size = params.cq_off.cqes + params.cq_entries * sizeof(struct io_uring_cqe);
+    ring->sqes_size = params.sq_entries * sizeof(struct io_uring_sqe);
+
+    if (params.features & IORING_FEAT_SINGLE_MMAP)
+    {
+        ring->sq_ring_size = ring->cq_ring_size = SW_MAX(ring->sq_ring_size, ring->cq_ring_size);
+    }
+
+    ring->sq_ring = mmap(NULL, ring->sq_ring_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+            ring->ring_fd, IORING_OFF_SQ_RING);
+    if (ring->sq_ring == MAP_FAILED)
+    {
+        swSysWarn("mmap(IORING_OFF_SQ_RING) failed");
+        goto _error;
+    }
+    if (params.features & IORING_FEAT_SINGLE_MMAP)
+    {
+        ring->cq_ring = ring->sq_ring;
+    }
+    else
+    {
+        ring->cq_ring = mmap(NULL, ring->cq_ring_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                ring->ring_fd, IORING_OFF_CQ_RING);
+        if (ring->cq_ring == MAP_FAILED)
+        {
+            swSysWarn("mmap(IORING_OFF_CQ_RING) failed");
+            goto _error;
+        }
+    }
+    ring->sqes = (struct io_uring_sqe *) mmap(NULL, ring->sqes_size, PROT_READ | PROT_WRITE,
+            MAP_SHARED | MAP_POPULATE, ring->ring_fd, IORING_OFF_SQES);
+    if (ring->sqes == MAP_FAILED)
+    {
+        swSysWarn("mmap(IORING_OFF_SQES) failed");
+        goto _error;
+    }
+
+    ring->sq_head = (uint32_t *) ((char *) ring->sq_ring + params.sq_off.head);
+    ring->sq_tail = (uint32_t *) ((char *) ring->sq_ring + params.sq_off.tail);
+    ring->sq_mask = (uint32_t *) ((char *) ring->sq_ring + params.sq_off.ring_mask);
+    ring->sq_array = (uint32_t *) ((char *) ring->sq_ring + params.sq_off.array);
+    ring->sq_entries = params.sq_entries;
+
+    ring->cq_head = (uint32_t *) ((char *) ring->cq_ring + params.cq_off.head);
+    ring->cq_tail = (uint32_t *) ((char *) ring->cq_ring + params.cq_off.tail);
+    ring->cq_mask = (uint32_t *) ((char *) ring->cq_ring + params.cq_off.ring_mask);
+    ring->cqes = (struct io_uring_cqe *) ((char *) ring->cq_ring + params.cq_off.cqes);
+
+    return SW_OK;
+
+    _error:
+    swIouring_unmap(ring);
+    close(ring->ring_fd);
+    ring->ring_fd = -1;
+    return SW_ERR;
+}
+
+void swIouring_free(swIouring *ring)
+{
+    swIouring_unmap(ring);
+    close(ring->ring_fd);
+    ring->ring_fd = -1;
+}
+
+/**
+ * flush the pending submissions, and wait for min_complete completions at most timeout_msec (-1 means forever)
+ */
+int swIouring_submit(swIouring *ring, uint32_t min_complete, int timeout_msec)
+{
+    uint32_t flags = 0;
+    struct __kernel_timespec ts;
+    struct io_uring_getevents_arg arg;
+
+    if (min_complete > 0)
+    {
+        flags |= IORING_ENTER_GETEVENTS;
+        if (timeout_msec >= 0)
+        {
+            ts.tv_sec = timeout_msec / 1000;
+            ts.tv_nsec = (timeout_msec % 1000) * 1000 * 1000;
+            bzero(&arg, sizeof(arg));
+            arg.ts = (uint64_t) (uintptr_t) &ts;
+            flags |= IORING_ENTER_EXT_ARG;
+        }
+    }
+
+    int ret = sw_io_uring_enter(ring->ring_fd, ring->sq_pending, min_complete, flags,
+            (flags & IORING_ENTER_EXT_ARG) ? &arg : NULL, (flags & IORING_ENTER_EXT_ARG) ? sizeof(arg) : 0);
+    if (ret > 0)
+    {
+        ring->sq_pending -= SW_MIN((uint32_t) ret, ring->sq_pending);
+    }
+    return ret;
+}
+
+int swIouring_register(swIouring *ring, uint32_t opcode, void *arg, uint32_t nr_args)
+{
+    return (int) syscall(__NR_io_uring_register, ring->ring_fd, opcode, arg, nr_args);
+}
+
+/**
+ * a zeroed sqe at the tail of the submission queue, NULL if the queue is still full after flushing it
+ */
+struct io_uring_sqe* swIouring_get_sqe(swIouring *ring)
+{
+    uint32_t tail = *ring->sq_tail;
+    uint32_t head = __atomic_load_n(ring->sq_head, __ATOMIC_ACQUIRE);
+
+    if (tail - head >= ring->sq_entries)
+    {
+        /**
+         * submission queue is full, flush it without waiting for completions
+         */
+        if (swIouring_submit(ring, 0, 0) < 0)
+        {
+            swSysWarn("io_uring_enter failed");
+            return NULL;
+        }
+        head = __atomic_load_n(ring->sq_head, __ATOMIC_ACQUIRE);
+        if (tail - head >= ring->sq_entries)
+        {
+            return NULL;
+        }
+    }
+
+    uint32_t index = tail & *ring->sq_mask;
+    struct io_uring_sqe *sqe = &ring->sqes[index];
+    bzero(sqe, sizeof(*sqe));
+    ring->sq_array[index] = index;
+    __atomic_store_n(ring->sq_tail, tail + 1, __ATOMIC_RELEASE);
+    ring->sq_pending++;
+
+    return sqe;
+}
+
+#endif
@@ -19,6 +19,7 @@
 #include "websocket.h"
 #include "static_handler.h"
 #include "swoole_cxx.h"
+#include "thirdparty/swoole_http_parser.h"
 
 #include <assert.h>
 #include <stddef.h>
@@ -36,6 +37,7 @@ static const char *method_strings[] =
 };
 
 string swHttpRequest_get_date_if_modified_since(swHttpRequest *request);
+string swHttpRequest_get_header(swHttpRequest *request, const char *name, size_t name_length);
 
 int swHttp_get_method(const char *method_str, size_t method_len)
 {
@@ -92,21 +94,57 @@ int swServer_http_static_handler_hit(swServer *serv, swHttpRequest *request, swC
         return true;
     }
 
+    /**
+     * the precompressed variant of the file
+     */
+    char encoding_header[64] = "";
+    if (serv->http_compression && !handler.is_dir())
+    {
+        if (handler.set_encoding(swHttpRequest_get_header(request, SW_STRL("Accept-Encoding"))))
+        {
+            sw_snprintf(
+                encoding_header, sizeof(encoding_header), "Content-Encoding: %s\r\nVary: Accept-Encoding\r\n",
+                handler.get_content_encoding()
+            );
+        }
+        else
+        {
+            sw_snprintf(encoding_header, sizeof(encoding_header), "Vary: Accept-Encoding\r\n");
+        }
+    }
+
     auto date_str = handler.get_date();
     auto date_str_last_modified = handler.get_date_last_modified();
 
-    string date_if_modified_since = swHttpRequest_get_date_if_modified_since(request);
-    if (!date_if_modified_since.empty() && handler.is_modified(date_if_modified_since))
+    /**
+     * If-None-Match takes precedence over If-Modified-Since
+     */
+    bool not_modified;
+    string if_none_match = swHttpRequest_get_header(request, SW_STRL("If-None-Match"));
+    if (!if_none_match.empty())
+    {
+        not_modified = handler.is_etag_matched(if_none_match);
+    }
+    else
+    {
+        string date_if_modified_since = swHttpRequest_get_date_if_modified_since(request);
+        not_modified = !date_if_modified_since.empty() && handler.is_modified(date_if_modified_since);
+    }
+    if (not_modified)
     {
         response.info.len = sw_snprintf(header_buffer, sizeof(header_buffer),
             "HTTP/1.1 304 Not Modified\r\n"
             "%s"
+            "%s"
             "Date: %s\r\n"
             "Last-Modified: %s\r\n"
+            "ETag: %s\r\n"
             "Server: %s\r\n\r\n",
             request->keep_alive ? "Connection: keep-alive\r\n" : "",
+            encoding_header,
             date_str.c_str(),
             date_str_last_modified.c_str(),
+            handler.get_etag().c_str(),
             SW_HTTP_SERVER_SOFTWARE
         );
         response.data = header_buffer;
@@ -172,19 +210,55 @@ int swServer_http_static_handler_hit(swServer *serv, swHttpRequest *request, swC
         return true;
     }
 
+    if (request->method == SW_HTTP_GET)
+    {
+        handler.parse_range(
+            swHttpRequest_get_header(request, SW_STRL("Range")),
+            swHttpRequest_get_header(request, SW_STRL("If-Range"))
+        );
+    }
+
+    auto &ranges = handler.get_ranges();
+    char content_range[128] = "";
+    string content_type = handler.get_mimetype();
+
+    if (handler.status_code == SW_HTTP_RANGE_NOT_SATISFIABLE)
+    {
+        sw_snprintf(content_range, sizeof(content_range), "Content-Range: bytes */%ld\r\n", (long) handler.get_filesize());
+    }
+    else if (handler.status_code == SW_HTTP_PARTIAL_CONTENT && ranges.size() == 1)
+    {
+        sw_snprintf(
+            content_range, sizeof(content_range), "Content-Range: bytes %ld-%ld/%ld\r\n",
+            (long) ranges[0].offset, (long) (ranges[0].offset + ranges[0].length - 1), (long) handler.get_filesize()
+        );
+    }
+    else if (handler.status_code == SW_HTTP_PARTIAL_CONTENT)
+    {
+        content_type = string("multipart/byteranges; boundary=") + handler.get_boundary();
+    }
+
     response.info.len = sw_snprintf(header_buffer, sizeof(header_buffer),
-        "HTTP/1.1 200 OK\r\n"
+        "HTTP/1.1 %s\r\n"
         "%s"
+        "Accept-Ranges: bytes\r\n"
         "Content-Length: %ld\r\n"
         "Content-Type: %s\r\n"
+        "%s"
+        "%s"
         "Date: %s\r\n"
         "Last-Modified: %s\r\n"
+        "ETag: %s\r\n"
         "Server: %s\r\n\r\n",
+        swHttp_get_status_message(handler.status_code),
         request->keep_alive ?"Connection: keep-alive\r\n" : "",
-        (long) task->length,
-        handler.get_mimetype(),
+        handler.status_code == SW_HTTP_RANGE_NOT_SATISFIABLE ? 0 : (long) handler.get_content_length(),
+        content_type.c_str(),
+        content_range,
+        encoding_header,
         date_str.c_str(),
-        date_str_last_modified.c_str(),
+        handler.get_date_last_modified().c_str(),
+        handler.get_etag().c_str(),
         SW_HTTP_SERVER_SOFTWARE
     );
 
@@ -202,10 +276,39 @@ int swServer_http_static_handler_hit(swServer *serv, swHttpRequest *request, swC
 #endif
     swServer_master_send(serv, &response);
 
-    if (task->length != 0)
+    if (handler.status_code == SW_HTTP_PARTIAL_CONTENT)
+    {
+        /**
+         * send the exact byte ranges of the file, separated by the part headers when there are many
+         */
+        for (auto &range : ranges)
+        {
+            if (ranges.size() > 1)
+            {
+                string part_header = handler.get_part_header(range);
+                response.info.type = SW_SERVER_EVENT_SEND_DATA;
+                response.info.len = part_header.length();
+                response.data = (char *) part_header.c_str();
+                swServer_master_send(serv, &response);
+            }
+            task = handler.get_task(range);
+            response.info.type = SW_SERVER_EVENT_SEND_FILE;
+            response.info.len = sizeof(swSendFile_request) + handler.get_filename_length() + 1;
+            response.data = (char *) task;
+            swServer_master_send(serv, &response);
+        }
+        if (ranges.size() > 1)
+        {
+            response.info.type = SW_SERVER_EVENT_SEND_DATA;
+            response.info.len = sw_snprintf(header_buffer, sizeof(header_buffer), "\r\n--%s--\r\n", handler.get_boundary());
+            response.data = header_buffer;
+            swServer_master_send(serv, &response);
+        }
+    }
+    else if (handler.status_code == SW_HTTP_OK && task->length != 0)
     {
         response.info.type = SW_SERVER_EVENT_SEND_FILE;
-        response.info.len = sizeof(swSendFile_request) + task->length + 1;
+        response.info.len = sizeof(swSendFile_request) + handler.get_filename_length() + 1;
         response.data = (char *) task;
 
         swServer_master_send(serv, &response);
@@ -680,21 +783,23 @@ void swHttpRequest_parse_header_info(swHttpRequest *request)
     }
 }
 
-#ifdef SW_HTTP_100_CONTINUE
+/**
+ * only the head is searched once its length is known
+ */
 int swHttpRequest_has_expect_header(swHttpRequest *request)
 {
     swString *buffer = request->buffer;
     //char *buf = buffer->str + buffer->offset;
     char *buf = buffer->str;
     //int len = buffer->length - buffer->offset;
-    int len = buffer->length;
+    int len = request->header_length > 0 ? SW_MIN(buffer->length, request->header_length) : buffer->length;
 
     char *pe = buf + len;
     char *p;
 
     for (p = buf; p < pe; p++)
     {
-        if (*p == '\r' && pe - p > sizeof("\r\nExpect"))
+        if (*p == '\r' && pe - p > (ssize_t) sizeof("\r\nExpect"))
         {
             p += 2;
             if (SW_STRCASECT(p, pe - p, "Expect: "))
@@ -717,7 +822,6 @@ int swHttpRequest_has_expect_header(swHttpRequest *request)
     }
     return 0;
 }
-#endif
 
 int swHttpRequest_get_header_length(swHttpRequest *request)
 {
@@ -778,6 +882,206 @@ int swHttpRequest_get_chunked_body_length(swHttpRequest *request)
     return SW_OK;
 }
 
+struct http_layout_context
+{
+    const char *data;
+    swString *layout;
+    bool failed;
+    bool has_body;
+    bool has_field;
+    bool completed;
+};
+
+static inline swHttpRequestLayout* http_layout_get(swoole_http_parser *parser)
+{
+    http_layout_context *ctx = (http_layout_context *) parser->data;
+    return (swHttpRequestLayout *) ctx->layout->str;
+}
+
+static inline bool http_layout_set(swoole_http_parser *parser, uint16_t *offset, uint16_t *length, const char *at, size_t n)
+{
+    http_layout_context *ctx = (http_layout_context *) parser->data;
+    if ((size_t) (at - ctx->data) + n > UINT16_MAX)
+    {
+        ctx->failed = true;
+        return false;
+    }
+    *offset = at - ctx->data;
+    *length = n;
+    return true;
+}
+
+static int http_layout_on_path(swoole_http_parser *parser, const char *at, size_t length)
+{
+    swHttpRequestLayout *layout = http_layout_get(parser);
+    return http_layout_set(parser, &layout->path_offset, &layout->path_length, at, length) ? 0 : -1;
+}
+
+static int http_layout_on_query_string(swoole_http_parser *parser, const char *at, size_t length)
+{
+    swHttpRequestLayout *layout = http_layout_get(parser);
+    return http_layout_set(parser, &layout->query_string_offset, &layout->query_string_length, at, length) ? 0 : -1;
+}
+
+static int http_layout_on_header_field(swoole_http_parser *parser, const char *at, size_t length)
+{
+    http_layout_context *ctx = (http_layout_context *) parser->data;
+    swHttpRequestLayout *layout = http_layout_get(parser);
+    if (ctx->has_field || layout->header_num == SW_HTTP_LAYOUT_MAX_HEADERS)
+    {
+        ctx->failed = true;
+        return -1;
+    }
+    swHttpHeaderLayout header = {};
+    if (swString_append_ptr(ctx->layout, (char *) &header, sizeof(header)) < 0)
+    {
+        ctx->failed = true;
+        return -1;
+    }
+    layout = http_layout_get(parser);
+    ctx->has_field = true;
+    return http_layout_set(parser, &layout->headers[layout->header_num].name_offset,
+            &layout->headers[layout->header_num].name_length, at, length) ? 0 : -1;
+}
+
+static int http_layout_on_header_value(swoole_http_parser *parser, const char *at, size_t length)
+{
+    http_layout_context *ctx = (http_layout_context *) parser->data;
+    swHttpRequestLayout *layout = http_layout_get(parser);
+    if (!ctx->has_field)
+    {
+        ctx->failed = true;
+        return -1;
+    }
+    ctx->has_field = false;
+    if (!http_layout_set(parser, &layout->headers[layout->header_num].value_offset,
+            &layout->headers[layout->header_num].value_length, at, length))
+    {
+        return -1;
+    }
+    layout->header_num++;
+    return 0;
+}
+
+static int http_layout_on_headers_complete(swoole_http_parser *parser)
+{
+    swHttpRequestLayout *layout = http_layout_get(parser);
+    layout->method = parser->method;
+    layout->http_major = parser->http_major;
+    layout->http_minor = parser->http_minor;
+    layout->keep_alive = swoole_http_should_keep_alive(parser);
+    return 0;
+}
+
+static int http_layout_on_body(swoole_http_parser *parser, const char *at, size_t length)
+{
+    http_layout_context *ctx = (http_layout_context *) parser->data;
+    swHttpRequestLayout *layout = http_layout_get(parser);
+    // the chunks of a chunked body are not contiguous
+    if (ctx->has_body)
+    {
+        ctx->failed = true;
+        return -1;
+    }
+    ctx->has_body = true;
+    layout->body_offset = at - ctx->data;
+    layout->body_length = length;
+    return 0;
+}
+
+static int http_layout_on_message_complete(swoole_http_parser *parser)
+{
+    http_layout_context *ctx = (http_layout_context *) parser->data;
+    ctx->completed = true;
+    return 1;
+}
+
+static const swoole_http_parser_settings http_layout_parser_settings =
+{
+    nullptr,
+    http_layout_on_path,
+    http_layout_on_query_string,
+    nullptr,
+    nullptr,
+    http_layout_on_header_field,
+    http_layout_on_header_value,
+    http_layout_on_headers_complete,
+    http_layout_on_body,
+    http_layout_on_message_complete,
+};
+
+/**
+ * parse the request in the reactor, so the worker builds the request from the offsets without parsing it again,
+ * SW_ERR is returned when the request is invalid or it can not be described by a layout (chunked body, too many headers)
+ */
+int swHttpRequest_get_layout(const char *data, size_t length, swString *layout)
+{
+    swoole_http_parser parser;
+    http_layout_context ctx = {};
+
+    swString_clear(layout);
+    if (swString_extend_align(layout, sizeof(swHttpRequestLayout)) < 0)
+    {
+        return SW_ERR;
+    }
+    bzero(layout->str, sizeof(swHttpRequestLayout));
+    layout->length = sizeof(swHttpRequestLayout);
+
+    ctx.data = data;
+    ctx.layout = layout;
+    swoole_http_parser_init(&parser, PHP_HTTP_REQUEST);
+    parser.data = &ctx;
+
+    swoole_http_parser_execute(&parser, &http_layout_parser_settings, data, length);
+    if (ctx.failed || !ctx.completed)
+    {
+        return SW_ERR;
+    }
+
+    swHttpRequestLayout *_layout = (swHttpRequestLayout *) layout->str;
+    _layout->size = layout->length;
+    return SW_OK;
+}
+
+/**
+ * the value of the first header field with the name, without the leading and the trailing spaces
+ */
+string swHttpRequest_get_header(swHttpRequest *request, const char *name, size_t name_length)
+{
+    char *buffer = request->buffer->str;
+    char *p = buffer + request->request_line_length + (sizeof("\r\n") - 1);
+    char *pe = buffer + request->header_length - (sizeof("\r\n") - 1);
+
+    for (; p < pe; p++)
+    {
+        if (*(p - 1) != '\n' || *(p - 2) != '\r')
+        {
+            continue;
+        }
+        if ((size_t) (pe - p) <= name_length || p[name_length] != ':' || strncasecmp(p, name, name_length) != 0)
+        {
+            continue;
+        }
+        p += name_length + 1;
+        while (p < pe && (*p == ' ' || *p == '\t'))
+        {
+            p++;
+        }
+        char *value = p;
+        while (p < pe && *p != '\r')
+        {
+            p++;
+        }
+        while (p > value && (*(p - 1) == ' ' || *(p - 1) == '\t'))
+        {
+            p--;
+        }
+        return string(value, p - value);
+    }
+
+    return string("");
+}
+
 string swHttpRequest_get_date_if_modified_since(swHttpRequest *request)
 {
     char *p = request->buffer->str + request->url_offset + request->url_length + 10;
@@ -34,6 +34,7 @@ static pthread_mutex_t *lock_array;
 
 static const SSL_METHOD *swSSL_get_method(int method);
 static int swSSL_verify_callback(int ok, X509_STORE_CTX *x509_store);
+static sw_inline void swSSL_connection_error(swSocket *conn);
 #ifndef OPENSSL_NO_RSA
 static RSA* swSSL_rsa_key_callback(SSL *ssl, int is_export, int key_length);
 #endif
@@ -448,6 +449,13 @@ SSL_CTX* swSSL_get_context(swSSL_option *option)
     }
 #endif
 
+#ifdef SW_SSL_KTLS
+    if (!option->disable_ktls)
+    {
+        SSL_CTX_set_options(ssl_context, SSL_OP_ENABLE_KTLS);
+    }
+#endif
+
 #ifdef SSL_MODE_RELEASE_BUFFERS
     SSL_CTX_set_mode(ssl_context, SSL_MODE_RELEASE_BUFFERS);
 #endif
@@ -913,6 +921,19 @@ int swSSL_get_peer_cert(SSL *ssl, char *buffer, size_t length)
     return SW_ERR;
 }
 
+/**
+ * OpenSSL hands the keys to the kernel at the end of the handshake if the cipher is supported
+ */
+static sw_inline void swSSL_check_ktls(swSocket *conn)
+{
+#ifdef SW_SSL_KTLS
+    conn->ssl_ktls_send = BIO_get_ktls_send(SSL_get_wbio(conn->ssl)) ? 1 : 0;
+    conn->ssl_ktls_recv = BIO_get_ktls_recv(SSL_get_rbio(conn->ssl)) ? 1 : 0;
+    swTraceLog(SW_TRACE_SSL, "fd=%d, cipher=%s, ktls_send=%d, ktls_recv=%d", conn->fd,
+            SSL_get_cipher_name(conn->ssl), conn->ssl_ktls_send, conn->ssl_ktls_recv);
+#endif
+}
+
 enum swReturn_code swSSL_accept(swSocket *conn)
 {
     swSSL_clear_error(conn);
@@ -924,6 +945,7 @@ enum swReturn_code swSSL_accept(swSocket *conn)
     if (n == 1)
     {
         conn->ssl_state = SW_SSL_STATE_READY;
+        swSSL_check_ktls(conn);
 #if OPENSSL_VERSION_NUMBER < 0x10100000L
 #ifdef SSL3_FLAGS_NO_RENEGOTIATE_CIPHERS
         if (conn->ssl->s3)
@@ -991,6 +1013,7 @@ int swSSL_connect(swSocket *conn)
     if (n == 1)
     {
         conn->ssl_state = SW_SSL_STATE_READY;
+        swSSL_check_ktls(conn);
 
 #ifdef SW_LOG_TRACE_OPEN
         const char *ssl_version = SSL_get_version(conn->ssl);
@@ -1039,6 +1062,35 @@ int swSSL_connect(swSocket *conn)
 
 int swSSL_sendfile(swSocket *conn, int fd, off_t *offset, size_t size)
 {
+#ifdef SW_SSL_KTLS
+    /**
+     * the kernel encrypts the pages of the file, nothing is copied to user space
+     */
+    if (conn->ssl_ktls_send)
+    {
+        swSSL_clear_error(conn);
+        ossl_ssize_t n = SSL_sendfile(conn->ssl, fd, *offset, size, 0);
+        if (n >= 0)
+        {
+            *offset += n;
+            swTraceLog(SW_TRACE_REACTOR, "fd=%d, size=%lu, n=%ld", fd, size, (long) n);
+            return n;
+        }
+        int _errno = SSL_get_error(conn->ssl, n);
+        if (_errno == SSL_ERROR_WANT_WRITE)
+        {
+            conn->ssl_want_write = 1;
+            errno = EAGAIN;
+        }
+        else if (_errno != SSL_ERROR_SYSCALL)
+        {
+            swSSL_connection_error(conn);
+            errno = SW_ERROR_SSL_BAD_CLIENT;
+        }
+        return SW_ERR;
+    }
+#endif
+
     char buf[SW_BUFFER_SIZE_BIG];
     int readn = size > sizeof(buf) ? sizeof(buf) : size;
 
@@ -18,6 +18,17 @@
 #include "server.h"
 #include "websocket.h"
 
+#if defined(__x86_64__) && defined(__GNUC__)
+#define SW_WEBSOCKET_SIMD 1
+#define SW_SSSE3_TARGET __attribute__((target("ssse3")))
+#define SW_AVX2_TARGET __attribute__((target("avx2")))
+#include <immintrin.h>
+#endif
+
+static int swWebSocket_simd_detect();
+
+static int simd_level = swWebSocket_simd_detect();
+
 static inline uint16_t swWebSocket_get_ext_flags(uchar opcode, uchar flags)
 {
     uint16_t ext_flags = opcode;
@@ -99,7 +110,31 @@ ssize_t swWebSocket_get_package_length(swProtocol *protocol, swSocket *conn, cha
     return header_length + payload_length;
 }
 
-static sw_inline void swWebSocket_mask(char *data, size_t len, const char *mask_key)
+static int swWebSocket_simd_detect()
+{
+#ifdef SW_WEBSOCKET_SIMD
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2"))
+    {
+        return SW_WEBSOCKET_SIMD_AVX2;
+    }
+    return SW_WEBSOCKET_SIMD_SSE2;
+#else
+    return SW_WEBSOCKET_SIMD_NONE;
+#endif
+}
+
+/**
+ * for the tests and the benchmarks, a level which is not supported by the CPU is lowered
+ */
+int swWebSocket_set_simd_level(int level)
+{
+    int supported = swWebSocket_simd_detect();
+    simd_level = level > supported ? supported : level;
+    return simd_level;
+}
+
+static sw_inline void swWebSocket_mask_scalar(char *data, size_t len, const char *mask_key)
 {
     size_t n = len / 8;
     uint64_t mask_key64 = ((uint64_t) (*((uint32_t *) mask_key)) << 32) | *((uint32_t *) mask_key);
@@ -116,6 +151,379 @@ static sw_inline void swWebSocket_mask(char *data, size_t len, const char *mask_
     }
 }
 
+#ifdef SW_WEBSOCKET_SIMD
+/**
+ * the vector widths are multiples of the key length, so the rest starts with the first byte of the key
+ */
+static void swWebSocket_mask_sse2(char *data, size_t len, const char *mask_key)
+{
+    __m128i key = _mm_set1_epi32(*((int32_t *) mask_key));
+    size_t i = 0;
+
+    for (; i + 64 <= len; i += 64)
+    {
+        __m128i *p = (__m128i *) (data + i);
+        _mm_storeu_si128(p, _mm_xor_si128(_mm_loadu_si128(p), key));
+        _mm_storeu_si128(p + 1, _mm_xor_si128(_mm_loadu_si128(p + 1), key));
+        _mm_storeu_si128(p + 2, _mm_xor_si128(_mm_loadu_si128(p + 2), key));
+        _mm_storeu_si128(p + 3, _mm_xor_si128(_mm_loadu_si128(p + 3), key));
+    }
+    for (; i + 16 <= len; i += 16)
+    {
+        __m128i *p = (__m128i *) (data + i);
+        _mm_storeu_si128(p, _mm_xor_si128(_mm_loadu_si128(p), key));
+    }
+    swWebSocket_mask_scalar(data + i, len - i, mask_key);
+}
+
+SW_AVX2_TARGET static void swWebSocket_mask_avx2(char *data, size_t len, const char *mask_key)
+{
+    __m256i key = _mm256_set1_epi32(*((int32_t *) mask_key));
+    size_t i = 0;
+
+    for (; i + 128 <= len; i += 128)
+    {
+        __m256i *p = (__m256i *) (data + i);
+        _mm256_storeu_si256(p, _mm256_xor_si256(_mm256_loadu_si256(p), key));
+        _mm256_storeu_si256(p + 1, _mm256_xor_si256(_mm256_loadu_si256(p + 1), key));
+        _mm256_storeu_si256(p + 2, _mm256_xor_si256(_mm256_loadu_si256(p + 2), key));
+        _mm256_storeu_si256(p + 3, _mm256_xor_si256(_mm256_loadu_si256(p + 3), key));
+    }
+    for (; i + 32 <= len; i += 32)
+    {
+        __m256i *p = (__m256i *) (data + i);
+        _mm256_storeu_si256(p, _mm256_xor_si256(_mm256_loadu_si256(p), key));
+    }
+    swWebSocket_mask_sse2(data + i, len - i, mask_key);
+}
+#endif
+
+void swWebSocket_mask(char *data, size_t len, const char *mask_key)
+{
+#ifdef SW_WEBSOCKET_SIMD
+    if (simd_level == SW_WEBSOCKET_SIMD_AVX2)
+    {
+        swWebSocket_mask_avx2(data, len, mask_key);
+        return;
+    }
+    else if (simd_level == SW_WEBSOCKET_SIMD_SSE2)
+    {
+        swWebSocket_mask_sse2(data, len, mask_key);
+        return;
+    }
+#endif
+    swWebSocket_mask_scalar(data, len, mask_key);
+}
+
+/**
+ * checks one character starting at data[i] (RFC 3629), returns the offset of the next one, or 0 if invalid
+ */
+static sw_inline size_t swWebSocket_utf8_next(const uchar *data, size_t len, size_t i)
+{
+    uchar c = data[i];
+    uchar lower = 0x80, upper = 0xbf;
+    size_t n;
+
+    if (c < 0x80)
+    {
+        return i + 1;
+    }
+    else if (c >= 0xc2 && c <= 0xdf)
+    {
+        n = 1;
+    }
+    else if (c >= 0xe0 && c <= 0xef)
+    {
+        n = 2;
+        // overlong forms and surrogates
+        if (c == 0xe0)
+        {
+            lower = 0xa0;
+        }
+        else if (c == 0xed)
+        {
+            upper = 0x9f;
+        }
+    }
+    else if (c >= 0xf0 && c <= 0xf4)
+    {
+        n = 3;
+        // overlong forms and code points above U+10FFFF
+        if (c == 0xf0)
+        {
+            lower = 0x90;
+        }
+        else if (c == 0xf4)
+        {
+            upper = 0x8f;
+        }
+    }
+    else
+    {
+        return 0;
+    }
+
+    if (len - i - 1 < n || data[i + 1] < lower || data[i + 1] > upper)
+    {
+        return 0;
+    }
+    for (size_t k = 2; k <= n; k++)
+    {
+        if ((data[i + k] & 0xc0) != 0x80)
+        {
+            return 0;
+        }
+    }
+    return i + n + 1;
+}
+
+static bool swWebSocket_validate_utf8_scalar(const uchar *data, size_t len, size_t i)
+{
+    while (i < len)
+    {
+        if (i + 8 <= len && (*((uint64_t *) (data + i)) & 0x8080808080808080ULL) == 0)
+        {
+            i += 8;
+            continue;
+        }
+        i = swWebSocket_utf8_next(data, len, i);
+        if (i == 0)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+#ifdef SW_WEBSOCKET_SIMD
+/**
+ * the lookup algorithm of "Validating UTF-8 In Less Than One Instruction Per Byte" (Keiser, Lemire),
+ * the errors of each pair of bytes are found with three table lookups
+ */
+#define SW_UTF8_TOO_SHORT       (1 << 0)
+#define SW_UTF8_TOO_LONG        (1 << 1)
+#define SW_UTF8_OVERLONG_3      (1 << 2)
+#define SW_UTF8_TOO_LARGE       (1 << 3)
+#define SW_UTF8_SURROGATE       (1 << 4)
+#define SW_UTF8_OVERLONG_2      (1 << 5)
+#define SW_UTF8_TOO_LARGE_1000  (1 << 6)
+#define SW_UTF8_OVERLONG_4      (1 << 6)
+#define SW_UTF8_TWO_CONTS       (1 << 7)
+#define SW_UTF8_CARRY           (SW_UTF8_TOO_SHORT | SW_UTF8_TOO_LONG | SW_UTF8_TWO_CONTS)
+
+/**
+ * indexed by the high nibble of the first byte
+ */
+#define SW_UTF8_BYTE_1_HIGH \
+    /* 0_______ ________ <ASCII in byte 1> */ \
+    SW_UTF8_TOO_LONG, SW_UTF8_TOO_LONG, SW_UTF8_TOO_LONG, SW_UTF8_TOO_LONG, \
+    SW_UTF8_TOO_LONG, SW_UTF8_TOO_LONG, SW_UTF8_TOO_LONG, SW_UTF8_TOO_LONG, \
+    /* 10______ ________ <continuation in byte 1> */ \
+    SW_UTF8_TWO_CONTS, SW_UTF8_TWO_CONTS, SW_UTF8_TWO_CONTS, SW_UTF8_TWO_CONTS, \
+    /* 1100____ ________ <two byte lead in byte 1> */ \
+    SW_UTF8_TOO_SHORT | SW_UTF8_OVERLONG_2, \
+    /* 1101____ ________ <two byte lead in byte 1> */ \
+    SW_UTF8_TOO_SHORT, \
+    /* 1110____ ________ <three byte lead in byte 1> */ \
+    SW_UTF8_TOO_SHORT | SW_UTF8_OVERLONG_3 | SW_UTF8_SURROGATE, \
+    /* 1111____ ________ <four+ byte lead in byte 1> */ \
+    SW_UTF8_TOO_SHORT | SW_UTF8_TOO_LARGE | SW_UTF8_TOO_LARGE_1000 | SW_UTF8_OVERLONG_4
+
+/**
+ * indexed by the low nibble of the first byte
+ */
+#define SW_UTF8_BYTE_1_LOW \
+    /* ____0000 ________ */ \
+    SW_UTF8_CARRY | SW_UTF8_OVERLONG_3 | SW_UTF8_OVERLONG_2 | SW_UTF8_OVERLONG_4, \
+    /* ____0001 ________ */ \
+    SW_UTF8_CARRY | SW_UTF8_OVERLONG_2, \
+    /* ____001_ ________ */ \
+    SW_UTF8_CARRY, \
+    SW_UTF8_CARRY, \
+    /* ____0100 ________ */ \
+    SW_UTF8_CARRY | SW_UTF8_TOO_LARGE, \
+    /* ____0101 ________ */ \
+    SW_UTF8_CARRY | SW_UTF8_TOO_LARGE | SW_UTF8_TOO_LARGE_1000, \
+    /* ____011_ ________ */ \
+    SW_UTF8_CARRY | SW_UTF8_TOO_LARGE | SW_UTF8_TOO_LARGE_1000, \
+    SW_UTF8_CARRY | SW_UTF8_TOO_LARGE | SW_UTF8_TOO_LARGE_1000, \
+    /* ____1___ ________ */ \
+    SW_UTF8_CARRY | SW_UTF8_TOO_LARGE | SW_UTF8_TOO_LARGE_1000, \
+    SW_UTF8_CARRY | SW_UTF8_TOO_LARGE | SW_UTF8_TOO_LARGE_1000, \
+    SW_UTF8_CARRY | SW_UTF8_TOO_LARGE | SW_UTF8_TOO_LARGE_1000, \
+    SW_UTF8_CARRY | SW_UTF8_TOO_LARGE | SW_UTF8_TOO_LARGE_1000, \
+    SW_UTF8_CARRY | SW_UTF8_TOO_LARGE | SW_UTF8_TOO_LARGE_1000, \
+    /* ____1101 ________ */ \
+    SW_UTF8_CARRY | SW_UTF8_TOO_LARGE | SW_UTF8_TOO_LARGE_1000 | SW_UTF8_SURROGATE, \
+    SW_UTF8_CARRY | SW_UTF8_TOO_LARGE | SW_UTF8_TOO_LARGE_1000, \
+    SW_UTF8_CARRY | SW_UTF8_TOO_LARGE | SW_UTF8_TOO_LARGE_1000
+
+/**
+ * indexed by the high nibble of the second byte
+ */
+#define SW_UTF8_BYTE_2_HIGH \
+    /* ________ 0_______ <ASCII in byte 2> */ \
+    SW_UTF8_TOO_SHORT, SW_UTF8_TOO_SHORT, SW_UTF8_TOO_SHORT, SW_UTF8_TOO_SHORT, \
+    SW_UTF8_TOO_SHORT, SW_UTF8_TOO_SHORT, SW_UTF8_TOO_SHORT, SW_UTF8_TOO_SHORT, \
+    /* ________ 1000____ */ \
+    SW_UTF8_TOO_LONG | SW_UTF8_OVERLONG_2 | SW_UTF8_TWO_CONTS | SW_UTF8_OVERLONG_3 | SW_UTF8_TOO_LARGE_1000 | SW_UTF8_OVERLONG_4, \
+    /* ________ 1001____ */ \
+    SW_UTF8_TOO_LONG | SW_UTF8_OVERLONG_2 | SW_UTF8_TWO_CONTS | SW_UTF8_OVERLONG_3 | SW_UTF8_TOO_LARGE, \
+    /* ________ 101_____ */ \
+    SW_UTF8_TOO_LONG | SW_UTF8_OVERLONG_2 | SW_UTF8_TWO_CONTS | SW_UTF8_SURROGATE | SW_UTF8_TOO_LARGE, \
+    SW_UTF8_TOO_LONG | SW_UTF8_OVERLONG_2 | SW_UTF8_TWO_CONTS | SW_UTF8_SURROGATE | SW_UTF8_TOO_LARGE, \
+    /* ________ 11______ */ \
+    SW_UTF8_TOO_SHORT, SW_UTF8_TOO_SHORT, SW_UTF8_TOO_SHORT, SW_UTF8_TOO_SHORT
+
+static bool swWebSocket_ssse3_detect()
+{
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("ssse3");
+}
+
+/**
+ * pshufb is an SSSE3 instruction, the SSE2 level falls back to the scalar validation without it
+ */
+static bool ssse3_supported = swWebSocket_ssse3_detect();
+
+#define SW_SSSE3_PREV(input, prev_input, n) _mm_alignr_epi8(input, prev_input, 16 - (n))
+
+SW_SSSE3_TARGET static inline __m128i swWebSocket_utf8_check_block_ssse3(__m128i input, __m128i prev_input)
+{
+    __m128i prev1 = SW_SSSE3_PREV(input, prev_input, 1);
+    __m128i low_nibble_mask = _mm_set1_epi8(0x0f);
+    __m128i byte_1_high = _mm_shuffle_epi8(_mm_setr_epi8(SW_UTF8_BYTE_1_HIGH),
+            _mm_and_si128(_mm_srli_epi16(prev1, 4), low_nibble_mask));
+    __m128i byte_1_low = _mm_shuffle_epi8(_mm_setr_epi8(SW_UTF8_BYTE_1_LOW), _mm_and_si128(prev1, low_nibble_mask));
+    __m128i byte_2_high = _mm_shuffle_epi8(_mm_setr_epi8(SW_UTF8_BYTE_2_HIGH),
+            _mm_and_si128(_mm_srli_epi16(input, 4), low_nibble_mask));
+    __m128i special_cases = _mm_and_si128(_mm_and_si128(byte_1_high, byte_1_low), byte_2_high);
+
+    /**
+     * the 3rd and the 4th bytes of the long characters must be continuations
+     */
+    __m128i prev2 = SW_SSSE3_PREV(input, prev_input, 2);
+    __m128i prev3 = SW_SSSE3_PREV(input, prev_input, 3);
+    __m128i is_third_byte = _mm_subs_epu8(prev2, _mm_set1_epi8(0xe0u - 0x80));
+    __m128i is_fourth_byte = _mm_subs_epu8(prev3, _mm_set1_epi8(0xf0u - 0x80));
+    __m128i must_be_continuation = _mm_and_si128(_mm_or_si128(is_third_byte, is_fourth_byte), _mm_set1_epi8(0x80));
+
+    return _mm_xor_si128(must_be_continuation, special_cases);
+}
+
+SW_SSSE3_TARGET static bool swWebSocket_validate_utf8_ssse3(const uchar *data, size_t len)
+{
+    /**
+     * a character starting in the last 3 bytes of a block continues in the next one
+     */
+    const __m128i max_value = _mm_setr_epi8(
+        -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, 0xf0u - 1, 0xe0u - 1, 0xc0u - 1
+    );
+    __m128i error = _mm_setzero_si128();
+    __m128i prev_input = _mm_setzero_si128();
+    __m128i prev_incomplete = _mm_setzero_si128();
+    size_t i = 0;
+
+    for (; i + 16 <= len; i += 16)
+    {
+        __m128i input = _mm_loadu_si128((__m128i *) (data + i));
+        if (_mm_movemask_epi8(input) == 0)
+        {
+            error = _mm_or_si128(error, prev_incomplete);
+        }
+        else
+        {
+            error = _mm_or_si128(error, swWebSocket_utf8_check_block_ssse3(input, prev_input));
+            prev_incomplete = _mm_subs_epu8(input, max_value);
+        }
+        prev_input = input;
+    }
+
+    uchar tail[16] = {};
+    memcpy(tail, data + i, len - i);
+    __m128i input = _mm_loadu_si128((__m128i *) tail);
+    error = _mm_or_si128(error, swWebSocket_utf8_check_block_ssse3(input, prev_input));
+
+    return _mm_movemask_epi8(_mm_cmpeq_epi8(error, _mm_setzero_si128())) == 0xffff;
+}
+
+#define SW_AVX2_PREV(input, prev_input, n) \
+    _mm256_alignr_epi8(input, _mm256_permute2x128_si256(prev_input, input, 0x21), 16 - (n))
+
+SW_AVX2_TARGET static inline __m256i swWebSocket_utf8_check_block_avx2(__m256i input, __m256i prev_input)
+{
+    __m256i prev1 = SW_AVX2_PREV(input, prev_input, 1);
+    __m256i low_nibble_mask = _mm256_set1_epi8(0x0f);
+    __m256i byte_1_high = _mm256_shuffle_epi8(_mm256_setr_epi8(SW_UTF8_BYTE_1_HIGH, SW_UTF8_BYTE_1_HIGH),
+            _mm256_and_si256(_mm256_srli_epi16(prev1, 4), low_nibble_mask));
+    __m256i byte_1_low = _mm256_shuffle_epi8(_mm256_setr_epi8(SW_UTF8_BYTE_1_LOW, SW_UTF8_BYTE_1_LOW),
+            _mm256_and_si256(prev1, low_nibble_mask));
+    __m256i byte_2_high = _mm256_shuffle_epi8(_mm256_setr_epi8(SW_UTF8_BYTE_2_HIGH, SW_UTF8_BYTE_2_HIGH),
+            _mm256_and_si256(_mm256_srli_epi16(input, 4), low_nibble_mask));
+    __m256i special_cases = _mm256_and_si256(_mm256_and_si256(byte_1_high, byte_1_low), byte_2_high);
+
+    __m256i prev2 = SW_AVX2_PREV(input, prev_input, 2);
+    __m256i prev3 = SW_AVX2_PREV(input, prev_input, 3);
+    __m256i is_third_byte = _mm256_subs_epu8(prev2, _mm256_set1_epi8(0xe0u - 0x80));
+    __m256i is_fourth_byte = _mm256_subs_epu8(prev3, _mm256_set1_epi8(0xf0u - 0x80));
+    __m256i must_be_continuation = _mm256_and_si256(_mm256_or_si256(is_third_byte, is_fourth_byte), _mm256_set1_epi8(0x80));
+
+    return _mm256_xor_si256(must_be_continuation, special_cases);
+}
+
+SW_AVX2_TARGET static bool swWebSocket_validate_utf8_avx2(const uchar *data, size_t len)
+{
+    const __m256i max_value = _mm256_setr_epi8(
+        -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+        -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, 0xf0u - 1, 0xe0u - 1, 0xc0u - 1
+    );
+    __m256i error = _mm256_setzero_si256();
+    __m256i prev_input = _mm256_setzero_si256();
+    __m256i prev_incomplete = _mm256_setzero_si256();
+    size_t i = 0;
+
+    for (; i + 32 <= len; i += 32)
+    {
+        __m256i input = _mm256_loadu_si256((__m256i *) (data + i));
+        if (_mm256_movemask_epi8(input) == 0)
+        {
+            error = _mm256_or_si256(error, prev_incomplete);
+        }
+        else
+        {
+            error = _mm256_or_si256(error, swWebSocket_utf8_check_block_avx2(input, prev_input));
+            prev_incomplete = _mm256_subs_epu8(input, max_value);
+        }
+        prev_input = input;
+    }
+
+    /**
+     * the rest is padded with zeros, which also ends a character left incomplete at the end
+     */
+    uchar tail[32] = {};
+    memcpy(tail, data + i, len - i);
+    __m256i input = _mm256_loadu_si256((__m256i *) tail);
+    error = _mm256_or_si256(error, swWebSocket_utf8_check_block_avx2(input, prev_input));
+
+    return _mm256_testz_si256(error, error);
+}
+#endif
+
+bool swWebSocket_validate_utf8(const char *data, size_t len)
+{
+#ifdef SW_WEBSOCKET_SIMD
+    if (simd_level == SW_WEBSOCKET_SIMD_AVX2)
+    {
+        return swWebSocket_validate_utf8_avx2((const uchar *) data, len);
+    }
+    else if (simd_level == SW_WEBSOCKET_SIMD_SSE2 && ssse3_supported)
+    {
+        return swWebSocket_validate_utf8_ssse3((const uchar *) data, len);
+    }
+#endif
+    return swWebSocket_validate_utf8_scalar((const uchar *) data, len, 0);
+}
+
 void swWebSocket_encode(swString *buffer, const char *data, size_t length, char opcode, uint8_t _flags)
 {
     int pos = 0;
@@ -240,6 +648,30 @@ void swWebSocket_print_frame(swWebSocket_frame *frame)
     }
 }
 
+/**
+ * RFC 6455 8.1, the endpoint fails the connection when a text message is not valid UTF-8
+ */
+static bool swWebSocket_check_text(swServer *serv, swSocket *_socket, uchar opcode, const char *data, size_t length)
+{
+    swConnection *conn = (swConnection *) _socket->object;
+    if (opcode != WEBSOCKET_OPCODE_TEXT || !swServer_get_port(serv, conn->fd)->open_websocket_utf8_check
+            || swWebSocket_validate_utf8(data, length))
+    {
+        return true;
+    }
+
+    swWarn("invalid UTF-8 in the text message. remote_addr=%s:%d", swSocket_get_ip(conn->socket_type, &conn->info),
+            swSocket_get_port(conn->socket_type, &conn->info));
+
+    char buf[SW_WEBSOCKET_HEADER_LEN + SW_WEBSOCKET_CLOSE_CODE_LEN];
+    swString close_frame = {};
+    close_frame.str = buf;
+    close_frame.size = sizeof(buf);
+    swWebSocket_pack_close_frame(&close_frame, WEBSOCKET_CLOSE_MESSAGE_ERROR, NULL, 0, 0);
+    swSocket_send(_socket, close_frame.str, close_frame.length, 0);
+    return false;
+}
+
 int swWebSocket_dispatch_frame(swProtocol *proto, swSocket *_socket, char *data, uint32_t length)
 {
     swServer *serv = (swServer *) proto->private_data_2;
@@ -288,6 +720,12 @@ int swWebSocket_dispatch_frame(swProtocol *proto, swSocket *_socket, char *data,
         if (ws.header.FIN)
         {
             proto->ext_flags = conn->websocket_buffer->offset;
+            if (!swWebSocket_check_text(serv, _socket, proto->ext_flags >> 8, frame_buffer->str, frame_buffer->length))
+            {
+                swString_free(frame_buffer);
+                conn->websocket_buffer = NULL;
+                return SW_ERR;
+            }
             swReactorThread_dispatch(proto, _socket, frame_buffer->str, frame_buffer->length);
             swString_free(frame_buffer);
             conn->websocket_buffer = NULL;
@@ -314,6 +752,10 @@ int swWebSocket_dispatch_frame(swProtocol *proto, swSocket *_socket, char *data,
         }
         else
         {
+            if (!swWebSocket_check_text(serv, _socket, ws.header.OPCODE, data + offset, length - offset))
+            {
+                return SW_ERR;
+            }
             swReactorThread_dispatch(proto, _socket, data + offset, length - offset);
         }
         break;
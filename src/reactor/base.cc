@@ -44,17 +44,30 @@ int swReactor_create(swReactor *reactor, int max_event)
     int ret;
     bzero(reactor, sizeof(swReactor));
 
+#ifdef HAVE_IO_URING
+    /**
+     * fallback to epoll when the kernel does not support io_uring
+     */
+    if (SwooleG.enable_io_uring && swReactorIouring_create(reactor, max_event) == SW_OK)
+    {
+        ret = SW_OK;
+    }
+    else
+#endif
+    {
 #ifdef HAVE_EPOLL
-    ret = swReactorEpoll_create(reactor, max_event);
+        ret = swReactorEpoll_create(reactor, max_event);
 #elif defined(HAVE_KQUEUE)
-    ret = swReactorKqueue_create(reactor, max_event);
+        ret = swReactorKqueue_create(reactor, max_event);
 #elif defined(HAVE_POLL)
-    ret = swReactorPoll_create(reactor, max_event);
+        ret = swReactorPoll_create(reactor, max_event);
 #else
-    ret = swReactorSelect_create(reactor);
+        ret = swReactorSelect_create(reactor);
 #endif
+    }
 
     reactor->running = 1;
+    reactor->timer_wheel = SwooleG.enable_timer_wheel;
 
     reactor->onFinish = reactor_finish;
     reactor->onTimeout = reactor_timeout;
@@ -133,10 +146,17 @@ int swReactor_empty(swReactor *reactor)
 
     int event_num = reactor->event_num;
     int empty = SW_FALSE;
-    //aio thread pool
-    if (SwooleTG.aio_init && SwooleTG.aio_task_num == 0)
+    //aio thread pool & io_uring
+    if (SwooleTG.aio_task_num == 0)
     {
-        event_num--;
+        if (SwooleTG.aio_init)
+        {
+            event_num--;
+        }
+        if (SwooleTG.aio_iouring_init)
+        {
+            event_num--;
+        }
     }
     //signalfd
     if (swReactor_isset_handler(reactor, SW_FD_SIGNAL))
@@ -439,5 +459,12 @@ void swReactor_destroy(swReactor *reactor)
         reactor->destroy_callbacks = nullptr;
         delete cm;
     }
+    /**
+     * the sockets released by the destroy callbacks with swSocket_free
+     */
+    if (reactor->defer_tasks)
+    {
+        defer_task_do(reactor);
+    }
     reactor->free(reactor);
 }
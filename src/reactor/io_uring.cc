@@ -0,0 +1,465 @@
+/*
+ +----------------------------------------------------------------------+
+ | Swoole                                                               |
+ +----------------------------------------------------------------------+
+ | This source file is subject to version 2.0 of the Apache license,    |
+ | that is bundled with this package in the file LICENSE, and is        |
+ | available through the world-wide-web at the following url:           |
+ | http://www.apache.org/licenses/LICENSE-2.0.html                      |
+ | If you did not receive a copy of the Apache2.0 license and are unable|
+ | to obtain it through the world-wide-web, please send a note to       |
+ | license@swoole.com so we can mail you a copy immediately.            |
+ +----------------------------------------------------------------------+
+ | Author: Tianfeng Han  <mikan.tenny@gmail.com>                        |
+ +----------------------------------------------------------------------+
+ */
+
+#include "swoole.h"
+
+#ifdef HAVE_IO_URING
+#include "io_uring.h"
+#include <poll.h>
+
+/**
+ * Readiness reactor built on io_uring IORING_OP_POLL_ADD.
+ *
+ * Every registered socket owns one oneshot poll request. Re-arming, modification and removal
+ * are queued in the submission ring and flushed by the same io_uring_enter() call that waits
+ * for completions, so one loop iteration costs a single syscall no matter how many sockets
+ * changed their events. Oneshot polls are re-armed after the handlers run, which keeps the
+ * level-triggered semantics the rest of the reactor relies on.
+ *
+ * user_data = (version << 32) | fd, completions whose version does not match the slot
+ * are stale (the socket was modified or removed after the request was queued) and ignored.
+ */
+#define SW_IOURING_USER_DATA(fd, version)    ((((uint64_t) (version)) << 32) | (uint32_t) (fd))
+#define SW_IOURING_USER_DATA_FD(data)        ((int) ((data) & 0xffffffff))
+#define SW_IOURING_USER_DATA_VERSION(data)   ((uint32_t) ((data) >> 32))
+#define SW_IOURING_USER_DATA_IGNORE          0
+
+typedef struct
+{
+    swSocket *socket;
+    uint32_t version;
+    uint8_t armed;
+} swReactorIouring_slot;
+
+typedef struct
+{
+    swIouring ring;
+    swReactorIouring_slot *slots;
+    uint32_t slot_num;
+} swReactorIouring;
+
+static int swReactorIouring_add(swReactor *reactor, swSocket *socket, int events);
+static int swReactorIouring_set(swReactor *reactor, swSocket *socket, int events);
+static int swReactorIouring_del(swReactor *reactor, swSocket *socket);
+static int swReactorIouring_wait(swReactor *reactor, struct timeval *timeo);
+static void swReactorIouring_free(swReactor *reactor);
+
+static sw_inline uint32_t swReactorIouring_event_set(int fdtype)
+{
+    uint32_t flag = 0;
+    if (swReactor_event_read(fdtype))
+    {
+        flag |= POLLIN;
+    }
+    if (swReactor_event_write(fdtype))
+    {
+        flag |= POLLOUT;
+    }
+    if (swReactor_event_error(fdtype))
+    {
+        flag |= (POLLRDHUP | POLLHUP | POLLERR);
+    }
+    return flag;
+}
+
+int swReactorIouring_create(swReactor *reactor, int max_event_num)
+{
+    swReactorIouring *object = (swReactorIouring *) sw_malloc(sizeof(swReactorIouring));
+    if (object == NULL)
+    {
+        swWarn("malloc[0] failed");
+        return SW_ERR;
+    }
+    bzero(object, sizeof(swReactorIouring));
+
+    if (swIouring_create(&object->ring, max_event_num) < 0)
+    {
+        sw_free(object);
+        return SW_ERR;
+    }
+    /**
+     * IORING_FEAT_EXT_ARG (linux-5.11) is required for io_uring_enter() with timeout
+     */
+    if (!(object->ring.features & IORING_FEAT_EXT_ARG) || !(object->ring.features & IORING_FEAT_NODROP))
+    {
+        swoole_error_log(SW_LOG_NOTICE, SW_ERROR_OPERATION_NOT_SUPPORT, "io_uring is not supported by this kernel");
+        swIouring_free(&object->ring);
+        sw_free(object);
+        return SW_ERR;
+    }
+
+    reactor->object = object;
+    reactor->max_event_num = max_event_num;
+
+    //binding method
+    reactor->add = swReactorIouring_add;
+    reactor->set = swReactorIouring_set;
+    reactor->del = swReactorIouring_del;
+    reactor->wait = swReactorIouring_wait;
+    reactor->free = swReactorIouring_free;
+
+    return SW_OK;
+}
+
+static void swReactorIouring_free(swReactor *reactor)
+{
+    swReactorIouring *object = (swReactorIouring *) reactor->object;
+    swIouring_free(&object->ring);
+    if (object->slots)
+    {
+        sw_free(object->slots);
+    }
+    sw_free(object);
+}
+
+static int swReactorIouring_poll_add(swReactorIouring *object, swReactorIouring_slot *slot, int fd, int events)
+{
+    struct io_uring_sqe *sqe = swIouring_get_sqe(&object->ring);
+    if (sqe == NULL)
+    {
+        return SW_ERR;
+    }
+    sqe->opcode = IORING_OP_POLL_ADD;
+    sqe->fd = fd;
+    sqe->poll32_events = swReactorIouring_event_set(events);
+    sqe->user_data = SW_IOURING_USER_DATA(fd, slot->version);
+    slot->armed = 1;
+    return SW_OK;
+}
+
+static int swReactorIouring_poll_remove(swReactorIouring *object, swReactorIouring_slot *slot, int fd)
+{
+    if (!slot->armed)
+    {
+        return SW_OK;
+    }
+    struct io_uring_sqe *sqe = swIouring_get_sqe(&object->ring);
+    if (sqe == NULL)
+    {
+        return SW_ERR;
+    }
+    sqe->opcode = IORING_OP_POLL_REMOVE;
+    sqe->fd = -1;
+    sqe->addr = SW_IOURING_USER_DATA(fd, slot->version);
+    sqe->user_data = SW_IOURING_USER_DATA_IGNORE;
+    slot->armed = 0;
+    return SW_OK;
+}
+
+static swReactorIouring_slot* swReactorIouring_get_slot(swReactorIouring *object, int fd)
+{
+    if ((uint32_t) fd >= object->slot_num)
+    {
+        uint32_t slot_num = SW_MAX(object->slot_num, 64);
+        while (slot_num <= (uint32_t) fd)
+        {
+            slot_num *= 2;
+        }
+        swReactorIouring_slot *slots = (swReactorIouring_slot *) sw_realloc(object->slots, slot_num * sizeof(swReactorIouring_slot));
+        if (slots == NULL)
+        {
+            swWarn("realloc(%u) failed", slot_num);
+            return NULL;
+        }
+        bzero(slots + object->slot_num, (slot_num - object->slot_num) * sizeof(swReactorIouring_slot));
+        object->slots = slots;
+        object->slot_num = slot_num;
+    }
+    return &object->slots[fd];
+}
+
+static int swReactorIouring_add(swReactor *reactor, swSocket *socket, int events)
+{
+    swReactorIouring *object = (swReactorIouring *) reactor->object;
+    swReactorIouring_slot *slot = swReactorIouring_get_slot(object, socket->fd);
+    if (slot == NULL)
+    {
+        return SW_ERR;
+    }
+    if (slot->socket)
+    {
+        swWarn("add events[fd=%d#%d, type=%d, events=%d] failed, fd is already exists", socket->fd, reactor->id,
+                socket->fdtype, events);
+        return SW_ERR;
+    }
+
+    slot->socket = socket;
+    slot->version++;
+    if (slot->version == 0)
+    {
+        slot->version = 1;
+    }
+    if (swReactorIouring_poll_add(object, slot, socket->fd, events) < 0)
+    {
+        swWarn("add events[fd=%d#%d, type=%d, events=%d] failed", socket->fd, reactor->id, socket->fdtype, events);
+        slot->socket = NULL;
+        return SW_ERR;
+    }
+
+    swReactor_add(reactor, socket, events);
+    swTraceLog(SW_TRACE_EVENT, "add events[fd=%d#%d, type=%d, events=%d]", socket->fd, reactor->id, socket->fdtype, events);
+
+    return SW_OK;
+}
+
+static int swReactorIouring_del(swReactor *reactor, swSocket *_socket)
+{
+    swReactorIouring *object = (swReactorIouring *) reactor->object;
+    if ((uint32_t) _socket->fd >= object->slot_num || object->slots[_socket->fd].socket != _socket)
+    {
+        swWarn("io_uring remove fd[%d#%d] failed, fd is not exists", _socket->fd, reactor->id);
+        return SW_ERR;
+    }
+
+    swReactorIouring_slot *slot = &object->slots[_socket->fd];
+    if (swReactorIouring_poll_remove(object, slot, _socket->fd) < 0)
+    {
+        swWarn("io_uring remove fd[%d#%d] failed", _socket->fd, reactor->id);
+        return SW_ERR;
+    }
+    slot->socket = NULL;
+    slot->version++;
+
+    swTraceLog(SW_TRACE_REACTOR, "remove event[reactor_id=%d|fd=%d]", reactor->id, _socket->fd);
+    swReactor_del(reactor, _socket);
+
+    return SW_OK;
+}
+
+static int swReactorIouring_set(swReactor *reactor, swSocket *socket, int events)
+{
+    swReactorIouring *object = (swReactorIouring *) reactor->object;
+    int fd = socket->fd;
+
+    if ((uint32_t) fd >= object->slot_num || object->slots[fd].socket != socket)
+    {
+        swWarn("reactor#%d->set(fd=%d|type=%d|events=%d) failed, fd is not exists", reactor->id, fd, socket->fdtype, events);
+        return SW_ERR;
+    }
+
+    swReactorIouring_slot *slot = &object->slots[fd];
+    if (swReactorIouring_poll_remove(object, slot, fd) < 0)
+    {
+        goto _error;
+    }
+    slot->version++;
+    if (slot->version == 0)
+    {
+        slot->version = 1;
+    }
+    if (swReactorIouring_poll_add(object, slot, fd, events) < 0)
+    {
+        goto _error;
+    }
+
+    swTraceLog(SW_TRACE_EVENT, "set event[reactor_id=%d, fd=%d, events=%d]", reactor->id, fd, events);
+    swReactor_set(reactor, socket, events);
+
+    return SW_OK;
+
+    _error:
+    swWarn("reactor#%d->set(fd=%d|type=%d|events=%d) failed", reactor->id, fd, socket->fdtype, events);
+    return SW_ERR;
+}
+
+static int swReactorIouring_wait(swReactor *reactor, struct timeval *timeo)
+{
+    swEvent event;
+    swReactorIouring *object = (swReactorIouring *) reactor->object;
+    swReactor_handler handler;
+    swReactorIouring_slot *slot;
+    uint32_t head, tail, mask, revents, version;
+    uint64_t user_data;
+    int ret;
+
+    int reactor_id = reactor->id;
+
+    if (reactor->timeout_msec == 0)
+    {
+        if (timeo == NULL)
+        {
+            reactor->timeout_msec = -1;
+        }
+        else
+        {
+            reactor->timeout_msec = timeo->tv_sec * 1000 + timeo->tv_usec / 1000;
+        }
+    }
+
+    swReactor_before_wait(reactor);
+
+    while (reactor->running > 0)
+    {
+        if (reactor->onBegin != NULL)
+        {
+            reactor->onBegin(reactor);
+        }
+
+        head = *object->ring.cq_head;
+        tail = __atomic_load_n(object->ring.cq_tail, __ATOMIC_ACQUIRE);
+        if (head != tail && object->ring.sq_pending > 0)
+        {
+            if (swIouring_submit(&object->ring, 0, 0) < 0 && swReactor_error(reactor) < 0)
+            {
+                swSysWarn("[Reactor#%d] io_uring_enter failed", reactor_id);
+                return SW_ERR;
+            }
+        }
+        else if (head == tail)
+        {
+            ret = swIouring_submit(&object->ring, 1, swReactor_get_timeout_msec(reactor));
+            if (ret < 0)
+            {
+                if (errno == ETIME)
+                {
+                    if (reactor->onTimeout)
+                    {
+                        reactor->onTimeout(reactor);
+                    }
+                    SW_REACTOR_CONTINUE;
+                }
+                else if (swReactor_error(reactor) < 0)
+                {
+                    swSysWarn("[Reactor#%d] io_uring_enter failed", reactor_id);
+                    return SW_ERR;
+                }
+                else
+                {
+                    goto _continue;
+                }
+            }
+            tail = __atomic_load_n(object->ring.cq_tail, __ATOMIC_ACQUIRE);
+            if (head == tail)
+            {
+                if (reactor->onTimeout)
+                {
+                    reactor->onTimeout(reactor);
+                }
+                SW_REACTOR_CONTINUE;
+            }
+        }
+
+        mask = *object->ring.cq_mask;
+        for (; head != tail; head++)
+        {
+            struct io_uring_cqe *cqe = &object->ring.cqes[head & mask];
+            user_data = cqe->user_data;
+            ret = cqe->res;
+            /**
+             * release the cqe before handling, the handlers may queue new submissions
+             */
+            __atomic_store_n(object->ring.cq_head, head + 1, __ATOMIC_RELEASE);
+
+            if (user_data == SW_IOURING_USER_DATA_IGNORE)
+            {
+                continue;
+            }
+
+            event.fd = SW_IOURING_USER_DATA_FD(user_data);
+            version = SW_IOURING_USER_DATA_VERSION(user_data);
+            if ((uint32_t) event.fd >= object->slot_num)
+            {
+                continue;
+            }
+            slot = &object->slots[event.fd];
+            if (slot->socket == NULL || slot->version != version)
+            {
+                continue;
+            }
+            slot->armed = 0;
+            if (ret < 0)
+            {
+                if (ret != -ECANCELED)
+                {
+                    swWarn("io_uring poll fd[%d#%d] failed, Error: %s[%d]", event.fd, reactor_id, strerror(-ret), -ret);
+                }
+                continue;
+            }
+
+            revents = (uint32_t) ret;
+            event.reactor_id = reactor_id;
+            event.socket = slot->socket;
+            event.type = event.socket->fdtype;
+
+            //read
+            if ((revents & POLLIN) && !event.socket->removed)
+            {
+                if (revents & (POLLRDHUP | POLLERR | POLLHUP))
+                {
+                    event.socket->event_hup = 1;
+                }
+                handler = swReactor_get_handler(reactor, SW_EVENT_READ, event.type);
+                ret = handler(reactor, &event);
+                if (ret < 0)
+                {
+                    swSysWarn("POLLIN handle failed. fd=%d", event.fd);
+                }
+            }
+            //write
+            if ((revents & POLLOUT) && !event.socket->removed)
+            {
+                handler = swReactor_get_handler(reactor, SW_EVENT_WRITE, event.type);
+                ret = handler(reactor, &event);
+                if (ret < 0)
+                {
+                    swSysWarn("POLLOUT handle failed. fd=%d", event.fd);
+                }
+            }
+            //error
+            if ((revents & (POLLRDHUP | POLLERR | POLLHUP)) && !(revents & (POLLIN | POLLOUT)) && !event.socket->removed)
+            {
+                handler = swReactor_get_handler(reactor, SW_EVENT_ERROR, event.type);
+                ret = handler(reactor, &event);
+                if (ret < 0)
+                {
+                    swSysWarn("POLLERR handle failed. fd=%d", event.fd);
+                }
+            }
+            /**
+             * the handlers may have added a higher fd, which moves the slots
+             */
+            slot = &object->slots[event.fd];
+            /**
+             * the handlers may have removed or modified the socket, in both cases the slot no longer
+             * belongs to this completion and the poll request has already been queued again
+             */
+            if (slot->socket != event.socket || slot->version != version || slot->armed)
+            {
+                continue;
+            }
+            if (event.socket->events & SW_EVENT_ONCE)
+            {
+                slot->socket = NULL;
+                slot->version++;
+                swReactor_del(reactor, event.socket);
+            }
+            else if (swReactorIouring_poll_add(object, slot, event.fd, event.socket->events) < 0)
+            {
+                swWarn("io_uring rearm fd[%d#%d] failed", event.fd, reactor_id);
+            }
+        }
+
+        _continue:
+        if (reactor->onFinish)
+        {
+            reactor->onFinish(reactor);
+        }
+        SW_REACTOR_CONTINUE;
+    }
+    return SW_OK;
+}
+
+#endif
@@ -0,0 +1,148 @@
+/*
+ +----------------------------------------------------------------------+
+ | Swoole                                                               |
+ +----------------------------------------------------------------------+
+ | This source file is subject to version 2.0 of the Apache license,    |
+ | that is bundled with this package in the file LICENSE, and is        |
+ | available through the world-wide-web at the following url:           |
+ | http://www.apache.org/licenses/LICENSE-2.0.html                      |
+ | If you did not receive a copy of the Apache2.0 license and are unable|
+ | to obtain it through the world-wide-web, please send a note to       |
+ | license@swoole.com so we can mail you a copy immediately.            |
+ +----------------------------------------------------------------------+
+ | Author: Tianfeng Han  <mikan.tenny@gmail.com>                        |
+ +----------------------------------------------------------------------+
+ */
+
+#include "server.h"
+#include "http.h"
+#include "lru_cache.h"
+
+#include <string>
+
+using namespace std;
+using swoole::LRUCache;
+
+string swHttpRequest_get_header(swHttpRequest *request, const char *name, size_t name_length);
+
+struct HttpCacheEntry
+{
+    string vary;
+    string response;
+};
+
+/**
+ * the responses are stored and served by the reactor threads, each of them has its own cache
+ */
+static thread_local LRUCache *response_cache = nullptr;
+
+/**
+ * the cached response says "Connection: keep-alive"
+ */
+static bool http_cache_keep_alive(swHttpRequest *request)
+{
+    string connection = swHttpRequest_get_header(request, SW_STRL("Connection"));
+    if (request->version == SW_HTTP_VERSION_11)
+    {
+        return strcasecmp(connection.c_str(), "close") != 0;
+    }
+    return strcasecmp(connection.c_str(), "keep-alive") == 0;
+}
+
+static bool http_cache_vary_matched(swHttpRequest *request, const string &vary)
+{
+    size_t offset = 0;
+    while (offset < vary.length())
+    {
+        size_t colon = vary.find(": ", offset);
+        size_t eol = vary.find("\r\n", offset);
+        if (colon == string::npos || eol == string::npos || colon > eol)
+        {
+            return false;
+        }
+        string value = swHttpRequest_get_header(request, vary.c_str() + offset, colon - offset);
+        if (value.compare(0, string::npos, vary, colon + 2, eol - colon - 2) != 0)
+        {
+            return false;
+        }
+        offset = eol + 2;
+    }
+    return true;
+}
+
+/**
+ * [Reactor] send the cached response of a GET request without dispatching it to the worker
+ */
+int swServer_http_cache_hit(swServer *serv, swHttpRequest *request, swConnection *conn)
+{
+    if (!response_cache || request->method != SW_HTTP_GET || !http_cache_keep_alive(request))
+    {
+        return false;
+    }
+    // the requests of a user and the protocol upgrades are always handled by the worker
+    if (!swHttpRequest_get_header(request, SW_STRL("Cookie")).empty()
+            || !swHttpRequest_get_header(request, SW_STRL("Authorization")).empty()
+            || !swHttpRequest_get_header(request, SW_STRL("Upgrade")).empty())
+    {
+        return false;
+    }
+
+    string host = swHttpRequest_get_header(request, SW_STRL("Host"));
+    string key = to_string(conn->server_fd) + " " + host + " ";
+    key.append(request->buffer->str + request->url_offset, request->url_length);
+
+    auto entry = static_pointer_cast<HttpCacheEntry>(response_cache->get(key));
+    if (!entry || !http_cache_vary_matched(request, entry->vary))
+    {
+        return false;
+    }
+
+    swTraceLog(SW_TRACE_HTTP, "response cache hit, key=%s", key.c_str());
+
+    swSendData response;
+    bzero(&response.info, sizeof(response.info));
+    response.info.fd = conn->session_id;
+    response.info.type = SW_SERVER_EVENT_SEND_DATA;
+    response.info.len = entry->response.length();
+    response.data = (char *) entry->response.c_str();
+    swServer_master_send(serv, &response);
+
+    return true;
+}
+
+/**
+ * [Reactor] store the response of the worker, then send it to the client
+ */
+int swServer_http_cache_store(swServer *serv, swSendData *_send)
+{
+    swHttpCachePacket *packet = (swHttpCachePacket *) _send->data;
+    size_t offset = sizeof(*packet);
+    if (_send->info.len < offset || _send->info.len < offset + packet->key_length + packet->vary_length)
+    {
+        swWarn("invalid http cache packet, length=%u", _send->info.len);
+        return SW_ERR;
+    }
+    offset += packet->key_length + packet->vary_length;
+
+    if (serv->http_response_cache_capacity > 0)
+    {
+        if (response_cache == nullptr)
+        {
+            response_cache = new LRUCache(serv->http_response_cache_capacity);
+        }
+        auto entry = make_shared<HttpCacheEntry>();
+        entry->vary.assign(packet->data + packet->key_length, packet->vary_length);
+        entry->response.assign(_send->data + offset, _send->info.len - offset);
+        response_cache->set(string(packet->data, packet->key_length), entry, packet->ttl);
+    }
+
+    swSendData response;
+    bzero(&response.info, sizeof(response.info));
+    response.info.fd = _send->info.fd;
+    response.info.type = SW_SERVER_EVENT_SEND_DATA;
+    response.info.reactor_id = _send->info.reactor_id;
+    response.info.len = _send->info.len - offset;
+    response.data = _send->data + offset;
+
+    return swServer_master_send(serv, &response);
+}
@@ -44,6 +44,7 @@ typedef std::unordered_map<uint32_t, pid_t> reload_list_t;
 static int swManager_loop(swServer *serv);
 static void swManager_signal_handler(int sig);
 static void swManager_check_exit_status(swServer *serv, int worker_id, pid_t pid, int status);
+static void swManager_release_ipc_ring(swServer *serv, pid_t pid);
 
 static swManagerProcess ManagerProcess;
 
@@ -282,6 +283,24 @@ static void swManager_check_exit_status(swServer *serv, int worker_id, pid_t pid
     }
 }
 
+/**
+ * the rings owned by an exited worker can be taken by the next worker with the same id
+ */
+static void swManager_release_ipc_ring(swServer *serv, pid_t pid)
+{
+    if (!serv->ipc_ring_owners)
+    {
+        return;
+    }
+    for (uint32_t i = 0; i < serv->worker_num; i++)
+    {
+        if (sw_atomic_cmp_set(&serv->ipc_ring_owners[i], pid, 0))
+        {
+            break;
+        }
+    }
+}
+
 static int swManager_loop(swServer *serv)
 {
     uint32_t i;
@@ -452,6 +471,8 @@ static int swManager_loop(swServer *serv)
                 goto _error;
             }
         }
+        swManager_release_ipc_ring(serv, pid);
+
         if (SwooleG.running == 1)
         {
             //event workers
@@ -760,6 +781,12 @@ pid_t swManager_spawn_worker(swServer *serv, swWorker *worker)
 {
     pid_t pid;
 
+    /**
+     * the new worker does not inherit the load of the previous one
+     */
+    worker->inflight_num = 0;
+    worker->service_time = 0;
+
     pid = swoole_fork(0);
 
     //fork() failed
@@ -17,8 +17,11 @@
 #include "server.h"
 #include "swoole_cxx.h"
 #include "http.h"
+#include "hash.h"
 #include <sys/time.h>
 #include <time.h>
+#include <map>
+#include <vector>
 
 using namespace swoole;
 
@@ -315,22 +318,22 @@ static int swServer_start_check(swServer *serv)
         {
             if (serv->onConnect)
             {
-                swWarn("cannot set 'onConnect' event when using dispatch_mode=1/3/7");
+                swWarn("cannot set 'onConnect' event when using dispatch_mode=1/3/7/8");
                 serv->onConnect = nullptr;
             }
             if (serv->onClose)
             {
-                swWarn("cannot set 'onClose' event when using dispatch_mode=1/3/7");
+                swWarn("cannot set 'onClose' event when using dispatch_mode=1/3/7/8");
                 serv->onClose = nullptr;
             }
             if (serv->onBufferFull)
             {
-                swWarn("cannot set 'onBufferFull' event when using dispatch_mode=1/3/7");
+                swWarn("cannot set 'onBufferFull' event when using dispatch_mode=1/3/7/8");
                 serv->onBufferFull = nullptr;
             }
             if (serv->onBufferEmpty)
             {
-                swWarn("cannot set 'onBufferEmpty' event when using dispatch_mode=1/3/7");
+                swWarn("cannot set 'onBufferEmpty' event when using dispatch_mode=1/3/7/8");
                 serv->onBufferEmpty = nullptr;
             }
             serv->disable_notify = 1;
@@ -556,7 +559,7 @@ int swServer_create_task_workers(swServer *serv)
         }
     }
 
-    return SW_OK;
+    return swTaskWorker_create_shm(serv);
 }
 
 /**
@@ -884,6 +887,9 @@ void swServer_init(swServer *serv)
     serv->http_compression_level = SW_Z_BEST_SPEED;
 #endif
     serv->upload_tmp_dir = sw_strdup("/tmp");
+    serv->static_handler_cache_interval = SW_HTTP_STATIC_CACHE_INTERVAL;
+    serv->task_shm_slice_size = SW_TASK_SHM_SLICE_SIZE;
+    serv->dgram_recv_burst = SW_DGRAM_RECV_BURST;
 
     serv->input_buffer_size = SW_INPUT_BUFFER_SIZE;
     serv->output_buffer_size = SW_OUTPUT_BUFFER_SIZE;
@@ -1071,6 +1077,7 @@ static int swServer_destory(swServer *serv)
     {
         delete serv->http_index_files;
     }
+    swTaskWorker_free_shm(serv);
     serv->lock.free(&serv->lock);
     SwooleG.serv = nullptr;
     return SW_OK;
@@ -1126,6 +1133,41 @@ swPipe * swServer_get_pipe_object(swServer *serv, int pipe_fd)
     return (swPipe *) serv->connection_list[pipe_fd].object;
 }
 
+/**
+ * dispatch_mode=9, a key stays on its worker when worker_num changes, unless it moves to a new worker
+ */
+int swServer_worker_schedule_hash(swServer *serv, int fd)
+{
+    uint64_t key = fd;
+    swConnection *conn = swServer_connection_get(serv, fd);
+
+    //UDP
+    if (conn == NULL)
+    {
+        key = fd;
+    }
+    else if (serv->dispatch_hash_key == SW_DISPATCH_HASH_KEY_UID)
+    {
+        if (conn->uid != 0)
+        {
+            key = conn->uid;
+        }
+    }
+    else if (serv->dispatch_hash_key == SW_DISPATCH_HASH_KEY_IP)
+    {
+        if (conn->socket_type == SW_SOCK_TCP)
+        {
+            key = conn->info.addr.inet_v4.sin_addr.s_addr;
+        }
+        else if (conn->socket_type == SW_SOCK_TCP6)
+        {
+            key = swoole_hash_php((char *) &conn->info.addr.inet_v6.sin6_addr, sizeof(conn->info.addr.inet_v6.sin6_addr));
+        }
+    }
+
+    return swoole_hash_jump_consistent(key, serv->worker_num);
+}
+
 /**
  * @process Worker
  * @return SW_OK or SW_ERR
@@ -1149,11 +1191,145 @@ static int swServer_tcp_send(swServer *serv, int session_id, void *data, uint32_
     return factory->finish(factory, &_send);
 }
 
+/**
+ * @process Worker
+ * the sessions are grouped by the reactor holding them, each reactor gets one packet for all of its sessions
+ * @return the number of sessions the data is sent to, or SW_ERR
+ */
+int swServer_broadcast(swServer *serv, const int *session_ids, uint32_t session_num, const char *data, uint32_t length)
+{
+    swFactory *factory = &(serv->factory);
+
+    if (sw_unlikely(swIsMaster()))
+    {
+        swoole_error_log(SW_LOG_ERROR, SW_ERROR_SERVER_SEND_IN_MASTER, "can't send data to the connections in master process");
+        return SW_ERR;
+    }
+    if (sizeof(swPacket_broadcast) + sizeof(int) + length > serv->output_buffer_size)
+    {
+        swoole_error_log(
+            SW_LOG_WARNING, SW_ERROR_DATA_LENGTH_TOO_LARGE,
+            "The length of data [%u] exceeds the output buffer size[%u]", length, serv->output_buffer_size
+        );
+        return SW_ERR;
+    }
+
+    std::map<int, std::vector<int>> groups;
+    for (uint32_t i = 0; i < session_num; i++)
+    {
+        swConnection *conn = swServer_connection_verify(serv, session_ids[i]);
+        if (!conn || conn->closed || conn->peer_closed)
+        {
+            continue;
+        }
+        groups[conn->reactor_id].push_back(session_ids[i]);
+    }
+
+    size_t max_num = (serv->output_buffer_size - sizeof(swPacket_broadcast) - length) / sizeof(int);
+    swString *packet = nullptr;
+    int count = 0;
+
+    for (auto &group : groups)
+    {
+        std::vector<int> &sessions = group.second;
+        for (size_t offset = 0; offset < sessions.size(); offset += max_num)
+        {
+            swPacket_broadcast header;
+            header.session_num = SW_MIN(max_num, sessions.size() - offset);
+            size_t packet_length = sizeof(header) + header.session_num * sizeof(int) + length;
+
+            if (packet == nullptr && (packet = swString_new(packet_length)) == nullptr)
+            {
+                return SW_ERR;
+            }
+            swString_clear(packet);
+            if (swString_append_ptr(packet, (char *) &header, sizeof(header)) < 0
+                    || swString_append_ptr(packet, (char *) &sessions[offset], header.session_num * sizeof(int)) < 0
+                    || swString_append_ptr(packet, data, length) < 0)
+            {
+                swString_free(packet);
+                return SW_ERR;
+            }
+
+            swSendData _send;
+            bzero(&_send.info, sizeof(_send.info));
+            _send.info.type = SW_SERVER_EVENT_BROADCAST;
+            _send.info.len = packet->length;
+            _send.data = packet->str;
+            /**
+             * the packet is routed by the lead session, a session closed in the meantime can not lead it
+             */
+            for (size_t i = offset; i < offset + header.session_num; i++)
+            {
+                swConnection *conn = swServer_connection_verify(serv, sessions[i]);
+                if (!conn || conn->closed || conn->peer_closed)
+                {
+                    continue;
+                }
+                _send.info.fd = sessions[i];
+                if (factory->finish(factory, &_send) == SW_OK)
+                {
+                    count += header.session_num;
+                }
+                break;
+            }
+        }
+    }
+
+    if (packet)
+    {
+        swString_free(packet);
+    }
+    return count;
+}
+
+/**
+ * [Master] fan out a broadcast packet to the sessions of this reactor
+ */
+static int swServer_master_broadcast(swServer *serv, swSendData *_send)
+{
+    swPacket_broadcast *header = (swPacket_broadcast *) _send->data;
+    size_t offset = sizeof(*header) + header->session_num * sizeof(int);
+    if (_send->info.len < offset)
+    {
+        swWarn("invalid broadcast packet, length=%u", _send->info.len);
+        return SW_ERR;
+    }
+
+    swSendData resp;
+    bzero(&resp.info, sizeof(resp.info));
+    resp.info.type = SW_SERVER_EVENT_SEND_DATA;
+    resp.info.reactor_id = _send->info.reactor_id;
+    resp.info.len = _send->info.len - offset;
+    resp.data = _send->data + offset;
+
+    for (uint32_t i = 0; i < header->session_num; i++)
+    {
+        swConnection *conn = swServer_connection_verify(serv, header->sessions[i]);
+        if (!conn || conn->closed || conn->peer_closed)
+        {
+            continue;
+        }
+        resp.info.fd = header->sessions[i];
+        swServer_master_send(serv, &resp);
+    }
+    return SW_OK;
+}
+
 /**
  * [Master] send to client or append to out_buffer
  */
 int swServer_master_send(swServer *serv, swSendData *_send)
 {
+    if (_send->info.type == SW_SERVER_EVENT_BROADCAST)
+    {
+        return swServer_master_broadcast(serv, _send);
+    }
+    else if (_send->info.type == SW_SERVER_EVENT_HTTP_CACHE)
+    {
+        return swServer_http_cache_store(serv, _send);
+    }
+
     uint32_t session_id = _send->info.fd;
     char *_send_data = _send->data;
     uint32_t _send_length = _send->info.len;
@@ -1321,7 +1497,23 @@ int swServer_master_send(swServer *serv, swSendData *_send)
     else if (_send->info.type == SW_SERVER_EVENT_SEND_FILE)
     {
         swSendFile_request *req = (swSendFile_request *) _send_data;
-        if (swSocket_sendfile(conn->socket, req->filename, req->offset, req->length) < 0)
+        if (req->fd >= 0)
+        {
+            /**
+             * the descriptor belongs to the static file cache, the buffer chunk closes its own copy
+             */
+            int file_fd = dup(req->fd);
+            if (file_fd < 0)
+            {
+                swSysWarn("dup(%d) failed", req->fd);
+                return SW_ERR;
+            }
+            if (swSocket_sendfile_fd(conn->socket, file_fd, req->filename, req->offset, req->length) < 0)
+            {
+                return SW_ERR;
+            }
+        }
+        else if (swSocket_sendfile(conn->socket, req->filename, req->offset, req->length) < 0)
         {
             return SW_ERR;
         }
@@ -1437,6 +1629,7 @@ static int swServer_tcp_sendfile(swServer *serv, int session_id, const char *fil
     }
     req->offset = offset;
     req->length = length;
+    req->fd = -1;
 
     // construct send data
     swSendData send_data = {};
@@ -369,6 +369,58 @@ static int swPort_onRead_check_length(swReactor *reactor, swListenPort *port, sw
 /**
  * For Http Protocol
  */
+/**
+ * the layout follows the request data and at least one byte of padding (the string terminator in the worker),
+ * swDataHead.ext_flags is the length of both
+ */
+static int swPort_dispatch_http(swServer *serv, swProtocol *protocol, swSocket *_socket, swString *buffer, size_t length)
+{
+    static thread_local swString *layout = nullptr;
+    static thread_local swString *pipeline_buffer = nullptr;
+
+    if (!serv->http_parse_in_reactor)
+    {
+        return swReactorThread_dispatch(protocol, _socket, buffer->str, length);
+    }
+    if (!layout)
+    {
+        layout = swString_new(SW_BUFFER_SIZE_STD);
+        pipeline_buffer = swString_new(SW_BUFFER_SIZE_STD);
+        if (!layout || !pipeline_buffer)
+        {
+            return swReactorThread_dispatch(protocol, _socket, buffer->str, length);
+        }
+    }
+    if (swHttpRequest_get_layout(buffer->str, length, layout) < 0)
+    {
+        // invalid or chunked request, it is parsed by the worker
+        return swReactorThread_dispatch(protocol, _socket, buffer->str, length);
+    }
+
+    size_t padding = sizeof(uint32_t) - length % sizeof(uint32_t);
+    size_t packet_length = length + padding + layout->length;
+    swString *packet = buffer;
+    if (buffer->length > length)
+    {
+        // the next request of the pipeline is in the buffer
+        packet = pipeline_buffer;
+        swString_clear(packet);
+        if (swString_append_ptr(packet, buffer->str, length) < 0)
+        {
+            return swReactorThread_dispatch(protocol, _socket, buffer->str, length);
+        }
+    }
+    if (packet_length > packet->size && swString_extend_align(packet, packet_length) < 0)
+    {
+        return swReactorThread_dispatch(protocol, _socket, buffer->str, length);
+    }
+    bzero(packet->str + length, padding);
+    memcpy(packet->str + length + padding, layout->str, layout->length);
+
+    protocol->ext_flags = padding + layout->length;
+    return swReactorThread_dispatch(protocol, _socket, packet->str, packet_length);
+}
+
 static int swPort_onRead_http(swReactor *reactor, swListenPort *port, swEvent *event)
 {
     swSocket *_socket = event->socket;
@@ -553,11 +605,12 @@ static int swPort_onRead_http(swReactor *reactor, swListenPort *port, swEvent *e
         // (know content-length is equal to 0) or (no content-length field and no chunked)
         if (request->content_length == 0 && (request->known_length || !request->chunked))
         {
-            // send static file content directly in the reactor thread
-            if (!serv->enable_static_handler || !swServer_http_static_handler_hit(serv, request, conn))
+            // send static file content or the cached response directly in the reactor thread
+            if ((!serv->enable_static_handler || !swServer_http_static_handler_hit(serv, request, conn))
+                    && (!serv->http_response_cache_capacity || !swServer_http_cache_hit(serv, request, conn)))
             {
                 // dynamic request, dispatch to worker
-                swReactorThread_dispatch(protocol, _socket, buffer->str, request->header_length);
+                swPort_dispatch_http(serv, protocol, _socket, buffer, request->header_length);
             }
             if (conn->active && buffer->length > request->header_length)
             {
@@ -614,6 +667,32 @@ static int swPort_onRead_http(swReactor *reactor, swListenPort *port, swEvent *e
     else
     {
         request_length = request->header_length + request->content_length;
+        if (serv->http_body_stream)
+        {
+            // the head and then the pieces of the body are dispatched as they arrive
+            size_t length = SW_MIN(buffer->length, request_length - request->stream_offset);
+            if (request->stream_offset == 0)
+            {
+                swPort_dispatch_http(serv, protocol, _socket, buffer, length);
+                // the clients wait for it before sending a large body
+                if (length < request_length && swHttpRequest_has_expect_header(request))
+                {
+                    swSocket_send(_socket, SW_STRL(SW_HTTP_100_CONTINUE_PACKET), 0);
+                }
+            }
+            else
+            {
+                swReactorThread_dispatch(protocol, _socket, buffer->str, length);
+            }
+            request->stream_offset += length;
+            if (request->stream_offset < request_length)
+            {
+                swString_clear(buffer);
+                goto _recv_data;
+            }
+            swHttpRequest_free(conn);
+            return SW_OK;
+        }
         if (request_length > protocol->package_max_length)
         {
             swoole_error_log(
@@ -660,7 +739,7 @@ static int swPort_onRead_http(swReactor *reactor, swListenPort *port, swEvent *e
         buffer->length = request_length;
     }
 
-    swReactorThread_dispatch(protocol, _socket, buffer->str, buffer->length);
+    swPort_dispatch_http(serv, protocol, _socket, buffer, buffer->length);
     swHttpRequest_free(conn);
 
     return SW_OK;
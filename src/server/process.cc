@@ -34,10 +34,13 @@ static int swFactoryProcess_shutdown(swFactory *factory);
 static int swFactoryProcess_end(swFactory *factory, int fd);
 static void swFactoryProcess_free(swFactory *factory);
 static int swFactoryProcess_create_pipes(swFactory *factory);
+static int swFactoryProcess_create_rings(swFactory *factory);
+static void swFactoryProcess_free_rings(swFactory *factory);
 
 static int process_send_packet(swServer *serv, swPipeBuffer *buf, swSendData *resp, send_func_t _send, void* private_data);
 static int process_sendto_worker(swServer *serv, swPipeBuffer *buf, size_t n, void *private_data);
 static int process_sendto_reactor(swServer *serv, swPipeBuffer *buf, size_t n, void *private_data);
+static int process_send_to_worker(swServer *serv, swWorker *worker, swSendData *task);
 
 int swFactoryProcess_create(swFactory *factory, uint32_t worker_num)
 {
@@ -102,6 +105,8 @@ static void swFactoryProcess_free(swFactory *factory)
     {
         object->pipes[i].close(&object->pipes[i]);
     }
+
+    swFactoryProcess_free_rings(factory);
 }
 
 static int swFactoryProcess_create_pipes(swFactory *factory)
@@ -140,6 +145,80 @@ static int swFactoryProcess_create_pipes(swFactory *factory)
     return SW_OK;
 }
 
+static int swFactoryProcess_create_rings(swFactory *factory)
+{
+    swServer *serv = (swServer *) factory->ptr;
+    uint32_t n = serv->worker_num * serv->reactor_num;
+
+    serv->ipc_rings = (swIpcRing *) sw_shm_calloc(n, sizeof(swIpcRing));
+    serv->ipc_ring_owners = (sw_atomic_t *) sw_shm_calloc(serv->worker_num, sizeof(sw_atomic_t));
+    serv->ipc_ring_notify = (swPipe *) sw_calloc(serv->worker_num, sizeof(swPipe));
+    if (!serv->ipc_rings || !serv->ipc_ring_owners || !serv->ipc_ring_notify)
+    {
+        swWarn("malloc[ipc_rings] failed");
+        goto _error;
+    }
+
+    for (uint32_t i = 0; i < n; i++)
+    {
+        serv->ipc_rings[i].ring = swShmRing_new(SW_MAX(serv->ipc_ring_size, SW_IPC_RING_MIN_SIZE));
+        if (!serv->ipc_rings[i].ring)
+        {
+            goto _error;
+        }
+    }
+    for (uint32_t i = 0; i < serv->worker_num; i++)
+    {
+        swPipe *notify = &serv->ipc_ring_notify[i];
+        if (swPipeNotify_auto(notify, 0, 0) < 0)
+        {
+            goto _error;
+        }
+        notify->getSocket(notify, SW_PIPE_WORKER)->fdtype = SW_FD_IPC_RING;
+    }
+    return SW_OK;
+
+    _error:
+    swFactoryProcess_free_rings(factory);
+    return SW_ERR;
+}
+
+static void swFactoryProcess_free_rings(swFactory *factory)
+{
+    swServer *serv = (swServer *) factory->ptr;
+
+    if (serv->ipc_rings)
+    {
+        for (uint32_t i = 0; i < serv->worker_num * serv->reactor_num; i++)
+        {
+            if (serv->ipc_rings[i].ring)
+            {
+                swShmRing_free(serv->ipc_rings[i].ring);
+            }
+        }
+        sw_shm_free(serv->ipc_rings);
+        serv->ipc_rings = NULL;
+    }
+    if (serv->ipc_ring_owners)
+    {
+        sw_shm_free((void *) serv->ipc_ring_owners);
+        serv->ipc_ring_owners = NULL;
+    }
+    if (serv->ipc_ring_notify)
+    {
+        for (uint32_t i = 0; i < serv->worker_num; i++)
+        {
+            swPipe *notify = &serv->ipc_ring_notify[i];
+            if (notify->close)
+            {
+                notify->close(notify);
+            }
+        }
+        sw_free(serv->ipc_ring_notify);
+        serv->ipc_ring_notify = NULL;
+    }
+}
+
 static int swFactoryProcess_start(swFactory *factory)
 {
     swServer *serv = (swServer *) factory->ptr;
@@ -178,6 +257,11 @@ static int swFactoryProcess_start(swFactory *factory)
         return SW_ERR;
     }
 
+    if (serv->ipc_ring_size > 0 && swFactoryProcess_create_rings(factory) < 0)
+    {
+        return SW_ERR;
+    }
+
     swServer_set_ipc_max_size(serv);
     if (swServer_create_pipe_buffers(serv) < 0)
     {
@@ -274,6 +358,35 @@ static int swFactoryProcess_dispatch(swFactory *factory, swSendData *task)
 
     swWorker *worker = swServer_get_worker(serv, target_worker_id);
 
+    if (task->data && task->info.type == SW_SERVER_EVENT_SEND_DATA)
+    {
+        worker->dispatch_count++;
+    }
+
+    /**
+     * the worker counts it down when the request is done
+     */
+    bool inflight = serv->dispatch_mode == SW_DISPATCH_LEAST_LATENCY && swEventData_is_request(task->info.type);
+    if (inflight)
+    {
+        sw_atomic_fetch_add(&worker->inflight_num, 1);
+    }
+
+    int retval = process_send_to_worker(serv, worker, task);
+    if (retval < 0 && inflight)
+    {
+        sw_atomic_fetch_sub(&worker->inflight_num, 1);
+    }
+    return retval;
+}
+
+static int process_send_to_worker(swServer *serv, swWorker *worker, swSendData *task)
+{
+    if (serv->ipc_rings && swReactorThread_send2worker_ring(serv, worker, &task->info, task->data) == SW_OK)
+    {
+        return SW_OK;
+    }
+
     //without data
     if (task->data == NULL)
     {
@@ -281,11 +394,6 @@ static int swFactoryProcess_dispatch(swFactory *factory, swSendData *task)
         return swReactorThread_send2worker(serv, worker, &task->info, sizeof(task->info));
     }
 
-    if (task->info.type == SW_SERVER_EVENT_SEND_DATA)
-    {
-        worker->dispatch_count++;
-    }
-
     /**
      * Multi-Threads
      */
@@ -422,7 +530,10 @@ static int swFactoryProcess_finish(swFactory *factory, swSendData *resp)
                 "send %d byte failed, because connection[fd=%d] is closed", resp->info.len, session_id);
         return SW_ERR;
     }
-    else if (conn->overflow)
+    /**
+     * the output buffer of each session is checked by the reactor
+     */
+    else if (conn->overflow && resp->info.type != SW_SERVER_EVENT_BROADCAST)
     {
         if (serv->send_yield && process_is_supported_send_yield(serv, conn))
         {
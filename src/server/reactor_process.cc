@@ -242,7 +242,7 @@ static int swReactorProcess_onPipeRead(swReactor *reactor, swEvent *event)
         if (task.info.type == SW_SERVER_EVENT_PROXY_END)
         {
             memcpy(&_send.info, &task.info, sizeof(_send.info));
-            _send.info.type = SW_SERVER_EVENT_SEND_DATA;
+            _send.info.type = task.info.ext_flags;
             _send.data = output_buffer->str;
             _send.info.len = output_buffer->length;
             factory->finish(factory, &_send);
@@ -539,11 +539,15 @@ static int swReactorProcess_send2client(swFactory *factory, swSendData *data)
         swEventData proxy_msg;
         bzero(&proxy_msg.info, sizeof(proxy_msg.info));
 
-        if (data->info.type == SW_SERVER_EVENT_SEND_DATA)
+        if (data->info.type == SW_SERVER_EVENT_SEND_DATA || data->info.type == SW_SERVER_EVENT_BROADCAST
+                || data->info.type == SW_SERVER_EVENT_HTTP_CACHE)
         {
             proxy_msg.info.fd = session_id;
             proxy_msg.info.reactor_id = SwooleWG.id;
             proxy_msg.info.type = SW_SERVER_EVENT_PROXY_START;
+            // the original event type, the sessions of a broadcast packet are all held by the target worker
+            // and a http response is cached by the reactor of the target worker
+            proxy_msg.info.ext_flags = data->info.type;
 
             size_t send_n = data->info.len;
             size_t offset = 0;
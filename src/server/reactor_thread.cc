@@ -124,6 +124,126 @@ static void swReactorThread_onStreamResponse(swStream *stream, char *data, uint3
     swServer_master_send(serv, &response);
 }
 
+static int swReactorThread_dispatch_packet(swServer *serv, swConnection *server_sock, swDgramPacket *pkt, uint32_t length)
+{
+    swFactory *factory = &serv->factory;
+    swSendData task;
+    int socket_type = server_sock->socket_type;
+
+    bzero(&task.info, sizeof(task.info));
+    task.info.server_fd = server_sock->fd;
+    task.info.reactor_id = SwooleTG.id;
+    task.info.type = SW_SERVER_EVENT_SNED_DGRAM;
+#ifdef SW_BUFFER_RECV_TIME
+    task.info.time = swoole_microtime();
+#endif
+
+    if (socket_type == SW_SOCK_UDP)
+    {
+        memcpy(&task.info.fd, &pkt->socket_addr.addr.inet_v4.sin_addr, sizeof(task.info.fd));
+    }
+    else if (socket_type == SW_SOCK_UDP6)
+    {
+        memcpy(&task.info.fd, &pkt->socket_addr.addr.inet_v6.sin6_addr, sizeof(task.info.fd));
+    }
+    else
+    {
+        task.info.fd = swoole_crc32(pkt->socket_addr.addr.un.sun_path, pkt->socket_addr.len);
+    }
+
+    pkt->socket_type = socket_type;
+    pkt->length = length;
+    task.info.len = sizeof(*pkt) + length;
+    task.data = (char*) pkt;
+
+    return factory->dispatch(factory, &task);
+}
+
+#ifdef HAVE_RECVMMSG
+/**
+ * each slot holds a whole datagram
+ */
+#define SW_DGRAM_SLOT_SIZE  SW_MEM_ALIGNED_SIZE(sizeof(swDgramPacket) + SW_BUFFER_SIZE_UDP)
+
+static thread_local char *dgram_slots = nullptr;
+static thread_local struct mmsghdr *dgram_msgs = nullptr;
+static thread_local struct iovec *dgram_iovs = nullptr;
+
+static bool swReactorThread_create_dgram_slots(uint32_t burst)
+{
+    dgram_slots = (char *) sw_malloc(SW_DGRAM_SLOT_SIZE * burst);
+    dgram_msgs = (struct mmsghdr *) sw_calloc(burst, sizeof(struct mmsghdr));
+    dgram_iovs = (struct iovec *) sw_calloc(burst, sizeof(struct iovec));
+    if (!dgram_slots || !dgram_msgs || !dgram_iovs)
+    {
+        swWarn("malloc(%u) failed", SW_DGRAM_SLOT_SIZE * burst);
+        sw_free(dgram_slots);
+        sw_free(dgram_msgs);
+        sw_free(dgram_iovs);
+        dgram_slots = nullptr;
+        return false;
+    }
+    for (uint32_t i = 0; i < burst; i++)
+    {
+        swDgramPacket *pkt = (swDgramPacket *) (dgram_slots + SW_DGRAM_SLOT_SIZE * i);
+        dgram_iovs[i].iov_base = pkt->data;
+        dgram_iovs[i].iov_len = SW_BUFFER_SIZE_UDP;
+        dgram_msgs[i].msg_hdr.msg_iov = &dgram_iovs[i];
+        dgram_msgs[i].msg_hdr.msg_iovlen = 1;
+        dgram_msgs[i].msg_hdr.msg_name = &pkt->socket_addr.addr;
+    }
+    return true;
+}
+
+/**
+ * read up to dgram_recv_burst datagrams with one recvmmsg call
+ */
+static int swReactorThread_onPacketBurst(swServer *serv, swConnection *server_sock)
+{
+    uint32_t burst = serv->dgram_recv_burst;
+    if (!dgram_slots && !swReactorThread_create_dgram_slots(burst))
+    {
+        return SW_ERR;
+    }
+
+    while (true)
+    {
+        for (uint32_t i = 0; i < burst; i++)
+        {
+            dgram_msgs[i].msg_hdr.msg_namelen = sizeof(((swSocketAddress *) 0)->addr);
+        }
+
+        int n = recvmmsg(server_sock->fd, dgram_msgs, burst, 0, nullptr);
+        if (n <= 0)
+        {
+            if (errno == EAGAIN)
+            {
+                return SW_OK;
+            }
+            else if (errno == EINTR)
+            {
+                continue;
+            }
+            swSysWarn("recvmmsg(%d) failed", server_sock->fd);
+            return SW_ERR;
+        }
+
+        for (int i = 0; i < n; i++)
+        {
+            swDgramPacket *pkt = (swDgramPacket *) (dgram_slots + SW_DGRAM_SLOT_SIZE * i);
+            pkt->socket_addr.len = dgram_msgs[i].msg_hdr.msg_namelen;
+            // the failed packet is dropped, the rest of the burst is still dispatched
+            swReactorThread_dispatch_packet(serv, server_sock, pkt, dgram_msgs[i].msg_len);
+        }
+
+        if ((uint32_t) n < burst)
+        {
+            return SW_OK;
+        }
+    }
+}
+#endif
+
 /**
  * for udp
  */
@@ -134,24 +254,26 @@ static int swReactorThread_onPacketReceived(swReactor *reactor, swEvent *event)
 
     swServer *serv = (swServer *) reactor->ptr;
     swConnection *server_sock = &serv->connection_list[fd];
-    swSendData task;
     swDgramPacket *pkt = (swDgramPacket *) SwooleTG.buffer_stack->str;
-    swFactory *factory = &serv->factory;
-
-    pkt->socket_addr.len = sizeof(pkt->socket_addr.addr);
 
-    bzero(&task.info, sizeof(task.info));
-    task.info.server_fd = fd;
-    task.info.reactor_id = SwooleTG.id;
-    task.info.type = SW_SERVER_EVENT_SNED_DGRAM;
-#ifdef SW_BUFFER_RECV_TIME
-    task.info.time = swoole_microtime();
+#ifdef SW_SUPPORT_DTLS
+    swListenPort *port = (swListenPort *) server_sock->object;
 #endif
 
-    int socket_type = server_sock->socket_type;
+#ifdef HAVE_RECVMMSG
+    if (serv->dgram_recv_burst > 1
+#ifdef SW_SUPPORT_DTLS
+        && !port->ssl_option.dtls
+#endif
+    )
+    {
+        return swReactorThread_onPacketBurst(serv, server_sock);
+    }
+#endif
 
     _do_recvfrom:
 
+    pkt->socket_addr.len = sizeof(pkt->socket_addr.addr);
     ret = recvfrom(
         fd, pkt->data, SwooleTG.buffer_stack->size - sizeof(*pkt), 0,
         (struct sockaddr *) &pkt->socket_addr.addr, &pkt->socket_addr.len
@@ -171,8 +293,6 @@ static int swReactorThread_onPacketReceived(swReactor *reactor, swEvent *event)
     }
 
 #ifdef SW_SUPPORT_DTLS
-    swListenPort *port = (swListenPort *) server_sock->object;
-
     if (port->ssl_option.dtls)
     {
         swoole::dtls::Session *session = swServer_dtls_accept(serv, port, &pkt->socket_addr);
@@ -217,25 +337,7 @@ static int swReactorThread_onPacketReceived(swReactor *reactor, swEvent *event)
     }
 #endif
 
-    if (socket_type == SW_SOCK_UDP)
-    {
-        memcpy(&task.info.fd, &pkt->socket_addr.addr.inet_v4.sin_addr, sizeof(task.info.fd));
-    }
-    else if (socket_type == SW_SOCK_UDP6)
-    {
-        memcpy(&task.info.fd, &pkt->socket_addr.addr.inet_v6.sin6_addr, sizeof(task.info.fd));
-    }
-    else
-    {
-        task.info.fd = swoole_crc32(pkt->socket_addr.addr.un.sun_path, pkt->socket_addr.len);
-    }
-
-    pkt->socket_type = socket_type;
-    pkt->length = ret;
-    task.info.len = sizeof(*pkt) + ret;
-    task.data = (char*) pkt;
-
-    if (factory->dispatch(factory, &task) < 0)
+    if (swReactorThread_dispatch_packet(serv, server_sock, pkt, ret) < 0)
     {
         return SW_ERR;
     }
@@ -527,16 +629,87 @@ static int swReactorThread_onPipeRead(swReactor *reactor, swEvent *ev)
 
 int swReactorThread_send2worker(swServer *serv, swWorker *worker, void *data, size_t len)
 {
+    swIpcRing *ipc = NULL;
+    swDataHead *info = (swDataHead *) data;
+    int retval;
+
+    /**
+     * the worker has to drain the ring of this reactor before it handles the packet
+     */
+    if (serv->ipc_rings && info->reactor_id >= 0 && info->reactor_id < (int) serv->reactor_num)
+    {
+        ipc = swServer_get_ipc_ring(serv, worker->id, info->reactor_id);
+        info->flags |= SW_EVENT_DATA_RING;
+        sw_atomic_fetch_add(&ipc->pipe_send_count, 1);
+    }
+
     if (SwooleTG.reactor)
     {
         swReactorThread *thread = swServer_get_thread(serv, SwooleTG.id);
         swSocket *socket = &thread->pipe_sockets[worker->pipe_master->fd];
-        return swoole_event_write(socket, data, len);
+        retval = swoole_event_write(socket, data, len);
     }
     else
     {
-        return swSocket_write_blocking(worker->pipe_master, data, len);
+        retval = swSocket_write_blocking(worker->pipe_master, data, len);
+    }
+
+    if (retval < 0 && ipc)
+    {
+        sw_atomic_fetch_sub(&ipc->pipe_send_count, 1);
+    }
+    return retval;
+}
+
+/**
+ * [ReactorThread] write the packet once into the shared memory ring, the worker processes it in place.
+ * returns SW_ERR if the packet has to be sent through the pipe.
+ */
+int swReactorThread_send2worker_ring(swServer *serv, swWorker *worker, swDataHead *info, const char *data)
+{
+    int reactor_id = SwooleTG.id;
+    if (!SwooleTG.reactor || reactor_id >= (int) serv->reactor_num || info->reactor_id != reactor_id)
+    {
+        return SW_ERR;
+    }
+
+    swIpcRing *ipc = swServer_get_ipc_ring(serv, worker->id, reactor_id);
+    /**
+     * the packets in the pipe must be received first to keep the order
+     */
+    if (ipc->pipe_send_count != ipc->pipe_recv_count)
+    {
+        return SW_ERR;
+    }
+
+    uint32_t length = data ? info->len : 0;
+    if (sizeof(swDataHead) + length > ipc->ring->size / 4)
+    {
+        return SW_ERR;
+    }
+
+    swPipeBuffer *buf = (swPipeBuffer *) swShmRing_alloc(ipc->ring, sizeof(swDataHead) + length);
+    if (buf == NULL)
+    {
+        return SW_ERR;
+    }
+    buf->info = *info;
+    buf->info.flags = 0;
+    if (length > 0)
+    {
+        memcpy(buf->data, data, length);
     }
+
+    if (swShmRing_push(ipc->ring))
+    {
+        swPipe *notify = &serv->ipc_ring_notify[worker->id];
+        uint64_t flag = 1;
+        if (notify->write(notify, &flag, sizeof(flag)) < 0 && errno != EAGAIN)
+        {
+            swSysWarn("failed to wake up worker#%d", worker->id);
+        }
+    }
+    return SW_OK;
 }
 
 /**
@@ -15,14 +15,64 @@
  */
 
 #include "static_handler.h"
+#include "lru_cache.h"
+#include "async.h"
 
 #include <string>
 #include <dirent.h>
 #include <algorithm>
 
+#ifdef SW_HAVE_ZLIB
+#include <zlib.h>
+#include <unordered_set>
+#endif
+
 using namespace std;
+using swoole::LRUCache;
+using swoole::http::StaticFile;
 using swoole::http::StaticHandler;
 
+/**
+ * the static files are served by the reactor threads, each of them has its own cache
+ */
+static thread_local LRUCache *file_cache = nullptr;
+
+static inline bool file_changed(const struct stat *a, const struct stat *b)
+{
+    return a->st_ino != b->st_ino || a->st_dev != b->st_dev || a->st_size != b->st_size || a->st_mode != b->st_mode
+#ifdef __MACH__
+            || a->st_mtimespec.tv_sec != b->st_mtimespec.tv_sec || a->st_mtimespec.tv_nsec != b->st_mtimespec.tv_nsec;
+#else
+            || a->st_mtim.tv_sec != b->st_mtim.tv_sec || a->st_mtim.tv_nsec != b->st_mtim.tv_nsec;
+#endif
+}
+
+static void format_date(time_t time, char *buf, size_t size)
+{
+    struct tm tm1;
+    gmtime_r(&time, &tm1);
+    strftime(buf, size, "%a, %d %b %Y %H:%M:%S %Z", &tm1);
+}
+
+static inline time_t file_mtime(const struct stat *file_stat)
+{
+#ifdef __MACH__
+    return file_stat->st_mtimespec.tv_sec;
+#else
+    return file_stat->st_mtim.tv_sec;
+#endif
+}
+
+/**
+ * the same form as nginx: "mtime-size" in hex
+ */
+static std::string file_etag(const struct stat *file_stat)
+{
+    char etag[64];
+    int n = sw_snprintf(etag, sizeof(etag), "\"%lx-%lx\"", (unsigned long) file_mtime(file_stat), (unsigned long) file_stat->st_size);
+    return std::string(etag, n);
+}
+
 bool StaticHandler::is_modified(const string &date_if_modified_since)
 {
     char date_tmp[64];
@@ -58,22 +108,327 @@ bool StaticHandler::is_modified(const string &date_if_modified_since)
 
 std::string StaticHandler::get_date()
 {
-    char date_[64];
+    /**
+     * formatted once per second
+     */
+    static thread_local time_t date_time = 0;
+    static thread_local char date_[64];
     time_t now = time(NULL);
-    struct tm *tm1 = gmtime(&now);
-    strftime(date_, sizeof(date_), "%a, %d %b %Y %H:%M:%S %Z", tm1);
+    if (now != date_time)
+    {
+        format_date(now, date_, sizeof(date_));
+        date_time = now;
+    }
     return std::string(date_);
 }
 
 std::string StaticHandler::get_date_last_modified()
 {
+    if (file)
+    {
+        return file->date_last_modified;
+    }
     char date_last_modified[64];
-    time_t file_mtime = get_file_mtime();
-    struct tm *tm2 = gmtime(&file_mtime);
-    strftime(date_last_modified, sizeof(date_last_modified), "%a, %d %b %Y %H:%M:%S %Z", tm2);
+    format_date(get_file_mtime(), date_last_modified, sizeof(date_last_modified));
     return std::string(date_last_modified);
 }
 
+std::string StaticHandler::get_etag()
+{
+    if (file)
+    {
+        return file->etag;
+    }
+    return file_etag(&file_stat);
+}
+
+bool StaticHandler::is_etag_matched(const std::string &if_none_match)
+{
+    if (if_none_match == "*")
+    {
+        return true;
+    }
+    std::string etag = get_etag();
+    const char *p = if_none_match.c_str();
+    const char *pe = p + if_none_match.length();
+    /**
+     * weak comparison, W/"xxx" matches "xxx"
+     */
+    while (p < pe)
+    {
+        while (p < pe && (isspace(*p) || *p == ','))
+        {
+            p++;
+        }
+        if (pe - p > 2 && p[0] == 'W' && p[1] == '/')
+        {
+            p += 2;
+        }
+        const char *tag = p;
+        while (p < pe && *p != ',')
+        {
+            p++;
+        }
+        const char *tag_end = p;
+        while (tag_end > tag && isspace(*(tag_end - 1)))
+        {
+            tag_end--;
+        }
+        if (swoole_streq(tag, tag_end - tag, etag.c_str(), etag.length()))
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+static const char *parse_range_number(const char *p, const char *pe, off_t *value)
+{
+    *value = -1;
+    if (p < pe && isdigit(*p))
+    {
+        off_t n = 0;
+        for (; p < pe && isdigit(*p); p++)
+        {
+            if (n > (INT64_MAX - 9) / 10)
+            {
+                return nullptr;
+            }
+            n = n * 10 + (*p - '0');
+        }
+        *value = n;
+    }
+    return p;
+}
+
+/**
+ * RFC 7233, returns false when the header must be ignored and the whole file is sent
+ */
+bool StaticHandler::parse_range(const std::string &range, const std::string &if_range)
+{
+    ranges.clear();
+    if (range.empty() || !SW_STRCASECT(range.c_str(), range.length(), "bytes="))
+    {
+        return false;
+    }
+    /**
+     * strong comparison with the validator, a weak ETag never matches
+     */
+    if (!if_range.empty())
+    {
+        if (if_range[0] == '"' ? if_range != get_etag() : if_range != get_date_last_modified())
+        {
+            return false;
+        }
+    }
+
+    off_t size = get_filesize();
+    const char *p = range.c_str() + (sizeof("bytes=") - 1);
+    const char *pe = range.c_str() + range.length();
+    int count = 0;
+
+    while (p < pe)
+    {
+        off_t start, end;
+        while (p < pe && (isspace(*p) || *p == ','))
+        {
+            p++;
+        }
+        if (p == pe)
+        {
+            break;
+        }
+        if (++count > SW_HTTP_MAX_RANGES)
+        {
+            ranges.clear();
+            return false;
+        }
+        p = parse_range_number(p, pe, &start);
+        if (p == nullptr || p == pe || *p != '-')
+        {
+            ranges.clear();
+            return false;
+        }
+        p = parse_range_number(p + 1, pe, &end);
+        if (p == nullptr || (p < pe && *p != ',' && !isspace(*p)) || (start < 0 && end < 0)
+                || (start >= 0 && end >= 0 && end < start))
+        {
+            ranges.clear();
+            return false;
+        }
+        // suffix-byte-range-spec: the last N bytes
+        if (start < 0)
+        {
+            if (end == 0 || size == 0)
+            {
+                continue;
+            }
+            start = end > size ? 0 : size - end;
+            end = size - 1;
+        }
+        else
+        {
+            if (start >= size)
+            {
+                continue;
+            }
+            if (end < 0 || end >= size)
+            {
+                end = size - 1;
+            }
+        }
+        ranges.push_back({start, (size_t) (end - start + 1)});
+    }
+
+    if (count == 0)
+    {
+        return false;
+    }
+    if (ranges.empty())
+    {
+        status_code = SW_HTTP_RANGE_NOT_SATISFIABLE;
+        return true;
+    }
+    status_code = SW_HTTP_PARTIAL_CONTENT;
+    if (ranges.size() > 1)
+    {
+        swoole_random_string(boundary, SW_HTTP_RANGE_BOUNDARY_LEN);
+    }
+    return true;
+}
+
+/**
+ * the delimiter and the headers of a multipart/byteranges body part
+ */
+std::string StaticHandler::get_part_header(const range_t &range)
+{
+    char header[512];
+    int n = sw_snprintf(header, sizeof(header),
+        "\r\n--%s\r\n"
+        "Content-Type: %s\r\n"
+        "Content-Range: bytes %ld-%ld/%ld\r\n\r\n",
+        boundary, get_mimetype(),
+        (long) range.offset, (long) (range.offset + range.length - 1), (long) get_filesize()
+    );
+    return std::string(header, n);
+}
+
+size_t StaticHandler::get_content_length()
+{
+    if (status_code != SW_HTTP_PARTIAL_CONTENT)
+    {
+        return get_filesize();
+    }
+    if (ranges.size() == 1)
+    {
+        return ranges[0].length;
+    }
+    size_t length = 0;
+    for (auto &range : ranges)
+    {
+        length += get_part_header(range).length() + range.length;
+    }
+    // the close-delimiter
+    return length + sizeof("\r\n----\r\n") - 1 + SW_HTTP_RANGE_BOUNDARY_LEN;
+}
+
+/**
+ * a cached entry without a regular file means that the file does not exist
+ */
+static shared_ptr<StaticFile> find_cached_file(const std::string &key, double interval)
+{
+    if (file_cache == nullptr)
+    {
+        return nullptr;
+    }
+
+    auto cached = std::static_pointer_cast<StaticFile>(file_cache->get(key));
+    if (!cached)
+    {
+        return nullptr;
+    }
+
+    double now = swoole_microtime();
+    if (now - cached->checked_at >= interval)
+    {
+        /**
+         * the cached fd follows the symlinks, so does the check
+         */
+        struct stat _stat;
+        bool exists = stat(cached->filename.c_str(), &_stat) == 0;
+        if (!S_ISREG(cached->file_stat.st_mode) ? exists : (!exists || file_changed(&_stat, &cached->file_stat)))
+        {
+            swTraceLog(SW_TRACE_HTTP, "static file[%s] is changed", cached->filename.c_str());
+            file_cache->del(key);
+            return nullptr;
+        }
+        cached->checked_at = now;
+    }
+    return cached;
+}
+
+void StaticHandler::set_file(const shared_ptr<StaticFile> &_file)
+{
+    file = _file;
+    file_stat = _file->file_stat;
+    l_filename = _file->filename.length();
+    memcpy(task.filename, _file->filename.c_str(), l_filename + 1);
+    task.length = get_filesize();
+    task.fd = _file->fd;
+}
+
+bool StaticHandler::get_cached_file(const char *url, size_t length)
+{
+    std::string key(url, length);
+    auto cached = find_cached_file(key, serv->static_handler_cache_interval);
+    if (!cached)
+    {
+        return false;
+    }
+
+    set_file(cached);
+    dir_path = key;
+
+    return true;
+}
+
+void StaticHandler::set_cached_file(const char *url, size_t length)
+{
+    if (file_cache == nullptr)
+    {
+        file_cache = new LRUCache(serv->static_handler_cache_capacity);
+    }
+
+    auto cached = std::make_shared<StaticFile>();
+    cached->fd = open(task.filename, O_RDONLY | O_CLOEXEC);
+    if (cached->fd < 0)
+    {
+        return;
+    }
+    /**
+     * the file may be replaced after stat()
+     */
+    struct stat _stat;
+    if (fstat(cached->fd, &_stat) < 0 || file_changed(&_stat, &file_stat))
+    {
+        return;
+    }
+
+    char date_last_modified[64];
+    format_date(get_file_mtime(), date_last_modified, sizeof(date_last_modified));
+
+    cached->file_stat = file_stat;
+    cached->etag = get_etag();
+    cached->filename = std::string(task.filename, l_filename);
+    cached->mime_type = swoole::mime_type::get(task.filename);
+    cached->date_last_modified = date_last_modified;
+    cached->checked_at = swoole_microtime();
+    file_cache->set(std::string(url, length), cached);
+
+    file = cached;
+    task.fd = cached->fd;
+}
+
 bool StaticHandler::hit()
 {
     char *p = task.filename;
@@ -113,6 +468,11 @@ bool StaticHandler::hit()
         return false;
     }
 
+    if (serv->static_handler_cache_capacity > 0 && get_cached_file(url, n))
+    {
+        return true;
+    }
+
     memcpy(p, url, n);
     p += n;
     *p = '\0';
@@ -195,9 +555,279 @@ bool StaticHandler::hit()
     }
     task.length = get_filesize();
 
+    if (serv->static_handler_cache_capacity > 0)
+    {
+        set_cached_file(url, n);
+    }
+
     return true;
 }
 
+#ifdef SW_HAVE_ZLIB
+/**
+ * the .gz files are built in the aio thread pool, the original files are sent meanwhile,
+ * the completions run in the reactor thread that dispatched the request
+ */
+static thread_local std::unordered_set<std::string> precompress_files;
+/**
+ * the files failed to build are not tried again while they are in the cache
+ */
+static thread_local LRUCache *precompress_failed_files = nullptr;
+
+static bool precompress_gzip(const std::string &filename, int level)
+{
+    std::string target = filename + ".gz";
+    std::string tmp_file = target + ".XXXXXX";
+    char buf[SW_BUFFER_SIZE_BIG];
+    char mode[8];
+    struct stat file_stat;
+    ssize_t n;
+    bool ok = true;
+
+    int fd = open(filename.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0)
+    {
+        return false;
+    }
+    int tmp_fd = mkstemp(&tmp_file[0]);
+    if (tmp_fd < 0 || fstat(fd, &file_stat) < 0 || fchmod(tmp_fd, file_stat.st_mode & 0777) < 0)
+    {
+        close(fd);
+        if (tmp_fd >= 0)
+        {
+            close(tmp_fd);
+            unlink(tmp_file.c_str());
+        }
+        return false;
+    }
+
+    sw_snprintf(mode, sizeof(mode), "wb%d", SW_MAX(Z_BEST_SPEED, SW_MIN(level, Z_BEST_COMPRESSION)));
+    gzFile gz = gzdopen(tmp_fd, mode);
+    if (gz == nullptr)
+    {
+        close(fd);
+        close(tmp_fd);
+        unlink(tmp_file.c_str());
+        return false;
+    }
+    while ((n = read(fd, buf, sizeof(buf))) > 0)
+    {
+        if (gzwrite(gz, buf, n) != n)
+        {
+            ok = false;
+            break;
+        }
+    }
+    close(fd);
+    if (gzclose(gz) != Z_OK || n < 0 || !ok || rename(tmp_file.c_str(), target.c_str()) < 0)
+    {
+        unlink(tmp_file.c_str());
+        return false;
+    }
+    return true;
+}
+
+static void precompress_handler(swAio_event *event)
+{
+    std::string *filename = (std::string *) event->req;
+    if (precompress_gzip(*filename, event->flags))
+    {
+        event->ret = 0;
+    }
+    else
+    {
+        event->ret = -1;
+        event->error = errno;
+    }
+}
+
+static void precompress_callback(swAio_event *event)
+{
+    std::string *filename = (std::string *) event->req;
+    if (event->ret < 0)
+    {
+        errno = event->error;
+        swSysWarn("failed to build %s.gz", filename->c_str());
+        if (precompress_failed_files == nullptr)
+        {
+            precompress_failed_files = new LRUCache(SW_HTTP_PRECOMPRESS_FAILED_NUM);
+        }
+        precompress_failed_files->set(*filename, std::make_shared<bool>(true));
+    }
+    else
+    {
+        swTraceLog(SW_TRACE_HTTP, "%s.gz is built", filename->c_str());
+    }
+    precompress_files.erase(*filename);
+    delete filename;
+}
+
+static void precompress(const std::string &filename, int level)
+{
+    if (!SwooleTG.reactor || (precompress_failed_files && precompress_failed_files->get(filename)))
+    {
+        return;
+    }
+    if (!precompress_files.insert(filename).second)
+    {
+        return;
+    }
+
+    swAio_event ev;
+    bzero(&ev, sizeof(swAio_event));
+    ev.req = new std::string(filename);
+    ev.flags = level;
+    ev.lane = SW_AIO_LANE_FILE;
+    ev.handler = precompress_handler;
+    ev.callback = precompress_callback;
+
+    if (swAio_dispatch(&ev) < 0)
+    {
+        precompress_files.erase(filename);
+        delete (std::string *) ev.req;
+    }
+}
+
+static bool is_compressible(const std::string &mime_type)
+{
+    return mime_type.compare(0, 5, "text/") == 0 || mime_type.find("javascript") != std::string::npos
+            || mime_type.find("json") != std::string::npos || mime_type.find("xml") != std::string::npos;
+}
+#endif
+
+/**
+ * RFC 7231, the coding is listed (or "*") and its qvalue is not 0
+ */
+static bool is_encoding_accepted(const std::string &accept_encoding, const char *coding)
+{
+    const char *p = accept_encoding.c_str();
+    const char *pe = p + accept_encoding.length();
+    size_t coding_length = strlen(coding);
+
+    while (p < pe)
+    {
+        while (p < pe && (isspace(*p) || *p == ','))
+        {
+            p++;
+        }
+        const char *token = p;
+        while (p < pe && *p != ',' && *p != ';' && !isspace(*p))
+        {
+            p++;
+        }
+        size_t token_length = p - token;
+        const char *params = p;
+        while (p < pe && *p != ',')
+        {
+            p++;
+        }
+        if (!swoole_strcaseeq(token, token_length, coding, coding_length) && !SW_STREQ(token, token_length, "*"))
+        {
+            continue;
+        }
+        std::string q(params, p - params);
+        q.erase(std::remove_if(q.begin(), q.end(), ::isspace), q.end());
+        size_t pos = q.find("q=");
+        return pos == std::string::npos || atof(q.c_str() + pos + 2) > 0;
+    }
+    return false;
+}
+
+/**
+ * the sibling file.br, file.zst or file.gz is sent instead of the file, when the client accepts the coding
+ * and the variant is not older than the file, the variants are looked up only with the cache or precompress on
+ */
+bool StaticHandler::set_encoding(const std::string &accept_encoding)
+{
+    static const struct
+    {
+        const char *coding;
+        const char *extension;
+    } encodings[] = {
+        {"br", ".br"},
+        {"zstd", ".zst"},
+        {"gzip", ".gz"},
+    };
+
+    if (status_code != SW_HTTP_OK || accept_encoding.empty() || is_dir())
+    {
+        return false;
+    }
+    // otherwise every hit would stat() the variants
+    if (serv->static_handler_cache_capacity == 0 && !serv->static_handler_precompress)
+    {
+        return false;
+    }
+
+    std::string filename = get_filename_std_string();
+    for (auto &encoding : encodings)
+    {
+        if (!is_encoding_accepted(accept_encoding, encoding.coding))
+        {
+            continue;
+        }
+        std::string variant_filename = filename + encoding.extension;
+        if (variant_filename.length() >= PATH_MAX)
+        {
+            return false;
+        }
+
+        std::string key = dir_path + "\n" + encoding.coding;
+        shared_ptr<StaticFile> variant;
+        if (serv->static_handler_cache_capacity > 0)
+        {
+            variant = find_cached_file(key, serv->static_handler_cache_interval);
+        }
+        if (!variant)
+        {
+            variant = std::make_shared<StaticFile>();
+            variant->filename = variant_filename;
+            variant->checked_at = swoole_microtime();
+            if (stat(variant_filename.c_str(), &variant->file_stat) < 0 || !S_ISREG(variant->file_stat.st_mode)
+                    || (serv->static_handler_cache_capacity > 0
+                            && (variant->fd = open(variant_filename.c_str(), O_RDONLY | O_CLOEXEC)) < 0))
+            {
+                bzero(&variant->file_stat, sizeof(variant->file_stat));
+            }
+            else
+            {
+                char date_last_modified[64];
+                format_date(file_mtime(&variant->file_stat), date_last_modified, sizeof(date_last_modified));
+                variant->date_last_modified = date_last_modified;
+                variant->etag = file_etag(&variant->file_stat);
+                variant->mime_type = get_mimetype();
+            }
+            if (serv->static_handler_cache_capacity > 0)
+            {
+                if (file_cache == nullptr)
+                {
+                    file_cache = new LRUCache(serv->static_handler_cache_capacity);
+                }
+                file_cache->set(key, variant);
+            }
+        }
+        if (!S_ISREG(variant->file_stat.st_mode) || file_mtime(&variant->file_stat) < get_file_mtime())
+        {
+            continue;
+        }
+
+        swTraceLog(SW_TRACE_HTTP, "send %s instead of %s", variant->filename.c_str(), filename.c_str());
+        content_type = get_mimetype();
+        content_encoding = encoding.coding;
+        set_file(variant);
+        return true;
+    }
+
+#ifdef SW_HAVE_ZLIB
+    if (serv->static_handler_precompress && get_filesize() >= SW_HTTP_PRECOMPRESS_MIN_SIZE
+            && is_encoding_accepted(accept_encoding, "gzip") && is_compressible(get_mimetype()))
+    {
+        precompress(filename, serv->http_compression_level);
+    }
+#endif
+    return false;
+}
+
 size_t StaticHandler::get_index_page(std::set<std::string> &files, char *buffer, size_t size)
 {
     int ret = 0;
@@ -85,34 +85,101 @@ int swTaskWorker_onTask(swProcessPool *pool, swEventData *task)
     return ret;
 }
 
-int swTaskWorker_large_pack(swEventData *task, const void *data, size_t data_len)
+/**
+ * the slices are allocated before the workers are forked, so they have the same address in every process
+ */
+int swTaskWorker_create_shm(swServer *serv)
 {
-    swPacket_task pkg;
-    bzero(&pkg, sizeof(pkg));
-
-    memcpy(pkg.tmpfile, SwooleG.task_tmpdir, SwooleG.task_tmpdir_len);
+    if (serv->task_shm_size == 0)
+    {
+        return SW_OK;
+    }
 
-    //create temp file
-    int tmp_fd = swoole_tmpfile(pkg.tmpfile);
-    if (tmp_fd < 0)
+    uint32_t slice_size = SW_MEM_ALIGNED_SIZE(serv->task_shm_slice_size);
+    size_t size = SW_MEM_ALIGNED_SIZE(serv->task_shm_size);
+    if (size < (slice_size + sizeof(swFixedPool_slice)) * 2 + sizeof(swFixedPool) + sizeof(swMemoryPool))
     {
+        swWarn("task_shm_size[%u] is too small, at least 2 slices of %u bytes are required", serv->task_shm_size, slice_size);
         return SW_ERR;
     }
 
-    //write to file
-    if (swoole_sync_writefile(tmp_fd, data, data_len) != data_len)
+    void *memory = sw_shm_malloc(sizeof(swLock) + size);
+    if (memory == NULL)
+    {
+        swWarn("sw_shm_malloc(%zu) failed", sizeof(swLock) + size);
+        return SW_ERR;
+    }
+    serv->task_shm_lock = (swLock *) memory;
+    if (swMutex_create(serv->task_shm_lock, 1) < 0)
     {
-        swWarn("write to tmpfile failed");
+        sw_shm_free(memory);
+        serv->task_shm_lock = NULL;
         return SW_ERR;
     }
+    serv->task_shm_pool = swFixedPool_new2(slice_size, (char *) memory + sizeof(swLock), size);
+    return SW_OK;
+}
+
+void swTaskWorker_free_shm(swServer *serv)
+{
+    if (serv->task_shm_lock)
+    {
+        serv->task_shm_lock->free(serv->task_shm_lock);
+        sw_shm_free(serv->task_shm_lock);
+        serv->task_shm_lock = NULL;
+        serv->task_shm_pool = NULL;
+    }
+}
+
+static char* swTaskWorker_shm_alloc(swServer *serv, size_t data_len)
+{
+    if (!serv || !serv->task_shm_pool || data_len > SW_MEM_ALIGNED_SIZE(serv->task_shm_slice_size))
+    {
+        return NULL;
+    }
+    serv->task_shm_lock->lock(serv->task_shm_lock);
+    char *shm_data = (char *) serv->task_shm_pool->alloc(serv->task_shm_pool, data_len);
+    serv->task_shm_lock->unlock(serv->task_shm_lock);
+    return shm_data;
+}
+
+int swTaskWorker_large_pack(swEventData *task, const void *data, size_t data_len)
+{
+    swPacket_task pkg;
+    bzero(&pkg, sizeof(pkg));
+
+    pkg.shm_data = swTaskWorker_shm_alloc((swServer *) SwooleG.serv, data_len);
+    if (pkg.shm_data)
+    {
+        memcpy(pkg.shm_data, data, data_len);
+    }
+    else
+    {
+        memcpy(pkg.tmpfile, SwooleG.task_tmpdir, SwooleG.task_tmpdir_len);
+
+        //create temp file
+        int tmp_fd = swoole_tmpfile(pkg.tmpfile);
+        if (tmp_fd < 0)
+        {
+            return SW_ERR;
+        }
+
+        //write to file
+        if (swoole_sync_writefile(tmp_fd, data, data_len) != data_len)
+        {
+            swWarn("write to tmpfile failed");
+            close(tmp_fd);
+            return SW_ERR;
+        }
+        close(tmp_fd);
+    }
 
     task->info.len = sizeof(swPacket_task);
-    //use tmp file
+    //use tmp file or shm
     swTask_type(task) |= SW_TASK_TMPFILE;
 
     pkg.length = data_len;
     memcpy(task->data, &pkg, sizeof(swPacket_task));
-    close(tmp_fd);
     return SW_OK;
 }
 
@@ -28,6 +28,21 @@ static int swWorker_onStreamRead(swReactor *reactor, swEvent *event);
 static int swWorker_onStreamPackage(swProtocol *proto, swSocket *sock, char *data, uint32_t length);
 static int swWorker_onStreamClose(swReactor *reactor, swEvent *event);
 static int swWorker_reactor_is_empty(swReactor *reactor);
+static int swWorker_onIpcRingNotify(swReactor *reactor, swEvent *event);
+static void swWorker_ipc_ring_start(swServer *serv, swWorker *worker);
+static void swWorker_ipc_ring_stop(swServer *serv, swWorker *worker);
+static void swWorker_ipc_ring_release(swServer *serv, swWorker *worker);
+static bool swWorker_ipc_ring_drain(swServer *serv, swShmRing *ring, uint32_t *count);
+
+/**
+ * state of the shared memory rings consumed by this worker
+ */
+static struct
+{
+    bool owned;
+    bool draining;
+    swTimer_node *timer;
+} ipc_ring;
 
 void swWorker_signal_init(void)
 {
@@ -239,12 +254,54 @@ static int swWorker_onStreamPackage(swProtocol *proto, swSocket *sock, char *dat
 
 typedef int (*task_callback)(swServer *, swEventData *);
 
+/**
+ * only the worker itself writes it, the reactor threads read it to schedule
+ */
+static sw_inline void swWorker_update_service_time(swWorker *worker, double usec)
+{
+    int64_t sample = SW_MIN(usec, UINT32_MAX);
+    int64_t average = worker->service_time;
+    if (average == 0)
+    {
+        worker->service_time = SW_MAX(sample, 1);
+    }
+    else
+    {
+        worker->service_time = SW_MAX(average + ((sample - average) >> SW_WORKER_SERVICE_TIME_EWMA_SHIFT), 1);
+    }
+}
+
+/**
+ * the counter is reset when the worker is respawned, the requests still queued for the previous worker must not wrap it
+ */
+static sw_inline void swWorker_inflight_done(swWorker *worker)
+{
+    sw_atomic_t n;
+    do
+    {
+        n = worker->inflight_num;
+        if (n == 0)
+        {
+            return;
+        }
+    } while (!sw_atomic_cmp_set(&worker->inflight_num, n, n - 1));
+}
+
 static sw_inline void swWorker_do_task(swServer *serv, swWorker *worker, swEventData *task, task_callback callback)
 {
 #ifdef SW_BUFFER_RECV_TIME
     serv->last_receive_usec = task->info.time;
 #endif
-    callback(serv, task);
+    if (serv->dispatch_mode == SW_DISPATCH_LEAST_LATENCY)
+    {
+        double start_time = swoole_microtime();
+        callback(serv, task);
+        swWorker_update_service_time(worker, (swoole_microtime() - start_time) * 1000 * 1000);
+    }
+    else
+    {
+        callback(serv, task);
+    }
 #ifdef SW_BUFFER_RECV_TIME
     serv->last_receive_usec = 0;
 #endif
@@ -350,6 +407,12 @@ int swWorker_onTask(swFactory *factory, swEventData *task)
     //worker idle
     worker->status = SW_WORKER_IDLE;
 
+    if (serv->dispatch_mode == SW_DISPATCH_LEAST_LATENCY && serv->factory_mode == SW_MODE_PROCESS
+            && swEventData_is_request(task->info.type))
+    {
+        swWorker_inflight_done(worker);
+    }
+
     //maximum number of requests, process will exit.
     if (!SwooleWG.run_always && worker->request_count >= SwooleWG.max_request)
     {
@@ -500,7 +563,11 @@ void swWorker_stop(swWorker *worker)
         serv->stream_socket = nullptr;
     }
 
-    if (worker->pipe_worker)
+    if (serv->ipc_rings && worker->id < serv->worker_num)
+    {
+        swWorker_ipc_ring_stop(serv, worker);
+    }
+    else if (worker->pipe_worker)
     {
         swReactor_remove_read_event(reactor, worker->pipe_worker);
     }
@@ -660,7 +727,15 @@ int swWorker_loop(swServer *serv, swWorker *worker)
 
     swSocket_set_nonblock(worker->pipe_worker);
     reactor->ptr = serv;
-    reactor->add(reactor, worker->pipe_worker, SW_EVENT_READ);
+    if (serv->ipc_rings)
+    {
+        swReactor_set_handler(reactor, SW_FD_IPC_RING, swWorker_onIpcRingNotify);
+        swWorker_ipc_ring_start(serv, worker);
+    }
+    else
+    {
+        reactor->add(reactor, worker->pipe_worker, SW_EVENT_READ);
+    }
     swReactor_set_handler(reactor, SW_FD_PIPE, swWorker_onPipeReceive);
 
     if (serv->dispatch_mode == SW_DISPATCH_STREAM)
@@ -680,6 +755,10 @@ int swWorker_loop(swServer *serv, swWorker *worker)
 
     //main loop
     reactor->wait(reactor, NULL);
+    if (serv->ipc_rings)
+    {
+        swWorker_ipc_ring_release(serv, worker);
+    }
     //clear pipe buffer
     swWorker_clean_pipe_buffer(serv);
     //reactor free
@@ -724,6 +803,8 @@ static int swWorker_onPipeReceive(swReactor *reactor, swEvent *event)
     struct iovec buffers[2];
     int recv_chunk_count = 0;
 
+    swIpcRing *ipc;
+
     _read_from_pipe:
     recv_n = recv(event->fd, &pipe_buffer->info, sizeof(pipe_buffer->info), MSG_PEEK);
     if (recv_n < 0)
@@ -734,6 +815,19 @@ static int swWorker_onPipeReceive(swReactor *reactor, swEvent *event)
         }
         return SW_ERR;
     }
+
+    ipc = NULL;
+    if (serv->ipc_rings && (pipe_buffer->info.flags & SW_EVENT_DATA_RING))
+    {
+        /**
+         * the packets in the ring were sent before this one
+         */
+        ipc = swServer_get_ipc_ring(serv, SwooleWG.id, pipe_buffer->info.reactor_id);
+        if (!ipc_ring.owned || (!swShmRing_empty(ipc->ring) && !swWorker_ipc_ring_drain(serv, ipc->ring, NULL)))
+        {
+            return SW_OK;
+        }
+    }
     
     if (pipe_buffer->info.flags & SW_EVENT_DATA_CHUNK)
     {
@@ -754,6 +848,10 @@ static int swWorker_onPipeReceive(swReactor *reactor, swEvent *event)
         if (recv_n > 0)
         {
             serv->add_buffer_len(serv, &pipe_buffer->info, recv_n - sizeof(pipe_buffer->info));
+            if (ipc)
+            {
+                sw_atomic_fetch_add(&ipc->pipe_recv_count, 1);
+            }
         }
 
         recv_chunk_count++;
@@ -792,6 +890,10 @@ static int swWorker_onPipeReceive(swReactor *reactor, swEvent *event)
     else
     {
         recv_n = read(event->fd, pipe_buffer, serv->ipc_max_size);
+        if (recv_n > 0 && ipc)
+        {
+            sw_atomic_fetch_add(&ipc->pipe_recv_count, 1);
+        }
     }
 
     if (recv_n > 0)
@@ -802,6 +904,166 @@ static int swWorker_onPipeReceive(swReactor *reactor, swEvent *event)
     return SW_ERR;
 }
 
+static void swWorker_ipc_ring_notify(swServer *serv)
+{
+    swPipe *notify = &serv->ipc_ring_notify[SwooleWG.id];
+    uint64_t flag = 1;
+    notify->write(notify, &flag, sizeof(flag));
+}
+
+static bool swWorker_ipc_ring_acquire(swServer *serv, swWorker *worker)
+{
+    /**
+     * the previous worker with the same id releases the rings when it stops,
+     * or the manager does when it reaps the previous worker
+     */
+    return sw_atomic_cmp_set(&serv->ipc_ring_owners[worker->id], 0, SwooleG.pid);
+}
+
+static void swWorker_ipc_ring_release(swServer *serv, swWorker *worker)
+{
+    if (ipc_ring.owned)
+    {
+        ipc_ring.owned = false;
+        sw_atomic_cmp_set(&serv->ipc_ring_owners[worker->id], SwooleG.pid, 0);
+    }
+}
+
+static void swWorker_ipc_ring_retry(swTimer *timer, swTimer_node *tnode)
+{
+    ipc_ring.timer = NULL;
+    swWorker_ipc_ring_start((swServer *) tnode->data, SwooleWG.worker);
+}
+
+/**
+ * the rings have a single consumer, the pipe is only read once they are owned by this worker
+ */
+static void swWorker_ipc_ring_start(swServer *serv, swWorker *worker)
+{
+    swReactor *reactor = SwooleTG.reactor;
+
+    if (!swWorker_ipc_ring_acquire(serv, worker))
+    {
+        ipc_ring.timer = swoole_timer_add(1, SW_FALSE, swWorker_ipc_ring_retry, serv);
+        return;
+    }
+    ipc_ring.owned = true;
+
+    swPipe *notify = &serv->ipc_ring_notify[worker->id];
+    reactor->add(reactor, worker->pipe_worker, SW_EVENT_READ);
+    reactor->add(reactor, notify->getSocket(notify, SW_PIPE_WORKER), SW_EVENT_READ);
+    /**
+     * the packets left by the previous worker are processed in the event loop
+     */
+    swWorker_ipc_ring_notify(serv);
+}
+
+static void swWorker_ipc_ring_stop(swServer *serv, swWorker *worker)
+{
+    swReactor *reactor = SwooleTG.reactor;
+
+    if (ipc_ring.timer)
+    {
+        swoole_timer_del(ipc_ring.timer);
+        ipc_ring.timer = NULL;
+    }
+    if (!ipc_ring.owned)
+    {
+        return;
+    }
+
+    swPipe *notify = &serv->ipc_ring_notify[worker->id];
+    swReactor_remove_read_event(reactor, worker->pipe_worker);
+    reactor->del(reactor, notify->getSocket(notify, SW_PIPE_WORKER));
+    if (!ipc_ring.draining)
+    {
+        swWorker_ipc_ring_release(serv, worker);
+    }
+}
+
+/**
+ * process the packets of the ring in place, returns false if the worker is exiting
+ */
+static bool swWorker_ipc_ring_drain(swServer *serv, swShmRing *ring, uint32_t *count)
+{
+    swReactor *reactor = SwooleTG.reactor;
+    void *packet;
+    uint32_t length;
+    bool retval = true;
+
+    ipc_ring.draining = true;
+    while ((packet = swShmRing_front(ring, &length)))
+    {
+        /**
+         * a packet which crashes the worker is not handled again by the next one
+         */
+        swShmRing_consume(ring);
+        swWorker_onTask(&serv->factory, (swEventData *) packet);
+        swShmRing_pop(ring);
+
+        if (reactor->wait_exit || !reactor->running)
+        {
+            retval = false;
+            break;
+        }
+        if (count && ++(*count) >= SW_WORKER_MAX_RECV_RING_COUNT)
+        {
+            break;
+        }
+    }
+    ipc_ring.draining = false;
+
+    if (!retval)
+    {
+        swWorker_ipc_ring_release(serv, SwooleWG.worker);
+    }
+    return retval;
+}
+
+static int swWorker_onIpcRingNotify(swReactor *reactor, swEvent *event)
+{
+    swServer *serv = (swServer *) reactor->ptr;
+    uint64_t flags[16];
+    uint32_t count = 0;
+
+    while (read(event->fd, flags, sizeof(flags)) > 0) {}
+
+    while (true)
+    {
+        for (uint32_t i = 0; i < serv->reactor_num; i++)
+        {
+            swShmRing *ring = swServer_get_ipc_ring(serv, SwooleWG.id, i)->ring;
+            if (!swWorker_ipc_ring_drain(serv, ring, &count))
+            {
+                return SW_OK;
+            }
+            /**
+             * return to the event loop to handle the other events fairly, and come back later
+             */
+            if (count >= SW_WORKER_MAX_RECV_RING_COUNT)
+            {
+                swWorker_ipc_ring_notify(serv);
+                return SW_OK;
+            }
+        }
+        /**
+         * no more notification until the reactor threads see the worker sleeping
+         */
+        bool idle = true;
+        for (uint32_t i = 0; i < serv->reactor_num; i++)
+        {
+            if (!swShmRing_wait(swServer_get_ipc_ring(serv, SwooleWG.id, i)->ring))
+            {
+                idle = false;
+            }
+        }
+        if (idle)
+        {
+            return SW_OK;
+        }
+    }
+}
+
 int swWorker_send2worker(swWorker *dst_worker, const void *buf, int n, int flag)
 {
     swSocket *pipe_sock;
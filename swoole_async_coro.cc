@@ -31,12 +31,6 @@ using swoole::coroutine::Socket;
 using std::string;
 using std::vector;
 
-typedef struct
-{
-    char address[16];
-    time_t update_time;
-} dns_cache;
-
 typedef struct
 {
     zval *callback;
@@ -45,21 +39,11 @@ typedef struct
     swString *buffer;
 } process_stream;
 
-static std::unordered_map<std::string, dns_cache*> request_cache_map;
-
 void php_swoole_async_coro_minit(int module_number)
 {
 
 }
 
-void php_swoole_async_coro_rshutdown()
-{
-    for(auto i = request_cache_map.begin(); i != request_cache_map.end(); i++)
-    {
-        efree(i->second);
-    }
-}
-
 PHP_FUNCTION(swoole_async_set)
 {
     if (SwooleTG.reactor)
@@ -81,6 +65,18 @@ PHP_FUNCTION(swoole_async_set)
     {
         SwooleG.enable_signalfd = zval_is_true(ztmp);
     }
+    if (php_swoole_array_get_value(vht, "enable_io_uring", ztmp))
+    {
+        SwooleG.enable_io_uring = zval_is_true(ztmp);
+    }
+    if (php_swoole_array_get_value(vht, "enable_timer_wheel", ztmp))
+    {
+        SwooleG.enable_timer_wheel = zval_is_true(ztmp);
+    }
+    if (php_swoole_array_get_value(vht, "enable_aio_io_uring", ztmp))
+    {
+        SwooleG.enable_aio_io_uring = zval_is_true(ztmp);
+    }
     if (php_swoole_array_get_value(vht, "dns_cache_refresh_time", ztmp))
     {
           SwooleG.dns_cache_refresh_time = zval_get_double(ztmp);
@@ -138,6 +134,22 @@ PHP_FUNCTION(swoole_async_set)
         }
         SwooleG.dns_server_v4 = zend::string(ztmp).dup();
     }
+    if (php_swoole_array_get_value(vht, "dns_resolvconf_path", ztmp))
+    {
+        if (SwooleG.dns_resolvconf_path)
+        {
+            sw_free(SwooleG.dns_resolvconf_path);
+        }
+        SwooleG.dns_resolvconf_path = zend::string(ztmp).dup();
+    }
+    if (php_swoole_array_get_value(vht, "dns_hosts_path", ztmp))
+    {
+        if (SwooleG.dns_hosts_path)
+        {
+            sw_free(SwooleG.dns_hosts_path);
+        }
+        SwooleG.dns_hosts_path = zend::string(ztmp).dup();
+    }
     if (php_swoole_array_get_value(vht, "use_async_resolver", ztmp))
     {
         SwooleG.use_async_resolver = zval_is_true(ztmp);
@@ -154,7 +166,8 @@ PHP_FUNCTION(swoole_async_dns_lookup_coro)
 
     zval *domain;
     double timeout = Socket::default_dns_timeout;
-    if (zend_parse_parameters(ZEND_NUM_ARGS(), "z|d", &domain, &timeout) == FAILURE)
+    zend_long type = AF_INET;
+    if (zend_parse_parameters(ZEND_NUM_ARGS(), "z|dl", &domain, &timeout, &type) == FAILURE)
     {
         RETURN_FALSE;
     }
@@ -171,22 +184,15 @@ PHP_FUNCTION(swoole_async_dns_lookup_coro)
         RETURN_FALSE;
     }
 
-    //find cache
-    std::string key(Z_STRVAL_P(domain), Z_STRLEN_P(domain));
-    dns_cache *cache;
-
-    if (request_cache_map.find(key) != request_cache_map.end())
+    if (type != AF_INET && type != AF_INET6)
     {
-        cache = request_cache_map[key];
-        if (cache->update_time > swTimer_get_absolute_msec())
-        {
-            RETURN_STRING(cache->address);
-        }
+        php_swoole_fatal_error(E_WARNING, "unknown protocol family, must be AF_INET or AF_INET6");
+        RETURN_FALSE;
     }
 
     php_swoole_check_reactor();
 
-    vector<string> result = swoole::coroutine::dns_lookup(Z_STRVAL_P(domain), timeout);
+    vector<string> result = swoole::coroutine::dns_lookup(Z_STRVAL_P(domain), (int) type, timeout);
     if (result.empty())
     {
         SwooleG.error = SW_ERROR_DNSLOOKUP_RESOLVE_FAILED;
@@ -201,19 +207,4 @@ PHP_FUNCTION(swoole_async_dns_lookup_coro)
     {
         RETVAL_STRING(result[0].c_str());
     }
-
-    auto cache_iterator = request_cache_map.find(key);
-    if (cache_iterator == request_cache_map.end())
-    {
-        cache = (dns_cache *) emalloc(sizeof(dns_cache));
-        bzero(cache, sizeof(dns_cache));
-        request_cache_map[key] = cache;
-    }
-    else
-    {
-        cache = cache_iterator->second;
-    }
-    memcpy(cache->address, Z_STRVAL_P(return_value), Z_STRLEN_P(return_value));
-    cache->address[Z_STRLEN_P(return_value)] = '\0';
-    cache->update_time = swTimer_get_absolute_msec() + (int64_t) (SwooleG.dns_cache_refresh_time * 1000);
 }
@@ -274,6 +274,10 @@ void php_swoole_client_check_ssl_setting(swClient *cli, zval *zset)
     {
         cli->ssl_option.disable_compress = !zval_is_true(ztmp);
     }
+    if (php_swoole_array_get_value(vht, "ssl_ktls", ztmp))
+    {
+        cli->ssl_option.disable_ktls = !zval_is_true(ztmp);
+    }
     if (php_swoole_array_get_value(vht, "ssl_cert_file", ztmp))
     {
         zend::string str_v(ztmp);
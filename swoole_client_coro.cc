@@ -505,6 +505,10 @@ bool php_swoole_socket_set_ssl(Socket *sock, zval *zset)
     {
         sock->ssl_option.disable_compress = !zval_is_true(ztmp);
     }
+    if (php_swoole_array_get_value(vht, "ssl_ktls", ztmp))
+    {
+        sock->ssl_option.disable_ktls = !zval_is_true(ztmp);
+    }
     if (php_swoole_array_get_value(vht, "ssl_cert_file", ztmp))
     {
         zend::string str_v(ztmp);
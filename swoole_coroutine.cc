@@ -938,7 +938,27 @@ PHP_METHOD(swoole_coroutine, stats)
     );
     add_assoc_long_ex(return_value, ZEND_STRL("aio_task_num"), SwooleTG.aio_task_num);
     add_assoc_long_ex(return_value, ZEND_STRL("aio_worker_num"), swAio_thread_count());
+
+    zval zlanes;
+    array_init(&zlanes);
+    for (int i = 0; i < SW_AIO_LANE_MAX; i++)
+    {
+        swAio_lane_stats stats;
+        swAio_get_lane_stats(i, &stats);
+
+        zval zlane;
+        array_init(&zlane);
+        add_assoc_long_ex(&zlane, ZEND_STRL("queue_num"), stats.queue_num);
+        add_assoc_long_ex(&zlane, ZEND_STRL("running_num"), stats.running_num);
+        add_assoc_long_ex(&zlane, ZEND_STRL("max_thread_num"), stats.max_thread_num);
+        add_assoc_long_ex(&zlane, ZEND_STRL("dispatch_num"), stats.dispatch_num);
+        add_assoc_double_ex(&zlane, ZEND_STRL("wait_time"), stats.wait_time);
+        add_assoc_double_ex(&zlane, ZEND_STRL("max_wait_time"), stats.max_wait_time);
+        add_assoc_zval(&zlanes, swAio_lane_get_name(i), &zlane);
+    }
+    add_assoc_zval_ex(return_value, ZEND_STRL("aio_lanes"), &zlanes);
     add_assoc_long_ex(return_value, ZEND_STRL("c_stack_size"), Coroutine::get_stack_size());
+    add_assoc_long_ex(return_value, ZEND_STRL("c_stack_pool_num"), swoole::StackPool::count());
     add_assoc_long_ex(return_value, ZEND_STRL("coroutine_num"), Coroutine::count());
     add_assoc_long_ex(return_value, ZEND_STRL("coroutine_peak_num"), Coroutine::get_peak_num());
     add_assoc_long_ex(return_value, ZEND_STRL("coroutine_last_cid"), Coroutine::get_last_cid());
@@ -169,6 +169,10 @@ PHP_METHOD(swoole_coroutine_scheduler, set)
     {
         Coroutine::set_stack_size(zval_get_long(ztmp));
     }
+    if (php_swoole_array_get_value(vht, "stack_pool_size", ztmp))
+    {
+        Coroutine::set_stack_pool_size(SW_MAX(0, zval_get_long(ztmp)));
+    }
     if (php_swoole_array_get_value(vht, "socket_dns_timeout", ztmp))
     {
         double t = zval_get_double(ztmp);
@@ -219,10 +223,38 @@ PHP_METHOD(swoole_coroutine_scheduler, set)
         }
         SwooleG.dns_server_v4 = zend::string(ztmp).dup();
     }
+    if (php_swoole_array_get_value(vht, "dns_resolvconf_path", ztmp))
+    {
+        if (SwooleG.dns_resolvconf_path)
+        {
+            sw_free(SwooleG.dns_resolvconf_path);
+        }
+        SwooleG.dns_resolvconf_path = zend::string(ztmp).dup();
+    }
+    if (php_swoole_array_get_value(vht, "dns_hosts_path", ztmp))
+    {
+        if (SwooleG.dns_hosts_path)
+        {
+            sw_free(SwooleG.dns_hosts_path);
+        }
+        SwooleG.dns_hosts_path = zend::string(ztmp).dup();
+    }
     if (php_swoole_array_get_value(vht, "display_errors", ztmp))
     {
         SWOOLE_G(display_errors) = zval_is_true(ztmp);
     }
+    if (php_swoole_array_get_value(vht, "enable_io_uring", ztmp))
+    {
+        SwooleG.enable_io_uring = zval_is_true(ztmp);
+    }
+    if (php_swoole_array_get_value(vht, "enable_timer_wheel", ztmp))
+    {
+        SwooleG.enable_timer_wheel = zval_is_true(ztmp);
+    }
+    if (php_swoole_array_get_value(vht, "enable_aio_io_uring", ztmp))
+    {
+        SwooleG.enable_aio_io_uring = zval_is_true(ztmp);
+    }
     /* AIO */
     if (php_swoole_array_get_value(vht, "aio_core_worker_num", ztmp))
     {
@@ -244,6 +276,47 @@ PHP_METHOD(swoole_coroutine_scheduler, set)
     {
         SwooleG.aio_max_idle_time = zval_get_double(ztmp);
     }
+    /* AIO lanes: ['dns' => 2, 'file' => 8] */
+    if (php_swoole_array_get_value(vht, "aio_lane_max_threads", ztmp) && ZVAL_IS_ARRAY(ztmp))
+    {
+        zend_string *key;
+        zval *zvalue;
+        ZEND_HASH_FOREACH_STR_KEY_VAL(Z_ARRVAL_P(ztmp), key, zvalue)
+        {
+            int lane = key ? swAio_lane_get_id(ZSTR_VAL(key)) : SW_ERR;
+            if (lane < 0)
+            {
+                php_swoole_fatal_error(E_WARNING, "unknown aio lane '%s'", key ? ZSTR_VAL(key) : "");
+                continue;
+            }
+            zend_long v = zval_get_long(zvalue);
+            swAio_set_lane_max_threads(lane, SW_MAX(0, SW_MIN(v, UINT32_MAX)));
+        }
+        ZEND_HASH_FOREACH_END();
+    }
+    /* AIO lanes: ['dns', 'file', 'blocking', 'user'] */
+    if (php_swoole_array_get_value(vht, "aio_lane_priority", ztmp) && ZVAL_IS_ARRAY(ztmp))
+    {
+        uint8_t lanes[SW_AIO_LANE_MAX];
+        size_t n = 0;
+        zval *zvalue;
+        ZEND_HASH_FOREACH_VAL(Z_ARRVAL_P(ztmp), zvalue)
+        {
+            zend::string name(zvalue);
+            int lane = swAio_lane_get_id(name.val());
+            if (lane < 0)
+            {
+                php_swoole_fatal_error(E_WARNING, "unknown aio lane '%s'", name.val());
+                continue;
+            }
+            if (n < SW_AIO_LANE_MAX)
+            {
+                lanes[n++] = lane;
+            }
+        }
+        ZEND_HASH_FOREACH_END();
+        swAio_set_lane_priority(lanes, n);
+    }
     /* Reactor can exit */
     if ((ztmp = zend_hash_str_find(vht, ZEND_STRL("exit_condition"))))
     {
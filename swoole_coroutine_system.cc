@@ -364,6 +364,7 @@ PHP_METHOD(swoole_coroutine_system, fread)
     ev.flags = 0;
     ev.object = context;
     ev.handler = swAio_handler_fread;
+    ev.lane = SW_AIO_LANE_FILE;
     ev.callback = aio_onReadCompleted;
     ev.fd = fd;
 
@@ -440,6 +441,7 @@ PHP_METHOD(swoole_coroutine_system, fgets)
     ev.object = context;
     ev.callback = aio_onFgetsCompleted;
     ev.handler = swAio_handler_fgets;
+    ev.lane = SW_AIO_LANE_FILE;
     ev.fd = fd;
     ev.req = (void *) file;
 
@@ -508,6 +510,7 @@ PHP_METHOD(swoole_coroutine_system, fwrite)
     ev.flags = 0;
     ev.object = context;
     ev.handler = swAio_handler_fwrite;
+    ev.lane = SW_AIO_LANE_FILE;
     ev.callback = aio_onWriteCompleted;
     ev.fd = fd;
 
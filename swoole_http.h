@@ -35,6 +35,8 @@
 #include "thirdparty/nghttp2/nghttp2.h"
 #endif
 
+namespace swoole { class Coroutine; }
+
 enum http_header_flag
 {
     HTTP_HEADER_SERVER            = 1u << 1,
@@ -69,6 +71,12 @@ struct http_request
 #ifdef SW_USE_HTTP2
     swString *h2_data_buffer;
 #endif
+    /* the body of a streamed request which has not been read */
+    swString *stream_body;
+    /* the multipart data which is held until the part it belongs to is known */
+    swString *stream_form;
+    swoole::Coroutine *stream_co;
+    size_t read_offset;
 
     // Notice: Do not change the order
     zval *zobject;
@@ -95,6 +103,10 @@ struct http_response
     int version;
     int status;
     char* reason;
+    /**
+     * seconds in the response cache of the reactor, it is set by Response->cache(), -1 means not cacheable
+     */
+    int cache_ttl;
 
     // Notice: Do not change the order
     zval *zobject;
@@ -111,6 +123,10 @@ struct http_response
 class http2_stream;
 #endif
 
+#ifdef SW_HAVE_COMPRESSION
+struct http_compress_stream;
+#endif
+
 struct http_context
 {
     int fd;
@@ -134,6 +150,9 @@ struct http_context
     uchar parse_body :1;
     uchar parse_files :1;
     uchar co_socket :1;
+    uchar recv_stream :1;
+    uchar stream_paused :1;
+    uchar stream_closed :1;
 
 #ifdef SW_USE_HTTP2
     uchar http2 :1;
@@ -143,6 +162,7 @@ struct http_context
 #ifdef SW_HAVE_COMPRESSION
     int8_t compression_level;
     int8_t compression_method;
+    http_compress_stream *compress_stream;
 #endif
 
     http_request request;
@@ -251,6 +271,7 @@ void php_swoole_http_request_set_context(zval *zobject, http_context *context);
 http_context * php_swoole_http_response_get_context(zval *zobject);
 void php_swoole_http_response_set_context(zval *zobject, http_context *context);
 size_t swoole_http_requset_parse(http_context *ctx, const char *data, size_t length);
+size_t swoole_http_requset_parse_layout(http_context *ctx, zval *zdata, uint16_t trailer_length);
 
 bool swoole_http_response_set_header(http_context *ctx, const char *k, size_t klen, const char *v, size_t vlen, bool ucwords);
 void swoole_http_response_end(http_context *ctx, zval *zdata, zval *return_value);
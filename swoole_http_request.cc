@@ -30,6 +30,7 @@ extern "C"
 #include "main/rfc1867.h"
 #include "main/php_variables.h"
 
+#include "http.h"
 #include "websocket.h"
 #include "base64.h"
 
@@ -45,6 +46,8 @@ extern "C"
 #include "http2.h"
 #endif
 
+using swoole::Coroutine;
+
 enum http_upload_errno
 {
     HTTP_UPLOAD_ERR_OK = 0,
@@ -209,6 +212,47 @@ size_t swoole_http_requset_parse(http_context *ctx, const char *data, size_t len
     return swoole_http_parser_execute(&ctx->parser, &http_parser_settings, data, length);
 }
 
+/**
+ * the request has been parsed by the reactor, the same callbacks are called with the offsets of the layout,
+ * then the padding and the layout are cut from the data
+ */
+size_t swoole_http_requset_parse_layout(http_context *ctx, zval *zdata, uint16_t trailer_length)
+{
+    swoole_http_parser *parser = &ctx->parser;
+    size_t length = Z_STRLEN_P(zdata) - trailer_length;
+    char *data = Z_STRVAL_P(zdata);
+    const swHttpRequestLayout *layout = (const swHttpRequestLayout *) (data + SW_MEM_ALIGNED_SIZE_EX(length + 1, sizeof(uint32_t)));
+
+    parser->method = layout->method;
+    parser->http_major = layout->http_major;
+    parser->http_minor = layout->http_minor;
+
+    http_request_on_path(parser, data + layout->path_offset, layout->path_length);
+    if (layout->query_string_length > 0)
+    {
+        http_request_on_query_string(parser, data + layout->query_string_offset, layout->query_string_length);
+    }
+    for (uint16_t i = 0; i < layout->header_num; i++)
+    {
+        const swHttpHeaderLayout *header = &layout->headers[i];
+        http_request_on_header_field(parser, data + header->name_offset, header->name_length);
+        if (http_request_on_header_value(parser, data + header->value_offset, header->value_length) != 0)
+        {
+            goto _end;
+        }
+    }
+    http_request_on_headers_complete(parser);
+    ctx->keepalive = layout->keep_alive;
+    http_request_on_body(parser, data + layout->body_offset, layout->body_length);
+    http_request_message_complete(parser);
+
+    _end:
+    // the padding is the terminator
+    Z_STRLEN_P(zdata) = length;
+    data[length] = '\0';
+    return length;
+}
+
 zend_class_entry *swoole_http_request_ce;
 static zend_object_handlers swoole_http_request_handlers;
 
@@ -278,15 +322,21 @@ static zend_object *php_swoole_http_request_create_object(zend_class_entry *ce)
 
 static PHP_METHOD(swoole_http_request, getData);
 static PHP_METHOD(swoole_http_request, rawContent);
+static PHP_METHOD(swoole_http_request, read);
 static PHP_METHOD(swoole_http_request, __destruct);
 
 ZEND_BEGIN_ARG_INFO_EX(arginfo_swoole_http_void, 0, 0, 0)
 ZEND_END_ARG_INFO()
 
+ZEND_BEGIN_ARG_INFO_EX(arginfo_swoole_http_request_read, 0, 0, 0)
+    ZEND_ARG_INFO(0, length)
+ZEND_END_ARG_INFO()
+
 const zend_function_entry swoole_http_request_methods[] =
 {
     PHP_ME(swoole_http_request, rawContent, arginfo_swoole_http_void, ZEND_ACC_PUBLIC)
     PHP_MALIAS(swoole_http_request, getContent, rawContent, arginfo_swoole_http_void, ZEND_ACC_PUBLIC)
+    PHP_ME(swoole_http_request, read, arginfo_swoole_http_request_read, ZEND_ACC_PUBLIC)
     PHP_ME(swoole_http_request, getData, arginfo_swoole_http_void, ZEND_ACC_PUBLIC)
     PHP_ME(swoole_http_request, __destruct, arginfo_swoole_http_void, ZEND_ACC_PUBLIC)
     PHP_FE_END
@@ -863,6 +913,246 @@ static int multipart_body_on_data_end(multipart_parser* p)
     return 0;
 }
 
+static void http_request_multipart_execute(http_context *ctx, const char *at, size_t length)
+{
+    size_t n = multipart_parser_execute(ctx->mt_parser, at, length);
+    if (n != length)
+    {
+        swoole_error_log(SW_LOG_WARNING, SW_ERROR_SERVER_INVALID_REQUEST, "parse multipart body failed, n=%zu", n);
+    }
+}
+
+static void http_request_multipart_skip_eol(const char **at, size_t *length)
+{
+    /* Compatibility: some clients may send extra EOL */
+    while (*length != 0 && (**at == '\r' || **at == '\n'))
+    {
+        (*at)++;
+        (*length)--;
+    }
+}
+
+/**
+ * the requests whose body is still arriving, the key is the session id
+ */
+static std::unordered_map<int, http_context *> http_body_streams;
+
+/**
+ * the data of an uploaded file is written as it arrives, the headers of a part and the value of a form field
+ * are held until they are complete, so that the parser never points to a piece which has been freed
+ */
+static void http_request_stream_multipart(http_context *ctx, const char *at, size_t length)
+{
+    multipart_parser *p = ctx->mt_parser;
+    http_request *req = &ctx->request;
+    if (req->stream_form == nullptr)
+    {
+        req->stream_form = swString_new(SW_BUFFER_SIZE_STD);
+        if (req->stream_form == nullptr)
+        {
+            http_request_multipart_execute(ctx, at, length);
+            return;
+        }
+    }
+    swString *form = req->stream_form;
+    if (swString_append_ptr(form, at, length) < 0)
+    {
+        return;
+    }
+
+    size_t boundary_length = p->boundary_length;
+    // the tail may be the beginning of a boundary
+    size_t n = form->length > boundary_length + 1 ? form->length - boundary_length - 1 : 0;
+    ssize_t last = -1;
+    for (size_t offset = 0; offset < form->length;)
+    {
+        int pos = swoole_strnpos(form->str + offset, form->length - offset, p->multipart_boundary, boundary_length);
+        if (pos < 0)
+        {
+            break;
+        }
+        last = offset + pos;
+        offset = last + boundary_length;
+    }
+    if (last >= 0)
+    {
+        const char *part = form->str + last + boundary_length;
+        size_t part_length = form->length - last - boundary_length;
+        int header_length = swoole_strnpos(part, part_length, SW_STRL("\r\n\r\n"));
+        if (part_length >= 2 && memcmp(part, "--", 2) == 0)
+        {
+            // the end of the body
+            n = form->length;
+        }
+        else if (header_length < 0 || swoole_strnpos(part, header_length, SW_STRL("filename=")) < 0)
+        {
+            // the headers or the form field are not complete
+            n = last;
+        }
+        else
+        {
+            n = SW_MAX(n, last + boundary_length + header_length + 4);
+        }
+    }
+    if (form->length - n > SW_HTTP_BODY_STREAM_BUFFER_SIZE)
+    {
+        n = form->length;
+    }
+    if (n > 0)
+    {
+        http_request_multipart_execute(ctx, form->str, n);
+        swString_pop_front(form, n);
+    }
+}
+
+static int http_request_stream_on_body(http_context *ctx, const char *at, size_t length, bool is_beginning)
+{
+    http_request *req = &ctx->request;
+    if (ctx->end)
+    {
+        // the response has been sent, the rest of the body is dropped
+        return 0;
+    }
+    if (ctx->parse_body && req->post_form_urlencoded)
+    {
+        // the form is parsed as a whole when it is complete
+        if (req->chunked_body == nullptr)
+        {
+            req->chunked_body = swString_new(SW_BUFFER_SIZE_STD);
+            if (req->chunked_body == nullptr)
+            {
+                return -1;
+            }
+        }
+        swString_append_ptr(req->chunked_body, at, length);
+    }
+    else if (ctx->mt_parser != NULL)
+    {
+        if (is_beginning)
+        {
+            http_request_multipart_skip_eol(&at, &length);
+        }
+        http_request_stream_multipart(ctx, at, length);
+    }
+    else
+    {
+        if (req->stream_body == nullptr)
+        {
+            req->stream_body = swString_new(SW_BUFFER_SIZE_STD);
+            if (req->stream_body == nullptr)
+            {
+                return -1;
+            }
+        }
+        // offset is the position of read()
+        swString_pop_front(req->stream_body, req->stream_body->offset);
+        swString_append_ptr(req->stream_body, at, length);
+    }
+    return 0;
+}
+
+static void http_request_stream_wakeup(http_context *ctx)
+{
+    Coroutine *co = ctx->request.stream_co;
+    if (co)
+    {
+        ctx->request.stream_co = nullptr;
+        co->resume();
+    }
+}
+
+static void http_request_stream_resume_recv(http_context *ctx)
+{
+    if (ctx->stream_paused)
+    {
+        swServer *serv = (swServer *) ctx->private_data;
+        ctx->stream_paused = 0;
+        serv->feedback(serv, ctx->fd, SW_SERVER_EVENT_RESUME_RECV);
+    }
+}
+
+static void http_request_stream_end(http_context *ctx)
+{
+    http_body_streams.erase(ctx->fd);
+    http_request_stream_resume_recv(ctx);
+    http_request_stream_wakeup(ctx);
+    // ctx may be freed
+    zend_object *object = Z_OBJ_P(ctx->request.zobject);
+    OBJ_RELEASE(object);
+}
+
+/**
+ * the handler has been called with the head of the request, the rest of the body is received later
+ */
+void swoole_http_request_stream_start(http_context *ctx)
+{
+    swTraceLog(SW_TRACE_HTTP, "stream the body of request#%d, body_length=%zu", ctx->fd, ctx->request.body_length);
+    // the request lives until its body is complete
+    GC_ADDREF(Z_OBJ_P(ctx->request.zobject));
+    http_body_streams[ctx->fd] = ctx;
+}
+
+bool swoole_http_request_stream_recv(swServer *serv, swEventData *req)
+{
+    auto i = http_body_streams.find(req->info.fd);
+    if (i == http_body_streams.end())
+    {
+        return false;
+    }
+    http_context *ctx = i->second;
+
+    zval zdata;
+    php_swoole_get_recv_data(serv, &zdata, req);
+    swoole_http_requset_parse(ctx, Z_STRVAL(zdata), Z_STRLEN(zdata));
+    zval_ptr_dtor(&zdata);
+
+    if (ctx->parser.state == s_dead)
+    {
+        swNotice("request#%d is illegal and the connection has been closed", ctx->fd);
+        ctx->stream_closed = 1;
+        ctx->close(ctx);
+        http_request_stream_end(ctx);
+    }
+    else if (ctx->completed)
+    {
+        http_request_stream_end(ctx);
+    }
+    else
+    {
+        swString *body = ctx->request.stream_body;
+        if (body && body->length - body->offset >= SW_HTTP_BODY_STREAM_BUFFER_SIZE && !ctx->stream_paused)
+        {
+            // the handler reads slower than the client sends
+            ctx->stream_paused = 1;
+            serv->feedback(serv, ctx->fd, SW_SERVER_EVENT_PAUSE_RECV);
+        }
+        http_request_stream_wakeup(ctx);
+    }
+    return true;
+}
+
+void swoole_http_request_stream_close(int fd)
+{
+    auto i = http_body_streams.find(fd);
+    if (i == http_body_streams.end())
+    {
+        return;
+    }
+    http_context *ctx = i->second;
+    ctx->stream_closed = 1;
+    ctx->stream_paused = 0;
+    http_request_stream_end(ctx);
+}
+
+void swoole_http_request_stream_discard(http_context *ctx)
+{
+    if (ctx->request.stream_body)
+    {
+        swString_clear(ctx->request.stream_body);
+    }
+    http_request_stream_resume_recv(ctx);
+}
+
 static int http_request_on_body(swoole_http_parser *parser, const char *at, size_t length)
 {
     if (length == 0)
@@ -890,6 +1180,11 @@ static int http_request_on_body(swoole_http_parser *parser, const char *at, size
         ctx->request.body_length += length;
     }
 
+    if (ctx->recv_stream && !ctx->recv_chunked)
+    {
+        return http_request_stream_on_body(ctx, at, length, is_beginning);
+    }
+
     if (!ctx->recv_chunked && ctx->parse_body && ctx->request.post_form_urlencoded)
     {
         sapi_module.treat_data(
@@ -900,25 +1195,11 @@ static int http_request_on_body(swoole_http_parser *parser, const char *at, size
     }
     else if (ctx->mt_parser != NULL)
     {
-        multipart_parser *multipart_parser = ctx->mt_parser;
         if (is_beginning)
         {
-            /* Compatibility: some clients may send extra EOL */
-            do
-            {
-                if (*at != '\r' && *at != '\n')
-                {
-                    break;
-                }
-                at++;
-                length--;
-            } while (length != 0);
-        }
-        size_t n = multipart_parser_execute(multipart_parser, at, length);
-        if (n != length)
-        {
-            swoole_error_log(SW_LOG_WARNING, SW_ERROR_SERVER_INVALID_REQUEST, "parse multipart body failed, n=%zu", n);
+            http_request_multipart_skip_eol(&at, &length);
         }
+        http_request_multipart_execute(ctx, at, length);
     }
 
     return 0;
@@ -940,6 +1221,11 @@ static int http_request_message_complete(swoole_http_parser *parser)
     }
     if (ctx->mt_parser)
     {
+        if (ctx->request.stream_form && ctx->request.stream_form->length > 0)
+        {
+            http_request_multipart_execute(ctx, ctx->request.stream_form->str, ctx->request.stream_form->length);
+            swString_clear(ctx->request.stream_form);
+        }
         multipart_parser_free(ctx->mt_parser);
         ctx->mt_parser = NULL;
     }
@@ -1000,34 +1286,131 @@ const char* swoole_http_get_content_encoding(http_context *ctx)
 }
 #endif
 
-static PHP_METHOD(swoole_http_request, rawContent)
+/**
+ * the body which has been received as a whole
+ */
+static bool http_request_get_body(http_context *ctx, const char **body, size_t *length)
 {
-    http_context *ctx = php_swoole_http_request_get_and_check_context(ZEND_THIS);
-    if (UNEXPECTED(!ctx))
-    {
-        RETURN_FALSE;
-    }
-
     http_request *req = &ctx->request;
-    if (req->body_length > 0)
+    if (req->body_length > 0 && !ctx->recv_stream)
     {
         zval *zdata = &req->zdata;
-        RETURN_STRINGL(Z_STRVAL_P(zdata) + Z_STRLEN_P(zdata) - req->body_length, req->body_length);
+        *body = Z_STRVAL_P(zdata) + Z_STRLEN_P(zdata) - req->body_length;
+        *length = req->body_length;
+        return true;
     }
     else if (req->chunked_body && req->chunked_body->length != 0)
     {
-        RETURN_STRINGL(req->chunked_body->str, req->chunked_body->length);
+        *body = req->chunked_body->str;
+        *length = req->chunked_body->length;
+        return true;
     }
 #ifdef SW_USE_HTTP2
     else if (req->h2_data_buffer && req->h2_data_buffer->length != 0)
     {
-        RETURN_STRINGL(req->h2_data_buffer->str, req->h2_data_buffer->length);
+        *body = req->h2_data_buffer->str;
+        *length = req->h2_data_buffer->length;
+        return true;
     }
 #endif
+    return false;
+}
+
+static PHP_METHOD(swoole_http_request, rawContent)
+{
+    http_context *ctx = php_swoole_http_request_get_and_check_context(ZEND_THIS);
+    if (UNEXPECTED(!ctx))
+    {
+        RETURN_FALSE;
+    }
+
+    const char *body;
+    size_t length;
+    swString *stream_body = ctx->request.stream_body;
+    if (stream_body && stream_body->length > (size_t) stream_body->offset)
+    {
+        // the part of a streamed body which has not been read
+        RETURN_STRINGL(stream_body->str + stream_body->offset, stream_body->length - stream_body->offset);
+    }
+    if (http_request_get_body(ctx, &body, &length))
+    {
+        RETURN_STRINGL(body, length);
+    }
 
     RETURN_EMPTY_STRING();
 }
 
+static PHP_METHOD(swoole_http_request, read)
+{
+    zend_long length = SW_BUFFER_SIZE_STD;
+
+    ZEND_PARSE_PARAMETERS_START(0, 1)
+        Z_PARAM_OPTIONAL
+        Z_PARAM_LONG(length)
+    ZEND_PARSE_PARAMETERS_END_EX(RETURN_FALSE);
+
+    if (length <= 0)
+    {
+        php_swoole_fatal_error(E_WARNING, "length must be greater than 0");
+        RETURN_FALSE;
+    }
+
+    http_context *ctx = php_swoole_http_request_get_and_check_context(ZEND_THIS);
+    if (UNEXPECTED(!ctx))
+    {
+        RETURN_FALSE;
+    }
+
+    http_request *req = &ctx->request;
+    if (ctx->recv_stream)
+    {
+        // wait for the next piece of the body
+        while (!ctx->completed && !ctx->stream_closed && (!req->stream_body || req->stream_body->length == (size_t) req->stream_body->offset))
+        {
+            if (req->stream_co)
+            {
+                php_swoole_fatal_error(E_WARNING, "the body is being read by another coroutine");
+                RETURN_FALSE;
+            }
+            Coroutine *co = Coroutine::get_current();
+            if (!co)
+            {
+                php_swoole_fatal_error(E_WARNING, "the body which has not arrived can only be read in a coroutine");
+                RETURN_FALSE;
+            }
+            req->stream_co = co;
+            co->yield();
+        }
+        swString *stream_body = req->stream_body;
+        if (stream_body && stream_body->length > (size_t) stream_body->offset)
+        {
+            size_t n = SW_MIN((size_t) length, stream_body->length - stream_body->offset);
+            RETVAL_STRINGL(stream_body->str + stream_body->offset, n);
+            stream_body->offset += n;
+            if (stream_body->length - stream_body->offset < SW_HTTP_BODY_STREAM_BUFFER_SIZE / 2)
+            {
+                http_request_stream_resume_recv(ctx);
+            }
+            return;
+        }
+        if (!ctx->completed)
+        {
+            // the connection has been closed
+            RETURN_FALSE;
+        }
+    }
+
+    const char *body;
+    size_t body_length;
+    if (!http_request_get_body(ctx, &body, &body_length) || req->read_offset >= body_length)
+    {
+        RETURN_EMPTY_STRING();
+    }
+    size_t n = SW_MIN((size_t) length, body_length - req->read_offset);
+    RETVAL_STRINGL(body + req->read_offset, n);
+    req->read_offset += n;
+}
+
 static PHP_METHOD(swoole_http_request, getData)
 {
     http_context *ctx = php_swoole_http_request_get_and_check_context(ZEND_THIS);
@@ -45,6 +45,8 @@ extern "C"
 #include "http2.h"
 #endif
 
+#include <vector>
+
 using namespace swoole;
 using swoole::coroutine::Socket;
 
@@ -52,6 +54,12 @@ zend_class_entry *swoole_http_response_ce;
 static zend_object_handlers swoole_http_response_handlers;
 
 static void http_build_header(http_context *, swString *response, int body_length);
+static void http_append_chunk(swString *buffer, const char *data, size_t length);
+#ifdef SW_HAVE_COMPRESSION
+static http_compress_stream* http_compress_stream_get(int method, int level);
+static int http_compress_stream_write(http_compress_stream *stream, const char *data, size_t length, bool finish);
+static void http_compress_stream_release(http_compress_stream *stream);
+#endif
 
 static inline void http_header_key_format(char *key, int length)
 {
@@ -155,6 +163,13 @@ static void php_swoole_http_response_free_object(zend_object *object)
                 }
             }
         }
+#ifdef SW_HAVE_COMPRESSION
+        if (ctx->compress_stream)
+        {
+            http_compress_stream_release(ctx->compress_stream);
+            ctx->compress_stream = NULL;
+        }
+#endif
         ctx->response.zobject = NULL;
         swoole_http_context_free(ctx);
     }
@@ -193,6 +208,7 @@ static PHP_METHOD(swoole_http_response, trailer);
 static PHP_METHOD(swoole_http_response, ping);
 #endif
 static PHP_METHOD(swoole_http_response, status);
+static PHP_METHOD(swoole_http_response, cache);
 static PHP_METHOD(swoole_http_response, __destruct);
 
 ZEND_BEGIN_ARG_INFO_EX(arginfo_swoole_http_void, 0, 0, 0)
@@ -203,6 +219,10 @@ ZEND_BEGIN_ARG_INFO_EX(arginfo_swoole_http_response_status, 0, 0, 1)
     ZEND_ARG_INFO(0, reason)
 ZEND_END_ARG_INFO()
 
+ZEND_BEGIN_ARG_INFO_EX(arginfo_swoole_http_response_cache, 0, 0, 1)
+    ZEND_ARG_INFO(0, ttl)
+ZEND_END_ARG_INFO()
+
 ZEND_BEGIN_ARG_INFO_EX(arginfo_swoole_http_response_header, 0, 0, 2)
     ZEND_ARG_INFO(0, key)
     ZEND_ARG_INFO(0, value)
@@ -266,6 +286,7 @@ const zend_function_entry swoole_http_response_methods[] =
     PHP_MALIAS(swoole_http_response, setStatusCode, status, arginfo_swoole_http_response_status, ZEND_ACC_PUBLIC)
     PHP_ME(swoole_http_response, header, arginfo_swoole_http_response_header, ZEND_ACC_PUBLIC)
     PHP_MALIAS(swoole_http_response, setHeader, header, arginfo_swoole_http_response_header, ZEND_ACC_PUBLIC)
+    PHP_ME(swoole_http_response, cache, arginfo_swoole_http_response_cache, ZEND_ACC_PUBLIC)
 #ifdef SW_USE_HTTP2
     PHP_ME(swoole_http_response, trailer, arginfo_swoole_http_response_trailer, ZEND_ACC_PUBLIC)
     PHP_ME(swoole_http_response, ping, arginfo_swoole_http_void, ZEND_ACC_PUBLIC)
@@ -327,7 +348,14 @@ static PHP_METHOD(swoole_http_response, write)
 #endif
 
 #ifdef SW_HAVE_COMPRESSION
-    ctx->accept_compression = 0;
+    if (!ctx->send_header && ctx->accept_compression)
+    {
+        ctx->compress_stream = http_compress_stream_get(ctx->compression_method, ctx->compression_level);
+    }
+    if (!ctx->compress_stream)
+    {
+        ctx->accept_compression = 0;
+    }
 #endif
 
     swString *http_buffer = http_get_write_buffer(ctx);
@@ -358,23 +386,40 @@ static PHP_METHOD(swoole_http_response, write)
         http_body.length = length;
     }
 
-    // Why not enable compression?
-    // If both compression and chunked encoding are enabled,
-    // then the content stream is first compressed, then chunked;
-    // so the chunk encoding itself is not compressed,
-    // **and the data in each chunk is not compressed individually.**
-    // The remote endpoint then decodes the stream by concatenating the chunks and decompressing the result.
+#ifdef SW_HAVE_COMPRESSION
+    // the content stream is compressed, then chunked,
+    // every chunk is flushed so that the client is able to decode it when it arrives
+    if (ctx->compress_stream)
+    {
+        if (http_compress_stream_write(ctx->compress_stream, http_body.str, http_body.length, false) < 0)
+        {
+            ctx->close(ctx);
+            RETURN_FALSE;
+        }
+        http_body.str = swoole_zlib_buffer->str;
+        http_body.length = swoole_zlib_buffer->length;
+        if (http_body.length == 0)
+        {
+            RETURN_TRUE;
+        }
+    }
+#endif
     swString_clear(http_buffer);
-    char *hex_string = swoole_dec2hex(http_body.length, 16);
+    http_append_chunk(http_buffer, http_body.str, http_body.length);
+
+    RETURN_BOOL(ctx->send(ctx, http_buffer->str, http_buffer->length));
+}
+
+static void http_append_chunk(swString *buffer, const char *data, size_t length)
+{
+    char *hex_string = swoole_dec2hex(length, 16);
     int hex_len = strlen(hex_string);
     //"%.*s\r\n%.*s\r\n", hex_len, hex_string, body.length, body.str
-    swString_append_ptr(http_buffer, hex_string, hex_len);
-    swString_append_ptr(http_buffer, ZEND_STRL("\r\n"));
-    swString_append_ptr(http_buffer, http_body.str, http_body.length);
-    swString_append_ptr(http_buffer, ZEND_STRL("\r\n"));
+    swString_append_ptr(buffer, hex_string, hex_len);
+    swString_append_ptr(buffer, ZEND_STRL("\r\n"));
+    swString_append_ptr(buffer, data, length);
+    swString_append_ptr(buffer, ZEND_STRL("\r\n"));
     sw_free(hex_string);
-
-    RETURN_BOOL(ctx->send(ctx, http_buffer->str, http_buffer->length));
 }
 
 static void http_build_header(http_context *ctx, swString *response, int body_length)
@@ -563,36 +608,204 @@ void php_brotli_free(void* opaque, void* address)
 #endif
 
 #ifdef SW_HAVE_COMPRESSION
-int swoole_http_response_compress(swString *body, int method, int level)
+/**
+ * the state of a compressed response, it keeps the window of the stream between the chunks
+ */
+struct http_compress_stream
 {
+    int method;
+    int level;
 #ifdef SW_HAVE_ZLIB
-    int encoding;
+    z_stream zstream;
 #endif
+#ifdef SW_HAVE_BROTLI
+    BrotliEncoderState *brotli;
+#endif
+};
+
+/**
+ * the deflate streams are reset and reused by the next responses, so that their memory is allocated only once
+ */
+static std::vector<http_compress_stream *> http_compress_stream_pool;
+
+static int http_compress_level(int method, int level)
+{
+#ifdef SW_HAVE_BROTLI
+    if (method == HTTP_COMPRESS_BR)
+    {
+        return SW_MAX(BROTLI_MIN_QUALITY, SW_MIN(level, BROTLI_MAX_QUALITY));
+    }
+#endif
+#ifdef SW_HAVE_ZLIB
+    if (level < Z_NO_COMPRESSION)
+    {
+        level = Z_DEFAULT_COMPRESSION;
+    }
+    else if (level == Z_NO_COMPRESSION)
+    {
+        level = Z_BEST_SPEED;
+    }
+    else if (level > Z_BEST_COMPRESSION)
+    {
+        level = Z_BEST_COMPRESSION;
+    }
+#endif
+    return level;
+}
 
-    if (0) { }
+static http_compress_stream* http_compress_stream_get(int method, int level)
+{
+    level = http_compress_level(method, level);
+    for (auto i = http_compress_stream_pool.begin(); i != http_compress_stream_pool.end(); i++)
+    {
+        if ((*i)->method == method && (*i)->level == level)
+        {
+            http_compress_stream *stream = *i;
+            http_compress_stream_pool.erase(i);
+            return stream;
+        }
+    }
+
+    http_compress_stream *stream = new http_compress_stream();
+    stream->method = method;
+    stream->level = level;
+#ifdef SW_HAVE_BROTLI
+    if (method == HTTP_COMPRESS_BR)
+    {
+        stream->brotli = BrotliEncoderCreateInstance(NULL, NULL, NULL);
+        if (!stream->brotli)
+        {
+            swWarn("BrotliEncoderCreateInstance() failed");
+            delete stream;
+            return nullptr;
+        }
+        BrotliEncoderSetParameter(stream->brotli, BROTLI_PARAM_QUALITY, level);
+        return stream;
+    }
+#endif
 #ifdef SW_HAVE_ZLIB
-    //gzip: 0x1f
-    else if (method == HTTP_COMPRESS_GZIP)
+    if (method == HTTP_COMPRESS_GZIP || method == HTTP_COMPRESS_DEFLATE)
+    {
+        //gzip: 0x1f, deflate: -0xf
+        int encoding = method == HTTP_COMPRESS_GZIP ? SW_ZLIB_ENCODING_GZIP : SW_ZLIB_ENCODING_RAW;
+        int status = deflateInit2(&stream->zstream, level, Z_DEFLATED, encoding, MAX_MEM_LEVEL, Z_DEFAULT_STRATEGY);
+        if (status != Z_OK)
+        {
+            swWarn("deflateInit2() failed, Error: [%d]", status);
+            delete stream;
+            return nullptr;
+        }
+        return stream;
+    }
+#endif
+    swWarn("Unknown compression method");
+    delete stream;
+    return nullptr;
+}
+
+static void http_compress_stream_release(http_compress_stream *stream)
+{
+#ifdef SW_HAVE_BROTLI
+    if (stream->method == HTTP_COMPRESS_BR)
     {
-        encoding = 0x1f;
+        // a brotli encoder can not be reset
+        BrotliEncoderDestroyInstance(stream->brotli);
+        delete stream;
+        return;
     }
-    //deflate: -0xf
-    else if (method == HTTP_COMPRESS_DEFLATE)
+#endif
+#ifdef SW_HAVE_ZLIB
+    if (http_compress_stream_pool.size() < SW_HTTP_COMPRESS_STREAM_POOL_SIZE && deflateReset(&stream->zstream) == Z_OK)
     {
-        encoding = -0xf;
+        http_compress_stream_pool.push_back(stream);
+        return;
     }
+    deflateEnd(&stream->zstream);
 #endif
+    delete stream;
+}
+
+/**
+ * compress the data into swoole_zlib_buffer, the output is flushed to a byte boundary, or the stream is finished
+ */
+static int http_compress_stream_write(http_compress_stream *stream, const char *data, size_t length, bool finish)
+{
+    swString *buffer = swoole_zlib_buffer;
+    swString_clear(buffer);
+
 #ifdef SW_HAVE_BROTLI
-    else if (method == HTTP_COMPRESS_BR)
+    if (stream->method == HTTP_COMPRESS_BR)
     {
-        if (level < BROTLI_MIN_QUALITY)
+        size_t available_in = length;
+        const uint8_t *next_in = (const uint8_t *) data;
+        BrotliEncoderOperation op = finish ? BROTLI_OPERATION_FINISH : BROTLI_OPERATION_FLUSH;
+        size_t memory_size = BrotliEncoderMaxCompressedSize(length);
+        if (memory_size > buffer->size && swString_extend(buffer, memory_size) < 0)
         {
-            level = BROTLI_MIN_QUALITY;
+            return SW_ERR;
         }
-        else if (level > BROTLI_MAX_QUALITY)
+        while (true)
         {
-            level = BROTLI_MAX_QUALITY;
+            if (buffer->length == buffer->size && swString_extend(buffer, buffer->size * 2) < 0)
+            {
+                return SW_ERR;
+            }
+            size_t available_out = buffer->size - buffer->length;
+            uint8_t *next_out = (uint8_t *) buffer->str + buffer->length;
+            if (!BrotliEncoderCompressStream(stream->brotli, op, &available_in, &next_in, &available_out, &next_out, NULL))
+            {
+                swWarn("BrotliEncoderCompressStream() failed");
+                return SW_ERR;
+            }
+            buffer->length = buffer->size - available_out;
+            if (available_in == 0 && !BrotliEncoderHasMoreOutput(stream->brotli)
+                    && (!finish || BrotliEncoderIsFinished(stream->brotli)))
+            {
+                return SW_OK;
+            }
         }
+    }
+#endif
+#ifdef SW_HAVE_ZLIB
+    z_stream *zstream = &stream->zstream;
+    size_t memory_size = deflateBound(zstream, length) + 16;
+    if (memory_size > buffer->size && swString_extend(buffer, memory_size) < 0)
+    {
+        return SW_ERR;
+    }
+    zstream->next_in = (Bytef *) data;
+    zstream->avail_in = length;
+    while (true)
+    {
+        if (buffer->length == buffer->size && swString_extend(buffer, buffer->size * 2) < 0)
+        {
+            return SW_ERR;
+        }
+        zstream->next_out = (Bytef *) buffer->str + buffer->length;
+        zstream->avail_out = buffer->size - buffer->length;
+        int status = deflate(zstream, finish ? Z_FINISH : Z_SYNC_FLUSH);
+        buffer->length = buffer->size - zstream->avail_out;
+        if (status == Z_STREAM_END || (!finish && zstream->avail_out != 0))
+        {
+            return SW_OK;
+        }
+        if (status != Z_OK && status != Z_BUF_ERROR)
+        {
+            swWarn("deflate() failed, Error: [%d]", status);
+            return SW_ERR;
+        }
+    }
+#else
+    return SW_ERR;
+#endif
+}
+
+int swoole_http_response_compress(swString *body, int method, int level)
+{
+#ifdef SW_HAVE_BROTLI
+    if (method == HTTP_COMPRESS_BR)
+    {
+        level = http_compress_level(method, level);
 
         size_t memory_size = BrotliEncoderMaxCompressedSize(body->length);
         if (memory_size > swoole_zlib_buffer->size)
@@ -623,63 +836,15 @@ int swoole_http_response_compress(swString *body, int method, int level)
         }
     }
 #endif
-    else
-    {
-        swWarn("Unknown compression method");
-        return SW_ERR;
-    }
-#ifdef SW_HAVE_ZLIB
-    if (level < Z_NO_COMPRESSION)
-    {
-        level = Z_DEFAULT_COMPRESSION;
-    }
-    else if (level == Z_NO_COMPRESSION)
-    {
-        level = Z_BEST_SPEED;
-    }
-    else if (level > Z_BEST_COMPRESSION)
-    {
-        level = Z_BEST_COMPRESSION;
-    }
-
-    size_t memory_size = ((size_t) ((double) body->length * (double) 1.015)) + 10 + 8 + 4 + 1;
-    if (memory_size > swoole_zlib_buffer->size)
-    {
-        if (swString_extend(swoole_zlib_buffer, memory_size) < 0)
-        {
-            return SW_ERR;
-        }
-    }
-
-    z_stream zstream = {};
-    int status;
-
-    zstream.zalloc = php_zlib_alloc;
-    zstream.zfree = php_zlib_free;
-
-    status = deflateInit2(&zstream, level, Z_DEFLATED, encoding, MAX_MEM_LEVEL, Z_DEFAULT_STRATEGY);
-    if (status != Z_OK)
+    // a deflate stream of the pool is used, deflateInit2() is expensive
+    http_compress_stream *stream = http_compress_stream_get(method, level);
+    if (!stream)
     {
-        swWarn("deflateInit2() failed, Error: [%d]", status);
         return SW_ERR;
     }
-
-    zstream.next_in = (Bytef *) body->str;
-    zstream.avail_in = body->length;
-    zstream.next_out = (Bytef *) swoole_zlib_buffer->str;
-    zstream.avail_out = swoole_zlib_buffer->size;
-
-    status = deflate(&zstream, Z_FINISH);
-    deflateEnd(&zstream);
-    if (status != Z_STREAM_END)
-    {
-        swWarn("deflate() failed, Error: [%d]", status);
-        return SW_ERR;
-    }
-
-    swoole_zlib_buffer->length = zstream.total_out;
-    return SW_OK;
-#endif
+    int ret = http_compress_stream_write(stream, body->str, body->length, true);
+    http_compress_stream_release(stream);
+    return ret;
 }
 #endif
 
@@ -726,6 +891,184 @@ static PHP_METHOD(swoole_http_response, end)
     }
 }
 
+static uint32_t http_response_parse_cache_control(const char *value, size_t length)
+{
+    std::string directives(value, length);
+    swoole_strtolower(&directives[0], directives.length());
+    if (directives.find("no-store") != std::string::npos || directives.find("no-cache") != std::string::npos
+            || directives.find("private") != std::string::npos)
+    {
+        return 0;
+    }
+    size_t pos = directives.find("s-maxage=");
+    if (pos != std::string::npos)
+    {
+        pos += sizeof("s-maxage=") - 1;
+    }
+    else if ((pos = directives.find("max-age=")) != std::string::npos)
+    {
+        pos += sizeof("max-age=") - 1;
+    }
+    else
+    {
+        return 0;
+    }
+    return SW_MAX(0, atoi(directives.c_str() + pos));
+}
+
+/**
+ * append the header of the cache packet when the response can be cached by the reactor,
+ * returns its length or 0
+ */
+static size_t http_response_cache_begin(http_context *ctx, swString *buffer, size_t body_length)
+{
+    if (ctx->co_socket || ctx->upgrade || ctx->response.cache_ttl < 0 || ctx->parser.method != PHP_HTTP_GET
+            || !ctx->keepalive || body_length > SW_HTTP_RESPONSE_CACHE_MAX_SIZE
+            || (ctx->response.status != 0 && ctx->response.status != SW_HTTP_OK))
+    {
+        return 0;
+    }
+    swServer *serv = (swServer *) ctx->private_data;
+    swConnection *conn = swWorker_get_connection(serv, ctx->fd);
+    if (serv->http_response_cache_capacity == 0 || !conn || !ctx->request.path)
+    {
+        return 0;
+    }
+
+    // the responses to a user are never shared
+    HashTable *request_header = Z_ARRVAL_P(ctx->request.zheader);
+    if (zend_hash_str_exists(request_header, ZEND_STRL("cookie"))
+            || zend_hash_str_exists(request_header, ZEND_STRL("authorization")))
+    {
+        return 0;
+    }
+    zval *zcookie = sw_zend_read_property(swoole_http_response_ce, ctx->response.zobject, ZEND_STRL("cookie"), 0);
+    if (ZVAL_IS_ARRAY(zcookie) && zend_hash_num_elements(Z_ARRVAL_P(zcookie)) > 0)
+    {
+        return 0;
+    }
+
+    std::string vary_names;
+#ifdef SW_HAVE_COMPRESSION
+    if (ctx->enable_compression)
+    {
+        vary_names = "accept-encoding";
+    }
+#endif
+    uint32_t ttl = ctx->response.cache_ttl;
+    zval *zheader = sw_zend_read_property(swoole_http_response_ce, ctx->response.zobject, ZEND_STRL("header"), 0);
+    if (ZVAL_IS_ARRAY(zheader))
+    {
+        const char *key;
+        uint32_t keylen;
+        int type;
+        zval *zvalue;
+
+        SW_HASHTABLE_FOREACH_START2(Z_ARRVAL_P(zheader), key, keylen, type, zvalue)
+        {
+            if (!key || ZVAL_IS_NULL(zvalue))
+            {
+                continue;
+            }
+            if (SW_STRCASEEQ(key, keylen, "Set-Cookie"))
+            {
+                return 0;
+            }
+            else if (SW_STRCASEEQ(key, keylen, "Vary"))
+            {
+                zend::string str_value(zvalue);
+                vary_names.append(",").append(str_value.val(), str_value.len());
+            }
+            else if (SW_STRCASEEQ(key, keylen, "Cache-Control") && ctx->response.cache_ttl == 0)
+            {
+                zend::string str_value(zvalue);
+                ttl = http_response_parse_cache_control(str_value.val(), str_value.len());
+            }
+        }
+        SW_HASHTABLE_FOREACH_END();
+        (void)type;
+    }
+    if (ttl == 0)
+    {
+        return 0;
+    }
+
+    // the values of the request headers which are listed in Vary
+    std::string vary;
+    swoole_strtolower(&vary_names[0], vary_names.length());
+    size_t offset = 0;
+    while (offset < vary_names.length())
+    {
+        size_t end = vary_names.find(',', offset);
+        if (end == std::string::npos)
+        {
+            end = vary_names.length();
+        }
+        size_t begin = vary_names.find_first_not_of(" \t", offset);
+        size_t last = vary_names.find_last_not_of(" \t", end - 1);
+        offset = end + 1;
+        if (begin >= end || last == std::string::npos || last < begin)
+        {
+            continue;
+        }
+        std::string name = vary_names.substr(begin, last - begin + 1);
+        if (name == "*")
+        {
+            return 0;
+        }
+        zval *zvalue = zend_hash_str_find(request_header, name.c_str(), name.length());
+        vary.append(name).append(": ");
+        if (zvalue && Z_TYPE_P(zvalue) == IS_STRING)
+        {
+            vary.append(Z_STRVAL_P(zvalue), Z_STRLEN_P(zvalue));
+        }
+        vary.append("\r\n");
+    }
+
+    // the reactor looks it up with the listening socket, Host and the url of the request line
+    std::string key = std::to_string(conn->server_fd) + " ";
+    zval *zhost = zend_hash_str_find(request_header, ZEND_STRL("host"));
+    if (zhost && Z_TYPE_P(zhost) == IS_STRING)
+    {
+        key.append(Z_STRVAL_P(zhost), Z_STRLEN_P(zhost));
+    }
+    key.append(" ").append(ctx->request.path, ctx->request.path_len);
+    zval *zquery_string = zend_hash_str_find(Z_ARRVAL_P(ctx->request.zserver), ZEND_STRL("query_string"));
+    if (zquery_string && Z_TYPE_P(zquery_string) == IS_STRING)
+    {
+        key.append("?").append(Z_STRVAL_P(zquery_string), Z_STRLEN_P(zquery_string));
+    }
+    if (key.length() > UINT16_MAX || vary.length() > UINT16_MAX)
+    {
+        return 0;
+    }
+
+    swHttpCachePacket packet;
+    packet.ttl = ttl;
+    packet.key_length = key.length();
+    packet.vary_length = vary.length();
+    if (swString_append_ptr(buffer, (char *) &packet, sizeof(packet)) < 0
+            || swString_append_ptr(buffer, key.c_str(), key.length()) < 0
+            || swString_append_ptr(buffer, vary.c_str(), vary.length()) < 0)
+    {
+        swString_clear(buffer);
+        return 0;
+    }
+    return buffer->length;
+}
+
+static bool http_response_cache_send(http_context *ctx, swString *packet)
+{
+    swServer *serv = (swServer *) ctx->private_data;
+    swSendData _send;
+    bzero(&_send.info, sizeof(_send.info));
+    _send.info.fd = ctx->fd;
+    _send.info.type = SW_SERVER_EVENT_HTTP_CACHE;
+    _send.info.len = packet->length;
+    _send.data = packet->str;
+    return serv->factory.finish(&serv->factory, &_send) == SW_OK;
+}
+
 void swoole_http_response_end(http_context *ctx, zval *zdata, zval *return_value)
 {
     swString http_body;
@@ -741,6 +1084,33 @@ void swoole_http_response_end(http_context *ctx, zval *zdata, zval *return_value
 
     if (ctx->send_chunked)
     {
+#ifdef SW_HAVE_COMPRESSION
+        if (ctx->compress_stream)
+        {
+            // the end of the compressed stream is in the last chunk
+            swString *http_buffer = http_get_write_buffer(ctx);
+            swString_clear(http_buffer);
+            int ret = http_compress_stream_write(ctx->compress_stream, NULL, 0, true);
+            http_compress_stream_release(ctx->compress_stream);
+            ctx->compress_stream = NULL;
+            if (ret < 0)
+            {
+                ctx->end = 1;
+                ctx->close(ctx);
+                RETURN_FALSE;
+            }
+            if (swoole_zlib_buffer->length > 0)
+            {
+                http_append_chunk(http_buffer, swoole_zlib_buffer->str, swoole_zlib_buffer->length);
+            }
+            swString_append_ptr(http_buffer, ZEND_STRL("0\r\n\r\n"));
+            if (!ctx->send(ctx, http_buffer->str, http_buffer->length))
+            {
+                RETURN_FALSE;
+            }
+        }
+        else
+#endif
         if (!ctx->send(ctx, ZEND_STRL("0\r\n\r\n")))
         {
             RETURN_FALSE;
@@ -762,6 +1132,7 @@ void swoole_http_response_end(http_context *ctx, zval *zdata, zval *return_value
             }
         }
 #endif
+        size_t cache_prefix = http_response_cache_begin(ctx, http_buffer, http_body.length);
         http_build_header(ctx, http_buffer, http_body.length);
 
         char *send_body_str;
@@ -785,7 +1156,7 @@ void swoole_http_response_end(http_context *ctx, zval *zdata, zval *return_value
              *
              */
 #ifdef SW_HTTP_SEND_TWICE
-            if (send_body_len < SwooleG.pagesize)
+            if (send_body_len < SwooleG.pagesize || cache_prefix > 0)
 #endif
             {
                 if (swString_append_ptr(http_buffer, send_body_str, send_body_len) < 0)
@@ -813,7 +1184,11 @@ void swoole_http_response_end(http_context *ctx, zval *zdata, zval *return_value
 #endif
         }
 
-        if (!ctx->send(ctx, http_buffer->str, http_buffer->length))
+        if (cache_prefix > 0 && http_response_cache_send(ctx, http_buffer))
+        {
+            // the reactor sends it
+        }
+        else if (!ctx->send(ctx, http_buffer->str + cache_prefix, http_buffer->length - cache_prefix))
         {
             ctx->end = 1;
             ctx->close(ctx);
@@ -847,6 +1222,11 @@ void swoole_http_response_end(http_context *ctx, zval *zdata, zval *return_value
         ctx->close(ctx);
     }
     ctx->end = 1;
+    if (ctx->recv_stream && !ctx->completed)
+    {
+        // the rest of the body is not read any more
+        swoole_http_request_stream_discard(ctx);
+    }
     RETURN_TRUE;
 }
 
@@ -1132,6 +1512,27 @@ static PHP_METHOD(swoole_http_response, status)
     RETURN_TRUE;
 }
 
+/**
+ * keep the response in the response cache of the reactor for ttl seconds, 0 means it is never cached
+ */
+static PHP_METHOD(swoole_http_response, cache)
+{
+    zend_long ttl;
+
+    ZEND_PARSE_PARAMETERS_START(1, 1)
+        Z_PARAM_LONG(ttl)
+    ZEND_PARSE_PARAMETERS_END_EX(RETURN_FALSE);
+
+    http_context *ctx = php_swoole_http_response_get_and_check_context(ZEND_THIS);
+    if (UNEXPECTED(!ctx))
+    {
+        RETURN_FALSE;
+    }
+
+    ctx->response.cache_ttl = ttl > 0 ? SW_MIN(ttl, INT_MAX) : -1;
+    RETURN_TRUE;
+}
+
 static PHP_METHOD(swoole_http_response, header)
 {
     char *k, *v;
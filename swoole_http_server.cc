@@ -69,9 +69,15 @@ int php_swoole_http_onReceive(swServer *serv, swEventData *req)
         return swoole_http2_server_onFrame(serv, conn, req);
     }
 #endif
+    //the body of a request which is being handled
+    if (serv->http_body_stream && swoole_http_request_stream_recv(serv, req))
+    {
+        return SW_OK;
+    }
 
     http_context *ctx = swoole_http_context_new(fd);
     swoole_http_server_init_context(serv, ctx);
+    ctx->recv_stream = serv->http_body_stream;
 
     zval *zdata = &ctx->request.zdata;
     php_swoole_get_recv_data(serv, zdata, req);
@@ -86,7 +92,16 @@ int php_swoole_http_onReceive(swServer *serv, swEventData *req)
     parser->data = ctx;
     swoole_http_parser_init(parser, PHP_HTTP_REQUEST);
 
-    size_t parsed_n = swoole_http_requset_parse(ctx, Z_STRVAL_P(zdata), Z_STRLEN_P(zdata));
+    size_t parsed_n;
+    if (req->info.ext_flags > 0 && req->info.ext_flags < Z_STRLEN_P(zdata))
+    {
+        // parsed by the reactor
+        parsed_n = swoole_http_requset_parse_layout(ctx, zdata, req->info.ext_flags);
+    }
+    else
+    {
+        parsed_n = swoole_http_requset_parse(ctx, Z_STRVAL_P(zdata), Z_STRLEN_P(zdata));
+    }
     if (ctx->parser.state == s_dead)
     {
 #ifdef SW_HTTP_BAD_REQUEST_PACKET
@@ -96,6 +111,24 @@ int php_swoole_http_onReceive(swServer *serv, swEventData *req)
         swNotice("request is illegal and it has been discarded, %ld bytes unprocessed", Z_STRLEN_P(zdata) - parsed_n);
         goto _dtor_and_return;
     }
+    if (ctx->recv_stream && !ctx->completed)
+    {
+        // the form is held whole until it is complete, the reactor does not check the length in stream mode
+        if (ctx->parse_body && ctx->request.post_form_urlencoded
+                && ctx->request.body_length + ctx->parser.content_length > port->protocol.package_max_length)
+        {
+            swoole_error_log(
+                SW_LOG_TRACE, SW_ERROR_HTTP_INVALID_PROTOCOL, "Request Entity Too Large: content-length (%zu) is greater than the package_max_length(%u)",
+                (size_t) (ctx->request.body_length + ctx->parser.content_length), port->protocol.package_max_length
+            );
+#ifdef SW_HTTP_REQUEST_ENTITY_TOO_LARGE_PACKET
+            ctx->send(ctx, SW_STRL(SW_HTTP_REQUEST_ENTITY_TOO_LARGE_PACKET));
+#endif
+            ctx->close(ctx);
+            goto _dtor_and_return;
+        }
+        swoole_http_request_stream_start(ctx);
+    }
 
     do {
         zval *zserver = ctx->request.zserver;
@@ -161,6 +194,10 @@ void php_swoole_http_onClose(swServer *serv, swDataHead *ev)
     {
         return;
     }
+    if (serv->http_body_stream)
+    {
+        swoole_http_request_stream_close(ev->fd);
+    }
     php_swoole_onClose(serv, ev);
 #ifdef SW_USE_HTTP2
     if (conn->http2_stream)
@@ -268,6 +305,14 @@ void swoole_http_context_free(http_context *ctx)
     {
         swString_free(req->chunked_body);
     }
+    if (req->stream_body)
+    {
+        swString_free(req->stream_body);
+    }
+    if (req->stream_form)
+    {
+        swString_free(req->stream_form);
+    }
 #ifdef SW_USE_HTTP2
     if (req->h2_data_buffer)
     {
@@ -29,6 +29,11 @@ bool swoole_websocket_handshake(http_context *ctx);
 
 void swoole_http_server_init_context(swServer *serv, http_context *ctx);
 
+void swoole_http_request_stream_start(http_context *ctx);
+bool swoole_http_request_stream_recv(swServer *serv, swEventData *req);
+void swoole_http_request_stream_close(int fd);
+void swoole_http_request_stream_discard(http_context *ctx);
+
 #ifdef SW_USE_HTTP2
 
 int swoole_http2_server_onFrame(swServer *serv, swConnection *conn, swEventData *req);
@@ -1261,6 +1261,17 @@ void php_swoole_server_before_start(swServer *serv, zval *zobject)
     if (find_http_port)
     {
         serv->onReceive = php_swoole_http_onReceive;
+        // the reactor and the worker are the same process in SWOOLE_BASE, and dispatch_func gets the raw data
+        if (serv->http_parse_in_reactor && (serv->factory_mode != SW_MODE_PROCESS || serv->dispatch_func))
+        {
+            serv->http_parse_in_reactor = 0;
+        }
+        // the pieces of a body must go to the worker of its head, which is told when the connection is closed
+        if (serv->http_body_stream && (serv->dispatch_func || !swServer_dispatch_mode_is_mod(serv)))
+        {
+            php_swoole_error(E_WARNING, "http_body_stream requires dispatch_mode 2 or 4, it has been disabled");
+            serv->http_body_stream = 0;
+        }
         if (swServer_support_unsafe_events(serv))
         {
             serv->onClose = php_swoole_http_onClose;
@@ -2466,12 +2477,33 @@ static PHP_METHOD(swoole_server, set)
         zend_long v = zval_get_long(ztmp);
         serv->dispatch_mode = SW_MAX(0, SW_MIN(v, UINT8_MAX));
     }
+    // dispatch_mode=9
+    if (php_swoole_array_get_value(vht, "dispatch_hash_key", ztmp))
+    {
+        zend::string str_v(ztmp);
+        if (SW_STRCASEEQ(str_v.val(), str_v.len(), "ip"))
+        {
+            serv->dispatch_hash_key = SW_DISPATCH_HASH_KEY_IP;
+        }
+        else if (SW_STRCASEEQ(str_v.val(), str_v.len(), "uid"))
+        {
+            serv->dispatch_hash_key = SW_DISPATCH_HASH_KEY_UID;
+        }
+        else if (SW_STRCASEEQ(str_v.val(), str_v.len(), "fd"))
+        {
+            serv->dispatch_hash_key = SW_DISPATCH_HASH_KEY_FD;
+        }
+        else
+        {
+            php_swoole_fatal_error(E_WARNING, "unknown dispatch_hash_key '%s', it can be ip, uid or fd", str_v.val());
+        }
+    }
     if (php_swoole_array_get_value(vht, "send_yield", ztmp))
     {
         serv->send_yield = zval_is_true(ztmp);
-        if (serv->send_yield && !(serv->dispatch_mode == SW_DISPATCH_FDMOD || serv->dispatch_mode == SW_DISPATCH_IPMOD))
+        if (serv->send_yield && !swServer_dispatch_mode_is_mod(serv))
         {
-            php_swoole_error(E_WARNING, "'send_yield' option can only be set when using dispatch_mode=2/4");
+            php_swoole_error(E_WARNING, "'send_yield' option can only be set when using dispatch_mode=2/4, or 9 with the ip or fd key");
             serv->send_yield = 0;
         }
     }
@@ -2612,6 +2644,27 @@ static PHP_METHOD(swoole_server, set)
             serv->task_max_request_grace = serv->task_max_request / 2;
         }
     }
+    if (php_swoole_array_get_value(vht, "dgram_recv_burst", ztmp))
+    {
+        zend_long v = zval_get_long(ztmp);
+        serv->dgram_recv_burst = SW_MAX(1, SW_MIN(v, SW_DGRAM_RECV_BURST_MAX));
+    }
+    if (php_swoole_array_get_value(vht, "dgram_send_batch", ztmp))
+    {
+        zend_long v = zval_get_long(ztmp);
+        serv->dgram_send_batch = SW_MAX(0, SW_MIN(v, SW_DGRAM_SEND_BATCH_MAX));
+    }
+    //task_shm_size
+    if (php_swoole_array_get_value(vht, "task_shm_size", ztmp))
+    {
+        zend_long v = zval_get_long(ztmp);
+        serv->task_shm_size = SW_MAX(0, SW_MIN(v, UINT32_MAX));
+    }
+    if (php_swoole_array_get_value(vht, "task_shm_slice_size", ztmp))
+    {
+        zend_long v = zval_get_long(ztmp);
+        serv->task_shm_slice_size = SW_MAX(SW_IPC_MAX_SIZE, SW_MIN(v, UINT32_MAX));
+    }
     //max_connection
     if (php_swoole_array_get_value(vht, "max_connection", ztmp) || php_swoole_array_get_value(vht, "max_conn", ztmp))
     {
@@ -2723,6 +2776,16 @@ static PHP_METHOD(swoole_server, set)
     {
         serv->http_parse_files = zval_is_true(ztmp);
     }
+    //parse the requests in the reactor threads
+    if (php_swoole_array_get_value(vht, "http_parse_in_reactor", ztmp))
+    {
+        serv->http_parse_in_reactor = zval_is_true(ztmp);
+    }
+    //call the handler before the body arrives
+    if (php_swoole_array_get_value(vht, "http_body_stream", ztmp))
+    {
+        serv->http_body_stream = zval_is_true(ztmp);
+    }
 #ifdef SW_HAVE_COMPRESSION
     //http content compression
     if (php_swoole_array_get_value(vht, "http_compression", ztmp))
@@ -2804,6 +2867,31 @@ static PHP_METHOD(swoole_server, set)
     {
         serv->http_autoindex = zval_is_true(ztmp);
     }
+    /**
+     * [static_handler] open-file cache
+     */
+    if (php_swoole_array_get_value(vht, "static_handler_cache_capacity", ztmp))
+    {
+        zend_long v = zval_get_long(ztmp);
+        serv->static_handler_cache_capacity = SW_MAX(0, SW_MIN(v, UINT32_MAX));
+    }
+    if (php_swoole_array_get_value(vht, "static_handler_cache_interval", ztmp))
+    {
+        serv->static_handler_cache_interval = SW_MAX(0, zval_get_double(ztmp));
+    }
+    //build the .gz variants of the static files
+    if (php_swoole_array_get_value(vht, "static_handler_precompress", ztmp))
+    {
+        serv->static_handler_precompress = zval_is_true(ztmp);
+    }
+    /**
+     * [http] response cache of the reactor threads
+     */
+    if (php_swoole_array_get_value(vht, "http_response_cache_capacity", ztmp))
+    {
+        zend_long v = zval_get_long(ztmp);
+        serv->http_response_cache_capacity = SW_MAX(0, SW_MIN(v, UINT32_MAX));
+    }
     if (php_swoole_array_get_value(vht, "http_index_files", ztmp))
     {
         if (ZVAL_IS_ARRAY(ztmp))
@@ -2867,6 +2955,12 @@ static PHP_METHOD(swoole_server, set)
         zend_long v = zval_get_long(ztmp);
         serv->message_queue_key = SW_MAX(0, SW_MIN(v, INT64_MAX));
     }
+    //shared memory ring between reactor threads and workers
+    if (php_swoole_array_get_value(vht, "ipc_ring_size", ztmp))
+    {
+        zend_long v = zval_get_long(ztmp);
+        serv->ipc_ring_size = SW_MAX(0, SW_MIN(v, SW_IPC_RING_MAX_SIZE));
+    }
 
     if (serv->task_enable_coroutine
             && (serv->task_ipc_mode == SW_TASK_IPC_MSGQUEUE || serv->task_ipc_mode == SW_TASK_IPC_PREEMPTIVE))
@@ -3241,7 +3335,32 @@ static PHP_METHOD(swoole_server, sendto)
     }
 
     int ret;
-    if (ipv6)
+    if (serv->dgram_send_batch > 1)
+    {
+        swSocketAddress addr;
+        bzero(&addr, sizeof(addr));
+        if (ipv6)
+        {
+            addr.addr.inet_v6.sin6_family = AF_INET6;
+            addr.addr.inet_v6.sin6_port = htons(port);
+            addr.len = sizeof(addr.addr.inet_v6);
+            ret = inet_pton(AF_INET6, ip, &addr.addr.inet_v6.sin6_addr);
+        }
+        else
+        {
+            addr.addr.inet_v4.sin_family = AF_INET;
+            addr.addr.inet_v4.sin_port = htons(port);
+            addr.len = sizeof(addr.addr.inet_v4);
+            ret = inet_pton(AF_INET, ip, &addr.addr.inet_v4.sin_addr);
+        }
+        if (ret != 1)
+        {
+            php_swoole_fatal_error(E_WARNING, "ip[%s] is invalid", ip);
+            RETURN_FALSE;
+        }
+        ret = swSocket_sendto_batch(server_socket, data, len, (struct sockaddr *) &addr.addr, addr.len, serv->dgram_send_batch, &serv->stats->dgram_send_dropped);
+    }
+    else if (ipv6)
     {
         ret = swSocket_udp_sendto6(server_socket, ip, port, data, len);
     }
@@ -3385,12 +3504,30 @@ static PHP_METHOD(swoole_server, stats)
     add_assoc_long_ex(return_value, ZEND_STRL("idle_worker_num"), idle_worker_num);
     add_assoc_long_ex(return_value, ZEND_STRL("tasking_num"), tasking_num);
     add_assoc_long_ex(return_value, ZEND_STRL("request_count"), serv->stats->request_count);
+    add_assoc_long_ex(return_value, ZEND_STRL("dgram_send_dropped"), serv->stats->dgram_send_dropped);
     if (SwooleWG.worker)
     {
         add_assoc_long_ex(return_value, ZEND_STRL("worker_request_count"), SwooleWG.worker->request_count);
         add_assoc_long_ex(return_value, ZEND_STRL("worker_dispatch_count"), SwooleWG.worker->dispatch_count);
     }
 
+    if (serv->dispatch_mode == SW_DISPATCH_LEAST_LATENCY)
+    {
+        zval zworkers;
+        array_init(&zworkers);
+        for (i = 0; i < worker_num; i++)
+        {
+            swWorker *worker = swServer_get_worker(serv, i);
+            zval zworker;
+            array_init(&zworker);
+            add_assoc_long_ex(&zworker, ZEND_STRL("dispatch_count"), worker->dispatch_count);
+            add_assoc_long_ex(&zworker, ZEND_STRL("inflight_num"), worker->inflight_num);
+            add_assoc_double_ex(&zworker, ZEND_STRL("service_time"), (double) worker->service_time / (1000 * 1000));
+            add_index_zval(&zworkers, i, &zworker);
+        }
+        add_assoc_zval_ex(return_value, ZEND_STRL("worker_dispatch_stats"), &zworkers);
+    }
+
     if (serv->task_ipc_mode > SW_TASK_IPC_UNIXSOCK && serv->gs->task_workers.queue)
     {
         int queue_num = -1;
@@ -3561,6 +3698,7 @@ static PHP_METHOD(swoole_server, taskwait)
             {
                 if (task_result->info.fd != task_id)
                 {
+                    swTaskWorker_large_free(task_result);
                     continue;
                 }
                 zval *task_notify_data = php_swoole_task_unpack(task_result);
@@ -3705,6 +3843,8 @@ static PHP_METHOD(swoole_server, taskWaitMulti)
 
     worker->lock.lock(&worker->lock);
     swString *content = swoole_file_get_contents(_tmpfile);
+    // the results finished later are not written, the file cannot be opened any more
+    unlink(_tmpfile);
     worker->lock.unlock(&worker->lock);
 
     if (content == NULL)
@@ -3720,11 +3860,6 @@ static PHP_METHOD(swoole_server, taskWaitMulti)
     {
         result = (swEventData *) (content->str + content->offset);
         task_id = result->info.fd;
-        zdata = php_swoole_task_unpack(result);
-        if (zdata == NULL)
-        {
-            goto _next;
-        }
         for (j = 0; j < php_swoole_array_length(ztasks); j++)
         {
             if (list_of_id[j] == task_id)
@@ -3732,6 +3867,18 @@ static PHP_METHOD(swoole_server, taskWaitMulti)
                 break;
             }
         }
+        // the result of another call or a duplicate is dropped, its large packet must be released
+        if (j == php_swoole_array_length(ztasks) || zend_hash_index_exists(Z_ARRVAL_P(return_value), j))
+        {
+            swTaskWorker_large_free(result);
+            goto _next;
+        }
+        zdata = php_swoole_task_unpack(result);
+        if (zdata == NULL)
+        {
+            swTaskWorker_large_free(result);
+            goto _next;
+        }
         (void) add_index_zval(return_value, j, zdata);
         efree(zdata);
         _next:
@@ -3739,8 +3886,6 @@ static PHP_METHOD(swoole_server, taskWaitMulti)
     } while (content->offset < 0 || (size_t) content->offset < content->length);
     //free memory
     swString_free(content);
-    //delete tmp file
-    unlink(_tmpfile);
 }
 
 static PHP_METHOD(swoole_server, taskCo)
@@ -4116,7 +4261,8 @@ static PHP_METHOD(swoole_server, getClientInfo)
     {
         array_init(return_value);
 
-        if (conn->uid > 0 || serv->dispatch_mode == SW_DISPATCH_UIDMOD)
+        if (conn->uid > 0 || serv->dispatch_mode == SW_DISPATCH_UIDMOD
+                || (serv->dispatch_mode == SW_DISPATCH_CONSISTENT_HASH && serv->dispatch_hash_key == SW_DISPATCH_HASH_KEY_UID))
         {
             add_assoc_long(return_value, "uid", conn->uid);
         }
@@ -388,6 +388,11 @@ static PHP_METHOD(swoole_server_port, set)
     {
         port->open_websocket_close_frame = zval_is_true(ztmp);
     }
+    // validate UTF-8 of websocket text messages
+    if (php_swoole_array_get_value(vht, "open_websocket_utf8_check", ztmp))
+    {
+        port->open_websocket_utf8_check = zval_is_true(ztmp);
+    }
 #ifdef SW_USE_HTTP2
     //http2 protocol
     if (php_swoole_array_get_value(vht, "open_http2_protocol", ztmp))
@@ -563,6 +568,10 @@ static PHP_METHOD(swoole_server_port, set)
         {
             port->ssl_option.disable_compress = !zval_is_true(ztmp);
         }
+        if (php_swoole_array_get_value(vht, "ssl_ktls", ztmp))
+        {
+            port->ssl_option.disable_ktls = !zval_is_true(ztmp);
+        }
         if (php_swoole_array_get_value(vht, "ssl_protocols", ztmp))
         {
             zend_long v = zval_get_long(ztmp);
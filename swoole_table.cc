@@ -164,6 +164,27 @@ void php_swoole_table_set_ptr(zval *zobject, swTable *ptr)
     php_swoole_table_fetch_object(Z_OBJ_P(zobject))->ptr = ptr;
 }
 
+/**
+ * rowlock is NULL if the row is a lock-free copy, nothing to unlock
+ */
+static inline swTableRow* php_swoole_table_row_get(swTable *table, const char *key, int keylen, swTableRow **rowlock)
+{
+    if (table->use_seqlock)
+    {
+        *rowlock = NULL;
+        return swTableRow_get_snapshot(table, key, keylen);
+    }
+    return swTableRow_get(table, key, keylen, rowlock);
+}
+
+static inline void php_swoole_table_row_release(swTableRow *rowlock)
+{
+    if (rowlock)
+    {
+        swTableRow_unlock(rowlock);
+    }
+}
+
 static void php_swoole_table_free_object(zend_object *object)
 {
     zend_object_std_dtor(object);
@@ -229,6 +250,7 @@ ZEND_END_ARG_INFO()
 ZEND_BEGIN_ARG_INFO_EX(arginfo_swoole_table_construct, 0, 0, 1)
     ZEND_ARG_INFO(0, table_size)
     ZEND_ARG_INFO(0, conflict_proportion)
+    ZEND_ARG_INFO(0, use_seqlock)
 ZEND_END_ARG_INFO()
 
 ZEND_BEGIN_ARG_INFO_EX(arginfo_swoole_table_column, 0, 0, 2)
@@ -393,11 +415,13 @@ PHP_METHOD(swoole_table, __construct)
 
     zend_long table_size;
     double conflict_proportion = SW_TABLE_CONFLICT_PROPORTION;
+    zend_bool use_seqlock = 0;
 
-    ZEND_PARSE_PARAMETERS_START_EX(ZEND_PARSE_PARAMS_THROW, 1, 2)
+    ZEND_PARSE_PARAMETERS_START_EX(ZEND_PARSE_PARAMS_THROW, 1, 3)
         Z_PARAM_LONG(table_size)
         Z_PARAM_OPTIONAL
         Z_PARAM_DOUBLE(conflict_proportion)
+        Z_PARAM_BOOL(use_seqlock)
     ZEND_PARSE_PARAMETERS_END_EX(RETURN_FALSE);
 
     table = swTable_new(table_size, conflict_proportion);
@@ -406,6 +430,7 @@ PHP_METHOD(swoole_table, __construct)
         zend_throw_exception(swoole_exception_ce, "global memory allocation failure", SW_ERROR_MALLOC_FAIL);
         RETURN_FALSE;
     }
+    table->use_seqlock = use_seqlock;
     php_swoole_table_set_ptr(ZEND_THIS, table);
 }
 
@@ -695,7 +720,7 @@ static PHP_METHOD(swoole_table, get)
     }
 
     swTableRow *_rowlock = NULL;
-    swTableRow *row = swTableRow_get(table, key, keylen, &_rowlock);
+    swTableRow *row = php_swoole_table_row_get(table, key, keylen, &_rowlock);
     if (!row)
     {
         RETVAL_FALSE;
@@ -708,7 +733,7 @@ static PHP_METHOD(swoole_table, get)
     {
         php_swoole_table_row2array(table, row, return_value);
     }
-    swTableRow_unlock(_rowlock);
+    php_swoole_table_row_release(_rowlock);
 }
 
 static PHP_METHOD(swoole_table, offsetGet)
@@ -726,7 +751,7 @@ static PHP_METHOD(swoole_table, offsetGet)
 
     zval value;
     swTableRow *_rowlock = NULL;
-    swTableRow *row = swTableRow_get(table, key, keylen, &_rowlock);
+    swTableRow *row = php_swoole_table_row_get(table, key, keylen, &_rowlock);
     if (!row)
     {
         array_init(&value);
@@ -735,7 +760,7 @@ static PHP_METHOD(swoole_table, offsetGet)
     {
         php_swoole_table_row2array(table, row, &value);
     }
-    swTableRow_unlock(_rowlock);
+    php_swoole_table_row_release(_rowlock);
 
     object_init_ex(return_value, swoole_table_row_ce);
     zend_update_property(swoole_table_row_ce, return_value, ZEND_STRL("value"), &value);
@@ -757,8 +782,8 @@ static PHP_METHOD(swoole_table, exists)
 
 
     swTableRow *_rowlock = NULL;
-    swTableRow *row = swTableRow_get(table, key, keylen, &_rowlock);
-    swTableRow_unlock(_rowlock);
+    swTableRow *row = php_swoole_table_row_get(table, key, keylen, &_rowlock);
+    php_swoole_table_row_release(_rowlock);
     if (!row)
     {
         RETURN_FALSE;
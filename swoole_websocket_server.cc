@@ -17,6 +17,7 @@
 #include "swoole_http_server.h"
 
 #include <iostream>
+#include <vector>
 
 extern "C"
 {
@@ -50,6 +51,7 @@ static PHP_METHOD(swoole_websocket_server, isEstablished);
 static PHP_METHOD(swoole_websocket_server, pack);
 static PHP_METHOD(swoole_websocket_server, unpack);
 static PHP_METHOD(swoole_websocket_server, disconnect);
+static PHP_METHOD(swoole_websocket_server, broadcast);
 
 static PHP_METHOD(swoole_websocket_frame, __toString);
 
@@ -60,6 +62,13 @@ ZEND_BEGIN_ARG_INFO_EX(arginfo_swoole_websocket_server_push, 0, 0, 2)
     ZEND_ARG_INFO(0, flags)
 ZEND_END_ARG_INFO()
 
+ZEND_BEGIN_ARG_INFO_EX(arginfo_swoole_websocket_server_broadcast, 0, 0, 2)
+    ZEND_ARG_INFO(0, fds)
+    ZEND_ARG_INFO(0, data)
+    ZEND_ARG_INFO(0, opcode)
+    ZEND_ARG_INFO(0, flags)
+ZEND_END_ARG_INFO()
+
 ZEND_BEGIN_ARG_INFO_EX(arginfo_swoole_websocket_server_disconnect, 0, 0, 1)
     ZEND_ARG_INFO(0, fd)
     ZEND_ARG_INFO(0, code)
@@ -86,6 +95,7 @@ ZEND_END_ARG_INFO()
 const zend_function_entry swoole_websocket_server_methods[] =
 {
     PHP_ME(swoole_websocket_server, push,              arginfo_swoole_websocket_server_push,          ZEND_ACC_PUBLIC)
+    PHP_ME(swoole_websocket_server, broadcast,         arginfo_swoole_websocket_server_broadcast,     ZEND_ACC_PUBLIC)
     PHP_ME(swoole_websocket_server, disconnect,        arginfo_swoole_websocket_server_disconnect,    ZEND_ACC_PUBLIC)
     PHP_ME(swoole_websocket_server, isEstablished,     arginfo_swoole_websocket_server_isEstablished, ZEND_ACC_PUBLIC)
     PHP_ME(swoole_websocket_server, pack,              arginfo_swoole_websocket_server_pack,          ZEND_ACC_PUBLIC | ZEND_ACC_STATIC)
@@ -910,6 +920,151 @@ static PHP_METHOD(swoole_websocket_server, push)
     }
 }
 
+static int swoole_websocket_server_broadcast_add(zend_object_iterator *iter, void *puser)
+{
+    zval *zfd = iter->funcs->get_current_data(iter);
+    if (zfd)
+    {
+        ((std::vector<int> *) puser)->push_back(zval_get_long(zfd));
+    }
+    return ZEND_HASH_APPLY_KEEP;
+}
+
+static int swoole_websocket_server_broadcast(swServer *serv, const std::vector<int> &sessions, zval *zdata, zend_long opcode, zend_long flags, zend_bool allow_compress)
+{
+    if (sessions.empty())
+    {
+        return 0;
+    }
+    swString_clear(swoole_http_buffer);
+    if (php_swoole_websocket_frame_is_object(zdata))
+    {
+        if (php_swoole_websocket_frame_object_pack(swoole_http_buffer, zdata, 0, allow_compress) < 0)
+        {
+            return SW_ERR;
+        }
+    }
+    else
+    {
+        if (php_swoole_websocket_frame_pack(swoole_http_buffer, zdata, opcode, flags & SW_WEBSOCKET_FLAGS_ALL, 0, allow_compress) < 0)
+        {
+            return SW_ERR;
+        }
+    }
+    return swServer_broadcast(serv, sessions.data(), sessions.size(), swoole_http_buffer->str, swoole_http_buffer->length);
+}
+
+/**
+ * the frame is packed once (twice at most if some of the connections use the compression),
+ * the reactor writes it to all the connections
+ */
+static PHP_METHOD(swoole_websocket_server, broadcast)
+{
+    swServer *serv = php_swoole_server_get_and_check_server(ZEND_THIS);
+    if (sw_unlikely(!serv->gs->start))
+    {
+        php_swoole_fatal_error(E_WARNING, "server is not running");
+        RETURN_FALSE;
+    }
+
+    zval *zfds;
+    zval *zdata = NULL;
+    zend_long opcode = WEBSOCKET_OPCODE_TEXT;
+    zval *zflags = NULL;
+    zend_long flags = SW_WEBSOCKET_FLAG_FIN;
+
+    ZEND_PARSE_PARAMETERS_START(2, 4)
+        Z_PARAM_ZVAL(zfds)
+        Z_PARAM_ZVAL(zdata)
+        Z_PARAM_OPTIONAL
+        Z_PARAM_LONG(opcode)
+        Z_PARAM_ZVAL_EX(zflags, 1, 0)
+    ZEND_PARSE_PARAMETERS_END_EX(RETURN_FALSE);
+
+    if (zflags != NULL)
+    {
+        flags = zval_get_long(zflags);
+    }
+    if (php_swoole_websocket_frame_is_object(zdata))
+    {
+        zval *ztmp;
+        if ((ztmp = sw_zend_read_property(swoole_websocket_frame_ce, zdata, ZEND_STRL("opcode"), 0)))
+        {
+            opcode = zval_get_long(ztmp);
+        }
+        if ((ztmp = sw_zend_read_property(swoole_websocket_frame_ce, zdata, ZEND_STRL("flags"), 0)))
+        {
+            flags = zval_get_long(ztmp);
+        }
+    }
+    if (opcode == WEBSOCKET_OPCODE_CLOSE)
+    {
+        php_swoole_fatal_error(E_WARNING, "can not broadcast the close frame, use disconnect instead");
+        RETURN_FALSE;
+    }
+
+    std::vector<int> fds;
+    if (ZVAL_IS_ARRAY(zfds))
+    {
+        zval *zfd;
+        fds.reserve(php_swoole_array_length(zfds));
+        ZEND_HASH_FOREACH_VAL(Z_ARRVAL_P(zfds), zfd)
+        {
+            fds.push_back(zval_get_long(zfd));
+        }
+        ZEND_HASH_FOREACH_END();
+    }
+    else if (Z_TYPE_P(zfds) == IS_OBJECT && instanceof_function(Z_OBJCE_P(zfds), zend_ce_traversable))
+    {
+        if (spl_iterator_apply(zfds, swoole_websocket_server_broadcast_add, &fds) == FAILURE)
+        {
+            RETURN_FALSE;
+        }
+    }
+    else
+    {
+        php_swoole_fatal_error(E_WARNING, "fds must be an array or a Traversable object");
+        RETURN_FALSE;
+    }
+
+    std::vector<int> sessions;
+#ifdef SW_HAVE_ZLIB
+    std::vector<int> compress_sessions;
+#endif
+    sessions.reserve(fds.size());
+    for (int fd : fds)
+    {
+        swConnection *conn = swWorker_get_connection(serv, fd);
+        if (!conn || conn->closed || conn->websocket_status < WEBSOCKET_STATUS_ACTIVE)
+        {
+            continue;
+        }
+#ifdef SW_HAVE_ZLIB
+        if (conn->websocket_compression && (flags & SW_WEBSOCKET_FLAG_COMPRESS))
+        {
+            compress_sessions.push_back(fd);
+            continue;
+        }
+#endif
+        sessions.push_back(fd);
+    }
+
+    int count = swoole_websocket_server_broadcast(serv, sessions, zdata, opcode, flags, 0);
+    if (count < 0)
+    {
+        RETURN_FALSE;
+    }
+#ifdef SW_HAVE_ZLIB
+    int n = swoole_websocket_server_broadcast(serv, compress_sessions, zdata, opcode, flags, 1);
+    if (n < 0)
+    {
+        RETURN_FALSE;
+    }
+    count += n;
+#endif
+    RETURN_LONG(count);
+}
+
 static PHP_METHOD(swoole_websocket_server, pack)
 {
     swString *buffer = SwooleTG.buffer_stack;
@@ -0,0 +1,120 @@
+--TEST--
+swoole_http_server: request bodies streamed to the handler
+--SKIPIF--
+<?php require __DIR__ . '/../include/skipif.inc'; ?>
+--FILE--
+<?php
+require __DIR__ . '/../include/bootstrap.php';
+
+use Swoole\Http\Request;
+use Swoole\Http\Response;
+use Swoole\Http\Server;
+
+$pm = new ProcessManager;
+$pm->parentFunc = function () use ($pm) {
+    Swoole\Coroutine\run(function () use ($pm) {
+        // the handler is called before the body arrives
+        $client = new Co\Client(SWOOLE_SOCK_TCP);
+        Assert::assert($client->connect('127.0.0.1', $pm->getFreePort(), 1));
+        $body = str_repeat('a', 1024) . str_repeat('b', 1024);
+        Assert::assert($client->send("POST /raw HTTP/1.1\r\nHost: localhost\r\nContent-Length: 2048\r\n\r\n" . substr($body, 0, 1024)));
+        Co::sleep(0.1);
+        Assert::assert($client->send(substr($body, 1024)));
+        $data = '';
+        while (strpos($data, "\r\n\r\n") === false || substr($data, -1) !== '}') {
+            $tmp = $client->recv();
+            Assert::notEmpty($tmp);
+            $data .= $tmp;
+        }
+        $result = json_decode(substr($data, strpos($data, "\r\n\r\n") + 4), true);
+        Assert::same($result['md5'], md5($body));
+        Assert::assert($result['pieces'] >= 2);
+
+        // a form field and a file
+        $file = tempnam('/tmp', 'swoole_');
+        file_put_contents($file, str_repeat('x', 3 * 1024 * 1024));
+        $cli = new Swoole\Coroutine\Http\Client('127.0.0.1', $pm->getFreePort());
+        $cli->set(['timeout' => 10]);
+        $cli->setData(['name' => 'swoole']);
+        $cli->addFile($file, 'file');
+        Assert::assert($cli->post('/upload', []));
+        Assert::same($cli->statusCode, 200);
+        $result = json_decode($cli->body, true);
+        Assert::same($result['post'], ['name' => 'swoole']);
+        Assert::same($result['md5'], md5_file($file));
+        unlink($file);
+
+        // the urlencoded form is parsed as a whole
+        Assert::same(httpGetBody("http://127.0.0.1:{$pm->getFreePort()}/form", ['data' => ['a' => str_repeat('1', 100000)]]), '100000');
+        // and it is limited by package_max_length
+        $client = new Co\Client(SWOOLE_SOCK_TCP);
+        Assert::assert($client->connect('127.0.0.1', $pm->getFreePort(), 1));
+        Assert::assert($client->send("POST /form HTTP/1.1\r\nHost: localhost\r\nContent-Type: application/x-www-form-urlencoded\r\nContent-Length: 300000\r\n\r\na=1"));
+        Assert::contains($client->recv(), '413 Request Entity Too Large');
+
+        // Expect: 100-continue is answered when the head is dispatched
+        $client = new Co\Client(SWOOLE_SOCK_TCP);
+        Assert::assert($client->connect('127.0.0.1', $pm->getFreePort(), 1));
+        Assert::assert($client->send("POST /raw HTTP/1.1\r\nHost: localhost\r\nExpect: 100-continue\r\nContent-Length: 2048\r\n\r\n"));
+        Assert::same($client->recv(), "HTTP/1.1 100 Continue\r\n\r\n");
+        Assert::assert($client->send($body));
+        $data = '';
+        while (strpos($data, "\r\n\r\n") === false || substr($data, -1) !== '}') {
+            $tmp = $client->recv();
+            Assert::notEmpty($tmp);
+            $data .= $tmp;
+        }
+        $result = json_decode(substr($data, strpos($data, "\r\n\r\n") + 4), true);
+        Assert::same($result['md5'], md5($body));
+    });
+    $pm->kill();
+    echo "DONE\n";
+};
+$pm->childFunc = function () use ($pm) {
+    $http = new Server('127.0.0.1', $pm->getFreePort(), SWOOLE_PROCESS);
+    $http->set([
+        'log_file' => '/dev/null',
+        'worker_num' => 1,
+        'http_body_stream' => true,
+        'package_max_length' => 200000,
+    ]);
+    $http->on('workerStart', function () use ($pm) {
+        $pm->wakeup();
+    });
+    $http->on('request', function (Request $request, Response $response) {
+        switch ($request->server['request_uri']) {
+            case '/raw':
+                $body = '';
+                $pieces = 0;
+                while (($data = $request->read(1024)) !== '') {
+                    Assert::string($data);
+                    $body .= $data;
+                    $pieces++;
+                }
+                $response->end(json_encode(['md5' => md5($body), 'pieces' => $pieces]));
+                break;
+            case '/upload':
+                // the request is complete when read() returns an empty string
+                Assert::same($request->read(), '');
+                $response->end(json_encode([
+                    'post' => $request->post,
+                    'md5' => md5_file($request->files['file']['tmp_name']),
+                ]));
+                break;
+            case '/form':
+                $body = '';
+                while (($data = $request->read()) !== '') {
+                    $body .= $data;
+                }
+                Assert::same($body, 'a=' . $request->post['a']);
+                $response->end(strlen($request->post['a']));
+                break;
+        }
+    });
+    $http->start();
+};
+$pm->childFirst();
+$pm->run();
+?>
+--EXPECT--
+DONE
@@ -0,0 +1,52 @@
+--TEST--
+swoole_http_server: compressed chunked responses
+--SKIPIF--
+<?php require __DIR__ . '/../include/skipif.inc'; ?>
+--FILE--
+<?php
+require __DIR__ . '/../include/bootstrap.php';
+
+$pm = new ProcessManager;
+$pm->parentFunc = function () use ($pm) {
+    go(function () use ($pm) {
+        $cli = new Swoole\Coroutine\Http\Client('127.0.0.1', $pm->getFreePort());
+        $cli->setHeaders(['Accept-Encoding' => 'gzip']);
+        // the deflate stream is reused by the next response
+        for ($i = 0; $i < 3; $i++) {
+            Assert::assert($cli->get('/'));
+            Assert::same($cli->statusCode, 200);
+            Assert::same($cli->headers['content-encoding'], 'gzip');
+            Assert::same($cli->headers['transfer-encoding'], 'chunked');
+            Assert::same($cli->body, str_repeat(co::readFile(__DIR__ . '/../../README.md'), 3) . 'end');
+        }
+        $pm->kill();
+    });
+    Swoole\Event::wait();
+    echo "DONE\n";
+};
+
+$pm->childFunc = function () use ($pm) {
+    $http = new swoole_http_server('127.0.0.1', $pm->getFreePort(), SWOOLE_BASE);
+    $http->set([
+        'log_file' => '/dev/null',
+        'http_compression' => true,
+    ]);
+    $http->on('WorkerStart', function () use ($pm) {
+        $pm->wakeup();
+    });
+    $http->on('request', function ($request, swoole_http_response $response) {
+        $data = co::readFile(__DIR__ . '/../../README.md');
+        for ($i = 0; $i < 3; $i++) {
+            Assert::true($response->write($data));
+        }
+        Assert::true($response->write('end'));
+        $response->end();
+    });
+    $http->start();
+};
+
+$pm->childFirst();
+$pm->run();
+?>
+--EXPECT--
+DONE
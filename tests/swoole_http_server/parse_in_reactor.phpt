@@ -0,0 +1,77 @@
+--TEST--
+swoole_http_server: requests parsed by the reactor
+--SKIPIF--
+<?php require __DIR__ . '/../include/skipif.inc'; ?>
+--FILE--
+<?php
+require __DIR__ . '/../include/bootstrap.php';
+
+$pm = new ProcessManager;
+$pm->parentFunc = function () use ($pm) {
+    go(function () use ($pm) {
+        $client = new Co\Client(SWOOLE_SOCK_TCP);
+        Assert::assert($client->connect('127.0.0.1', $pm->getFreePort(), 1));
+
+        // pipelined requests, a form body and a chunked body which is parsed by the worker
+        $requests = [
+            "GET /a.php?x=1&y=2 HTTP/1.1\r\nHost: localhost\r\nX-Test: a\r\n\r\n",
+            "GET /b HTTP/1.1\r\nHost: localhost\r\nCookie: k=v\r\n\r\n",
+            "POST /c HTTP/1.1\r\nHost: localhost\r\nContent-Type: application/x-www-form-urlencoded\r\nContent-Length: 7\r\n\r\nfoo=bar",
+            "POST /d HTTP/1.1\r\nHost: localhost\r\nTransfer-Encoding: chunked\r\n\r\n3\r\nabc\r\n2\r\nde\r\n0\r\n\r\n",
+        ];
+        Assert::assert($client->send(implode('', $requests)));
+
+        $data = '';
+        $responses = [];
+        while (count($responses) < count($requests)) {
+            $tmp = $client->recv();
+            Assert::notEmpty($tmp);
+            $data .= $tmp;
+            while (preg_match('/^HTTP\/1\.1 200 OK\r\n.*?Content-Length: (\d+)\r\n.*?\r\n\r\n/s', $data, $matches)) {
+                $length = strlen($matches[0]) + $matches[1];
+                if (strlen($data) < $length) {
+                    break;
+                }
+                $responses[] = json_decode(substr($data, strlen($matches[0]), $matches[1]), true);
+                $data = substr($data, $length);
+            }
+        }
+
+        Assert::same($responses[0]['uri'], '/a.php');
+        Assert::same($responses[0]['get'], ['x' => '1', 'y' => '2']);
+        Assert::same($responses[0]['header']['x-test'], 'a');
+        Assert::same($responses[1]['uri'], '/b');
+        Assert::same($responses[1]['cookie'], ['k' => 'v']);
+        Assert::same($responses[2]['post'], ['foo' => 'bar']);
+        Assert::same($responses[2]['content'], 'foo=bar');
+        Assert::same($responses[3]['content'], 'abcde');
+        echo "DONE\n";
+    });
+    Swoole\Event::wait();
+    $pm->kill();
+};
+
+$pm->childFunc = function () use ($pm) {
+    $http = new swoole_http_server('127.0.0.1', $pm->getFreePort(), SWOOLE_PROCESS);
+    $http->set(['log_file' => '/dev/null', 'worker_num' => 1, 'http_parse_in_reactor' => true]);
+    $http->on('WorkerStart', function () use ($pm) {
+        $pm->wakeup();
+    });
+    $http->on('request', function (swoole_http_request $request, swoole_http_response $response) {
+        $response->end(json_encode([
+            'uri' => $request->server['request_uri'],
+            'get' => $request->get,
+            'post' => $request->post,
+            'cookie' => $request->cookie,
+            'header' => $request->header,
+            'content' => $request->rawContent(),
+        ]));
+    });
+    $http->start();
+};
+
+$pm->childFirst();
+$pm->run();
+?>
+--EXPECT--
+DONE
@@ -0,0 +1,86 @@
+--TEST--
+swoole_http_server: responses cached by the reactor
+--SKIPIF--
+<?php require __DIR__ . '/../include/skipif.inc'; ?>
+--FILE--
+<?php
+require __DIR__ . '/../include/bootstrap.php';
+
+use Swoole\Http\Request;
+use Swoole\Http\Response;
+use Swoole\Http\Server;
+
+$pm = new ProcessManager;
+$pm->parentFunc = function () use ($pm) {
+    Swoole\Coroutine\run(function () use ($pm) {
+        $url = "http://127.0.0.1:{$pm->getFreePort()}";
+
+        // Cache-Control
+        Assert::same(httpGetBody("{$url}/max-age?a=1"), '1');
+        Assert::same(httpGetBody("{$url}/max-age?a=1"), '1');
+        Assert::same(httpGetBody("{$url}/max-age?a=2"), '2');
+
+        // Response->cache()
+        Assert::same(httpGetBody("{$url}/explicit"), '3');
+        Assert::same(httpGetBody("{$url}/explicit"), '3');
+
+        Assert::same(httpGetBody("{$url}/none"), '4');
+        Assert::same(httpGetBody("{$url}/none"), '5');
+        Assert::same(httpGetBody("{$url}/private"), '6');
+        Assert::same(httpGetBody("{$url}/private"), '7');
+
+        // the requests of a user are handled by the worker
+        Assert::same(httpGetBody("{$url}/explicit", ['headers' => ['Cookie' => 'k=v']]), '8');
+
+        // Vary
+        Assert::same(httpGetBody("{$url}/vary", ['headers' => ['X-Lang' => 'en']]), 'en9');
+        Assert::same(httpGetBody("{$url}/vary", ['headers' => ['X-Lang' => 'en']]), 'en9');
+        Assert::same(httpGetBody("{$url}/vary", ['headers' => ['X-Lang' => 'fr']]), 'fr10');
+        Assert::same(httpGetBody("{$url}/vary", ['headers' => ['X-Lang' => 'fr']]), 'fr10');
+
+        $response = httpRequest("{$url}/max-age?a=1");
+        Assert::same($response['headers']['cache-control'], 'public, max-age=60');
+        Assert::same($response['body'], '1');
+    });
+    $pm->kill();
+    echo "DONE\n";
+};
+$pm->childFunc = function () use ($pm) {
+    $http = new Server('127.0.0.1', $pm->getFreePort(), SWOOLE_PROCESS);
+    $http->set([
+        'log_file' => '/dev/null',
+        'worker_num' => 1,
+        'reactor_num' => 1,
+        'http_response_cache_capacity' => 16,
+    ]);
+    $http->on('workerStart', function () use ($pm) {
+        $pm->wakeup();
+    });
+    $counter = 0;
+    $http->on('request', function (Request $request, Response $response) use (&$counter) {
+        $counter++;
+        switch ($request->server['request_uri']) {
+            case '/max-age':
+                $response->header('Cache-Control', 'public, max-age=60');
+                break;
+            case '/explicit':
+                $response->cache(60);
+                break;
+            case '/private':
+                $response->header('Cache-Control', 'private, max-age=60');
+                break;
+            case '/vary':
+                $response->header('Cache-Control', 'max-age=60');
+                $response->header('Vary', 'X-Lang');
+                $response->end($request->header['x-lang'] . $counter);
+                return;
+        }
+        $response->end($counter);
+    });
+    $http->start();
+};
+$pm->childFirst();
+$pm->run();
+?>
+--EXPECT--
+DONE
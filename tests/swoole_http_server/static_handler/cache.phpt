@@ -0,0 +1,70 @@
+--TEST--
+swoole_http_server/static_handler: open file cache
+--SKIPIF--
+<?php
+require __DIR__ . '/../../include/skipif.inc'; ?>
+--FILE--
+<?php
+require __DIR__ . '/../../include/bootstrap.php';
+
+use Swoole\Http\Request;
+use Swoole\Http\Response;
+use Swoole\Http\Server;
+
+define('DOCUMENT_ROOT', '/tmp/swoole_static_cache');
+define('STATIC_FILE', DOCUMENT_ROOT . '/cache.txt');
+
+@mkdir(DOCUMENT_ROOT);
+file_put_contents(STATIC_FILE, 'version 1');
+
+$pm = new ProcessManager;
+$pm->parentFunc = function () use ($pm) {
+    Swoole\Coroutine\run(function () use ($pm) {
+        $url = "http://127.0.0.1:{$pm->getFreePort()}/cache.txt";
+        for ($i = 0; $i < 3; $i++) {
+            $response = httpRequest($url);
+            Assert::same($response['statusCode'], 200);
+            Assert::same($response['body'], 'version 1');
+            Assert::same($response['headers']['content-type'], 'text/plain');
+            Assert::notEmpty($response['headers']['last-modified']);
+        }
+
+        // replaced file is found after the revalidation interval
+        file_put_contents(STATIC_FILE . '.tmp', 'version 2 is longer');
+        rename(STATIC_FILE . '.tmp', STATIC_FILE);
+        Co::sleep(0.2);
+        Assert::same(httpGetBody($url), 'version 2 is longer');
+
+        // deleted file is not served from the cache
+        unlink(STATIC_FILE);
+        Co::sleep(0.2);
+        Assert::same(httpGetBody($url), 'dynamic');
+    });
+    $pm->kill();
+    echo "DONE\n";
+};
+$pm->childFunc = function () use ($pm) {
+    $http = new Server('127.0.0.1', $pm->getFreePort(), SWOOLE_PROCESS);
+    $http->set([
+        'log_file' => '/dev/null',
+        'worker_num' => 1,
+        'enable_static_handler' => true,
+        'document_root' => DOCUMENT_ROOT,
+        'static_handler_cache_capacity' => 16,
+        'static_handler_cache_interval' => 0.1,
+    ]);
+    $http->on('workerStart', function () use ($pm) {
+        $pm->wakeup();
+    });
+    $http->on('request', function (Request $request, Response $response) {
+        $response->end('dynamic');
+    });
+    $http->start();
+};
+$pm->childFirst();
+$pm->run();
+@unlink(STATIC_FILE);
+@rmdir(DOCUMENT_ROOT);
+?>
+--EXPECT--
+DONE
@@ -0,0 +1,85 @@
+--TEST--
+swoole_http_server/static_handler: precompressed files
+--SKIPIF--
+<?php
+require __DIR__ . '/../../include/skipif.inc'; ?>
+--FILE--
+<?php
+require __DIR__ . '/../../include/bootstrap.php';
+
+use Swoole\Http\Request;
+use Swoole\Http\Response;
+use Swoole\Http\Server;
+
+define('DOCUMENT_ROOT', '/tmp/swoole_static_precompressed');
+define('STATIC_FILE', DOCUMENT_ROOT . '/a.txt');
+define('LARGE_FILE', DOCUMENT_ROOT . '/large.txt');
+
+@mkdir(DOCUMENT_ROOT);
+file_put_contents(STATIC_FILE, 'original');
+// the variant is told apart from the original by its content
+file_put_contents(STATIC_FILE . '.gz', gzencode('precompressed'));
+file_put_contents(LARGE_FILE, str_repeat('swoole ', 1024));
+
+$pm = new ProcessManager;
+$pm->parentFunc = function () use ($pm) {
+    Swoole\Coroutine\run(function () use ($pm) {
+        $url = "http://127.0.0.1:{$pm->getFreePort()}";
+
+        $response = httpRequest("{$url}/a.txt", ['headers' => ['Accept-Encoding' => 'gzip']]);
+        Assert::same($response['statusCode'], 200);
+        Assert::same($response['headers']['content-encoding'], 'gzip');
+        Assert::same($response['headers']['vary'], 'Accept-Encoding');
+        Assert::same($response['headers']['content-type'], 'text/plain');
+        Assert::same($response['body'], 'precompressed');
+
+        $response = httpRequest("{$url}/a.txt", ['headers' => ['Accept-Encoding' => 'gzip;q=0, br']]);
+        Assert::false(isset($response['headers']['content-encoding']));
+        Assert::same($response['headers']['vary'], 'Accept-Encoding');
+        Assert::same($response['body'], 'original');
+
+        // a variant older than the original is not served
+        touch(STATIC_FILE . '.gz', time() - 10);
+        Assert::same(httpGetBody("{$url}/a.txt", ['headers' => ['Accept-Encoding' => 'gzip']]), 'original');
+
+        // the variant is built in the background
+        Assert::same(httpGetBody("{$url}/large.txt", ['headers' => ['Accept-Encoding' => 'gzip']]), str_repeat('swoole ', 1024));
+        for ($i = 0; $i < 50 && !is_file(LARGE_FILE . '.gz'); $i++) {
+            Co::sleep(0.02);
+        }
+        Assert::same(gzdecode(file_get_contents(LARGE_FILE . '.gz')), str_repeat('swoole ', 1024));
+        $response = httpRequest("{$url}/large.txt", ['headers' => ['Accept-Encoding' => 'gzip']]);
+        Assert::same($response['headers']['content-encoding'], 'gzip');
+        Assert::same($response['body'], str_repeat('swoole ', 1024));
+    });
+    $pm->kill();
+    echo "DONE\n";
+};
+$pm->childFunc = function () use ($pm) {
+    $http = new Server('127.0.0.1', $pm->getFreePort(), SWOOLE_PROCESS);
+    $http->set([
+        'log_file' => '/dev/null',
+        'worker_num' => 1,
+        'enable_static_handler' => true,
+        'document_root' => DOCUMENT_ROOT,
+        'http_compression' => true,
+        'static_handler_precompress' => true,
+    ]);
+    $http->on('workerStart', function () use ($pm) {
+        $pm->wakeup();
+    });
+    $http->on('request', function (Request $request, Response $response) {
+        $response->end('dynamic');
+    });
+    $http->start();
+};
+$pm->childFirst();
+$pm->run();
+@unlink(STATIC_FILE);
+@unlink(STATIC_FILE . '.gz');
+@unlink(LARGE_FILE);
+@unlink(LARGE_FILE . '.gz');
+@rmdir(DOCUMENT_ROOT);
+?>
+--EXPECT--
+DONE
@@ -0,0 +1,82 @@
+--TEST--
+swoole_http_server/static_handler: range requests
+--SKIPIF--
+<?php
+require __DIR__ . '/../../include/skipif.inc'; ?>
+--FILE--
+<?php
+require __DIR__ . '/../../include/bootstrap.php';
+
+use Swoole\Http\Request;
+use Swoole\Http\Response;
+use Swoole\Http\Server;
+
+$pm = new ProcessManager;
+$pm->parentFunc = function () use ($pm) {
+    Swoole\Coroutine\run(function () use ($pm) {
+        $url = "http://127.0.0.1:{$pm->getFreePort()}/test.jpg";
+        $data = file_get_contents(TEST_IMAGE);
+        $size = strlen($data);
+
+        $response = httpRequest($url);
+        Assert::same($response['statusCode'], 200);
+        Assert::same($response['headers']['accept-ranges'], 'bytes');
+        $etag = $response['headers']['etag'];
+        Assert::notEmpty($etag);
+
+        $response = httpRequest($url, ['headers' => ['If-None-Match' => $etag]]);
+        Assert::same($response['statusCode'], 304);
+
+        $response = httpRequest($url, ['headers' => ['Range' => 'bytes=100-199']]);
+        Assert::same($response['statusCode'], 206);
+        Assert::same($response['headers']['content-range'], "bytes 100-199/{$size}");
+        Assert::same($response['body'], substr($data, 100, 100));
+
+        $response = httpRequest($url, ['headers' => ['Range' => 'bytes=-10']]);
+        Assert::same($response['statusCode'], 206);
+        Assert::same($response['body'], substr($data, -10));
+
+        $response = httpRequest($url, ['headers' => ['Range' => "bytes={$size}-"]]);
+        Assert::same($response['statusCode'], 416);
+        Assert::same($response['headers']['content-range'], "bytes */{$size}");
+
+        // the validator does not match, the whole file is sent
+        $response = httpRequest($url, ['headers' => ['Range' => 'bytes=0-9', 'If-Range' => '"other"']]);
+        Assert::same($response['statusCode'], 200);
+        Assert::same(strlen($response['body']), $size);
+
+        $response = httpRequest($url, ['headers' => ['Range' => 'bytes=0-9,20-29', 'If-Range' => $etag]]);
+        Assert::same($response['statusCode'], 206);
+        Assert::true((bool)preg_match('/^multipart\/byteranges; boundary=(\w+)$/', $response['headers']['content-type'], $matches));
+        $boundary = $matches[1];
+        $expected = '';
+        foreach ([[0, 9], [20, 29]] as list($start, $end)) {
+            $expected .= "\r\n--{$boundary}\r\nContent-Type: image/jpeg\r\nContent-Range: bytes {$start}-{$end}/{$size}\r\n\r\n";
+            $expected .= substr($data, $start, $end - $start + 1);
+        }
+        $expected .= "\r\n--{$boundary}--\r\n";
+        Assert::same($response['body'], $expected);
+    });
+    $pm->kill();
+    echo "DONE\n";
+};
+$pm->childFunc = function () use ($pm) {
+    $http = new Server('127.0.0.1', $pm->getFreePort(), SWOOLE_BASE);
+    $http->set([
+        'log_file' => '/dev/null',
+        'enable_static_handler' => true,
+        'document_root' => dirname(TEST_IMAGE),
+    ]);
+    $http->on('workerStart', function () use ($pm) {
+        $pm->wakeup();
+    });
+    $http->on('request', function (Request $request, Response $response) {
+        $response->end('dynamic');
+    });
+    $http->start();
+};
+$pm->childFirst();
+$pm->run();
+?>
+--EXPECT--
+DONE
@@ -26,7 +26,7 @@ $pm->childFirst();
 $pm->run();
 ?>
 --EXPECTF--
-array(11) {
+array(12) {
   ["start_time"]=>
   int(%d)
   ["connection_num"]=>
@@ -43,6 +43,8 @@ array(11) {
   int(0)
   ["request_count"]=>
   int(0)
+  ["dgram_send_dropped"]=>
+  int(0)
   ["worker_request_count"]=>
   int(0)
   ["worker_dispatch_count"]=>
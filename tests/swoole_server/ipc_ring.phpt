@@ -0,0 +1,77 @@
+--TEST--
+swoole_server: shared memory ring between reactor threads and workers
+--SKIPIF--
+<?php
+require __DIR__ . '/../include/skipif.inc';
+?>
+--FILE--
+<?php
+require __DIR__ . '/../include/bootstrap.php';
+
+const REQ_N = 2000;
+const CLIENT_N = 4;
+
+$pm = new SwooleTest\ProcessManager;
+
+$pm->parentFunc = function ($pid) use ($pm) {
+    for ($i = 0; $i < CLIENT_N; $i++) {
+        go(function () use ($pm) {
+            $cli = new Co\Client(SWOOLE_SOCK_TCP);
+            if ($cli->connect('127.0.0.1', $pm->getFreePort(), 1) == false) {
+                echo "ERROR\n";
+                return;
+            }
+            for ($n = 0; $n < REQ_N; $n++) {
+                // the big packets go through the pipe, the others through the ring
+                $len = $n % 100 == 0 ? rand(128 * 1024, 512 * 1024) : rand(0, 4096);
+                $cli->send(pack('NN', $len + 4, $n) . str_repeat(chr(ord('A') + $n % 10), $len));
+            }
+            $cli->send(pack('NN', 4, REQ_N));
+            Assert::same($cli->recv(), "OK\n");
+        });
+    }
+    Swoole\Event::wait();
+    echo "DONE\n";
+    $pm->kill();
+};
+
+$pm->childFunc = function () use ($pm) {
+    $serv = new Swoole\Server('127.0.0.1', $pm->getFreePort(), SWOOLE_PROCESS);
+    $serv->set([
+        'reactor_num' => 2,
+        'worker_num' => 2,
+        'dispatch_mode' => 2,
+        'log_level' => SWOOLE_LOG_ERROR,
+        'ipc_ring_size' => 1024 * 1024,
+        'open_length_check' => true,
+        'package_max_length' => 4 * 1024 * 1024,
+        'package_length_type' => 'N',
+        'package_length_offset' => 0,
+        'package_body_offset' => 4,
+    ]);
+    $serv->on("WorkerStart", function (Swoole\Server $serv) use ($pm) {
+        $pm->wakeup();
+    });
+    $serv->on('receive', function (Swoole\Server $serv, $fd, $rid, $data) {
+        static $sequences = [];
+        $n = unpack('N', substr($data, 4, 4))[1];
+        $expect = $sequences[$fd] ?? 0;
+        if ($n != $expect) {
+            $serv->send($fd, "ERROR: expect $expect, got $n\n");
+            return;
+        }
+        $sequences[$fd] = $n + 1;
+        if ($n == REQ_N) {
+            $serv->send($fd, "OK\n");
+        } elseif (strlen($data) > 8 && $data[strlen($data) - 1] !== chr(ord('A') + $n % 10)) {
+            $serv->send($fd, "ERROR: broken packet $n\n");
+        }
+    });
+    $serv->start();
+};
+
+$pm->childFirst();
+$pm->run();
+?>
+--EXPECT--
+DONE
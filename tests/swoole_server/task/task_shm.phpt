@@ -0,0 +1,48 @@
+--TEST--
+swoole_server/task: large data in the shared memory
+--SKIPIF--
+<?php require __DIR__ . '/../../include/skipif.inc'; ?>
+--FILE--
+<?php
+require __DIR__ . '/../../include/bootstrap.php';
+$pm = new SwooleTest\ProcessManager;
+$pm->parentFunc = function (int $pid) use ($pm) {
+    echo file_get_contents("http://127.0.0.1:{$pm->getFreePort()}/") . "\n";
+    $pm->kill();
+};
+$pm->childFunc = function () use ($pm) {
+    $http = new Swoole\Http\Server('127.0.0.1', $pm->getFreePort(), SERVER_MODE_RANDOM);
+    $http->set([
+        'log_file' => '/dev/null',
+        'worker_num' => 1,
+        'task_worker_num' => 2,
+        'task_shm_size' => 2 * 1024 * 1024,
+        'task_shm_slice_size' => 256 * 1024,
+    ]);
+    $http->on('workerStart', function () use ($pm) {
+        $pm->wakeup();
+    });
+    $http->on('request', function (Swoole\Http\Request $request, Swoole\Http\Response $response) use ($http) {
+        // the shared memory is used up by the taskWaitMulti, the rest goes to the tmpfile
+        $tasks = [];
+        for ($i = 0; $i < 16; $i++) {
+            $tasks[] = str_repeat(chr(ord('a') + $i), 100 * 1024 + $i);
+        }
+        $tasks[] = str_repeat('z', 1024 * 1024);
+        $results = $http->taskWaitMulti($tasks, 5);
+        foreach ($tasks as $i => $data) {
+            Assert::same($results[$i], strrev($data));
+        }
+        Assert::same($http->taskwait($tasks[0]), strrev($tasks[0]));
+        $response->end('DONE');
+    });
+    $http->on('task', function ($server, $task_id, $worker_id, string $data) {
+        return strrev($data);
+    });
+    $http->start();
+};
+$pm->childFirst();
+$pm->run();
+?>
+--EXPECT--
+DONE
@@ -0,0 +1,50 @@
+--TEST--
+swoole_server: batched udp receiving and sending
+--SKIPIF--
+<?php require __DIR__ . '/../include/skipif.inc'; ?>
+--FILE--
+<?php
+require __DIR__ . '/../include/bootstrap.php';
+
+const N = 200;
+$port = get_one_free_port();
+
+$pm = new SwooleTest\ProcessManager;
+$pm->parentFunc = function ($pid) use ($port) {
+    $client = new swoole_client(SWOOLE_SOCK_UDP, SWOOLE_SOCK_SYNC);
+    Assert::assert($client->connect('127.0.0.1', $port, 5));
+    for ($i = 0; $i < N; $i++) {
+        $client->send("packet-{$i}");
+    }
+    $replies = [];
+    for ($i = 0; $i < N; $i++) {
+        $replies[] = $client->recv();
+    }
+    sort($replies);
+    $expected = array_map(function ($i) { return "reply-packet-{$i}"; }, range(0, N - 1));
+    sort($expected);
+    Assert::same($replies, $expected);
+    swoole_process::kill($pid);
+    echo "DONE\n";
+};
+$pm->childFunc = function () use ($pm, $port) {
+    $serv = new swoole_server('127.0.0.1', $port, SERVER_MODE_RANDOM, SWOOLE_SOCK_UDP);
+    $serv->set([
+        'worker_num' => 1,
+        'log_file' => '/dev/null',
+        'dgram_recv_burst' => 32,
+        'dgram_send_batch' => 16,
+    ]);
+    $serv->on('workerStart', function ($serv) use ($pm) {
+        $pm->wakeup();
+    });
+    $serv->on('packet', function ($serv, $data, $client) {
+        Assert::assert($serv->sendto($client['address'], $client['port'], "reply-{$data}"));
+    });
+    $serv->start();
+};
+$pm->childFirst();
+$pm->run();
+?>
+--EXPECT--
+DONE
@@ -0,0 +1,52 @@
+--TEST--
+swoole_table: lock-free reads with seqlock
+--SKIPIF--
+<?php require  __DIR__ . '/../include/skipif.inc'; ?>
+--FILE--
+<?php
+require __DIR__ . '/../include/bootstrap.php';
+
+$table = new Swoole\Table(1024, 0.2, true);
+$table->column('a', Swoole\Table::TYPE_INT, 8);
+$table->column('b', Swoole\Table::TYPE_INT, 8);
+$table->column('s', Swoole\Table::TYPE_STRING, 32);
+$table->create();
+
+Assert::false($table->get('key'));
+Assert::false($table->exist('key'));
+$table->set('key', ['a' => 1, 'b' => 1, 's' => 'hello']);
+Assert::same($table->get('key'), ['a' => 1, 'b' => 1, 's' => 'hello']);
+Assert::same($table->get('key', 's'), 'hello');
+Assert::true($table->exist('key'));
+Assert::same($table['key']['a'], 1);
+
+$writer = new Swoole\Process(function () use ($table) {
+    for ($n = 2; $n < 100000; $n++) {
+        $table->set('key', ['a' => $n, 'b' => $n, 's' => "value_$n"]);
+    }
+});
+$writer->start();
+
+// readers never see a half written row
+$pids = [];
+for ($i = 0; $i < 4; $i++) {
+    $pids[] = (new Swoole\Process(function () use ($table) {
+        for ($n = 0; $n < 20000; $n++) {
+            $row = $table->get('key');
+            if ($row['a'] !== $row['b'] or ($row['a'] > 1 and $row['s'] !== "value_{$row['a']}")) {
+                exit(1);
+            }
+        }
+    }))->start();
+}
+for ($i = 0; $i < 5; $i++) {
+    $status = Swoole\Process::wait();
+    Assert::same($status['code'], 0);
+}
+
+Assert::true($table->del('key'));
+Assert::false($table->get('key'));
+echo "SUCCESS\n";
+?>
+--EXPECT--
+SUCCESS
@@ -0,0 +1,56 @@
+--TEST--
+swoole_websocket_server: broadcast
+--SKIPIF--
+<?php require __DIR__ . '/../include/skipif.inc'; ?>
+--FILE--
+<?php
+require __DIR__ . '/../include/bootstrap.php';
+const CLIENT_NUM = 8;
+$pm = new ProcessManager;
+$pm->parentFunc = function (int $pid) use ($pm) {
+    go(function () use ($pm) {
+        $clients = [];
+        for ($i = 0; $i < CLIENT_NUM; $i++) {
+            $cli = new \Swoole\Coroutine\Http\Client('127.0.0.1', $pm->getFreePort());
+            $cli->set(['timeout' => 5]);
+            Assert::assert($cli->upgrade('/'));
+            $clients[] = $cli;
+        }
+        // the last client asks for the broadcast
+        Assert::assert(end($clients)->push('broadcast'));
+        foreach ($clients as $cli) {
+            $frame = $cli->recv();
+            Assert::same($frame->opcode, WEBSOCKET_OPCODE_BINARY);
+            Assert::same($frame->data, str_repeat('x', 100000));
+            $frame = $cli->recv();
+            Assert::same($frame->data, 'sent to ' . CLIENT_NUM);
+        }
+        echo "DONE\n";
+    });
+    swoole_event_wait();
+    $pm->kill();
+};
+$pm->childFunc = function () use ($pm) {
+    $serv = new swoole_websocket_server('127.0.0.1', $pm->getFreePort(), SERVER_MODE_RANDOM);
+    $serv->set([
+        'log_file' => '/dev/null',
+        'worker_num' => 2,
+    ]);
+    $serv->on('WorkerStart', function () use ($pm) {
+        $pm->wakeup();
+    });
+    $serv->on('Message', function (swoole_websocket_server $serv, swoole_websocket_frame $frame) {
+        // the closed and unknown fds are skipped
+        $fds = array_merge(iterator_to_array($serv->connections), [999999]);
+        $n = $serv->broadcast(new ArrayIterator($fds), str_repeat('x', 100000), WEBSOCKET_OPCODE_BINARY);
+        $reply = new swoole_websocket_frame;
+        $reply->data = "sent to {$n}";
+        $serv->broadcast($fds, $reply);
+    });
+    $serv->start();
+};
+$pm->childFirst();
+$pm->run();
+?>
+--EXPECT--
+DONE
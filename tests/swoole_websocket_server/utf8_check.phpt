@@ -0,0 +1,51 @@
+--TEST--
+swoole_websocket_server: close the connection on invalid UTF-8 text
+--SKIPIF--
+<?php require __DIR__ . '/../include/skipif.inc'; ?>
+--FILE--
+<?php
+require __DIR__ . '/../include/bootstrap.php';
+$pm = new ProcessManager;
+$pm->parentFunc = function (int $pid) use ($pm) {
+    go(function () use ($pm) {
+        $cli = new \Swoole\Coroutine\Http\Client('127.0.0.1', $pm->getFreePort());
+        $cli->set(['timeout' => 5]);
+        Assert::assert($cli->upgrade('/'));
+
+        $text = str_repeat("caf\xc3\xa9 \xf0\x9f\x98\x80 ", 1000);
+        Assert::assert($cli->push($text));
+        Assert::same($cli->recv()->data, $text);
+
+        // a fragmented message is checked as a whole
+        Assert::assert($cli->push(substr($text, 0, 4), WEBSOCKET_OPCODE_TEXT, false));
+        Assert::assert($cli->push(substr($text, 4), WEBSOCKET_OPCODE_CONTINUATION, true));
+        Assert::same($cli->recv()->data, $text);
+
+        Assert::assert($cli->push(str_repeat('a', 100) . "\xed\xa0\x80"));
+        $frame = $cli->recv();
+        Assert::same($frame->opcode, WEBSOCKET_OPCODE_CLOSE);
+        Assert::same($frame->code, WEBSOCKET_CLOSE_MESSAGE_ERROR);
+        echo "DONE\n";
+    });
+    swoole_event_wait();
+    $pm->kill();
+};
+$pm->childFunc = function () use ($pm) {
+    $serv = new swoole_websocket_server('127.0.0.1', $pm->getFreePort(), SERVER_MODE_RANDOM);
+    $serv->set([
+        'log_file' => '/dev/null',
+        'open_websocket_utf8_check' => true,
+    ]);
+    $serv->on('WorkerStart', function () use ($pm) {
+        $pm->wakeup();
+    });
+    $serv->on('Message', function (swoole_websocket_server $serv, swoole_websocket_frame $frame) {
+        $serv->push($frame->fd, $frame->data);
+    });
+    $serv->start();
+};
+$pm->childFirst();
+$pm->run();
+?>
+--EXPECT--
+DONE
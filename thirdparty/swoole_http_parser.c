@@ -22,6 +22,11 @@
 #include <stddef.h>
 #include "swoole_http_parser.h"
 
+#if defined(__x86_64__) && defined(__GNUC__)
+# define HTTP_PARSER_SIMD 1
+# include <immintrin.h>
+#endif
+
 
 #ifndef MIN
 # define MIN(a,b) ((a) < (b) ? (a) : (b))
@@ -262,6 +267,116 @@ enum flags
 #endif
 
 
+/* Runs of bytes which only move the parser forward (the path, the query
+ * string, a plain header name or value) are skipped by one block compare.
+ * A byte stops the run when it is out of [lo, hi] or equals x1 or x2, the
+ * stop byte and the last (< block size) bytes go through the state machine.
+ */
+static int simd_level = -1;
+
+static int http_simd_detect (void)
+{
+#ifdef HTTP_PARSER_SIMD
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("avx2")) {
+    return PHP_HTTP_SIMD_AVX2;
+  }
+  return PHP_HTTP_SIMD_SSE2;
+#else
+  return PHP_HTTP_SIMD_NONE;
+#endif
+}
+
+int swoole_http_parser_set_simd_level (int level)
+{
+  int supported = http_simd_detect();
+  simd_level = level > supported ? supported : level;
+  return simd_level;
+}
+
+#ifdef HTTP_PARSER_SIMD
+static const char * http_skip_sse2 (const char *p, const char *pe,
+                                    unsigned char lo, unsigned char hi,
+                                    char x1, char x2)
+{
+  const __m128i vlo = _mm_set1_epi8((char) lo);
+  const __m128i vrange = _mm_set1_epi8((char) (hi - lo));
+  const __m128i v1 = _mm_set1_epi8(x1);
+  const __m128i v2 = _mm_set1_epi8(x2);
+
+  for (; pe - p >= 16; p += 16) {
+    __m128i b = _mm_loadu_si128((const __m128i *) p);
+    /* unsigned (b - lo) <= (hi - lo) */
+    __m128i t = _mm_sub_epi8(b, vlo);
+    __m128i in = _mm_cmpeq_epi8(_mm_max_epu8(t, vrange), vrange);
+    __m128i stop = _mm_or_si128(_mm_cmpeq_epi8(b, v1), _mm_cmpeq_epi8(b, v2));
+    int mask = _mm_movemask_epi8(_mm_andnot_si128(stop, in)) ^ 0xffff;
+    if (mask) {
+      return p + __builtin_ctz(mask);
+    }
+  }
+  return p;
+}
+
+__attribute__((target("avx2")))
+static const char * http_skip_avx2 (const char *p, const char *pe,
+                                    unsigned char lo, unsigned char hi,
+                                    char x1, char x2)
+{
+  const __m256i vlo = _mm256_set1_epi8((char) lo);
+  const __m256i vrange = _mm256_set1_epi8((char) (hi - lo));
+  const __m256i v1 = _mm256_set1_epi8(x1);
+  const __m256i v2 = _mm256_set1_epi8(x2);
+
+  /* most of the header values are short, a long run goes on with 32 bytes */
+  if (pe - p < 64) {
+    return http_skip_sse2(p, pe, lo, hi, x1, x2);
+  }
+  for (; pe - p >= 32; p += 32) {
+    __m256i b = _mm256_loadu_si256((const __m256i *) p);
+    __m256i t = _mm256_sub_epi8(b, vlo);
+    __m256i in = _mm256_cmpeq_epi8(_mm256_max_epu8(t, vrange), vrange);
+    __m256i stop = _mm256_or_si256(_mm256_cmpeq_epi8(b, v1), _mm256_cmpeq_epi8(b, v2));
+    unsigned int mask = ~(unsigned int) _mm256_movemask_epi8(_mm256_andnot_si256(stop, in));
+    if (mask) {
+      return p + __builtin_ctz(mask);
+    }
+  }
+  return http_skip_sse2(p, pe, lo, hi, x1, x2);
+}
+#endif
+
+static inline const char * http_skip (const char *p, const char *pe,
+                                       unsigned char lo, unsigned char hi,
+                                       char x1, char x2)
+{
+#ifdef HTTP_PARSER_SIMD
+  if (simd_level == PHP_HTTP_SIMD_AVX2) {
+    return http_skip_avx2(p, pe, lo, hi, x1, x2);
+  } else if (simd_level == PHP_HTTP_SIMD_SSE2) {
+    return http_skip_sse2(p, pe, lo, hi, x1, x2);
+  }
+#endif
+  return p;
+}
+
+/* Moves p to the byte before the end of the run, the loop increment lands on
+ * it. The header size limit still errors out at the same byte.
+ */
+#define SKIP_RUN(lo, hi, x1, x2)                                     \
+do {                                                                 \
+  const char *end = pe;                                              \
+  const char *q;                                                     \
+  if (PARSING_HEADER(state)                                          \
+      && (size_t) (pe - p - 1) > PHP_HTTP_MAX_HEADER_SIZE - nread) { \
+    end = p + 1 + (PHP_HTTP_MAX_HEADER_SIZE - nread);                \
+  }                                                                  \
+  q = http_skip(p + 1, end, lo, hi, x1, x2);                         \
+  if (PARSING_HEADER(state)) nread += q - (p + 1);                   \
+  p = q - 1;                                                         \
+} while (0)
+
+
 size_t swoole_http_parser_execute (swoole_http_parser *parser,
                             const swoole_http_parser_settings *settings,
                             const char *data,
@@ -287,6 +402,12 @@ size_t swoole_http_parser_execute (swoole_http_parser *parser,
   const char *path_mark = 0;
   const char *url_mark = 0;
 
+  /* the 32 bytes loop does not pay off for the short runs of a request,
+   * AVX2 is only used if it is set explicitly */
+  if (simd_level < 0) {
+    swoole_http_parser_set_simd_level(PHP_HTTP_SIMD_SSE2);
+  }
+
   if (len == 0) {
     if (state == s_body_identity_eof) {
       CALLBACK_MESSAGE_COMPLETE();
@@ -699,7 +820,10 @@ size_t swoole_http_parser_execute (swoole_http_parser *parser,
 
       case s_req_path:
       {
-        if (normal_url_char[(unsigned char)ch]) break;
+        if (normal_url_char[(unsigned char)ch]) {
+          SKIP_RUN(0x21, 0x7e, '?', '#');
+          break;
+        }
 
         switch (ch) {
           case ' ':
@@ -773,7 +897,11 @@ size_t swoole_http_parser_execute (swoole_http_parser *parser,
 
       case s_req_query_string:
       {
-        if (normal_url_char[(unsigned char)ch]) break;
+        if (normal_url_char[(unsigned char)ch]) {
+          /* extra '?' is allowed in the query string */
+          SKIP_RUN(0x21, 0x7e, '#', '#');
+          break;
+        }
 
         switch (ch) {
           case '?':
@@ -1027,6 +1155,8 @@ size_t swoole_http_parser_execute (swoole_http_parser *parser,
         if (c) {
           switch (header_state) {
             case h_general:
+              /* tokens and the other normal chars, ' ' included */
+              SKIP_RUN(0x20, 0x7e, ':', '?');
               break;
 
             case h_C:
@@ -1235,6 +1365,7 @@ size_t swoole_http_parser_execute (swoole_http_parser *parser,
 
         switch (header_state) {
           case h_general:
+            SKIP_RUN(0x00, 0xff, CR, LF);
             break;
 
           case h_connection:
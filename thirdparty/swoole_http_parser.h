@@ -235,6 +235,14 @@ int swoole_http_should_keep_alive(swoole_http_parser *parser);
 /* Returns a string version of the HTTP method. */
 const char *swoole_http_method_str(enum swoole_http_method);
 
+enum swoole_http_parser_simd_level { PHP_HTTP_SIMD_NONE = 0, PHP_HTTP_SIMD_SSE2, PHP_HTTP_SIMD_AVX2 };
+
+/* The scan of the path, the query string and the plain headers uses SSE2 by
+ * default, AVX2 has to be set. For the tests and the benchmarks, a level
+ * which is not supported by the CPU is lowered, the effective one is returned.
+ */
+int swoole_http_parser_set_simd_level(int level);
+
 #ifdef __cplusplus
 }
 #endif